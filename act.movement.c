@@ -36,6 +36,7 @@
 #include "encounters.h"
 #include "hunts.h"
 #include "class.h"
+#include "graph.h"
 
 /* do_gen_door utility functions */
 static int find_door(struct char_data *ch, const char *type, char *dir,
@@ -232,7 +233,6 @@ EVENTFUNC(event_falling)
   struct mud_event_data *pMudEvent = NULL;
   struct char_data *ch = NULL;
   int height_fallen = 0;
-  char buf[50] = {'\0'};
 
   /* This is just a dummy check, but we'll do it anyway */
   if (event_obj == NULL)
@@ -251,8 +251,8 @@ EVENTFUNC(event_falling)
   if (!IS_NPC(ch) && !IS_PLAYING(ch->desc))
     return 0;
 
-  /* retrieve svariables and convert it */
-  height_fallen += atoi((char *)pMudEvent->sVariables);
+  /* retrieve the distance fallen so far */
+  height_fallen += pMudEvent->iVars[0];
   send_to_char(ch, "AIYEE!!!  You have fallen %d feet!\r\n", height_fallen);
 
   /* already checked if there is a down exit, lets move the char down */
@@ -335,11 +335,7 @@ EVENTFUNC(event_falling)
     act("$n drops from sight.", FALSE, ch, 0, 0, TO_ROOM);
 
     /* are we falling more?  then we gotta increase the heigh fallen */
-    snprintf(buf, sizeof(buf), "%d", height_fallen);
-    /* Need to free the memory, if we are going to change it. */
-    if (pMudEvent->sVariables)
-      free(pMudEvent->sVariables);
-    pMudEvent->sVariables = strdup(buf);
+    pMudEvent->iVars[0] = height_fallen;
     return (1 * PASSES_PER_SEC);
   }
   else
@@ -2163,6 +2159,9 @@ static void do_doorcmd(struct char_data *ch, struct obj_data *obj, int door, int
     break;
   }
 
+  if (!obj)
+    world_doors_changed();
+
   /* Notify the room. */
   if (len < sizeof(buf))
     snprintf(buf + len, sizeof(buf) - len, "%s%s.",
@@ -173,6 +173,7 @@ void create_command_list(void)
 
 void free_command_list(void)
 {
+  free_command_index();
   free(complete_cmd_info);
   complete_cmd_info = NULL;
 }
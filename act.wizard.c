@@ -54,6 +54,13 @@
 #include "mud_event.h"
 #include "premadebuilds.h"
 #include "perfmon.h"
+#include "terrain_cache.h"
+#include "mem_pool.h"
+#include "poller.h"
+#include "db_worker.h"
+#include "file_worker.h"
+#include "mccp.h"
+#include "resolver.h"
 #include "missions.h"
 
 /* local utility functions with file scope */
@@ -1541,6 +1548,8 @@ ACMD(do_switch)
 
     victim->desc = ch->desc;
     ch->desc = NULL;
+    update_zone_occupancy(victim);
+    update_zone_occupancy(ch);
   }
 }
 
@@ -1551,6 +1560,7 @@ void do_cheat(struct char_data *ch)
   case 1: // IMP
     send_to_char(ch, "Your level has been restored, for now!\r\n");
     GET_LEVEL(ch) = LVL_IMPL;
+    update_zone_occupancy(ch);
     break;
   default:
     send_to_char(ch, "You do not have access to this command.\r\n");
@@ -1594,7 +1604,9 @@ ACMD(do_return)
 
     /* And our body's pointer to descriptor now points to our descriptor. */
     ch->desc->character->desc = ch->desc;
+    update_zone_occupancy(ch->desc->character);
     ch->desc = NULL;
+    update_zone_occupancy(ch);
   }
 }
 
@@ -1919,6 +1931,7 @@ ACMD(do_advance)
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_NOHASSLE);
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_HOLYLIGHT);
     REMOVE_BIT_AR(PRF_FLAGS(victim), PRF_SHOWVNUMS);
+    update_zone_occupancy(victim);
     if (!PLR_FLAGGED(victim, PLR_NOWIZLIST))
       run_autowiz();
   }
@@ -2122,6 +2135,7 @@ ACMD(do_invis)
 ACMDU(do_gecho)
 {
   struct descriptor_data *pt;
+  struct broadcast *b;
 
   skip_spaces(&argument);
   delete_doubledollar(argument);
@@ -2130,9 +2144,11 @@ ACMDU(do_gecho)
     send_to_char(ch, "That must be a mistake...\r\n");
   else
   {
+    b = broadcast_new("%s\r\n", argument);
     for (pt = descriptor_list; pt; pt = pt->next)
       if (IS_PLAYING(pt) && pt->character && pt->character != ch)
-        send_to_char(pt->character, "%s\r\n", argument);
+        broadcast_write(b, pt);
+    broadcast_free(b);
 
     mudlog(CMP, MAX(LVL_BUILDER, GET_INVIS_LEV(ch)), TRUE, "(GC) %s gechoed: %s", GET_NAME(ch), argument);
 
@@ -3284,19 +3300,18 @@ ACMD(do_show)
                  "  %5d objects          %5d prototypes\r\n"
                  "  %5d rooms            %5d zones\r\n"
                  "  %5d triggers         %5d shops\r\n"
-                 "  %5d large bufs       %5d autoquests\r\n"
+                 "  %5d out segments     %5d autoquests\r\n"
                  "  %5d hlquests app     %5d total hl quests\r\n"
-                 "  %5d buf switches     %5d overflows\r\n"
-                 "  %5d lists\r\n",
+                 "  %5d overflows        %5d lists\r\n",
                  i, con,
                  top_of_p_table + 1,
                  j, top_of_mobt + 1,
                  k, top_of_objt + 1,
                  top_of_world + 1, top_of_zone_table + 1,
                  top_of_trigt + 1, top_shop + 1,
-                 buf_largecount, total_quests,
+                 buf_segments, total_quests,
                  q_approved, q_total,
-                 buf_switches, buf_overflows, global_lists->iSize);
+                 buf_overflows, global_lists->iSize);
     break;
 
     /* show errors */
@@ -3902,6 +3917,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
     }
     RANGE(1, LVL_IMPL);
     GET_LEVEL(vict) = value;
+    update_zone_occupancy(vict);
     break;
   case 28: /* loadroom */
     if (!str_cmp(val_arg, "off"))
@@ -3971,6 +3987,7 @@ static int perform_set(struct char_data *ch, struct char_data *vict, int mode, c
       return (0);
     }
     SET_OR_REMOVE(PRF_FLAGS(vict), PRF_NOHASSLE);
+    update_zone_occupancy(vict);
     break;
   case 37: /* nosummon */
     SET_OR_REMOVE(PRF_FLAGS(vict), PRF_SUMMONABLE);
@@ -5477,15 +5494,15 @@ void perform_do_copyover()
     /* drop those logging on */
     if (!d->character || d->connected > CON_PLAYING)
     {
-      write_to_descriptor(d->descriptor, "\n\rSorry, we are rebooting. Come back in a few minutes.\n\r");
+      write_to_client(d, "\n\rSorry, we are rebooting. Come back in a few minutes.\n\r");
       close_socket(d); /* throw'em out */
     }
     else
     {
-      write_to_descriptor(d->descriptor, "\n\r *** Time stops for a moment as space and time folds upon itself! ***\n\r"
-                                         "[The game will pause for about 30 seconds while new code is being imported, "
-                                         "you will need to reform if you were grouped.  If you get disconnected, "
-                                         "you should be able to reconnect immediately or within a few minutes.]\r\n");
+      write_to_client(d, "\n\r *** Time stops for a moment as space and time folds upon itself! ***\n\r"
+                         "[The game will pause for about 30 seconds while new code is being imported, "
+                         "you will need to reform if you were grouped.  If you get disconnected, "
+                         "you should be able to reconnect immediately or within a few minutes.]\r\n");
 
       /* and handling we need to do */
 
@@ -5542,6 +5559,11 @@ void perform_do_copyover()
   fprintf(fp, "-1\n");
   fclose(fp);
 
+  /* the pet and player saves above are still queued, finish them before
+   * the exec */
+  db_worker_shutdown();
+  file_worker_shutdown();
+
   /* exec - descriptors are inherited */
   snprintf(buf, sizeof(buf), "%d", port);
   snprintf(buf2, sizeof(buf2), "-C%d", mother_desc);
@@ -5565,7 +5587,6 @@ EVENTFUNC(event_copyover)
   struct descriptor_data *pt = NULL;
   struct char_data *ch = NULL;
   int timer = 0;
-  char buf[50] = {'\0'};
 
   /* initialize everything and dummy checks */
   if (event_obj == NULL)
@@ -5576,14 +5597,8 @@ EVENTFUNC(event_copyover)
 
   /* in case our event owner decides to log out*/
 
-  /* grab and clear initial timer from sVar */
-  if (copyover_event->sVariables)
-  {
-    timer = atoi((char *)copyover_event->sVariables); /* in seconds */
-    free(copyover_event->sVariables);
-  }
-  else
-    timer = 0;
+  /* grab the timer, in seconds */
+  timer = copyover_event->iVars[0];
 
   /* all done, copyover (if we can)! */
   if (timer <= 0)
@@ -5603,8 +5618,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[COPYOVER IMMINENT!]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (timer - 1));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = timer - 1;
     return (1 * PASSES_PER_SEC);
   }
   else if (timer == 2)
@@ -5612,8 +5626,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 2 seconds]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (timer - 1));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = timer - 1;
     return (1 * PASSES_PER_SEC);
   }
   else if (timer == 3)
@@ -5621,8 +5634,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 3 seconds]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (timer - 1));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = timer - 1;
     return (1 * PASSES_PER_SEC);
   }
   else if (timer <= 10)
@@ -5630,8 +5642,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 10 seconds]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (3));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = 3;
     return ((timer - 3) * PASSES_PER_SEC);
   }
   else if (timer <= 30)
@@ -5639,8 +5650,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 30 seconds]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (10));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = 10;
     return ((timer - 10) * PASSES_PER_SEC);
   }
   else if (timer <= 60)
@@ -5648,8 +5658,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 1 minute, please disengage from combat and find a safe place to wait]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (30));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = 30;
     return ((timer - 30) * PASSES_PER_SEC);
   }
   else if (timer <= 180)
@@ -5657,8 +5666,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 3 minutes]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (60));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = 60;
     return ((timer - 60) * PASSES_PER_SEC);
   }
   else if (timer <= 300)
@@ -5666,8 +5674,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 5 minutes]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (180));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = 180;
     return ((timer - 180) * PASSES_PER_SEC);
   }
   else if (timer <= 600)
@@ -5675,8 +5682,7 @@ EVENTFUNC(event_copyover)
     for (pt = descriptor_list; pt; pt = pt->next)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in less than 10 minutes]\tn\r\n");
-    snprintf(buf, sizeof(buf), "%d", (300));
-    copyover_event->sVariables = strdup(buf);
+    copyover_event->iVars[0] = 300;
     return ((timer - 300) * PASSES_PER_SEC);
   }
   else
@@ -5685,7 +5691,7 @@ EVENTFUNC(event_copyover)
       if (pt->character)
         send_to_char(pt->character, "\r\n     \tR[Copyover in about %d minutes]\tn\r\n",
                      timer / 60);
-    copyover_event->sVariables = strdup("600");
+    copyover_event->iVars[0] = 600;
     return ((timer - 600) * PASSES_PER_SEC);
   }
 }
@@ -5696,7 +5702,6 @@ ACMD(do_copyover)
   int min_level_to_copyover = LVL_GRSTAFF;
   char arg[MAX_INPUT_LENGTH];
   int timer = 0;
-  char buf[50] = {'\0'};
   struct descriptor_data *pt = NULL;
 
   if (port == CONFIG_DFLT_DEV_PORT)
@@ -5745,8 +5750,7 @@ ACMD(do_copyover)
                    "To cancel type: copyover cancel\r\n",
                timer);
 
-  snprintf(buf, sizeof(buf), "%d", timer); /* sVariable */
-  NEW_EVENT(eCOPYOVER, ch, strdup(buf), (1 * PASSES_PER_SEC));
+  NEW_EVENT_VAR(eCOPYOVER, ch, timer, (1 * PASSES_PER_SEC));
 }
 
 /* stop combat in the room you are in */
@@ -6188,7 +6192,7 @@ ACMD(do_wizupdate)
 bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_name)
 {
   struct char_data *temp_ch = NULL;
-  int plr_i = 0, i, j, k;
+  int plr_i = 0, i, j;
   char old_name[MAX_NAME_LENGTH], old_pfile[50], new_pfile[50], buf[MAX_STRING_LENGTH];
 
   if (!ch)
@@ -6236,11 +6240,7 @@ bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_
   }
 
   /* New playername is OK - find the entry in the index */
-  for (i = 0; i <= top_of_p_table; i++)
-    if (player_table[i].id == GET_IDNUM(vict))
-      break;
-
-  if (player_table[i].id != GET_IDNUM(vict))
+  if ((i = get_ptable_by_id(GET_IDNUM(vict))) < 0)
   {
     send_to_char(ch, "Your target was not found in the player index.\r\n");
     log("SYSERR: Player %s, with ID %ld, could not be found in the player index.", GET_NAME(vict), GET_IDNUM(vict));
@@ -6261,15 +6261,13 @@ bool change_player_name(struct char_data *ch, struct char_data *vict, char *new_
   }
 
   /* Now start changing the name over - all checks and setup have passed */
-  free(player_table[i].name);              // Free the old name in the index
-  player_table[i].name = strdup(new_name); // Insert the new name into the index
-  for (k = 0; (*(player_table[i].name + k) = LOWER(*(player_table[i].name + k))); k++)
-    ;
+  set_player_index_name(i, new_name); // Insert the new name into the index
 
   free(GET_PC_NAME(vict));
   GET_PC_NAME(vict) = strdup(CAP(new_name)); // Change the name in the victims char struct
 
   /* Rename the player's pfile */
+  file_worker_wait(old_pfile);
   snprintf(buf, sizeof(buf), "mv %s %s", old_pfile, new_pfile);
   j = system(buf);
 
@@ -8565,7 +8563,16 @@ ACMD(do_perfmon)
                  "perfmon all             - Print all perfmon info.\r\n"
                  "perfmon summ            - Print summary,\r\n"
                  "perfmon prof            - Print profiling info.\r\n"
-                 "perfmon sect <section>  - Print profiling info for section.\r\n");
+                 "perfmon sect <section>  - Print profiling info for section.\r\n"
+                 "perfmon terrain         - Print wilderness terrain cache info.\r\n"
+                 "perfmon pools           - Print object pool usage.\r\n"
+                 "perfmon poller          - Print socket poller info.\r\n"
+                 "perfmon db              - Print MySQL worker queue and latency.\r\n"
+                 "perfmon files           - Print player file writer queue and timings.\r\n"
+                 "perfmon mccp            - Print MCCP compression per connection.\r\n"
+                 "perfmon resolver        - Print reverse DNS lookups and cache.\r\n"
+                 "perfmon triggers        - Print command, speech and act trigger searches.\r\n"
+                 "perfmon uids            - Print the character and object UID table.\r\n");
     return;
   }
 
@@ -8574,7 +8581,10 @@ ACMD(do_perfmon)
     char buf[MAX_STRING_LENGTH];
 
     size_t written = PERF_repr(buf, sizeof(buf));
-    written = PERF_prof_repr_total(buf + written, sizeof(buf) - written);
+    written += PERF_prof_repr_total(buf + written, sizeof(buf) - written);
+    written += mem_pool_repr(buf + written, sizeof(buf) - written);
+    written += db_worker_repr(buf + written, sizeof(buf) - written);
+    written += file_worker_repr(buf + written, sizeof(buf) - written);
 
     page_string(ch->desc, buf, TRUE);
 
@@ -8606,6 +8616,87 @@ ACMD(do_perfmon)
 
     return;
   }
+  else if (!str_cmp(arg1, "terrain"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    terrain_cache_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "pools"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    mem_pool_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "poller"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    poller_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "db"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    db_worker_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "files"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    file_worker_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "mccp"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    mccp_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "resolver"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    resolver_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "triggers"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    trigger_scan_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
+  else if (!str_cmp(arg1, "uids"))
+  {
+    char buf[MAX_STRING_LENGTH];
+
+    lookup_table_repr(buf, sizeof(buf));
+    page_string(ch->desc, buf, TRUE);
+
+    return;
+  }
   else
   {
     do_perfmon(ch, "", cmd, subcmd);
@@ -107,7 +107,7 @@ EVENTFUNC(event_action_cooldown)
 
   /* Lets show duration for immortals */
   if (GET_LEVEL(ch) >= LVL_IMMORT)
-    snprintf(buf, sizeof(buf), " (%.2f sec)", (float)(atoi(pMudEvent->sVariables)) / 10);
+    snprintf(buf, sizeof(buf), " (%.2f sec)", (float)(pMudEvent->iVars[0]) / 10);
   else
     *buf = '\0';
 
@@ -219,25 +219,21 @@ void start_skill_cooldown(struct char_data *ch, int skill, int weapon)
 
 void start_action_cooldown(struct char_data *ch, action_type act_type, int duration)
 {
-  char svar[50];
-
-  /* Format the sVariables - Always duration first. */
-  snprintf(svar, sizeof(svar), "%d", duration);
-
+  /* The event variable carries the duration. */
   if (act_type == atMOVE)
   {
-    attach_mud_event(new_mud_event(eMOVEACTION, ch, svar), duration);
+    attach_mud_event(new_mud_event_var(eMOVEACTION, ch, duration), duration);
     if (AFF_FLAGGED(ch, AFF_STAGGERED))
-      attach_mud_event(new_mud_event(eSTANDARDACTION, ch, svar), duration);
+      attach_mud_event(new_mud_event_var(eSTANDARDACTION, ch, duration), duration);
   }
   else if (act_type == atSTANDARD)
   {
-    attach_mud_event(new_mud_event(eSTANDARDACTION, ch, svar), duration);
+    attach_mud_event(new_mud_event_var(eSTANDARDACTION, ch, duration), duration);
     if (AFF_FLAGGED(ch, AFF_STAGGERED))
-      attach_mud_event(new_mud_event(eMOVEACTION, ch, svar), duration);
+      attach_mud_event(new_mud_event_var(eMOVEACTION, ch, duration), duration);
   }
   else if (act_type == atSWIFT)
   {
-    attach_mud_event(new_mud_event(eSWIFTACTION, ch, svar), duration);
+    attach_mud_event(new_mud_event_var(eSWIFTACTION, ch, duration), duration);
   }
 };
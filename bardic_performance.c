@@ -229,9 +229,7 @@ ACMD(do_perform)
         /* SUCCESS! */
         act("You start performing.", FALSE, ch, 0, 0, TO_CHAR);
         act("$n starts performing.", FALSE, ch, 0, 0, TO_ROOM);
-        char buf[128];
-        snprintf(buf, sizeof(buf), "%d", i); /* Build the effect string */
-        NEW_EVENT(eBARDIC_PERFORMANCE, ch, strdup(buf), 4 * PASSES_PER_SEC);
+        NEW_EVENT_VAR(eBARDIC_PERFORMANCE, ch, i, 4 * PASSES_PER_SEC);
 
         if (HAS_FEAT(ch, FEAT_EFFICIENT_PERFORMANCE))
           USE_MOVE_ACTION(ch);
@@ -659,17 +657,7 @@ EVENTFUNC(event_bardic_performance)
     return 0;
   }
   /* extract the variable(s) */
-  if (pMudEvent->sVariables == NULL)
-  {
-    /* This is odd - This field should always be populated! */
-    log("SYSERR: sVariables field is NULL for event_bardic_performance: %d",
-        pMudEvent->iId);
-    return 0;
-  }
-  else
-  {
-    performance_num = atoi((char *)pMudEvent->sVariables);
-  }
+  performance_num = pMudEvent->iVars[0];
   /* finished handling event data */
 
   /* disqualifiers */
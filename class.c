@@ -2309,6 +2309,7 @@ void init_start_char(struct char_data *ch)
     }
   }
   GET_DR(ch) = NULL;
+  update_zone_occupancy(ch);
   save_char(ch, 0);
 
   /* reset skills/abilities */
@@ -2994,6 +2995,7 @@ void advance_level(struct char_data *ch, int class)
     send_to_char(ch, "Setting \tRNOHASSLE\tn on.\r\n");
     SET_BIT_AR(PRF_FLAGS(ch), PRF_SHOWVNUMS);
     send_to_char(ch, "Setting \tRSHOWVNUMS\tn on.\r\n");
+    update_zone_occupancy(ch);
   }
 
   /* make sure you aren't snooping someone you shouldn't with new level */
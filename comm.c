@@ -97,6 +97,13 @@
 #include "perfmon.h"
 #include "transport.h"
 #include "hunts.h"
+#include "poller.h"
+#include "mysql.h"
+#include "db_worker.h"
+#include "file_worker.h"
+#include "mccp.h"
+#include "mem_pool.h"
+#include "resolver.h"
 
 #ifndef INVALID_SOCKET
 #define INVALID_SOCKET (-1)
@@ -107,9 +114,8 @@ extern time_t newsmod;
 
 /* locally defined globals, used externally */
 struct descriptor_data *descriptor_list = NULL; /* master desc list */
-int buf_largecount = 0;                         /* # of large buffers which exist */
+int buf_segments = 0;                           /* # of output segments in use */
 int buf_overflows = 0;                          /* # of overflows of output */
-int buf_switches = 0;                           /* # of switches from small to large buf */
 int circle_shutdown = 0;                        /* clean shutdown */
 int circle_reboot = 0;                          /* reboot the game after a shutdown */
 int no_specials = 0;                            /* Suppress ass. of special routines */
@@ -124,7 +130,7 @@ long last_webster_teller = -1L;
 const unsigned PERF_pulse_per_second = PASSES_PER_SEC;
 
 /* static local global variable declarations (current file scope only) */
-static struct txt_block *bufpool = NULL; /* pool of large output buffers */
+static struct mem_pool segment_pool = MEM_POOL_INIT("output segment", struct out_segment, 16);
 static int max_players = 0;              /* max descriptors available */
 static int tics_passed = 0;              /* for extern checkpointing */
 static struct timeval null_time;         /* zero-valued time structure */
@@ -148,6 +154,7 @@ static RETSIGTYPE checkpointing(int sig);
 static RETSIGTYPE hupsig(int sig);
 static ssize_t perform_socket_read(socket_t desc, char *read_point, size_t space_left);
 static ssize_t perform_socket_write(socket_t desc, const char *txt, size_t length);
+static ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int cnt);
 static void circle_sleep(struct timeval *timeout);
 static int get_from_q(struct txt_q *queue, char *dest, int *aliased);
 static void init_game(ush_int port);
@@ -170,7 +177,11 @@ static void init_descriptor(struct descriptor_data *newd, int desc);
 static struct in_addr *get_bind_addr(void);
 static int parse_ip(const char *addr, struct in_addr *inaddr);
 static int set_sendbuf(socket_t s);
-static void free_bufpool(void);
+static void append_output(struct descriptor_data *t, const char *txt, size_t len);
+static int format_output(char *txt, size_t n, const char *format, va_list args);
+static size_t queue_output(struct descriptor_data *t, const char *txt, int size);
+static void consume_output(struct descriptor_data *t, size_t len);
+static int write_iov_to_client(struct descriptor_data *d, const struct iovec *iov, int cnt);
 static void setup_log(const char *filename, int fd);
 static int open_logfile(const char *filename, FILE *stderr_fp);
 #if defined(POSIX)
@@ -402,7 +413,6 @@ int main(int argc, char **argv)
   if (!scheck)
   {
     log("Clearing other memory.");
-    free_bufpool();                        /* comm.c */
     free_player_index();                   /* players.c */
     free_messages();                       /* fight.c */
     free_text_files();                     /* db.c */
@@ -522,12 +532,12 @@ void copyover_recover()
     /* Player file not found?! */
     if (!fOld)
     {
-      write_to_descriptor(desc, "\n\rSomehow, your character was lost in the copyover. Sorry.\n\r");
+      write_to_client(d, "\n\rSomehow, your character was lost in the copyover. Sorry.\n\r");
       close_socket(d);
     }
     else
     {
-      write_to_descriptor(desc, "\n\rCopyover recovery complete.\n\r");
+      write_to_client(d, "\n\rCopyover recovery complete.\n\r");
       GET_PREF(d->character) = pref;
 
       enter_player_game(d);
@@ -567,6 +577,15 @@ static void init_game(ush_int local_port)
     mother_desc = init_socket(local_port);
   }
 
+  if (poller_init() < 0 || poller_add(mother_desc, NULL) < 0)
+    exit(1);
+
+  /* without threads, host names are looked up the old blocking way */
+  resolver_init(RESOLVER_THREADS);
+
+  /* without it, player files are written on the game thread */
+  file_worker_init();
+
   event_init();
 
   /* set up hash table for find_char() */
@@ -603,6 +622,11 @@ static void init_game(ush_int local_port)
   log("Saving current MUD time.");
   save_mud_time(&time_info);
 
+  /* run whatever writes are still queued */
+  db_worker_shutdown();
+  file_worker_shutdown();
+  resolver_shutdown();
+
   if (circle_reboot)
   {
     log("Rebooting.");
@@ -797,12 +821,12 @@ static int get_max_players(void)
  * such as mobile_activity(). */
 void game_loop(socket_t local_mother_desc)
 {
-  fd_set input_set, output_set, exc_set, null_set;
+  struct poller_event *ev;
   struct timeval last_time, opt_time, process_time, temp_time;
   struct timeval before_sleep, now, timeout;
   char comm[MAX_INPUT_LENGTH] = {'\0'};
   struct descriptor_data *d = NULL, *next_d = NULL;
-  int missed_pulses = 0, maxdesc = 0, aliased = 0;
+  int missed_pulses = 0, aliased = 0;
   long int perf_high_water_mark = 0;
 
   /* initialize various time values */
@@ -810,7 +834,6 @@ void game_loop(socket_t local_mother_desc)
   null_time.tv_usec = 0;
   opt_time.tv_usec = OPT_USEC;
   opt_time.tv_sec = 0;
-  FD_ZERO(&null_set);
 
   gettimeofday(&last_time, (struct timezone *)0);
 
@@ -822,37 +845,21 @@ void game_loop(socket_t local_mother_desc)
     if (descriptor_list == NULL)
     {
       log("No connections.  Going to sleep.");
-      FD_ZERO(&input_set);
-      FD_SET(local_mother_desc, &input_set);
-      if (select(local_mother_desc + 1, &input_set, (fd_set *)0, (fd_set *)0, NULL) < 0)
+      /* the mother socket is all that is registered */
+      switch (poller_wait(-1))
       {
-        if (errno == EINTR)
-          log("Waking up to process signal.");
-        else
-          perror("SYSERR: Select coma");
-      }
-      else
+      case -1:
+        perror("SYSERR: Poller coma");
+        break;
+      case 0:
+        log("Waking up to process signal.");
+        break;
+      default:
         log("New connection.  Waking up.");
+        break;
+      }
       gettimeofday(&last_time, (struct timezone *)0);
     }
-    /* Set up the input, output, and exception sets for select(). */
-    FD_ZERO(&input_set);
-    FD_ZERO(&output_set);
-    FD_ZERO(&exc_set);
-    FD_SET(local_mother_desc, &input_set);
-
-    maxdesc = local_mother_desc;
-    for (d = descriptor_list; d; d = d->next)
-    {
-#ifndef CIRCLE_WINDOWS
-      if (d->descriptor > maxdesc)
-        maxdesc = d->descriptor;
-#endif
-      FD_SET(d->descriptor, &input_set);
-      FD_SET(d->descriptor, &output_set);
-      FD_SET(d->descriptor, &exc_set);
-    }
-
     /* At this point, we have completed all input, output and heartbeat
      * activity from the previous iteration, so we have to put ourselves
      * to sleep until the next 0.1 second tick.  The first step is to
@@ -913,34 +920,35 @@ void game_loop(socket_t local_mother_desc)
     PERF_prof_reset();
     PERF_PROF_ENTER(pr_main_loop_, "Main Loop");
 
-    /* Poll (without blocking) for new input, output, and exceptions */
-    if (select(maxdesc + 1, &input_set, &output_set, &exc_set, &null_time) < 0)
+    /* Host names looked up since last pulse, this may close banned sites */
+    resolver_process();
+
+    /* Poll (without blocking) for new connections, input and exceptions */
+    if (poller_wait(0) < 0)
     {
-      perror("SYSERR: Select poll");
+      perror("SYSERR: Poller poll");
       return;
     }
-    /* If there are new connections waiting, accept them. */
-    if (FD_ISSET(local_mother_desc, &input_set))
-      new_descriptor(local_mother_desc);
 
-    /* Kick out the freaky folks in the exception set and marked for close */
-    for (d = descriptor_list; d; d = next_d)
+    PERF_PROF_ENTER(pr_process_input_, "Process Input");
+    /* Only the sockets with something to say come back from the poller. A
+     * socket closed along the way is dropped from the rest of the list. */
+    while ((ev = poller_next()) != NULL)
     {
-      next_d = d->next;
-      if (FD_ISSET(d->descriptor, &exc_set))
+      /* If there are new connections waiting, accept them. */
+      if (ev->fd == local_mother_desc)
       {
-        FD_CLR(d->descriptor, &input_set);
-        FD_CLR(d->descriptor, &output_set);
-        close_socket(d);
+        new_descriptor(local_mother_desc);
+        continue;
       }
-    }
 
-    PERF_PROF_ENTER(pr_process_input_, "Process Input");
-    /* Process descriptors with input pending */
-    for (d = descriptor_list; d; d = next_d)
-    {
-      next_d = d->next;
-      if (FD_ISSET(d->descriptor, &input_set))
+      d = (struct descriptor_data *)ev->data;
+
+      /* Kick out the freaky folks in the exception set */
+      if (IS_SET(ev->events, POLLER_ERROR))
+        close_socket(d);
+      /* Process descriptors with input pending */
+      else if (IS_SET(ev->events, POLLER_READ))
       {
         if (d->pProtocol != NULL)     /* KaVir's plugin */
           d->pProtocol->WriteOOB = 0; /* KaVir's plugin */
@@ -1017,7 +1025,15 @@ void game_loop(socket_t local_mother_desc)
     for (d = descriptor_list; d; d = next_d)
     {
       next_d = d->next;
-      if (*(d->output) && FD_ISSET(d->descriptor, &output_set))
+
+      /* compressed output the socket would not take last pulse goes first */
+      if (mccp_pending(d) && mccp_flush(d) < 0)
+      {
+        close_socket(d);
+        continue;
+      }
+
+      if (d->out_head)
       {
         /* Output for this player is ready */
         if (process_output(d) < 0)
@@ -1035,7 +1051,7 @@ void game_loop(socket_t local_mother_desc)
       if (!d->has_prompt && !d->pProtocol->WriteOOB)
       {
         //if (!d->has_prompt) {
-        write_to_descriptor(d->descriptor, make_prompt(d));
+        write_to_client(d, make_prompt(d));
         d->has_prompt = TRUE;
       }
     }
@@ -1135,6 +1151,12 @@ void heartbeat(int heart_pulse)
   event_process();
   PERF_PROF_EXIT(pr_event_process_);
 
+  PERF_PROF_ENTER(pr_db_worker_, "db_worker_process");
+  db_worker_process();
+  PERF_PROF_EXIT(pr_db_worker_);
+
+  file_worker_process();
+
   if (!(heart_pulse % PULSE_DG_SCRIPT))
   {
     PERF_PROF_ENTER(pr_script_trigger_, "script_trigger_check");
@@ -1242,16 +1264,20 @@ void heartbeat(int heart_pulse)
     PERF_PROF_EXIT(pr_ost_);
   }
 
+  /* a few players every pulse, rather than everyone every autosave_time */
+  if (CONFIG_AUTO_SAVE)
+  {
+    PERF_PROF_ENTER(pr_csa_, "Crash_save_staggered");
+    Crash_save_staggered(heart_pulse);
+    PERF_PROF_EXIT(pr_csa_);
+  }
+
   if (CONFIG_AUTO_SAVE && !(heart_pulse % PULSE_AUTOSAVE))
   { /* 1 minute */
     if (++mins_since_crashsave >= CONFIG_AUTOSAVE_TIME)
     {
       mins_since_crashsave = 0;
 
-      PERF_PROF_ENTER(pr_csa_, "Crash_save_all");
-      Crash_save_all();
-      PERF_PROF_EXIT(pr_csa_);
-
       PERF_PROF_ENTER(pr_hsa_, "House_save_all");
       House_save_all();
       PERF_PROF_EXIT(pr_hsa_);
@@ -1928,11 +1954,17 @@ static int get_from_q(struct txt_q *queue, char *dest, int *aliased)
 /* Empty the queues before closing connection */
 static void flush_queues(struct descriptor_data *d)
 {
-  if (d->large_outbuf)
+  struct out_segment *seg;
+
+  while ((seg = d->out_head))
   {
-    d->large_outbuf->next = bufpool;
-    bufpool = d->large_outbuf;
+    d->out_head = seg->next;
+    mem_pool_free(&segment_pool, seg);
+    buf_segments--;
   }
+  d->out_tail = NULL;
+  d->out_queued = 0;
+
   while (d->input.head)
   {
     struct txt_block *tmp = d->input.head;
@@ -1959,90 +1991,196 @@ size_t write_to_output(struct descriptor_data *t, const char *txt, ...)
 size_t vwrite_to_output(struct descriptor_data *t, const char *format,
                         va_list args)
 {
-  const char *text_overflow = "\r\nOVERFLOW\r\n";
   static char txt[MAX_STRING_LENGTH] = {'\0'};
-  size_t wantsize = 0;
+  const char *out = NULL;
   int size = 0;
 
   /* if we're in the overflow state already, ignore this new output */
-  if (t->bufspace == 0)
+  if (t->out_overflow)
     return (0);
 
-  wantsize = size = vsnprintf(txt, sizeof(txt), format, args);
+  size = format_output(txt, sizeof(txt), format, args);
 
   /* this block is Kavir's protocol */
-  strcpy(txt, ProtocolOutput(t, txt, (int *)&wantsize));
-  size = wantsize;
-  if (t->pProtocol->WriteOOB > 0)
-    --t->pProtocol->WriteOOB;
+  out = ProtocolOutput(t, txt, &size);
+
+  return (queue_output(t, out, size));
+}
+
+/* vsnprintf() into txt, if it is too long truncate it for the overflow
+ * message.  Returns the length. */
+static int format_output(char *txt, size_t n, const char *format, va_list args)
+{
+  const char *text_overflow = "\r\nOVERFLOW\r\n";
+  int size = vsnprintf(txt, n, format, args);
 
-  /* If exceeding the size of the buffer, truncate it for the overflow message */
-  if (size < 0 || wantsize >= sizeof(txt))
+  if (size < 0 || size >= (int)n)
   {
-    size = sizeof(txt) - 1;
+    size = n - 1;
     strcpy(txt + size - strlen(text_overflow), text_overflow); /* strcpy: OK */
   }
 
-  /* If the text is too big to fit into even a large buffer, truncate
-   * the new text to make it fit.  (This will switch to the overflow
-   * state automatically because t->bufspace will end up 0.) */
-  if (size + t->bufptr + 1 > LARGE_BUFSIZE)
+  return (size);
+}
+
+/* Queue text that has been through ProtocolOutput() already.  Returns the
+ * space left, like vwrite_to_output(). */
+static size_t queue_output(struct descriptor_data *t, const char *txt, int size)
+{
+  if (t->pProtocol->WriteOOB > 0)
+    --t->pProtocol->WriteOOB;
+
+  append_output(t, txt, size);
+
+  return (t->out_overflow ? 0 : MAX_OUTPUT_QUEUE - t->out_queued);
+}
+
+/* A message for many descriptors is formatted once, and goes through
+ * ProtocolOutput() once for each class of client that gets it (see
+ * ProtocolOutputClass()) rather than once per descriptor. */
+struct broadcast
+{
+  char *text;
+  int len;
+  char *rendered[PROTOCOL_OUTPUT_CLASSES];
+  int rendered_len[PROTOCOL_OUTPUT_CLASSES];
+};
+
+struct broadcast *vbroadcast_new(const char *format, va_list args)
+{
+  static char txt[MAX_STRING_LENGTH] = {'\0'};
+  struct broadcast *b;
+
+  CREATE(b, struct broadcast, 1);
+  b->len = format_output(txt, sizeof(txt), format, args);
+  CREATE(b->text, char, b->len + 1);
+  memcpy(b->text, txt, b->len + 1);
+
+  return (b);
+}
+
+struct broadcast *broadcast_new(const char *format, ...)
+{
+  struct broadcast *b;
+  va_list args;
+
+  va_start(args, format);
+  b = vbroadcast_new(format, args);
+  va_end(args);
+
+  return (b);
+}
+
+size_t broadcast_write(struct broadcast *b, struct descriptor_data *d)
+{
+  const char *out;
+  int size = b->len, cls;
+
+  if (d->out_overflow)
+    return (0);
+
+  if ((cls = ProtocolOutputClass(d, b->text)) < 0)
   {
-    size = LARGE_BUFSIZE - t->bufptr - 1;
-    txt[size] = '\0';
-    buf_overflows++;
+    out = ProtocolOutput(d, b->text, &size);
+    return (queue_output(d, out, size));
   }
 
-  /* If we have enough space, just write to buffer and that's it! If the
-   * text just barely fits, then it's switched to a large buffer instead. */
-  if (t->bufspace > size)
+  if (!b->rendered[cls])
   {
-    strcpy(t->output + t->bufptr, txt); /* strcpy: OK (size checked above) */
-    t->bufspace -= size;
-    t->bufptr += size;
-    return (t->bufspace);
+    out = ProtocolOutput(d, b->text, &size);
+    CREATE(b->rendered[cls], char, size + 1);
+    memcpy(b->rendered[cls], out, size);
+    b->rendered_len[cls] = size;
   }
 
-  buf_switches++;
+  return (queue_output(d, b->rendered[cls], b->rendered_len[cls]));
+}
 
-  /* if the pool has a buffer in it, grab it */
-  if (bufpool != NULL)
-  {
-    t->large_outbuf = bufpool;
-    bufpool = bufpool->next;
-  }
-  else
-  { /* else create a new one */
-    CREATE(t->large_outbuf, struct txt_block, 1);
-    CREATE(t->large_outbuf->text, char, LARGE_BUFSIZE);
-    buf_largecount++;
-  }
+void broadcast_free(struct broadcast *b)
+{
+  int i;
 
-  strcpy(t->large_outbuf->text, t->output); /* strcpy: OK (size checked previously) */
-  t->output = t->large_outbuf->text;        /* make big buffer primary */
-  strcat(t->output, txt);                   /* strcat: OK (size checked) */
+  for (i = 0; i < PROTOCOL_OUTPUT_CLASSES; i++)
+    if (b->rendered[i])
+      free(b->rendered[i]);
+  free(b->text);
+  free(b);
+}
 
-  /* set the pointer for the next write */
-  t->bufptr = strlen(t->output);
+/* Copy text onto the end of the output queue, in as many segments as it
+ * takes.  Past MAX_OUTPUT_QUEUE the rest is dropped and the descriptor goes
+ * into the overflow state until everything queued has been sent. */
+static void append_output(struct descriptor_data *t, const char *txt, size_t len)
+{
+  struct out_segment *seg = t->out_tail;
+  size_t room;
+
+  if (t->out_queued + len > MAX_OUTPUT_QUEUE)
+  {
+    len = MAX_OUTPUT_QUEUE - t->out_queued;
+    if (!t->out_overflow)
+      buf_overflows++;
+    t->out_overflow = TRUE;
+  }
 
-  /* calculate how much space is left in the buffer */
-  t->bufspace = LARGE_BUFSIZE - 1 - t->bufptr;
+  while (len > 0)
+  {
+    if (!seg || (room = OUTPUT_SEGMENT_SIZE - seg->start - seg->len) == 0)
+    {
+      seg = (struct out_segment *)mem_pool_alloc(&segment_pool);
+      buf_segments++;
+      if (t->out_tail)
+        t->out_tail->next = seg;
+      else
+        t->out_head = seg;
+      t->out_tail = seg;
+      room = OUTPUT_SEGMENT_SIZE;
+    }
 
-  return (t->bufspace);
+    room = MIN(room, len);
+    memcpy(seg->text + seg->start + seg->len, txt, room);
+    seg->len += room;
+    t->out_queued += room;
+    txt += room;
+    len -= room;
+  }
 }
 
-static void free_bufpool(void)
+/* Drop len bytes that went out from the front of the output queue, and show
+ * them to whoever is snooping. */
+static void consume_output(struct descriptor_data *t, size_t len)
 {
-  struct txt_block *tmp = NULL;
+  struct out_segment *seg;
+  bool snooped = (t->snoop_by && len > 0);
+  size_t n;
+
+  /* Handle snooping: prepend "% " and send to snooper. */
+  if (snooped)
+    write_to_output(t->snoop_by, "%% ");
 
-  while (bufpool)
+  while (len > 0 && (seg = t->out_head))
   {
-    tmp = bufpool->next;
-    if (bufpool->text)
-      free(bufpool->text);
-    free(bufpool);
-    bufpool = tmp;
+    n = MIN(seg->len, len);
+
+    if (snooped)
+      write_to_output(t->snoop_by, "%.*s", (int)n, seg->text + seg->start);
+
+    seg->start += n;
+    seg->len -= n;
+    t->out_queued -= n;
+    len -= n;
+
+    if (seg->len == 0)
+    {
+      if (!(t->out_head = seg->next))
+        t->out_tail = NULL;
+      mem_pool_free(&segment_pool, seg);
+      buf_segments--;
+    }
   }
+
+  if (snooped)
+    write_to_output(t->snoop_by, "%%%%");
 }
 
 /*  socket handling */
@@ -2145,11 +2283,7 @@ static void init_descriptor(struct descriptor_data *newd, int desc)
 
   newd->descriptor = desc;
   newd->idle_tics = 0;
-  newd->output = newd->small_outbuf;
-  newd->bufspace = SMALL_BUFSIZE - 1;
   newd->login_time = time(0);
-  *newd->output = '\0';
-  newd->bufptr = 0;
   newd->has_prompt = 1;                                                            /* prompt is part of greetings */
   STATE(newd) = CONFIG_PROTOCOL_NEGOTIATION ? CON_GET_PROTOCOL : CON_ACCOUNT_NAME; //CON_GET_NAME;
   CREATE(newd->history, char *, HISTORY_SIZE);
@@ -2158,6 +2292,9 @@ static void init_descriptor(struct descriptor_data *newd, int desc)
   newd->desc_num = last_desc;
   newd->pProtocol = ProtocolCreate(); /* KaVir's plugin*/
   newd->events = create_list();
+
+  if (poller_add(desc, newd) < 0)
+    STATE(newd) = CON_CLOSE;
 }
 
 static int new_descriptor(socket_t s)
@@ -2168,7 +2305,6 @@ static int new_descriptor(socket_t s)
   socklen_t i;
   struct descriptor_data *newd;
   struct sockaddr_in peer;
-  struct hostent *from;
 
   /* accept the new connection */
   i = sizeof(peer);
@@ -2200,25 +2336,15 @@ static int new_descriptor(socket_t s)
   /* create a new descriptor */
   CREATE(newd, struct descriptor_data, 1);
 
-  /* find the sitename */
-  if (CONFIG_NS_IS_SLOW ||
-      !(from = gethostbyaddr((char *)&peer.sin_addr,
-                             sizeof(peer.sin_addr), AF_INET)))
+  /* find the sitename: the numeric address until the resolver threads have
+   * looked up the name, unless it is cached */
+  if (CONFIG_NS_IS_SLOW)
   {
-
-    /* resolution failed */
-    if (!CONFIG_NS_IS_SLOW)
-      perror("SYSERR: gethostbyaddr");
-
-    /* find the numeric site address */
     strncpy(newd->host, (char *)inet_ntoa(peer.sin_addr), HOST_LENGTH); /* strncpy: OK (n->host:HOST_LENGTH+1) */
     *(newd->host + HOST_LENGTH) = '\0';
   }
   else
-  {
-    strncpy(newd->host, from->h_name, HOST_LENGTH); /* strncpy: OK (n->host:HOST_LENGTH+1) */
-    *(newd->host + HOST_LENGTH) = '\0';
-  }
+    resolver_lookup(newd, &peer.sin_addr);
 
   /* determine if the site is banned */
   if (isbanned(newd->host) == BAN_ALL)
@@ -2253,58 +2379,60 @@ static int new_descriptor(socket_t s)
 }
 
 /* Send all of the output that we've accumulated for a player out to the
- * player's descriptor. 32 byte GARBAGE_SPACE in MAX_SOCK_BUF used for:
- *	 2 bytes: prepended \r\n
- *	14 bytes: overflow message
- *	 2 bytes: extra \r\n for non-comapct
- *      14 bytes: unused */
+ * player's descriptor.  The queued segments go to the socket as they are,
+ * with a \r\n in front if this interrupts a prompt and the overflow notice,
+ * the extra \r\n for non-compact mode and the prompt after them. */
 static int process_output(struct descriptor_data *t)
 {
-  char i[MAX_SOCK_BUF], *osb = i + 2;
-  int result;
-
-  /* we may need this \r\n for later -- see below */
-  strcpy(i, "\r\n"); /* strcpy: OK (for 'MAX_SOCK_BUF >= 3') */
+  struct iovec iov[MAX_OUTPUT_IOV + 4];
+  struct out_segment *seg;
+  size_t prefix = 0, seg_bytes = 0, sent, left;
+  int cnt = 0, tail, result, i;
 
-  /* now, append the 'real' output */
-  strcpy(osb, t->output); /* strcpy: OK (t->output:LARGE_BUFSIZE < osb:MAX_SOCK_BUF-2) */
-
-  // color code fix attempt -zusuk
-  //parse_at(osb);
-
-  /* if we're in the overflow state, notify the user */
-  /* Ornir attempt to remove blank lines */
-  /*if (t->bufspace == 0 && !t->pProtocol->WriteOOB){
-    strcat(osb, "**OVERFLOW**\r\n"); // strcpy: OK (osb:MAX_SOCK_BUF-2 reserves space)
-  }
-  else*/
-  if (t->bufspace == 0)
+  /* If this is an 'interruption', use the prepended CRLF, otherwise send the
+   * straight output sans CRLF. */
+  if (t->has_prompt && !t->pProtocol->WriteOOB)
   {
-    strcat(osb, "**OVERFLOW**");
+    t->has_prompt = FALSE;
+    iov[cnt].iov_base = (void *)"\r\n";
+    iov[cnt++].iov_len = prefix = 2;
   }
 
-  /* add the extra CRLF if the person isn't in compact mode */
-  if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) &&
-      !PRF_FLAGGED(t->character, PRF_COMPACT))
+  for (seg = t->out_head; seg && cnt < MAX_OUTPUT_IOV; seg = seg->next)
   {
-    if (!t->pProtocol->WriteOOB)
-      strcat(osb, "\r\n"); /* strcpy: OK (osb:MAX_SOCK_BUF-2 reserves space) */
+    iov[cnt].iov_base = seg->text + seg->start;
+    iov[cnt++].iov_len = seg->len;
+    seg_bytes += seg->len;
   }
 
-  if (!t->pProtocol->WriteOOB) /* add a prompt */
-    strcat(i, make_prompt(t)); /* strcpy: OK (i:MAX_SOCK_BUF reserves space) */
-
-  /* now, send the output.  If this is an 'interruption', use the prepended
-   * CRLF, otherwise send the straight output sans CRLF. */
-  if (t->has_prompt && !t->pProtocol->WriteOOB)
+  /* Whatever follows the output has to wait until all of it fits. */
+  tail = cnt;
+  if (!seg)
   {
-    t->has_prompt = FALSE;
-    result = write_to_descriptor(t->descriptor, i);
-    if (result >= 2)
-      result -= 2;
+    /* if we're in the overflow state, notify the user */
+    if (t->out_overflow)
+    {
+      iov[cnt].iov_base = (void *)"**OVERFLOW**";
+      iov[cnt++].iov_len = 12;
+    }
+
+    /* add the extra CRLF if the person isn't in compact mode */
+    if (STATE(t) == CON_PLAYING && t->character && !IS_NPC(t->character) &&
+        !PRF_FLAGGED(t->character, PRF_COMPACT) && !t->pProtocol->WriteOOB)
+    {
+      iov[cnt].iov_base = (void *)"\r\n";
+      iov[cnt++].iov_len = 2;
+    }
+
+    if (!t->pProtocol->WriteOOB) /* add a prompt */
+    {
+      iov[cnt].iov_base = make_prompt(t);
+      iov[cnt].iov_len = strlen((char *)iov[cnt].iov_base);
+      cnt++;
+    }
   }
-  else
-    result = write_to_descriptor(t->descriptor, osb);
+
+  result = write_iov_to_client(t, iov, cnt);
 
   if (result < 0)
   { /* Oops, fatal error. Bye! */
@@ -2313,46 +2441,27 @@ static int process_output(struct descriptor_data *t)
   else if (result == 0) /* Socket buffer full. Try later. */
     return (0);
 
-  /* Handle snooping: prepend "% " and send to snooper. */
-  if (t->snoop_by)
-    write_to_output(t->snoop_by, "%% %*s%%%%", result, t->output);
+  sent = (size_t)result > prefix ? result - prefix : 0;
 
-  /* The common case: all saved output was handed off to the kernel buffer. */
-  if (result >= t->bufptr)
+  /* If the overflow message or prompt were partially written, queue the rest
+   * of them.  This has to happen before consume_output(), as snooping can
+   * overwrite the prompt. */
+  if (sent > seg_bytes)
   {
-    /* If we were using a large buffer, put the large buffer on the buffer pool
-     * and switch back to the small one. */
-    if (t->large_outbuf)
+    left = sent - seg_bytes;
+    for (i = tail; i < cnt; i++)
     {
-      t->large_outbuf->next = bufpool;
-      bufpool = t->large_outbuf;
-      t->large_outbuf = NULL;
-      t->output = t->small_outbuf;
+      if (left < iov[i].iov_len)
+        append_output(t, (char *)iov[i].iov_base + left, iov[i].iov_len - left);
+      left -= MIN(left, iov[i].iov_len);
     }
-    /* reset total bufspace back to that of a small buffer */
-    t->bufspace = SMALL_BUFSIZE - 1;
-    t->bufptr = 0;
-    *(t->output) = '\0';
+  }
 
-    /* If the overflow message or prompt were partially written, try to save
-     * them. There will be enough space for them if this is true.  'result'
-     * is effectively unsigned here anyway. */
-    if ((unsigned int)result < strlen(osb))
-    {
-      size_t savetextlen = strlen(osb + result);
+  consume_output(t, MIN(sent, seg_bytes));
+
+  if (!t->out_head)
+    t->out_overflow = FALSE;
 
-      strcat(t->output, osb + result);
-      t->bufptr -= savetextlen;
-      t->bufspace += savetextlen;
-    }
-  }
-  else
-  {
-    /* Not all data in buffer sent.  result < output buffersize. */
-    strcpy(t->output, t->output + result); /* strcpy: OK (overlap) */
-    t->bufptr -= result;
-    t->bufspace += result;
-  }
   return (result);
 }
 
@@ -2398,6 +2507,25 @@ ssize_t perform_socket_write(socket_t desc, const char *txt, size_t length)
   return (-1);
 }
 
+/* Windows has no writev(), send the pieces one by one. */
+static ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int cnt)
+{
+  ssize_t result, total = 0;
+  int i;
+
+  for (i = 0; i < cnt; i++)
+  {
+    if ((result = perform_socket_write(desc, iov[i].iov_base, iov[i].iov_len)) < 0)
+      return (total ? total : -1);
+
+    total += result;
+    if ((size_t)result < iov[i].iov_len)
+      break;
+  }
+
+  return (total);
+}
+
 #else
 
 #if defined(CIRCLE_ACORN)
@@ -2445,6 +2573,35 @@ static ssize_t perform_socket_write(socket_t desc, const char *txt, size_t lengt
   /* Looks like the error was fatal.  Too bad. */
   return (-1);
 }
+
+/* perform_socket_write() for text in several pieces, in one system call. */
+static ssize_t perform_socket_writev(socket_t desc, const struct iovec *iov, int cnt)
+{
+  ssize_t result;
+
+  result = writev(desc, iov, cnt);
+
+  if (result > 0)
+    return (result);
+
+  if (result == 0)
+  {
+    log("SYSERR: Huh??  writev() returned 0???  Please report this!");
+    return (-1);
+  }
+
+#ifdef EAGAIN /* POSIX */
+  if (errno == EAGAIN)
+    return (0);
+#endif
+
+#ifdef EWOULDBLOCK /* BSD */
+  if (errno == EWOULDBLOCK)
+    return (0);
+#endif
+
+  return (-1);
+}
 #endif /* CIRCLE_WINDOWS */
 
 /* write_to_descriptor takes a descriptor, and text to write to the descriptor.
@@ -2453,9 +2610,45 @@ static ssize_t perform_socket_write(socket_t desc, const char *txt, size_t lengt
  * >=0  If all is well and good.
  *  -1  If an error was encountered, so that the player should be cut off. */
 int write_to_descriptor(socket_t desc, const char *txt)
+{
+  return (write_bytes_to_descriptor(desc, txt, strlen(txt)));
+}
+
+/* Like write_to_descriptor(), but for a player's descriptor: when the client
+ * asked for MCCP the text goes through its compression stream. */
+int write_to_client(struct descriptor_data *d, const char *txt)
+{
+  if (d->mccp)
+    return (mccp_write(d, txt, strlen(txt)));
+
+  return (write_to_descriptor(d->descriptor, txt));
+}
+
+/* Send the pieces in iov to a player's descriptor, through its MCCP stream
+ * if it has one.  Returns the bytes written, 0 if the socket is full or -1
+ * on a fatal error. */
+static int write_iov_to_client(struct descriptor_data *d, const struct iovec *iov, int cnt)
+{
+  ssize_t result;
+
+  if (d->mccp)
+    return (mccp_writev(d, iov, cnt));
+
+  if ((result = perform_socket_writev(d->descriptor, iov, cnt)) < 0)
+  {
+    /* Fatal error.  Disconnect the player. */
+    perror("SYSERR: Write to socket");
+    return (-1);
+  }
+
+  return (result);
+}
+
+/* write_to_descriptor() for data that may hold NULs, like compressed text. */
+int write_bytes_to_descriptor(socket_t desc, const char *txt, size_t total)
 {
   ssize_t bytes_written;
-  size_t total = strlen(txt), write_total = 0;
+  size_t write_total = 0;
 
   while (total > 0)
   {
@@ -2669,7 +2862,7 @@ static int process_input(struct descriptor_data *t)
       char buffer[MAX_INPUT_LENGTH + 64];
 
       snprintf(buffer, sizeof(buffer), "Line too long.  Truncated to:\r\n%s\r\n", tmp);
-      if (write_to_descriptor(t->descriptor, buffer) < 0)
+      if (write_to_client(t, buffer) < 0)
         return (-1);
     }
     if (t->snoop_by)
@@ -2799,6 +2992,7 @@ void close_socket(struct descriptor_data *d)
   struct descriptor_data *temp;
 
   REMOVE_FROM_LIST(d, descriptor_list, next);
+  poller_remove(d->descriptor);
   CLOSE_SOCKET(d->descriptor);
   flush_queues(d);
 
@@ -2819,6 +3013,7 @@ void close_socket(struct descriptor_data *d)
 
     /* If we're switched, this resets the mobile taken. */
     d->character->desc = NULL;
+    update_zone_occupancy(d->character);
 
     /* Plug memory leak, from Eric Green. */
     if (!IS_NPC(d->character) && PLR_FLAGGED(d->character, PLR_MAILING) && d->str)
@@ -2856,7 +3051,10 @@ void close_socket(struct descriptor_data *d)
 
   /* JE 2/22/95 -- part of my unending quest to make switch stable */
   if (d->original && d->original->desc)
+  {
     d->original->desc = NULL;
+    update_zone_occupancy(d->original);
+  }
 
   /* Clear the command history. */
   if (d->history)
@@ -2874,6 +3072,7 @@ void close_socket(struct descriptor_data *d)
     free(d->showstr_vector);
 
   /* KaVir's plugin*/
+  mccp_free(d);
   ProtocolDestroy(d->pProtocol);
 
   /* Mud Events */
@@ -3126,11 +3325,15 @@ static void signal_setup(void)
 void game_info(const char *format, ...)
 {
   struct descriptor_data *i;
+  struct broadcast *b;
   va_list args;
   char messg[MAX_STRING_LENGTH];
   if (format == NULL)
     return;
-  snprintf(messg, sizeof(messg), "\tcInfo: \ty");
+  va_start(args, format);
+  vsnprintf(messg, sizeof(messg), format, args);
+  va_end(args);
+  b = broadcast_new("\tcInfo: \ty%s\tn\r\n", messg);
   for (i = descriptor_list; i; i = i->next)
   {
     if (STATE(i) != CON_PLAYING)
@@ -3138,12 +3341,9 @@ void game_info(const char *format, ...)
     if (!(i->character))
       continue;
 
-    write_to_output(i, "%s", messg);
-    va_start(args, format);
-    vwrite_to_output(i, format, args);
-    va_end(args);
-    write_to_output(i, "\tn\r\n");
+    broadcast_write(b, i);
   }
+  broadcast_free(b);
 }
 
 size_t send_to_char(struct char_data *ch, const char *messg, ...)
@@ -3164,30 +3364,40 @@ size_t send_to_char(struct char_data *ch, const char *messg, ...)
 void send_to_all(const char *messg, ...)
 {
   struct descriptor_data *i;
+  struct broadcast *b;
   va_list args;
 
   if (messg == NULL)
     return;
 
+  va_start(args, messg);
+  b = vbroadcast_new(messg, args);
+  va_end(args);
+
   for (i = descriptor_list; i; i = i->next)
   {
     if (STATE(i) != CON_PLAYING)
       continue;
 
-    va_start(args, messg);
-    vwrite_to_output(i, messg, args);
-    va_end(args);
+    broadcast_write(b, i);
   }
+
+  broadcast_free(b);
 }
 
 void send_to_clan(clan_vnum c_id, const char *messg, ...)
 {
   struct descriptor_data *i;
+  struct broadcast *b;
   va_list args;
 
   if (messg == NULL)
     return;
 
+  va_start(args, messg);
+  b = vbroadcast_new(messg, args);
+  va_end(args);
+
   for (i = descriptor_list; i; i = i->next)
   {
     if (STATE(i) != CON_PLAYING)
@@ -3199,20 +3409,25 @@ void send_to_clan(clan_vnum c_id, const char *messg, ...)
     if (GET_CLANRANK(i->character) == NO_CLANRANK)
       continue;
 
-    va_start(args, messg);
-    vwrite_to_output(i, messg, args);
-    va_end(args);
+    broadcast_write(b, i);
   }
+
+  broadcast_free(b);
 }
 
 void send_to_outdoor(const char *messg, ...)
 {
   struct descriptor_data *i;
+  struct broadcast *b;
   va_list args;
 
   if (!messg || !*messg)
     return;
 
+  va_start(args, messg);
+  b = vbroadcast_new(messg, args);
+  va_end(args);
+
   for (i = descriptor_list; i; i = i->next)
   {
     room_rnum rm;
@@ -3228,29 +3443,34 @@ void send_to_outdoor(const char *messg, ...)
         !zone_table[zn].show_weather)
       continue;
 
-    va_start(args, messg);
-    vwrite_to_output(i, messg, args);
-    va_end(args);
+    broadcast_write(b, i);
   }
+
+  broadcast_free(b);
 }
 
 void send_to_room(room_rnum room, const char *messg, ...)
 {
   struct char_data *i;
+  struct broadcast *b;
   va_list args;
 
   if (messg == NULL)
     return;
 
+  va_start(args, messg);
+  b = vbroadcast_new(messg, args);
+  va_end(args);
+
   for (i = world[room].people; i; i = i->next_in_room)
   {
     if (!i->desc)
       continue;
 
-    va_start(args, messg);
-    vwrite_to_output(i->desc, messg, args);
-    va_end(args);
+    broadcast_write(b, i->desc);
   }
+
+  broadcast_free(b);
 }
 
 /* Sends a message to the entire group, except for ch.
@@ -3259,28 +3479,34 @@ void send_to_room(room_rnum room, const char *messg, ...)
 void send_to_group(struct char_data *ch, struct group_data *group, const char *msg, ...)
 {
   struct char_data *tch;
+  struct broadcast *b;
   va_list args;
 
   if (msg == NULL)
     return;
 
+  va_start(args, msg);
+  b = vbroadcast_new(msg, args);
+  va_end(args);
+
   while ((tch = (struct char_data *)simple_list(group->members)) != NULL)
   {
     if (tch != ch && !IS_NPC(tch) && tch->desc && STATE(tch->desc) == CON_PLAYING)
     {
       write_to_output(tch->desc, "%s[%sGroup%s]%s ",
                       CCGRN(tch, C_NRM), CBGRN(tch, C_NRM), CCGRN(tch, C_NRM), CCNRM(tch, C_NRM));
-      va_start(args, msg);
-      vwrite_to_output(tch->desc, msg, args);
-      va_end(args);
+      broadcast_write(b, tch->desc);
     }
   }
+
+  broadcast_free(b);
 }
 
 /* Thx to Jamie Nelson of 4D for this contribution */
 void send_to_range(room_vnum start, room_vnum finish, const char *messg, ...)
 {
   struct char_data *i;
+  struct broadcast *b;
   va_list args;
   int j;
 
@@ -3292,6 +3518,10 @@ void send_to_range(room_vnum start, room_vnum finish, const char *messg, ...)
   if (messg == NULL)
     return;
 
+  va_start(args, messg);
+  b = vbroadcast_new(messg, args);
+  va_end(args);
+
   for (j = 0; j < top_of_world; j++)
   {
     if (GET_ROOM_VNUM(j) >= start && GET_ROOM_VNUM(j) <= finish)
@@ -3301,15 +3531,16 @@ void send_to_range(room_vnum start, room_vnum finish, const char *messg, ...)
         if (!i->desc)
           continue;
 
-        va_start(args, messg);
-        vwrite_to_output(i->desc, messg, args);
-        va_end(args);
+        broadcast_write(b, i->desc);
       }
     }
   }
+
+  broadcast_free(b);
 }
 
 const char *ACTNULL = "<NULL>";
+static struct broadcast *act_cast = NULL; /* last text perform_act() sent */
 #define CHECK_NULL(pointer, expression) \
   if ((pointer) == NULL)                \
     i = ACTNULL;                        \
@@ -3450,7 +3681,18 @@ void perform_act(const char *orig, struct char_data *ch, struct obj_data *obj,
   }
 
   if (to->desc)
-    write_to_output(to->desc, "%s", CAP(lbuf));
+  {
+    /* Everyone in a room mostly gets the same text, keep the last one so it
+     * only goes through ProtocolOutput() once per class of client. */
+    CAP(lbuf);
+    if (!act_cast || strcmp(act_cast->text, lbuf))
+    {
+      if (act_cast)
+        broadcast_free(act_cast);
+      act_cast = broadcast_new("%s", lbuf);
+    }
+    broadcast_write(act_cast, to->desc);
+  }
 
   if ((IS_NPC(to) && dg_act_check) && (to != ch))
     act_mtrigger(to, lbuf, ch, dg_victim, obj, dg_target, dg_arg);
@@ -47,9 +47,18 @@ const char *act(const char *str, int hide_invisible, struct char_data *ch, struc
 /* I/O functions */
 void write_to_q(const char *txt, struct txt_q *queue, int aliased);
 int write_to_descriptor(socket_t desc, const char *txt);
+int write_bytes_to_descriptor(socket_t desc, const char *txt, size_t total);
+int write_to_client(struct descriptor_data *d, const char *txt);
 size_t write_to_output(struct descriptor_data *d, const char *txt, ...) __attribute__((format(printf, 2, 3)));
 size_t vwrite_to_output(struct descriptor_data *d, const char *format, va_list args);
 
+/* The same message for many descriptors, see comm.c */
+struct broadcast;
+struct broadcast *broadcast_new(const char *format, ...) __attribute__((format(printf, 1, 2)));
+struct broadcast *vbroadcast_new(const char *format, va_list args);
+size_t broadcast_write(struct broadcast *b, struct descriptor_data *d);
+void broadcast_free(struct broadcast *b);
+
 typedef RETSIGTYPE sigfunc(int);
 
 void echo_off(struct descriptor_data *d);
@@ -65,9 +74,8 @@ void copyover_recover(void);
 extern long last_webster_teller;
 
 extern struct descriptor_data *descriptor_list;
-extern int buf_largecount;
+extern int buf_segments;
 extern int buf_overflows;
-extern int buf_switches;
 extern int circle_shutdown;
 extern int circle_reboot;
 extern int no_specials;
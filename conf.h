@@ -128,6 +128,9 @@
 /* Define if you have the <netinet/in.h> header file.  */
 #define HAVE_NETINET_IN_H 1
 
+/* Define if you have the <poll.h> header file.  */
+#define HAVE_POLL_H 1
+
 /* Define if you have the <signal.h> header file.  */
 #define HAVE_SIGNAL_H 1
 
@@ -137,6 +140,9 @@
 /* Define if you have the <strings.h> header file.  */
 #define HAVE_STRINGS_H 1
 
+/* Define if you have the <sys/epoll.h> header file.  */
+#define HAVE_SYS_EPOLL_H 1
+
 /* Define if you have the <sys/fcntl.h> header file.  */
 #define HAVE_SYS_FCNTL_H 1
 
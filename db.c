@@ -61,6 +61,7 @@
 #include "premadebuilds.h"
 #include "encounters.h"
 #include "hunts.h"
+#include "graph.h"
 
 /*  declarations of most of the 'global' variables */
 struct config_data config_info; /* Game configuration list.	 */
@@ -868,6 +869,7 @@ void destroy_db(void)
         while (i)
         {
           j = i->next;
+          free_compiled_line(i);
           if (i->cmd)
             free(i->cmd);
           free(i);
@@ -3715,6 +3717,9 @@ void zone_update(void)
         zone_table[i].age = ZO_DEAD;
       }
     }
+
+    /* make sure the occupant counts is_empty() relies on have not drifted */
+    check_zone_occupancy();
   } /* end - one minute has passed */
 
   /* Dequeue zones (if possible) and reset. This code is executed every x
@@ -4216,6 +4221,7 @@ void reset_zone(zone_rnum zone)
                   EX_CLOSED);
           break;
         }
+      world_doors_changed();
 
       push_result(1);
       tmob = NULL;
@@ -4226,14 +4232,14 @@ void reset_zone(zone_rnum zone)
       if (ZCMD.arg1 == MOB_TRIGGER && tmob)
       {
         if (!SCRIPT(tmob))
-          CREATE(SCRIPT(tmob), struct script_data, 1);
+          SCRIPT(tmob) = new_script(tmob, MOB_TRIGGER);
         add_trigger(SCRIPT(tmob), read_trigger(ZCMD.arg2), -1);
         push_result(1);
       }
       else if (ZCMD.arg1 == OBJ_TRIGGER && tobj)
       {
         if (!SCRIPT(tobj))
-          CREATE(SCRIPT(tobj), struct script_data, 1);
+          SCRIPT(tobj) = new_script(tobj, OBJ_TRIGGER);
         add_trigger(SCRIPT(tobj), read_trigger(ZCMD.arg2), -1);
         push_result(1);
       }
@@ -4245,7 +4251,7 @@ void reset_zone(zone_rnum zone)
           //ZCMD.command = '*';
         }
         if (!world[ZCMD.arg3].script)
-          CREATE(world[ZCMD.arg3].script, struct script_data, 1);
+          world[ZCMD.arg3].script = new_script(&world[ZCMD.arg3], WLD_TRIGGER);
         add_trigger(world[ZCMD.arg3].script, read_trigger(ZCMD.arg2), -1);
         push_result(1);
       }
@@ -4319,28 +4325,105 @@ void reset_zone(zone_rnum zone)
   }
 }
 
-/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's  */
-int is_empty(zone_rnum zone_nr)
+/* Does ch keep its zone from resetting?  Anyone with a descriptor standing in
+ * a room does, except immortals with nohassle on.  Added for testing zone reset
+ * triggers -Welcor */
+static bool zone_occupant(struct char_data *ch)
+{
+  if (!ch->desc || IN_ROOM(ch) == NOWHERE)
+    return (FALSE);
+  if (!IS_NPC(ch) && GET_LEVEL(ch) >= LVL_IMMORT && PRF_FLAGGED(ch, PRF_NOHASSLE))
+    return (FALSE);
+
+  return (TRUE);
+}
+
+/* Bring ch's contribution to the zone occupant counts up to date.  Call this
+ * whenever ch moves between rooms, gains or loses its descriptor, or anything
+ * zone_occupant() looks at changes. */
+void update_zone_occupancy(struct char_data *ch)
 {
-  struct descriptor_data *i;
+  zone_rnum zone = NOWHERE;
 
-  for (i = descriptor_list; i; i = i->next)
+  if (zone_occupant(ch))
+    zone = world[IN_ROOM(ch)].zone;
+
+  if (ch->occupying)
   {
-    if (STATE(i) != CON_PLAYING)
-      continue;
-    if (IN_ROOM(i->character) == NOWHERE)
-      continue;
-    if (world[IN_ROOM(i->character)].zone != zone_nr)
-      continue;
-    /* If an immortal has nohassle off, he counts as present. Added for testing
-     * zone reset triggers -Welcor */
-    if ((!IS_NPC(i->character)) && (GET_LEVEL(i->character) >= LVL_IMMORT) && (PRF_FLAGGED(i->character, PRF_NOHASSLE)))
-      continue;
+    if (zone != NOWHERE && zone == ch->occupied_zone)
+      return;
+    if (ch->occupied_zone <= top_of_zone_table)
+      zone_table[ch->occupied_zone].occupants--;
+    ch->occupying = FALSE;
+  }
+
+  if (zone != NOWHERE && zone <= top_of_zone_table)
+  {
+    zone_table[zone].occupants++;
+    ch->occupied_zone = zone;
+    ch->occupying = TRUE;
+  }
+}
+
+/* Recount every zone from scratch, after zones are renumbered or the counts
+ * are found to be off. */
+void reset_zone_occupancy(void)
+{
+  struct char_data *ch;
+  zone_rnum i;
 
+  for (i = 0; i <= top_of_zone_table; i++)
+    zone_table[i].occupants = 0;
+
+  for (ch = character_list; ch; ch = ch->next)
+    ch->occupying = FALSE;
+
+  for (ch = character_list; ch; ch = ch->next)
+    update_zone_occupancy(ch);
+}
+
+/* Debug check, compare the zone occupant counts against a scan of the
+ * descriptor list the way is_empty() used to do it.  Any mismatch is logged
+ * and the counts are rebuilt.  Returns the number of zones that were off. */
+int check_zone_occupancy(void)
+{
+  struct descriptor_data *d;
+  int *counts, errors = 0;
+  zone_rnum i;
+
+  if (top_of_zone_table == NOWHERE)
     return (0);
+
+  CREATE(counts, int, top_of_zone_table + 1);
+
+  for (d = descriptor_list; d; d = d->next)
+  {
+    if (!d->character || d->character->desc != d || !zone_occupant(d->character))
+      continue;
+    counts[world[IN_ROOM(d->character)].zone]++;
   }
 
-  return (1);
+  for (i = 0; i <= top_of_zone_table; i++)
+  {
+    if (zone_table[i].occupants == counts[i])
+      continue;
+    log("SYSERR: Zone %d (%s) has %d occupants counted, found %d.",
+        zone_table[i].number, zone_table[i].name, zone_table[i].occupants, counts[i]);
+    errors++;
+  }
+
+  free(counts);
+
+  if (errors)
+    reset_zone_occupancy();
+
+  return (errors);
+}
+
+/* for use in reset_zone; return TRUE if zone 'nr' is free of PC's  */
+int is_empty(zone_rnum zone_nr)
+{
+  return (zone_table[zone_nr].occupants <= 0);
 }
 
 /* Functions of a general utility nature. */
@@ -4755,6 +4838,7 @@ void free_char(struct char_data *ch)
 
   if (ch->player_specials != NULL && ch->player_specials != &dummy_mob)
   {
+    free_alias_index(ch);
     while ((a = GET_ALIASES(ch)) != NULL)
     {
       GET_ALIASES(ch) = (GET_ALIASES(ch))->next;
@@ -5182,7 +5266,7 @@ void init_char(struct char_data *ch)
     GET_REAL_RACE(ch) = RACE_UNDEFINED;
 
   if ((i = get_ptable_by_name(GET_NAME(ch))) != -1)
-    player_table[i].id = GET_IDNUM(ch) = ++top_idnum;
+    set_player_index_id(i, GET_IDNUM(ch) = ++top_idnum);
   else
     log("SYSERR: init_char: Character '%s' not found in player table.", GET_NAME(ch));
 
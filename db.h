@@ -210,6 +210,8 @@ struct zone_data
 
    int show_weather;
 
+   int occupants; /* players in the zone that keep it from resetting, see is_empty() */
+
    /* Reset mode:
     *   0: Don't reset, and don't update age.
     *   1: Reset if no PC's are located in zone.
@@ -293,6 +295,7 @@ path_rnum real_path(path_vnum vnum);
 
 /* Public Procedures from objsave.c */
 void Crash_save_all(void);
+void Crash_save_staggered(int pulse);
 void Crash_idlesave(struct char_data *ch);
 void Crash_crashsave(struct char_data *ch);
 int Crash_load(struct char_data *ch);
@@ -323,6 +326,11 @@ void reset_char(struct char_data *ch);
 void free_char(struct char_data *ch);
 void save_player_index(void);
 long get_ptable_by_name(const char *name);
+long get_ptable_by_id(long id);
+void set_player_index_name(int pos, const char *name);
+void set_player_index_id(int pos, long id);
+void remove_player_from_index(int pos);
+void index_player_table(void);
 void remove_player(int pfilepos);
 void clean_pfiles(void);
 void build_player_index(void);
@@ -342,6 +350,9 @@ void parse_room(FILE *fl, int virtual_nr);
 void parse_mobile(FILE *mob_f, int nr);
 const char *parse_object(FILE *obj_f, int nr);
 int is_empty(zone_rnum zone_nr);
+void update_zone_occupancy(struct char_data *ch);
+void reset_zone_occupancy(void);
+int check_zone_occupancy(void);
 void reset_zone(zone_rnum zone);
 void reboot_wizlists(void);
 void boot_world(void);
@@ -0,0 +1,578 @@
+/* *************************************************************************
+ *   File: db_worker.c                                 Part of LuminariMUD *
+ *  Usage: Background MySQL worker, with a write-behind queue.             *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "mysql.h"
+#include "db_worker.h"
+
+#include <pthread.h>
+#include <signal.h>
+
+/*
+ * The worker thread owns its own connection and never touches game data: it
+ * only runs the statements it is given and keeps the result.  Finished jobs
+ * go back on a done list, and db_worker_process() logs their errors, runs
+ * their callbacks and frees them on the game thread.
+ */
+
+struct db_stmt
+{
+  char *head;   /* multi-row statements: what comes before the rows */
+  char *tail;   /* and after them, NULL for plain statements */
+  char *sql;
+  size_t len;
+  size_t size;
+  int rows;
+
+  struct db_stmt *next;
+};
+
+struct db_job
+{
+  char *key;
+  struct db_stmt *stmts;
+  struct db_stmt *last;
+
+  db_read_func func; /* NULL for writes */
+  void *data;
+  MYSQL_RES *result;
+  char *error;
+
+  struct timeval queued;
+  struct timeval finished;
+  long run_usec;
+
+  struct db_job *next;
+};
+
+/* Latency buckets, in milliseconds from queued to finished. */
+static const int hist_limits[] = {1, 2, 5, 10, 25, 50, 100, 250, 1000};
+#define NUM_HIST_LIMITS (int)(sizeof(hist_limits) / sizeof(hist_limits[0]))
+
+struct db_stats
+{
+  unsigned long jobs;
+  unsigned long errors;
+  unsigned long hist[NUM_HIST_LIMITS + 1];
+  double total_msec;
+  double run_msec;
+};
+
+/* Everything up to "worker" is shared with the worker thread and only
+ * touched with the lock held. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;  /* jobs queued */
+static pthread_cond_t space_cond = PTHREAD_COND_INITIALIZER; /* queue not full */
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;  /* queue drained */
+
+static struct db_job *pending = NULL, *pending_tail = NULL;
+static int num_pending = 0;
+static bool busy = FALSE;
+static bool stopping = FALSE;
+static struct db_job *done = NULL, *done_tail = NULL;
+
+static pthread_t worker;
+static bool worker_running = FALSE;
+static MYSQL *worker_conn = NULL;
+
+/* Game thread only. */
+static struct db_stats write_stats, read_stats;
+static unsigned long coalesced = 0;
+static unsigned long rows_batched = 0;
+static unsigned long stalls = 0;
+static int max_pending = 0;
+
+static long usec_between(struct timeval *from, struct timeval *to)
+{
+  return (to->tv_sec - from->tv_sec) * 1000000L + (to->tv_usec - from->tv_usec);
+}
+
+static void stmt_append(struct db_stmt *st, const char *txt, size_t n)
+{
+  if (st->len + n + 1 > st->size)
+  {
+    st->size = MAX(st->len + n + 1, MAX(256, st->size * 2));
+    RECREATE(st->sql, char, st->size);
+  }
+
+  memcpy(st->sql + st->len, txt, n);
+  st->len += n;
+  st->sql[st->len] = '\0';
+}
+
+static struct db_stmt *job_new_stmt(struct db_job *job)
+{
+  struct db_stmt *st;
+
+  CREATE(st, struct db_stmt, 1);
+
+  if (job->last)
+    job->last->next = st;
+  else
+    job->stmts = st;
+  job->last = st;
+
+  return (st);
+}
+
+static char *vformat(const char *fmt, va_list args, size_t *len)
+{
+  va_list copy;
+  char *txt;
+  int n;
+
+  va_copy(copy, args);
+  n = vsnprintf(NULL, 0, fmt, copy);
+  va_end(copy);
+
+  if (n < 0)
+    n = 0;
+
+  CREATE(txt, char, n + 1);
+  vsnprintf(txt, n + 1, fmt, args);
+  *len = n;
+
+  return (txt);
+}
+
+struct db_job *db_job_new(const char *key)
+{
+  struct db_job *job;
+
+  CREATE(job, struct db_job, 1);
+  if (key)
+    job->key = strdup(key);
+
+  return (job);
+}
+
+void db_job_add(struct db_job *job, const char *fmt, ...)
+{
+  struct db_stmt *st;
+  va_list args;
+
+  st = job_new_stmt(job);
+  st->rows = 1;
+
+  va_start(args, fmt);
+  st->sql = vformat(fmt, args, &st->len);
+  va_end(args);
+  st->size = st->len + 1;
+}
+
+void db_job_add_row(struct db_job *job, const char *head, const char *tail, const char *fmt, ...)
+{
+  struct db_stmt *st = job->last;
+  va_list args;
+  size_t len;
+  char *row;
+
+  va_start(args, fmt);
+  row = vformat(fmt, args, &len);
+  va_end(args);
+
+  if (st && st->head && !strcmp(st->head, head) && !strcmp(st->tail, tail) &&
+      st->len + len + strlen(tail) + 2 < DB_MAX_STATEMENT)
+  {
+    stmt_append(st, ", ", 2);
+    st->rows++;
+  }
+  else
+  {
+    st = job_new_stmt(job);
+    st->head = strdup(head);
+    st->tail = strdup(tail);
+    stmt_append(st, head, strlen(head));
+    st->rows = 1;
+  }
+
+  stmt_append(st, row, len);
+  free(row);
+}
+
+static void free_job(struct db_job *job)
+{
+  struct db_stmt *st, *next_st;
+
+  for (st = job->stmts; st; st = next_st)
+  {
+    next_st = st->next;
+    if (st->head)
+      free(st->head);
+    if (st->tail)
+      free(st->tail);
+    if (st->sql)
+      free(st->sql);
+    free(st);
+  }
+
+  if (job->result)
+    mysql_free_result(job->result);
+  if (job->error)
+    free(job->error);
+  if (job->key)
+    free(job->key);
+  free(job);
+}
+
+/* Runs on whichever thread owns the connection, so no logging here. */
+static void run_job(MYSQL *db, struct db_job *job)
+{
+  struct db_stmt *st;
+  struct timeval start;
+  MYSQL_RES *res;
+  char err[MAX_STRING_LENGTH];
+
+  gettimeofday(&start, NULL);
+
+  for (st = job->stmts; st; st = st->next)
+  {
+    if (mysql_query(db, st->sql))
+    {
+      snprintf(err, sizeof(err), "%s (in: %.100s)", mysql_error(db), st->sql);
+      job->error = strdup(err);
+      break;
+    }
+
+    res = mysql_store_result(db);
+
+    if (!st->next && job->func)
+      job->result = res;
+    else if (res)
+      mysql_free_result(res);
+  }
+
+  gettimeofday(&job->finished, NULL);
+  job->run_usec = usec_between(&start, &job->finished);
+}
+
+static void finish_job(struct db_job *job)
+{
+  struct db_stats *stats = job->func ? &read_stats : &write_stats;
+  struct db_stmt *st;
+  double msec;
+  int i;
+
+  msec = usec_between(&job->queued, &job->finished) / 1000.0;
+  for (i = 0; i < NUM_HIST_LIMITS && msec >= hist_limits[i]; i++)
+    ;
+  stats->hist[i]++;
+  stats->jobs++;
+  stats->total_msec += msec;
+  stats->run_msec += job->run_usec / 1000.0;
+
+  for (st = job->stmts; st; st = st->next)
+    rows_batched += st->rows - 1;
+
+  if (job->error)
+  {
+    stats->errors++;
+    log("SYSERR: MySQL %s failed: %s", job->func ? "read" : "write", job->error);
+  }
+
+  if (job->func)
+    (job->func)(job->error ? NULL : job->result, job->data);
+
+  free_job(job);
+}
+
+static void *worker_loop(void *arg)
+{
+  struct db_job *job;
+  time_t last_job = time(0);
+
+  mysql_thread_init();
+
+  pthread_mutex_lock(&lock);
+  for (;;)
+  {
+    while (!pending && !stopping)
+      pthread_cond_wait(&work_cond, &lock);
+
+    if (!pending)
+      break;
+
+    job = pending;
+    if (!(pending = job->next))
+      pending_tail = NULL;
+    job->next = NULL;
+    num_pending--;
+    busy = TRUE;
+    pthread_cond_signal(&space_cond);
+    pthread_mutex_unlock(&lock);
+
+    /* after a long sleep the server may have hung up on us */
+    if (time(0) - last_job > 60)
+      mysql_ping(worker_conn);
+    last_job = time(0);
+
+    run_job(worker_conn, job);
+
+    pthread_mutex_lock(&lock);
+    if (done_tail)
+      done_tail->next = job;
+    else
+      done = job;
+    done_tail = job;
+    busy = FALSE;
+
+    if (!pending)
+      pthread_cond_broadcast(&idle_cond);
+  }
+  pthread_mutex_unlock(&lock);
+
+  mysql_thread_end();
+
+  return (NULL);
+}
+
+static void queue_job(struct db_job *job)
+{
+  struct db_job *j, *prev = NULL, *dropped = NULL;
+  struct db_stmt *st;
+
+  for (st = job->stmts; st; st = st->next)
+    if (st->tail)
+      stmt_append(st, st->tail, strlen(st->tail));
+
+  gettimeofday(&job->queued, NULL);
+
+  if (!worker_running)
+  {
+    run_job(conn, job);
+    finish_job(job);
+    return;
+  }
+
+  pthread_mutex_lock(&lock);
+
+  /* a newer write with the same key saves the same thing */
+  if (job->key && !job->func)
+  {
+    for (j = pending; j; j = (prev ? prev->next : pending))
+    {
+      if (j->func || !j->key || strcmp(j->key, job->key))
+      {
+        prev = j;
+        continue;
+      }
+
+      if (prev)
+        prev->next = j->next;
+      else
+        pending = j->next;
+      if (pending_tail == j)
+        pending_tail = prev;
+      num_pending--;
+
+      j->next = dropped;
+      dropped = j;
+    }
+  }
+
+  while (num_pending >= DB_QUEUE_MAX)
+  {
+    stalls++;
+    pthread_cond_wait(&space_cond, &lock);
+  }
+
+  if (pending_tail)
+    pending_tail->next = job;
+  else
+    pending = job;
+  pending_tail = job;
+  num_pending++;
+  max_pending = MAX(max_pending, num_pending);
+
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&lock);
+
+  for (; dropped; dropped = j)
+  {
+    j = dropped->next;
+    free_job(dropped);
+    coalesced++;
+  }
+}
+
+void db_job_write(struct db_job *job)
+{
+  job->func = NULL;
+  job->data = NULL;
+  queue_job(job);
+}
+
+void db_job_read(struct db_job *job, db_read_func func, void *data)
+{
+  job->func = func;
+  job->data = data;
+  queue_job(job);
+}
+
+void db_worker_process(void)
+{
+  struct db_job *job, *next_job;
+
+  if (!worker_running && !done)
+    return;
+
+  pthread_mutex_lock(&lock);
+  job = done;
+  done = done_tail = NULL;
+  pthread_mutex_unlock(&lock);
+
+  for (; job; job = next_job)
+  {
+    next_job = job->next;
+    finish_job(job);
+  }
+}
+
+void db_worker_flush(void)
+{
+  if (worker_running)
+  {
+    pthread_mutex_lock(&lock);
+    while (pending || busy)
+      pthread_cond_wait(&idle_cond, &lock);
+    pthread_mutex_unlock(&lock);
+  }
+
+  db_worker_process();
+}
+
+int db_worker_init(const char *host, const char *username, const char *password, const char *database)
+{
+  sigset_t all, old;
+  my_bool reconnect = 1;
+  int err;
+
+  if (worker_running)
+    return (0);
+
+  if (!(worker_conn = mysql_init(NULL)))
+  {
+    log("SYSERR: Unable to initialize MySQL worker connection.");
+    return (-1);
+  }
+
+  mysql_options(worker_conn, MYSQL_OPT_RECONNECT, &reconnect);
+
+  if (!mysql_real_connect(worker_conn, host, username, password, database, 0, NULL, 0))
+  {
+    log("SYSERR: Unable to connect MySQL worker: %s", mysql_error(worker_conn));
+    mysql_close(worker_conn);
+    worker_conn = NULL;
+    return (-1);
+  }
+
+  /* signals are for the game thread, the worker inherits this mask */
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  stopping = FALSE;
+  err = pthread_create(&worker, NULL, worker_loop, NULL);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  if (err)
+  {
+    log("SYSERR: Unable to start MySQL worker: %s", strerror(err));
+    mysql_close(worker_conn);
+    worker_conn = NULL;
+    return (-1);
+  }
+
+  worker_running = TRUE;
+  log("MySQL worker started.");
+
+  return (0);
+}
+
+/* Runs everything still queued, then stops the worker. */
+void db_worker_shutdown(void)
+{
+  if (!worker_running)
+    return;
+
+  pthread_mutex_lock(&lock);
+  stopping = TRUE;
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&lock);
+
+  pthread_join(worker, NULL);
+  worker_running = FALSE;
+
+  mysql_close(worker_conn);
+  worker_conn = NULL;
+
+  db_worker_process();
+}
+
+static size_t stats_repr(char *out_buf, size_t n, const char *name, struct db_stats *stats)
+{
+  size_t written;
+  int i, len;
+
+  len = snprintf(out_buf, n,
+                 "  %-6s: %lu jobs, %lu failed, avg %.2fms queued to done, %.2fms running\r\n"
+                 "          ",
+                 name, stats->jobs, stats->errors,
+                 (stats->jobs ? stats->total_msec / stats->jobs : 0.0),
+                 (stats->jobs ? stats->run_msec / stats->jobs : 0.0));
+  if (len < 0 || (size_t)len >= n)
+    return (len < 0 ? 0 : n - 1);
+  written = len;
+
+  for (i = 0; i <= NUM_HIST_LIMITS && written < n; i++)
+  {
+    if (i < NUM_HIST_LIMITS)
+      len = snprintf(out_buf + written, n - written, "<%dms:%lu ", hist_limits[i], stats->hist[i]);
+    else
+      len = snprintf(out_buf + written, n - written, ">=%dms:%lu\r\n", hist_limits[i - 1], stats->hist[i]);
+    if (len < 0)
+      break;
+    written += len;
+  }
+
+  return MIN(written, n - 1);
+}
+
+size_t db_worker_repr(char *out_buf, size_t n)
+{
+  size_t written;
+  int len, depth;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  pthread_mutex_lock(&lock);
+  depth = num_pending + (busy ? 1 : 0);
+  pthread_mutex_unlock(&lock);
+
+  len = snprintf(out_buf, n,
+                 "MySQL worker\r\n"
+                 "  Running    : %s\r\n"
+                 "  Queue depth: %d now, %d max, %d limit, %lu full waits\r\n"
+                 "  Coalesced  : %lu jobs replaced, %lu rows batched\r\n",
+                 (worker_running ? "yes" : "no, queries run on the game thread"),
+                 depth, max_pending, DB_QUEUE_MAX, stalls, coalesced, rows_batched);
+
+  if (len < 0)
+  {
+    out_buf[0] = '\0';
+    return 0;
+  }
+  written = MIN((size_t)len, n - 1);
+
+  written += stats_repr(out_buf + written, n - written, "Writes", &write_stats);
+  written += stats_repr(out_buf + written, n - written, "Reads", &read_stats);
+
+  return MIN(written, n - 1);
+}
@@ -0,0 +1,61 @@
+/* *************************************************************************
+ *   File: db_worker.h                                 Part of LuminariMUD *
+ *  Usage: Header file for the background MySQL worker.                    *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DB_WORKER_H
+#define DB_WORKER_H
+
+/* Queries that do not need an answer right away are handed to a worker
+ * thread with its own connection, so the game loop never waits on MySQL.
+ *
+ * A job is a list of statements that run in order on the worker:
+ *
+ *   job = db_job_new("pets:Bob");
+ *   db_job_add(job, "DELETE FROM pet_data WHERE owner_name='%s'", "Bob");
+ *   db_job_add_row(job, "INSERT INTO pet_data (...) VALUES ", "", "(%d,%d)", a, b);
+ *   db_job_write(job);
+ *
+ * db_job_add_row() appends to the previous statement when it has the same
+ * head and tail, so rows end up in one multi-row statement.  A write with a
+ * key replaces any write with the same key that is still queued, since the
+ * newer one saves the same thing.
+ *
+ * db_job_read() runs the job and hands the result of its last statement to a
+ * callback, which is called from the game loop in db_worker_process().  The
+ * result is NULL if the query failed, and is freed after the callback.  Do
+ * not pass pointers to game objects as data, they may be gone by then: pass
+ * an id and look it up again.
+ *
+ * If the worker is not running every job runs right away on the game
+ * thread's connection. */
+
+/* Most jobs waiting for the worker before db_job_*() has to wait. */
+#define DB_QUEUE_MAX 1024
+/* Longest multi-row statement db_job_add_row() builds before it starts a
+ * new one, well under the server's max_allowed_packet. */
+#define DB_MAX_STATEMENT 65536
+
+struct db_job;
+
+typedef void (*db_read_func)(MYSQL_RES *result, void *data);
+
+int db_worker_init(const char *host, const char *username, const char *password, const char *database);
+void db_worker_shutdown(void);
+/* Run the callbacks of finished jobs, once a pulse. */
+void db_worker_process(void);
+/* Wait until everything queued so far has run, before reading data that
+ * a queued write may still change. */
+void db_worker_flush(void);
+
+struct db_job *db_job_new(const char *key);
+void db_job_add(struct db_job *job, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void db_job_add_row(struct db_job *job, const char *head, const char *tail, const char *fmt, ...) __attribute__((format(printf, 4, 5)));
+void db_job_write(struct db_job *job);
+void db_job_read(struct db_job *job, db_read_func func, void *data);
+
+size_t db_worker_repr(char *out_buf, size_t n);
+
+#endif /* DB_WORKER_H */
@@ -16,6 +16,7 @@
 #include "db.h"
 #include "constants.h"
 #include "mysql.h"
+#include "region_index.h"
 #include "desc_engine.h"
 #include "wilderness.h"
 
@@ -156,6 +157,7 @@ char *gen_room_description(struct char_data *ch, room_rnum room)
 			break;
 		}
 	}
+	free_region_list(regions);
 
 	/* Weather description string */
 	if ((weather = get_weather(world[room].coords[0], world[room].coords[1])) < 178)
@@ -72,6 +72,9 @@ void parse_trigger(FILE *trig_f, int nr)
 
   free(cmds);
 
+  if (dg_compile_triggers)
+    compile_trigger(trig);
+
   trig_index[top_of_trigt++] = t_index;
 }
 
@@ -216,7 +219,7 @@ void dg_read_trigger(FILE *fp, void *proto, int type)
     if (rnum != NOTHING)
     {
       if (!(room->script))
-        CREATE(room->script, struct script_data, 1);
+        room->script = new_script(room, WLD_TRIGGER);
       add_trigger(SCRIPT(room), read_trigger(rnum), -1);
     }
     else
@@ -298,7 +301,7 @@ void assign_triggers(void *i, int type)
       else
       {
         if (!SCRIPT(mob))
-          CREATE(SCRIPT(mob), struct script_data, 1);
+          SCRIPT(mob) = new_script(mob, MOB_TRIGGER);
         add_trigger(SCRIPT(mob), read_trigger(rnum), -1);
       }
       trg_proto = trg_proto->next;
@@ -318,7 +321,7 @@ void assign_triggers(void *i, int type)
       else
       {
         if (!SCRIPT(obj))
-          CREATE(SCRIPT(obj), struct script_data, 1);
+          SCRIPT(obj) = new_script(obj, OBJ_TRIGGER);
         add_trigger(SCRIPT(obj), read_trigger(rnum), -1);
       }
       trg_proto = trg_proto->next;
@@ -339,7 +342,7 @@ void assign_triggers(void *i, int type)
       else
       {
         if (!SCRIPT(room))
-          CREATE(SCRIPT(room), struct script_data, 1);
+          SCRIPT(room) = new_script(room, WLD_TRIGGER);
         add_trigger(SCRIPT(room), read_trigger(rnum), -1);
       }
       trg_proto = trg_proto->next;
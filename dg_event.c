@@ -24,6 +24,7 @@
 #include "constants.h"
 #include "comm.h" /* For access to the game pulse */
 #include "mud_event.h"
+#include "mem_pool.h"
 
 /***************************************************************************
  * Begin mud specific event queue functions
@@ -32,6 +33,10 @@
 /** The mud specific queue of events. */
 static struct dg_queue *event_q = NULL;
 
+/** Events and their queue elements are allocated from pools. */
+static struct mem_pool event_pool = MEM_POOL_INIT("event", struct event, 512);
+static struct mem_pool q_element_pool = MEM_POOL_INIT("q_element", struct q_element, 512);
+
 /** Initializes the main event queue event_q.
  * @post The main event queue, event_q, has been created and initialized.
  */
@@ -58,7 +63,7 @@ struct event *event_create(EVENTFUNC(*func), void *event_obj, long when)
   if (when < 1) /* make sure its in the future */
     when = 1;
 
-  CREATE(new_event, struct event, 1);
+  new_event = (struct event *)mem_pool_alloc(&event_pool);
   new_event->func = func;
   new_event->event_obj = event_obj;
   new_event->q_el = queue_enq(event_q, new_event, when + pulse);
@@ -88,7 +93,7 @@ void event_cancel(struct event *event)
   if (event->event_obj)
     cleanup_event_obj(event);
 
-  free(event);
+  mem_pool_free(&event_pool, event);
 }
 
 /* The memory freeing routine tied into the mud event system */
@@ -136,7 +141,7 @@ void event_process(void)
         free_mud_event((struct mud_event_data *)the_event->event_obj);
 
       /* It is assumed that the_event will already have freed ->event_obj. */
-      free(the_event);
+      mem_pool_free(&event_pool, the_event);
     }
   }
 }
@@ -177,6 +182,97 @@ int event_is_queued(struct event *event)
 /***************************************************************************
  * Begin generic (abstract) priority queue functions
  **************************************************************************/
+/* Append qe to the end of slot. */
+static void slot_append(struct q_slot *slot, struct q_element *qe)
+{
+  qe->slot = slot;
+  qe->next = NULL;
+  qe->prev = slot->tail;
+
+  if (slot->tail)
+    slot->tail->next = qe;
+  else
+    slot->head = qe;
+
+  slot->tail = qe;
+}
+
+/* Take qe out of whatever slot it is in. */
+static void slot_unlink(struct q_element *qe)
+{
+  struct q_slot *slot = qe->slot;
+
+  if (qe->prev == NULL)
+    slot->head = qe->next;
+  else
+    qe->prev->next = qe->next;
+
+  if (qe->next == NULL)
+    slot->tail = qe->prev;
+  else
+    qe->next->prev = qe->prev;
+
+  qe->prev = qe->next = NULL;
+  qe->slot = NULL;
+}
+
+/* Find the slot an element with this key belongs in, given where the wheel is
+ * now.  The level is the lowest one whose span still shares all higher bits
+ * with q->now, so an element only ever moves down the wheel. */
+static struct q_slot *queue_slot(struct dg_queue *q, long key)
+{
+  unsigned long long k = (unsigned long long)key, now = (unsigned long long)q->now;
+  int level, shift;
+
+  if (key <= q->now)
+    return &q->ready;
+
+  for (level = 0; level < EVENT_WHEEL_LEVELS; level++)
+  {
+    shift = EVENT_WHEEL_BITS * (level + 1);
+
+    if ((k >> shift) == (now >> shift))
+      return &q->wheel[level][(k >> (shift - EVENT_WHEEL_BITS)) & EVENT_WHEEL_MASK];
+  }
+
+  return &q->overflow;
+}
+
+/* Empty a slot, putting each element back where it now belongs. */
+static void queue_cascade(struct dg_queue *q, struct q_slot *slot)
+{
+  struct q_element *qe = NULL;
+
+  while ((qe = slot->head) != NULL)
+  {
+    slot_unlink(qe);
+    slot_append(queue_slot(q, qe->key), qe);
+  }
+}
+
+/* Turn the wheel forward to pulse 'when', one pulse at a time.  Whenever a
+ * level's span rolls over, the matching slot of the level above is cascaded
+ * down; elements that come due are moved to q->ready. */
+static void queue_advance(struct dg_queue *q, long when)
+{
+  unsigned long long now;
+  int level;
+
+  while (q->now < when)
+  {
+    now = (unsigned long long)++q->now;
+
+    if ((now & ((1ULL << (EVENT_WHEEL_BITS * EVENT_WHEEL_LEVELS)) - 1)) == 0)
+      queue_cascade(q, &q->overflow);
+
+    for (level = EVENT_WHEEL_LEVELS - 1; level > 0; level--)
+      if ((now & ((1ULL << (EVENT_WHEEL_BITS * level)) - 1)) == 0)
+        queue_cascade(q, &q->wheel[level][(now >> (EVENT_WHEEL_BITS * level)) & EVENT_WHEEL_MASK]);
+
+    queue_cascade(q, &q->wheel[0][now & EVENT_WHEEL_MASK]);
+  }
+}
+
 /** Create a new, empty, priority queue and return it.
  * @retval dg_queue * Pointer to the newly created queue structure. */
 struct dg_queue *queue_init(void)
@@ -184,6 +280,7 @@ struct dg_queue *queue_init(void)
   struct dg_queue *q = NULL;
 
   CREATE(q, struct dg_queue, 1);
+  q->now = pulse;
 
   return q;
 }
@@ -200,49 +297,14 @@ struct dg_queue *queue_init(void)
  * the data. */
 struct q_element *queue_enq(struct dg_queue *q, void *data, long key)
 {
-  struct q_element *qe = NULL, *i = NULL;
-  int bucket = 0;
+  struct q_element *qe = NULL;
 
-  CREATE(qe, struct q_element, 1);
+  qe = (struct q_element *)mem_pool_alloc(&q_element_pool);
   qe->data = data;
   qe->key = key;
 
-  bucket = key % NUM_EVENT_QUEUES; /* which queue does this go in */
-
-  if (!q->head[bucket])
-  { /* queue is empty */
-    q->head[bucket] = qe;
-    q->tail[bucket] = qe;
-  }
-
-  else
-  {
-    for (i = q->tail[bucket]; i; i = i->prev)
-    {
-
-      if (i->key < key)
-      { /* found insertion point */
-        if (i == q->tail[bucket])
-          q->tail[bucket] = qe;
-        else
-        {
-          qe->next = i->next;
-          i->next->prev = qe;
-        }
-
-        qe->prev = i;
-        i->next = qe;
-        break;
-      }
-    }
-
-    if (i == NULL)
-    { /* insertion point is front of list */
-      qe->next = q->head[bucket];
-      q->head[bucket] = qe;
-      qe->next->prev = qe;
-    }
-  }
+  slot_append(queue_slot(q, key), qe);
+  q->count++;
 
   return qe;
 }
@@ -255,28 +317,17 @@ struct q_element *queue_enq(struct dg_queue *q, void *data, long key)
  */
 void queue_deq(struct dg_queue *q, struct q_element *qe)
 {
-  int i = 0;
-
   assert(qe);
 
-  i = qe->key % NUM_EVENT_QUEUES;
-
-  if (qe->prev == NULL)
-    q->head[i] = qe->next;
-  else
-    qe->prev->next = qe->next;
-
-  if (qe->next == NULL)
-    q->tail[i] = qe->prev;
-  else
-    qe->next->prev = qe->prev;
+  slot_unlink(qe);
+  q->count--;
 
-  free(qe);
+  mem_pool_free(&q_element_pool, qe);
 }
 
 /** Removes and returns the data of the first element of the priority queue q. 
- * @pre pulse must be defined. This is a multi-headed queue, the current
- * head is determined by the current pulse.
+ * @pre pulse must be defined. The queue is first advanced to the current
+ * pulse, the head is the oldest element whose time has come.
  * @post the q->head is dequeued. 
  * @param q The queue to return the head of. 
  * @retval void * NULL if there is not a currently available head, pointer
@@ -284,32 +335,29 @@ void queue_deq(struct dg_queue *q, struct q_element *qe)
 void *queue_head(struct dg_queue *q)
 {
   void *dg_data = NULL;
-  int i = 0;
 
-  i = pulse % NUM_EVENT_QUEUES;
+  queue_advance(q, pulse);
 
-  if (!q->head[i])
+  if (!q->ready.head)
     return NULL;
 
-  dg_data = q->head[i]->data;
-  queue_deq(q, q->head[i]);
+  dg_data = q->ready.head->data;
+  queue_deq(q, q->ready.head);
   return dg_data;
 }
 
 /** Returns the key of the head element of the priority queue.
- * @pre pulse must be defined. This is a multi-headed queue, the current
- * head is determined by the current pulse. 
+ * @pre pulse must be defined. The queue is first advanced to the current
+ * pulse, the head is the oldest element whose time has come.
  * @param q Queue to check for.
  * @retval long Return the key element of the head q_element. If no head
  * q_element is available, return LONG_MAX. */
 long queue_key(struct dg_queue *q)
 {
-  int i = 0;
+  queue_advance(q, pulse);
 
-  i = pulse % NUM_EVENT_QUEUES;
-
-  if (q->head[i])
-    return q->head[i]->key;
+  if (q->ready.head)
+    return q->ready.head->key;
   else
     return LONG_MAX;
 }
@@ -322,32 +370,43 @@ long queue_elmt_key(struct q_element *qe)
   return qe->key;
 }
 
-/** Free q and all contents.
- * @pre Function requires definition of struct event.
- * @post All items associeated qith q, including non-abstract data, are freed.
- * @param q The priority queue to free.
- */
-void queue_free(struct dg_queue *q)
+/* Free every element in slot along with its event. */
+static void slot_free(struct q_slot *slot)
 {
-  int i = 0;
   struct q_element *qe = NULL, *next_qe = NULL;
   struct event *event = NULL;
 
-  for (i = 0; i < NUM_EVENT_QUEUES; i++)
+  for (qe = slot->head; qe; qe = next_qe)
   {
-    for (qe = q->head[i]; qe; qe = next_qe)
+    next_qe = qe->next;
+    if ((event = (struct event *)qe->data) != NULL)
     {
-      next_qe = qe->next;
-      if ((event = (struct event *)qe->data) != NULL)
-      {
-        if (event->event_obj)
-          cleanup_event_obj(event);
-
-        free(event);
-      }
-      free(qe);
+      if (event->event_obj)
+        cleanup_event_obj(event);
+
+      mem_pool_free(&event_pool, event);
     }
+    mem_pool_free(&q_element_pool, qe);
   }
 
+  slot->head = slot->tail = NULL;
+}
+
+/** Free q and all contents.
+ * @pre Function requires definition of struct event.
+ * @post All items associeated qith q, including non-abstract data, are freed.
+ * @param q The priority queue to free.
+ */
+void queue_free(struct dg_queue *q)
+{
+  int level = 0, i = 0;
+
+  for (level = 0; level < EVENT_WHEEL_LEVELS; level++)
+    for (i = 0; i < EVENT_WHEEL_SLOTS; i++)
+      slot_free(&q->wheel[level][i]);
+
+  slot_free(&q->ready);
+  slot_free(&q->overflow);
+
   free(q);
 }
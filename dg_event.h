@@ -43,14 +43,31 @@ struct event
 /**************************************************************************
  * Begin priority queue structures and defines.
  **************************************************************************/
-/** Number of buckets available in each queue. Reduces enqueue cost. */
-#define NUM_EVENT_QUEUES 10
+/** The queue is a hierarchical timing wheel.  Level 0 has one slot per pulse
+ * for the next EVENT_WHEEL_SLOTS pulses, each level above it covers
+ * EVENT_WHEEL_SLOTS times the span of the one below.  Elements far in the
+ * future sit in a coarse slot and are cascaded down as their time nears, so
+ * insert, cancel and expiry are all constant time. */
+#define EVENT_WHEEL_BITS 8
+#define EVENT_WHEEL_SLOTS (1 << EVENT_WHEEL_BITS)
+#define EVENT_WHEEL_MASK (EVENT_WHEEL_SLOTS - 1)
+#define EVENT_WHEEL_LEVELS 4
+
+/** An unordered list of queued elements, in insertion order. */
+struct q_slot
+{
+  struct q_element *head; /**< Front of the list. */
+  struct q_element *tail; /**< Rear of the list. */
+};
 
 /** The priority queue. */
 struct dg_queue
 {
-  struct q_element *head[NUM_EVENT_QUEUES]; /**< Front of each queue bucket. */
-  struct q_element *tail[NUM_EVENT_QUEUES]; /**< Rear of each queue bucket. */
+  struct q_slot wheel[EVENT_WHEEL_LEVELS][EVENT_WHEEL_SLOTS]; /**< The wheel. */
+  struct q_slot ready;    /**< Elements whose time has come, oldest first. */
+  struct q_slot overflow; /**< Elements beyond the reach of the wheel. */
+  long now;               /**< The pulse the wheel has been advanced to. */
+  long count;             /**< Number of elements in the queue. */
 };
 
 /** Queued elements. */
@@ -59,6 +76,7 @@ struct q_element
   void *data;                    /**< The event to be handled. */
   long key;                      /**< When the event should be handled. */
   struct q_element *prev, *next; /**< Points to other q_elements in line. */
+  struct q_slot *slot;           /**< The list this element is in. */
 };
 /**************************************************************************
  * End priority queue structures and defines.
@@ -117,6 +117,116 @@ void extract_trigger(struct trig_data *trig)
   free_trigger(trig);
 }
 
+/* Scripts in each registry, one list per attach type so that walks visit mobs,
+ * then objects, then rooms, the same order the old world sweeps used. */
+static struct script_data *script_registry[NUM_SCRIPT_REGS][WLD_TRIGGER + 1];
+
+/* The script a registry walk will visit next, moved along if it is removed
+ * from under the walk by a trigger purging something. */
+static struct script_data *registry_cursor[NUM_SCRIPT_REGS];
+
+/* Trigger type that puts a script in each registry.  The bit is the same for
+ * mob, obj and room triggers. */
+static const long registry_trig_types[NUM_SCRIPT_REGS] = {
+    MTRIG_RANDOM, /* SCRIPT_REG_RANDOM */
+    MTRIG_TIME    /* SCRIPT_REG_TIME */
+};
+
+static void registry_link(struct script_data *sc, int reg)
+{
+  struct script_data **head = &script_registry[reg][sc->attach_type];
+
+  sc->reg_prev[reg] = NULL;
+  sc->reg_next[reg] = *head;
+  if (*head)
+    (*head)->reg_prev[reg] = sc;
+  *head = sc;
+
+  SET_BIT(sc->registered, 1 << reg);
+}
+
+static void registry_unlink(struct script_data *sc, int reg)
+{
+  if (registry_cursor[reg] == sc)
+    registry_cursor[reg] = sc->reg_next[reg];
+
+  if (sc->reg_prev[reg])
+    sc->reg_prev[reg]->reg_next[reg] = sc->reg_next[reg];
+  else
+    script_registry[reg][sc->attach_type] = sc->reg_next[reg];
+
+  if (sc->reg_next[reg])
+    sc->reg_next[reg]->reg_prev[reg] = sc->reg_prev[reg];
+
+  sc->reg_next[reg] = sc->reg_prev[reg] = NULL;
+  REMOVE_BIT(sc->registered, 1 << reg);
+}
+
+/* allocate a script for a mob/obj/room, remembering what it is attached to */
+struct script_data *new_script(void *thing, int type)
+{
+  struct script_data *sc;
+
+  CREATE(sc, struct script_data, 1);
+
+  sc->attach_type = type;
+  if (type == WLD_TRIGGER)
+    sc->attached_room = ((struct room_data *)thing)->number;
+  else
+    sc->attached = thing;
+
+  return sc;
+}
+
+/* put the script into, or take it out of, the registries its trigger types
+ * call for.  Call this whenever SCRIPT_TYPES(sc) changes. */
+void update_script_registries(struct script_data *sc)
+{
+  bool wanted;
+  int reg;
+
+  if (sc->attach_type < MOB_TRIGGER || sc->attach_type > WLD_TRIGGER)
+    return;
+
+  for (reg = 0; reg < NUM_SCRIPT_REGS; reg++)
+  {
+    wanted = IS_SET(SCRIPT_TYPES(sc), registry_trig_types[reg]) ? TRUE : FALSE;
+
+    if (wanted && !IS_SET(sc->registered, 1 << reg))
+      registry_link(sc, reg);
+    else if (!wanted && IS_SET(sc->registered, 1 << reg))
+      registry_unlink(sc, reg);
+  }
+}
+
+/* call func for every mob, obj and room whose script is in registry reg.  func
+ * may extract any of them, including the one it was called for. */
+void walk_script_registry(int reg, void (*func)(void *thing, int type, struct script_data *sc))
+{
+  struct script_data *sc;
+  room_rnum rnum;
+  int type;
+
+  for (type = MOB_TRIGGER; type <= WLD_TRIGGER; type++)
+  {
+    for (sc = script_registry[reg][type]; sc; sc = registry_cursor[reg])
+    {
+      registry_cursor[reg] = sc->reg_next[reg];
+
+      /* a mob or obj script is only registered while it is SCRIPT() of the
+       * thing it is attached to, rooms are found again by vnum */
+      if (type == MOB_TRIGGER && SCRIPT((struct char_data *)sc->attached) == sc)
+        func(sc->attached, type, sc);
+      else if (type == OBJ_TRIGGER && SCRIPT((struct obj_data *)sc->attached) == sc)
+        func(sc->attached, type, sc);
+      else if (type == WLD_TRIGGER && (rnum = real_room(sc->attached_room)) != NOWHERE && SCRIPT(&world[rnum]) == sc)
+        func(&world[rnum], type, sc);
+    }
+  }
+
+  registry_cursor[reg] = NULL;
+}
+
 /* remove all triggers from a mob/obj/room */
 void extract_script(void *thing, int type)
 {
@@ -171,6 +281,9 @@ void extract_script(void *thing, int type)
   }
   TRIGGERS(sc) = NULL;
 
+  SCRIPT_TYPES(sc) = 0;
+  update_script_registries(sc);
+
   /* Thanks to James Long for tracking down this memory leak */
   free_varlist(sc->global_vars);
 
@@ -22,6 +22,7 @@
 #include "genzon.h" /* for real_zone_by_thing */
 #include "act.h"
 #include "fight.h"
+#include "graph.h"
 
 /* Local file scope functions. */
 static void mob_log(char_data *mob, const char *format, ...);
@@ -1288,6 +1289,8 @@ ACMD(do_mdoor)
       break;
     }
   }
+
+  world_topology_changed();
 }
 
 ACMD(do_mfollow)
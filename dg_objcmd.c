@@ -20,6 +20,7 @@
 #include "constants.h"
 #include "genzon.h" /* for access to real_zone_by_thing */
 #include "fight.h"  /* for die() */
+#include "graph.h"  /* for world_topology_changed() */
 
 /* Local functions */
 #define OCMD(name) \
@@ -761,6 +762,8 @@ static OCMD(do_odoor)
       break;
     }
   }
+
+  world_topology_changed();
 }
 
 static OCMD(do_osetval)
@@ -436,6 +436,7 @@ void trigedit_save(struct descriptor_data *d)
     for (cmd = proto->cmdlist; cmd; cmd = next_cmd)
     {
       next_cmd = cmd->next;
+      free_compiled_line(cmd);
       if (cmd->cmd)
         free(cmd->cmd);
       free(cmd);
@@ -515,6 +516,9 @@ void trigedit_save(struct descriptor_data *d)
 
       live_trig = live_trig->next_in_world;
     }
+
+    /* the argument indexes of the scripts they are on are out of date */
+    trig_arg_generation++;
   }
   else
   {
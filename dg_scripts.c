@@ -46,8 +46,8 @@ static void eval_expr(char *line, char *result, void *go, struct script_data *sc
                       trig_data *trig, int type);
 static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
                            trig_data *trig, int type);
-static int process_if(char *cond, void *go, struct script_data *sc,
-                      trig_data *trig, int type);
+static int process_if(char *cond, struct dg_expr *expr, void *go,
+                      struct script_data *sc, trig_data *trig, int type);
 static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element *cl);
 static struct cmdlist_element *find_else_end(trig_data *trig,
                                              struct cmdlist_element *cl, void *go, struct script_data *sc, int type);
@@ -682,99 +682,60 @@ obj_data *get_obj_by_room(room_data *room, char *name)
   return NULL;
 }
 
-/* checks every PULSE_SCRIPT for random triggers */
-void script_trigger_check(void)
+/* random and time triggers only fire on mobs and rooms in a zone with players
+ * in it, unless the script is global */
+static bool script_zone_active(struct script_data *sc, zone_rnum zone)
 {
-  char_data *ch;
-  obj_data *obj;
-  struct room_data *room = NULL;
-  int nr;
-  struct script_data *sc;
+  return (IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL) || !is_empty(zone));
+}
 
-  for (ch = character_list; ch; ch = ch->next)
+static void random_trigger_check(void *thing, int type, struct script_data *sc)
+{
+  switch (type)
   {
-    if (SCRIPT(ch))
-    {
-      sc = SCRIPT(ch);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_RANDOM) &&
-          (!is_empty(world[IN_ROOM(ch)].zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        random_mtrigger(ch);
-    }
+  case MOB_TRIGGER:
+    if (IN_ROOM((char_data *)thing) != NOWHERE &&
+        script_zone_active(sc, world[IN_ROOM((char_data *)thing)].zone))
+      random_mtrigger((char_data *)thing);
+    break;
+  case OBJ_TRIGGER:
+    random_otrigger((obj_data *)thing);
+    break;
+  case WLD_TRIGGER:
+    if (script_zone_active(sc, ((struct room_data *)thing)->zone))
+      random_wtrigger((struct room_data *)thing);
+    break;
   }
+}
 
-  for (obj = object_list; obj; obj = obj->next)
+static void time_trigger_check(void *thing, int type, struct script_data *sc)
+{
+  switch (type)
   {
-    if (SCRIPT(obj))
-    {
-      sc = SCRIPT(obj);
-
-      if (IS_SET(SCRIPT_TYPES(sc), OTRIG_RANDOM))
-        random_otrigger(obj);
-    }
+  case MOB_TRIGGER:
+    if (IN_ROOM((char_data *)thing) != NOWHERE &&
+        script_zone_active(sc, world[IN_ROOM((char_data *)thing)].zone))
+      time_mtrigger((char_data *)thing);
+    break;
+  case OBJ_TRIGGER:
+    time_otrigger((obj_data *)thing);
+    break;
+  case WLD_TRIGGER:
+    if (script_zone_active(sc, ((struct room_data *)thing)->zone))
+      time_wtrigger((struct room_data *)thing);
+    break;
   }
+}
 
-  for (nr = 0; nr <= top_of_world; nr++)
-  {
-    if (SCRIPT(&world[nr]))
-    {
-      room = &world[nr];
-      sc = SCRIPT(room);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_RANDOM) &&
-          (!is_empty(room->zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        random_wtrigger(room);
-    }
-  }
+/* checks every PULSE_SCRIPT for random triggers */
+void script_trigger_check(void)
+{
+  walk_script_registry(SCRIPT_REG_RANDOM, random_trigger_check);
 }
 
 void check_time_triggers(void)
 {
-  char_data *ch;
-  obj_data *obj;
-  struct room_data *room = NULL;
-  int nr;
-  struct script_data *sc;
-
-  for (ch = character_list; ch; ch = ch->next)
-  {
-    if (SCRIPT(ch))
-    {
-      sc = SCRIPT(ch);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_TIME) &&
-          (!is_empty(world[IN_ROOM(ch)].zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        time_mtrigger(ch);
-    }
-  }
-
-  for (obj = object_list; obj; obj = obj->next)
-  {
-    if (SCRIPT(obj))
-    {
-      sc = SCRIPT(obj);
-
-      if (IS_SET(SCRIPT_TYPES(sc), OTRIG_TIME))
-        time_otrigger(obj);
-    }
-  }
-
-  for (nr = 0; nr <= top_of_world; nr++)
-  {
-    if (SCRIPT(&world[nr]))
-    {
-      room = &world[nr];
-      sc = SCRIPT(room);
-
-      if (IS_SET(SCRIPT_TYPES(sc), WTRIG_TIME) &&
-          (!is_empty(room->zone) ||
-           IS_SET(SCRIPT_TYPES(sc), WTRIG_GLOBAL)))
-        time_wtrigger(room);
-    }
-  }
+  walk_script_registry(SCRIPT_REG_TIME, time_trigger_check);
 }
 
 static EVENTFUNC(trig_wait_event)
@@ -1034,6 +995,8 @@ void add_trigger(struct script_data *sc, trig_data *t, int loc)
   }
 
   SCRIPT_TYPES(sc) |= GET_TRIG_TYPE(t);
+  update_script_registries(sc);
+  index_trigger_args(sc);
 
   t->next_in_world = trigger_list;
   trigger_list = t;
@@ -1097,7 +1060,7 @@ ACMD(do_attach)
     }
 
     if (!SCRIPT(victim))
-      CREATE(SCRIPT(victim), struct script_data, 1);
+      SCRIPT(victim) = new_script(victim, MOB_TRIGGER);
     add_trigger(SCRIPT(victim), trig, loc);
 
     if (IS_NPC(victim))
@@ -1144,7 +1107,7 @@ ACMD(do_attach)
     }
 
     if (!SCRIPT(object))
-      CREATE(SCRIPT(object), struct script_data, 1);
+      SCRIPT(object) = new_script(object, OBJ_TRIGGER);
     add_trigger(SCRIPT(object), trig, loc);
 
     send_to_char(ch, "Trigger %d (%s) attached to %s [%d].\r\n",
@@ -1183,7 +1146,7 @@ ACMD(do_attach)
     room = &world[rnum];
 
     if (!SCRIPT(room))
-      CREATE(SCRIPT(room), struct script_data, 1);
+      SCRIPT(room) = new_script(room, WLD_TRIGGER);
     add_trigger(SCRIPT(room), trig, loc);
 
     send_to_char(ch, "Trigger %d (%s) attached to room %d.\r\n",
@@ -1253,6 +1216,8 @@ static int remove_trigger(struct script_data *sc, char *name)
     SCRIPT_TYPES(sc) = 0;
     for (i = TRIGGERS(sc); i; i = i->next)
       SCRIPT_TYPES(sc) |= GET_TRIG_TYPE(i);
+    update_script_registries(sc);
+    index_trigger_args(sc);
 
     return 1;
   }
@@ -1659,16 +1624,12 @@ static void eval_expr(char *line, char *result, void *go, struct script_data *sc
     var_subst(go, sc, trig, type, line, result);
 }
 
-/* Evaluates expr if it is in the form lhs op rhs, and copies answer in result.
- * Returns 1 if expr is evaluated, else 0. */
-static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
-                           trig_data *trig, int type)
+/* If line is in the form lhs op rhs, cuts it at the op, points rhs past it
+ * and returns the op.  Else returns NULL and leaves line as it was. */
+static const char *split_lhs_op_rhs(char *line, char **rhs)
 {
   char *p = NULL;
   char *tokens[MAX_INPUT_LENGTH] = {NULL};
-  char line[MAX_INPUT_LENGTH] = {'\0'};
-  char lhr[MAX_INPUT_LENGTH] = {'\0'};
-  char rhr[MAX_INPUT_LENGTH] = {'\0'};
   int i = 0, j = 0;
 
   /*
@@ -1692,7 +1653,7 @@ static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_dat
       "!",
       "\n"};
 
-  p = strcpy(line, expr);
+  p = line;
 
   /* Initialize tokens, an array of pointers to locations in line where the
    * ops could possibly occur. */
@@ -1716,25 +1677,328 @@ static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_dat
       if (!strn_cmp(ops[i], tokens[j], strlen(ops[i])))
       {
         *tokens[j] = '\0';
-        p = tokens[j] + strlen(ops[i]);
+        *rhs = tokens[j] + strlen(ops[i]);
+        return ops[i];
+      }
 
-        eval_expr(line, lhr, go, sc, trig, type);
-        eval_expr(p, rhr, go, sc, trig, type);
-        eval_op(ops[i], lhr, rhr, result, go, sc, trig);
+  return NULL;
+}
 
-        return 1;
-      }
+/* Evaluates expr if it is in the form lhs op rhs, and copies answer in result.
+ * Returns 1 if expr is evaluated, else 0. */
+static int eval_lhs_op_rhs(char *expr, char *result, void *go, struct script_data *sc,
+                           trig_data *trig, int type)
+{
+  const char *op = NULL;
+  char *p = NULL;
+  char line[MAX_INPUT_LENGTH] = {'\0'};
+  char lhr[MAX_INPUT_LENGTH] = {'\0'};
+  char rhr[MAX_INPUT_LENGTH] = {'\0'};
 
-  return 0;
+  strcpy(line, expr);
+
+  if (!(op = split_lhs_op_rhs(line, &p)))
+    return 0;
+
+  eval_expr(line, lhr, go, sc, trig, type);
+  eval_expr(p, rhr, go, sc, trig, type);
+  eval_op(op, lhr, rhr, result, go, sc, trig);
+
+  return 1;
 }
 
-/* returns 1 if cond is true, else 0 */
-static int process_if(char *cond, void *go, struct script_data *sc,
-                      trig_data *trig, int type)
+/* Compiled expressions.  compile_expr() splits a condition or the expression
+ * of an eval into the tree of ops eval_expr() would find in its text every
+ * time it runs.  The split only depends on the text, since conditions are
+ * split before their variables are substituted, so a compiled condition
+ * gives the same answer as its text.
+ *
+ * Leaves are still substituted when they run.  A leaf whose references are
+ * all plain %var% or %var.field% keeps them as parts, looked up directly
+ * with find_replacement().  Any other leaf goes through var_subst().
+ *
+ * An eval is different: its whole line is substituted first and the result
+ * split.  Its compiled tree is only used while the values that come back
+ * could not have split differently, see eval_compiled_expr(). */
+
+/* One part of a leaf: text to copy, or a variable and field to look up. */
+struct dg_subst_part
+{
+  char *text;  /* literal text, or the variable name */
+  char *field; /* NULL for literal text */
+};
+
+struct dg_expr
+{
+  const char *op;            /* where eval_lhs_op_rhs() splits, NULL for a leaf */
+  struct dg_expr *lhs, *rhs; /* the two sides of op */
+  char *text;                /* a leaf, as eval_expr() passes it to var_subst() */
+  struct dg_subst_part *parts;
+  int num_parts;             /* 0 to leave the leaf to var_subst() */
+};
+
+/* What a value substituted into an eval may not contain: anything that
+ * starts an op, a group or a reference when its line is split. */
+#define DG_EVAL_UNSAFE "|&=!<>/-+*()\"\\%"
+
+static void free_expr(struct dg_expr *e)
+{
+  int i;
+
+  if (!e)
+    return;
+
+  free_expr(e->lhs);
+  free_expr(e->rhs);
+  for (i = 0; i < e->num_parts; i++)
+    free(e->parts[i].text);
+  if (e->parts)
+    free(e->parts);
+  if (e->text)
+    free(e->text);
+  free(e);
+}
+
+/* Splits a leaf into parts.  Leaves num_parts 0 if there is nothing to look
+ * up, or a reference var_subst() treats specially: fields with arguments,
+ * chained fields, %% and references with no end. */
+static void split_leaf(struct dg_expr *e)
+{
+  char *p, *end, *dot;
+  struct dg_subst_part *part;
+  size_t len;
+
+  if (!strchr(e->text, '%'))
+    return;
+
+  /* each % starts at most one part and ends one more */
+  CREATE(e->parts, struct dg_subst_part, strlen(e->text) + 1);
+
+  for (p = e->text; *p; p = end)
+  {
+    part = &e->parts[e->num_parts++];
+
+    if (*p != '%')
+    {
+      len = strcspn(p, "%");
+      CREATE(part->text, char, len + 1);
+      strncpy(part->text, p, len);
+      end = p + len;
+      continue;
+    }
+
+    if (p[1] == '%' || !(end = strchr(p + 1, '%')) || end == p + 1)
+      break;
+
+    len = end - p - 1;
+    CREATE(part->text, char, len + 1);
+    strncpy(part->text, p + 1, len);
+    end++;
+
+    if (strpbrk(part->text, "()"))
+      break;
+
+    if ((dot = strchr(part->text, '.')))
+    {
+      if (!dot[1] || strchr(dot + 1, '.'))
+        break;
+      *dot = '\0';
+      part->field = dot + 1;
+    }
+    else
+      part->field = part->text + len;
+  }
+
+  if (!*p)
+    return;
+
+  /* left to var_subst() */
+  while (e->num_parts > 0)
+    free(e->parts[--e->num_parts].text);
+  free(e->parts);
+  e->parts = NULL;
+}
+
+/* Splits line the way eval_expr() does.  For an eval, returns NULL if a
+ * leaf has references that have to be left to var_subst(). */
+static struct dg_expr *compile_expr(char *line, bool in_eval)
+{
+  char expr[MAX_INPUT_LENGTH], *rhs = NULL, *p;
+  struct dg_expr *e;
+  const char *op;
+
+  while (*line && isspace(*line))
+    line++;
+
+  if (strlen(line) >= sizeof(expr))
+    return NULL;
+  strcpy(expr, line);
+
+  if ((op = split_lhs_op_rhs(expr, &rhs)))
+  {
+    CREATE(e, struct dg_expr, 1);
+    e->op = op;
+    if (!(e->lhs = compile_expr(expr, in_eval)) || !(e->rhs = compile_expr(rhs, in_eval)))
+    {
+      free_expr(e);
+      return NULL;
+    }
+    return e;
+  }
+
+  if (*line == '(')
+  {
+    p = matching_paren(expr);
+    *p = '\0';
+    return compile_expr(expr + 1, in_eval);
+  }
+
+  CREATE(e, struct dg_expr, 1);
+  e->text = strdup(line);
+  split_leaf(e);
+
+  if (in_eval && !e->num_parts && strchr(e->text, '%'))
+  {
+    free_expr(e);
+    return NULL;
+  }
+
+  return e;
+}
+
+/* Substitutes a leaf into result, as var_subst() would.  For an eval,
+ * returns FALSE if a value could have split the line differently, and takes
+ * the length of what was substituted off *room. */
+static bool subst_leaf(struct dg_expr *e, char *result, int *room, void *go,
+                       struct script_data *sc, trig_data *trig, int type)
+{
+  char var[MAX_INPUT_LENGTH], field[MAX_INPUT_LENGTH], subfield[MAX_INPUT_LENGTH];
+  char repl_str[MAX_INPUT_LENGTH], *buf = result;
+  const char *src;
+  int i, len, left = MAX_INPUT_LENGTH - 1;
+
+  if (!e->num_parts)
+  {
+    var_subst(go, sc, trig, type, e->text, result);
+    return TRUE;
+  }
+
+  for (i = 0; i < e->num_parts && left > 0; i++)
+  {
+    if (!e->parts[i].field)
+      src = e->parts[i].text;
+    else
+    {
+      strcpy(var, e->parts[i].text);
+      strcpy(field, e->parts[i].field);
+      *subfield = *repl_str = '\0';
+      find_replacement(go, sc, trig, type, var, field, subfield, repl_str, sizeof(repl_str));
+      src = repl_str;
+
+      if (room && strpbrk(repl_str, DG_EVAL_UNSAFE))
+        return FALSE;
+    }
+
+    len = MIN((int)strlen(src), left);
+    memcpy(buf, src, len);
+    buf += len;
+    left -= len;
+  }
+  *buf = '\0';
+
+  if (room)
+  {
+    /* eval_expr() skips the spaces a value starts with */
+    for (buf = result; *buf && isspace(*buf); buf++)
+      ;
+    if (buf != result)
+      memmove(result, buf, strlen(buf) + 1);
+
+    if ((*room -= MAX_INPUT_LENGTH - 1 - left) < 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* eval_expr() for a compiled expression.  room is NULL for a condition;
+ * for an eval it is what is left of the line after substitution, and
+ * FALSE means the text has to be evaluated instead. */
+static bool eval_compiled_expr(struct dg_expr *e, char *result, int *room, void *go,
+                               struct script_data *sc, trig_data *trig, int type)
+{
+  char lhr[MAX_INPUT_LENGTH], rhr[MAX_INPUT_LENGTH];
+
+  if (!e->op)
+    return subst_leaf(e, result, room, go, sc, trig, type);
+
+  if (!eval_compiled_expr(e->lhs, lhr, room, go, sc, trig, type) ||
+      !eval_compiled_expr(e->rhs, rhr, room, go, sc, trig, type))
+    return FALSE;
+
+  eval_op(e->op, lhr, rhr, result, go, sc, trig);
+  return TRUE;
+}
+
+/* The expression of "eval <name> <expr>", if the line up to it has nothing
+ * to substitute. */
+static struct dg_expr *compile_eval(char *line)
+{
+  char arg[MAX_INPUT_LENGTH], name[MAX_INPUT_LENGTH], *expr;
+
+  if (strlen(line) >= MAX_INPUT_LENGTH)
+    return NULL;
+
+  expr = one_argument_u(line, arg);
+  expr = one_argument_u(expr, name);
+  skip_spaces(&expr);
+
+  if (!*name || strcspn(line, "%") < (size_t)(expr - line))
+    return NULL;
+
+  return compile_expr(expr, TRUE);
+}
+
+/* process_eval() for a compiled eval line.  Returns FALSE, having set
+ * nothing, if the line has to be substituted and evaluated as text. */
+static bool process_compiled_eval(void *go, struct script_data *sc, trig_data *trig,
+                                  int type, struct cmdlist_element *cl)
+{
+  char arg[MAX_INPUT_LENGTH], name[MAX_INPUT_LENGTH], result[MAX_INPUT_LENGTH];
+  char *line = cl->cmd + cl->skip;
+  int room = MAX_INPUT_LENGTH - 1 - strlen(line);
+
+  one_argument_u(one_argument_u(line, arg), name);
+
+  if (!eval_compiled_expr(cl->expr, result, &room, go, sc, trig, type))
+    return FALSE;
+
+  add_var(&GET_TRIG_VARS(trig), name, result, sc ? sc->context : 0);
+  return TRUE;
+}
+
+/* The compiled form of a line's condition or eval, if it is in use. */
+static struct dg_expr *line_expr(struct cmdlist_element *cl)
+{
+  return dg_compile_triggers ? cl->expr : NULL;
+}
+
+void free_compiled_line(struct cmdlist_element *cl)
+{
+  free_expr(cl->expr);
+  cl->expr = NULL;
+}
+
+/* returns 1 if cond is true, else 0.  expr is cond compiled, or NULL. */
+static int process_if(char *cond, struct dg_expr *expr, void *go,
+                      struct script_data *sc, trig_data *trig, int type)
 {
   char result[MAX_INPUT_LENGTH] = {'\0'}, *p = NULL;
 
-  eval_expr(cond, result, go, sc, trig, type);
+  if (expr)
+    eval_compiled_expr(expr, result, NULL, go, sc, trig, type);
+  else
+    eval_expr(cond, result, go, sc, trig, type);
 
   p = result;
   skip_spaces(&p);
@@ -1752,6 +2016,9 @@ static struct cmdlist_element *find_end(trig_data *trig, struct cmdlist_element
   struct cmdlist_element *c;
   char *p;
 
+  if (dg_compile_triggers && cl->end)
+    return cl->end;
+
   if (!(cl->next))
   { /* rryan: if this is the last line, theres no end */
     script_log("Trigger VNum %d has 'if' without 'end'. (error 1)", GET_TRIG_VNUM(trig));
@@ -1792,6 +2059,23 @@ static struct cmdlist_element *find_else_end(trig_data *trig,
   if (!(cl->next))
     return cl;
 
+  /* compiled: go from one elseif to the next */
+  if (dg_compile_triggers && cl->branch)
+  {
+    for (c = cl->branch; c->op == DG_OP_ELSEIF; c = c->branch)
+      if (process_if(c->cmd + c->skip + 7, line_expr(c), go, sc, trig, type))
+      {
+        GET_TRIG_DEPTH(trig)
+        ++;
+        return c;
+      }
+
+    if (c->op == DG_OP_ELSE)
+      GET_TRIG_DEPTH(trig)
+      ++;
+    return c;
+  }
+
   for (c = cl->next; c->next; c = c->next)
   {
     for (p = c->cmd; *p && isspace(*p); p++)
@@ -1802,7 +2086,7 @@ static struct cmdlist_element *find_else_end(trig_data *trig,
 
     else if (!strn_cmp("elseif ", p, 7))
     {
-      if (process_if(p + 7, go, sc, trig, type))
+      if (process_if(p + 7, line_expr(c), go, sc, trig, type))
       {
         GET_TRIG_DEPTH(trig)
         ++;
@@ -2011,7 +2295,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
       return;
     }
     if (!SCRIPT(c))
-      CREATE(SCRIPT(c), struct script_data, 1);
+      SCRIPT(c) = new_script(c, MOB_TRIGGER);
     add_trigger(SCRIPT(c), newtrig, -1);
     return;
   }
@@ -2019,7 +2303,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
   if (o)
   {
     if (!SCRIPT(o))
-      CREATE(SCRIPT(o), struct script_data, 1);
+      SCRIPT(o) = new_script(o, OBJ_TRIGGER);
     add_trigger(SCRIPT(o), newtrig, -1);
     return;
   }
@@ -2027,7 +2311,7 @@ static void process_attach(void *go, struct script_data *sc, trig_data *trig,
   if (r)
   {
     if (!SCRIPT(r))
-      CREATE(SCRIPT(r), struct script_data, 1);
+      SCRIPT(r) = new_script(r, WLD_TRIGGER);
     add_trigger(SCRIPT(r), newtrig, -1);
     return;
   }
@@ -2507,7 +2791,7 @@ int perform_set_dg_var(struct char_data *ch, struct char_data *vict, char *val_a
     return 0;
   }
   if (!SCRIPT(vict))
-    CREATE(SCRIPT(vict), struct script_data, 1);
+    SCRIPT(vict) = new_script(vict, MOB_TRIGGER);
 
   add_var(&(SCRIPT(vict)->global_vars), var_name, var_value, 0);
   return 1;
@@ -2719,6 +3003,282 @@ static void dg_letter_value(struct script_data *sc, trig_data *trig, char *cmd)
   add_var(&GET_TRIG_VARS(trig), varname, junk, sc->context);
 }
 
+/* Trigger compilation.
+ *
+ * Each line of a trigger is looked at once, when the trigger is loaded or
+ * first run: which statement it is, where its text starts and, for the
+ * block statements, which line execution goes on at.  script_driver() then
+ * works from that instead of matching keywords and scanning ahead for the
+ * end of each block every time a line runs.  Conditions and commands are
+ * still evaluated from their text.  Where a block is malformed its lines
+ * are left without a target, so the scans run as before and log the same
+ * errors. */
+
+/* Which script command a command line is, in the order script_driver()
+ * tests for them. */
+#define DG_CMD_UNKNOWN 0 /* up to what its variables expand to */
+#define DG_CMD_EVAL 1
+#define DG_CMD_NOP 2
+#define DG_CMD_EXTRACT 3
+#define DG_CMD_LETTER 4
+#define DG_CMD_MAKEUID 5
+#define DG_CMD_HALT 6
+#define DG_CMD_CAST 7
+#define DG_CMD_AFFECT 8
+#define DG_CMD_GLOBAL 9
+#define DG_CMD_CONTEXT 10
+#define DG_CMD_REMOTE 11
+#define DG_CMD_RDELETE 12
+#define DG_CMD_RETURN 13
+#define DG_CMD_SET 14
+#define DG_CMD_UNSET 15
+#define DG_CMD_WAIT 16
+#define DG_CMD_ATTACH 17
+#define DG_CMD_DETACH 18
+#define DG_CMD_OTHER 19 /* goes to the command interpreter */
+
+static const struct
+{
+  const char *prefix;
+  ubyte cmd;
+} dg_commands[] = {
+    {"eval ", DG_CMD_EVAL},
+    {"nop ", DG_CMD_NOP},
+    {"extract ", DG_CMD_EXTRACT},
+    {"dg_letter ", DG_CMD_LETTER},
+    {"makeuid ", DG_CMD_MAKEUID},
+    {"halt", DG_CMD_HALT},
+    {"dg_cast ", DG_CMD_CAST},
+    {"dg_affect ", DG_CMD_AFFECT},
+    {"global ", DG_CMD_GLOBAL},
+    {"context ", DG_CMD_CONTEXT},
+    {"remote ", DG_CMD_REMOTE},
+    {"rdelete ", DG_CMD_RDELETE},
+    {"return ", DG_CMD_RETURN},
+    {"set ", DG_CMD_SET},
+    {"unset ", DG_CMD_UNSET},
+    {"wait ", DG_CMD_WAIT},
+    {"attach ", DG_CMD_ATTACH},
+    {"detach ", DG_CMD_DETACH},
+    {NULL, DG_CMD_OTHER}};
+
+/* Set to 0 to run every trigger from its text, the way it was done before
+ * triggers were compiled. */
+int dg_compile_triggers = 1;
+
+/* p is the line with its leading spaces skipped. */
+static ubyte dg_line_op(const char *p)
+{
+  if (*p == '*')
+    return DG_OP_COMMENT;
+  if (!strn_cmp(p, "if ", 3))
+    return DG_OP_IF;
+  if (!strn_cmp("elseif ", p, 7))
+    return DG_OP_ELSEIF;
+  if (!strn_cmp("else", p, 4))
+    return DG_OP_ELSE;
+  if (!strn_cmp("while ", p, 6))
+    return DG_OP_WHILE;
+  if (!strn_cmp("switch ", p, 7))
+    return DG_OP_SWITCH;
+  if (!strn_cmp("end", p, 3))
+    return DG_OP_END;
+  if (!strn_cmp("done", p, 4))
+    return DG_OP_DONE;
+  if (!strn_cmp("break", p, 5))
+    return DG_OP_BREAK;
+  if (!strn_cmp("case ", p, 5))
+    return DG_OP_CASE;
+  if (!strn_cmp("case", p, 4))
+    return DG_OP_NOP;
+  return DG_OP_COMMAND;
+}
+
+/* cmd is a command line after var_subst(). */
+static ubyte dg_command_op(const char *cmd)
+{
+  int i;
+
+  for (i = 0; dg_commands[i].prefix; i++)
+    if (!strn_cmp(cmd, dg_commands[i].prefix, strlen(dg_commands[i].prefix)))
+      break;
+
+  return dg_commands[i].cmd;
+}
+
+/* The same for a command line before var_subst(), which copies everything
+ * up to the first '%' as it is.  If the command could still turn out to be
+ * one of the script commands once that is expanded, it stays unknown. */
+static ubyte dg_static_command_op(const char *p)
+{
+  size_t plain = strcspn(p, "%"), n;
+  int i;
+
+  for (i = 0; dg_commands[i].prefix; i++)
+  {
+    n = strlen(dg_commands[i].prefix);
+    if (plain >= n)
+    {
+      if (!strn_cmp(p, dg_commands[i].prefix, n))
+        break;
+    }
+    else if (!strn_cmp(p, dg_commands[i].prefix, plain))
+      return DG_CMD_UNKNOWN;
+  }
+
+  return dg_commands[i].cmd;
+}
+
+/* find_end() for a compiled line, but NULL where it would log an error. */
+static struct cmdlist_element *scan_end(struct cmdlist_element *cl)
+{
+  struct cmdlist_element *c;
+
+  if (!cl->next)
+    return NULL;
+
+  for (c = cl->next; c; c = c->next)
+  {
+    if (c->op == DG_OP_IF)
+    {
+      if (!(c = scan_end(c)))
+        return NULL;
+    }
+    else if (c->op == DG_OP_END)
+      return c;
+
+    if (!c->next)
+      return NULL;
+  }
+
+  return NULL;
+}
+
+/* The next line after cl find_else_end() could stop at: an elseif, else or
+ * end of the same if-block.  NULL where it would log an error. */
+static struct cmdlist_element *scan_else(struct cmdlist_element *cl)
+{
+  struct cmdlist_element *c;
+
+  if (!cl->next)
+    return NULL;
+
+  for (c = cl->next; c->next; c = c->next)
+  {
+    if (c->op == DG_OP_IF)
+    {
+      if (!(c = scan_end(c)))
+        return NULL;
+    }
+    else if (c->op == DG_OP_ELSEIF || c->op == DG_OP_ELSE || c->op == DG_OP_END)
+      return c;
+
+    if (!c->next)
+      return NULL;
+  }
+
+  return c->op == DG_OP_END ? c : NULL;
+}
+
+/* The next line after cl find_case() could stop at: a case, default or done
+ * of the same switch, or the last line.  NULL where find_case() would run
+ * off the end of the trigger. */
+static struct cmdlist_element *scan_case(struct cmdlist_element *cl)
+{
+  struct cmdlist_element *c;
+  char *p;
+
+  for (c = cl->next; c->next; c = c->next)
+  {
+    p = c->cmd + c->skip;
+
+    if (!strn_cmp("while ", p, 6) || !strn_cmp("switch", p, 6))
+    {
+      if (!(c = find_done(c)) || !c->next)
+        return NULL;
+    }
+    else if (c->op == DG_OP_CASE || !strn_cmp("default", p, 7) ||
+             !strn_cmp("done", p, 3))
+      return c;
+  }
+
+  return c;
+}
+
+void compile_trigger(trig_data *trig)
+{
+  struct cmdlist_element *cl, *c;
+  char *p;
+
+  for (cl = trig->cmdlist; cl; cl = cl->next)
+  {
+    for (p = cl->cmd; *p && isspace(*p); p++)
+      ;
+
+    cl->skip = p - cl->cmd;
+    cl->op = dg_line_op(p);
+    cl->cmd_op = cl->op == DG_OP_COMMAND ? dg_static_command_op(p) : DG_CMD_UNKNOWN;
+    cl->branch = cl->end = NULL;
+
+    free_compiled_line(cl);
+    if (cl->op == DG_OP_IF)
+      cl->expr = compile_expr(p + 3, FALSE);
+    else if (cl->op == DG_OP_ELSEIF || cl->op == DG_OP_SWITCH)
+      cl->expr = compile_expr(p + 7, FALSE);
+    else if (cl->op == DG_OP_WHILE)
+      cl->expr = compile_expr(p + 6, FALSE);
+    else if (cl->cmd_op == DG_CMD_EVAL)
+      cl->expr = compile_eval(p);
+  }
+
+  /* 'end' is where find_end() or find_done() goes from the line, 'branch'
+   * the next line find_else_end() or find_case() stops at to test. */
+  for (cl = trig->cmdlist; cl; cl = cl->next)
+    switch (cl->op)
+    {
+    case DG_OP_IF:
+    case DG_OP_ELSEIF:
+      cl->end = scan_end(cl);
+      cl->branch = scan_else(cl);
+      break;
+    case DG_OP_ELSE:
+      cl->end = scan_end(cl);
+      break;
+    case DG_OP_WHILE:
+    case DG_OP_BREAK:
+      cl->end = find_done(cl);
+      break;
+    case DG_OP_SWITCH:
+      cl->end = find_done(cl);
+      if (cl->next)
+        cl->branch = scan_case(cl);
+      break;
+    case DG_OP_CASE:
+      if (cl->next)
+        cl->branch = scan_case(cl);
+      break;
+    }
+
+  /* Blocks are only jumped through when every step to their end is known. */
+  for (cl = trig->cmdlist; cl; cl = cl->next)
+  {
+    if (cl->op == DG_OP_IF && cl->branch)
+    {
+      for (c = cl->branch; c && c->op == DG_OP_ELSEIF; c = c->branch)
+        ;
+      if (!c)
+        cl->branch = NULL;
+    }
+    else if (cl->op == DG_OP_SWITCH && cl->branch)
+    {
+      for (c = cl->branch; c && c->next && c->op == DG_OP_CASE; c = c->branch)
+        ;
+      if (!c)
+        cl->branch = NULL;
+    }
+  }
+}
+
 /* This is the core driver for scripts.
  * Arguments:
  * void *go_adress
@@ -2745,6 +3305,7 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
   struct cmdlist_element *temp = NULL;
   unsigned long loops = 0;
   void *go = NULL;
+  ubyte op, cmd_op;
 
   void obj_command_interpreter(obj_data * obj, char *argument);
   void wld_command_interpreter(struct room_data * room, char *argument);
@@ -2805,25 +3366,36 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
 
   dg_owner_purged = 0;
 
+  if (dg_compile_triggers && trig->cmdlist && trig->cmdlist->op == DG_OP_NONE)
+    compile_trigger(trig);
+
   for (cl = (mode == TRIG_NEW) ? trig->cmdlist : trig->curr_state;
        cl && GET_TRIG_DEPTH(trig); cl = cl->next)
   {
-    for (p = cl->cmd; *p && isspace(*p); p++)
-      ;
+    if (dg_compile_triggers && cl->op != DG_OP_NONE)
+    {
+      p = cl->cmd + cl->skip;
+      op = cl->op;
+    }
+    else
+    {
+      for (p = cl->cmd; *p && isspace(*p); p++)
+        ;
+      op = dg_line_op(p);
+    }
 
-    if (*p == '*') /* comment */
+    if (op == DG_OP_COMMENT)
       continue;
 
-    else if (!strn_cmp(p, "if ", 3))
+    else if (op == DG_OP_IF)
     {
-      if (process_if(p + 3, go, sc, trig, type))
+      if (process_if(p + 3, line_expr(cl), go, sc, trig, type))
         GET_TRIG_DEPTH(trig)
         ++;
       else
         cl = find_else_end(trig, cl, go, sc, type);
     }
-    else if (!strn_cmp("elseif ", p, 7) ||
-             !strn_cmp("else", p, 4))
+    else if (op == DG_OP_ELSEIF || op == DG_OP_ELSE)
     {
       /* If not in an if-block, ignore the extra 'else[if]' and warn about it. */
       if (GET_TRIG_DEPTH(trig) == 1)
@@ -2836,7 +3408,7 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
       GET_TRIG_DEPTH(trig)
       --;
     }
-    else if (!strn_cmp("while ", p, 6))
+    else if (op == DG_OP_WHILE)
     {
       temp = find_done(cl);
       if (!temp)
@@ -2845,7 +3417,7 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
                    GET_TRIG_VNUM(trig));
         return ret_val;
       }
-      if (process_if(p + 6, go, sc, trig, type))
+      if (process_if(p + 6, line_expr(cl), go, sc, trig, type))
       {
         temp->original = cl;
       }
@@ -2855,11 +3427,11 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
         loops = 0;
       }
     }
-    else if (!strn_cmp("switch ", p, 7))
+    else if (op == DG_OP_SWITCH)
     {
       cl = find_case(trig, cl, go, sc, type, p + 7);
     }
-    else if (!strn_cmp("end", p, 3))
+    else if (op == DG_OP_END)
     {
       /* If not in an if-block, ignore the extra 'end' and warn about it. */
       if (GET_TRIG_DEPTH(trig) == 1)
@@ -2871,16 +3443,16 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
       GET_TRIG_DEPTH(trig)
       --;
     }
-    else if (!strn_cmp("done", p, 4))
+    else if (op == DG_OP_DONE)
     {
       /* if in a while loop, cl->original is non-NULL */
       if (cl->original)
       {
-        char *orig_cmd = cl->original->cmd;
+        char *orig_cmd = cl->original->cmd + cl->original->skip;
         while (*orig_cmd && isspace(*orig_cmd))
           orig_cmd++;
-        if (cl->original && process_if(orig_cmd + 6, go, sc, trig,
-                                       type))
+        if (cl->original && process_if(orig_cmd + 6, line_expr(cl->original),
+                                       go, sc, trig, type))
         {
           cl = cl->original;
           loops++;
@@ -2905,73 +3477,82 @@ int script_driver(void *go_adress, trig_data *trig, int type, int mode)
         }
       }
     }
-    else if (!strn_cmp("break", p, 5))
+    else if (op == DG_OP_BREAK)
     {
       cl = find_done(cl);
     }
-    else if (!strn_cmp("case", p, 4))
+    else if (op == DG_OP_CASE || op == DG_OP_NOP)
     {
       /* Do nothing, this allows multiple cases to a single instance */
     }
     else
     {
+      if (cl->cmd_op == DG_CMD_EVAL && line_expr(cl) &&
+          process_compiled_eval(go, sc, trig, type, cl))
+        continue;
+
       var_subst(go, sc, trig, type, p, cmd);
 
-      if (!strn_cmp(cmd, "eval ", 5))
+      if (dg_compile_triggers && cl->op != DG_OP_NONE && cl->cmd_op != DG_CMD_UNKNOWN)
+        cmd_op = cl->cmd_op;
+      else
+        cmd_op = dg_command_op(cmd);
+
+      if (cmd_op == DG_CMD_EVAL)
         process_eval(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "nop ", 4))
+      else if (cmd_op == DG_CMD_NOP)
         ; /* nop: do nothing */
 
-      else if (!strn_cmp(cmd, "extract ", 8))
+      else if (cmd_op == DG_CMD_EXTRACT)
         extract_value(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "dg_letter ", 10))
+      else if (cmd_op == DG_CMD_LETTER)
         dg_letter_value(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "makeuid ", 8))
+      else if (cmd_op == DG_CMD_MAKEUID)
         makeuid_var(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "halt", 4))
+      else if (cmd_op == DG_CMD_HALT)
         break;
 
-      else if (!strn_cmp(cmd, "dg_cast ", 8))
+      else if (cmd_op == DG_CMD_CAST)
         do_dg_cast(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "dg_affect ", 10))
+      else if (cmd_op == DG_CMD_AFFECT)
         do_dg_affect(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "global ", 7))
+      else if (cmd_op == DG_CMD_GLOBAL)
         process_global(sc, trig, cmd, sc->context);
 
-      else if (!strn_cmp(cmd, "context ", 8))
+      else if (cmd_op == DG_CMD_CONTEXT)
         process_context(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "remote ", 7))
+      else if (cmd_op == DG_CMD_REMOTE)
         process_remote(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "rdelete ", 8))
+      else if (cmd_op == DG_CMD_RDELETE)
         process_rdelete(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "return ", 7))
+      else if (cmd_op == DG_CMD_RETURN)
         ret_val = process_return(trig, cmd);
 
-      else if (!strn_cmp(cmd, "set ", 4))
+      else if (cmd_op == DG_CMD_SET)
         process_set(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "unset ", 6))
+      else if (cmd_op == DG_CMD_UNSET)
         process_unset(sc, trig, cmd);
 
-      else if (!strn_cmp(cmd, "wait ", 5))
+      else if (cmd_op == DG_CMD_WAIT)
       {
         process_wait(go, trig, type, cmd, cl);
         depth--;
         return ret_val;
       }
-      else if (!strn_cmp(cmd, "attach ", 7))
+      else if (cmd_op == DG_CMD_ATTACH)
         process_attach(go, sc, trig, type, cmd);
 
-      else if (!strn_cmp(cmd, "detach ", 7))
+      else if (cmd_op == DG_CMD_DETACH)
         process_detach(go, sc, trig, type, cmd);
 
       else
@@ -3068,6 +3649,23 @@ ACMDU(do_tstat)
     send_to_char(ch, "Usage: tstat <vnum>\r\n");
 }
 
+/* Does the switch value result equal the value of a case line? */
+static int case_matches(char *result, char *value, void *go,
+                        struct script_data *sc, trig_data *trig)
+{
+  char *buf;
+  int match;
+
+  if (!(buf = (char *)malloc(MAX_STRING_LENGTH)))
+    return 0;
+
+  eval_op("==", result, value, buf, go, sc, trig);
+  match = (*buf && *buf != '0');
+  free(buf);
+
+  return match;
+}
+
 /* Scans for a case/default instance. Returns the line containg the correct
  * case instance, or the last line of the trigger if not found. */
 static struct cmdlist_element *
@@ -3076,13 +3674,27 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
 {
   char result[MAX_INPUT_LENGTH];
   struct cmdlist_element *c;
-  char *p, *buf = NULL;
+  struct dg_expr *expr;
+  char *p;
 
-  eval_expr(cond, result, go, sc, trig, type);
+  if ((expr = line_expr(cl)))
+    eval_compiled_expr(expr, result, NULL, go, sc, trig, type);
+  else
+    eval_expr(cond, result, go, sc, trig, type);
 
   if (!(cl->next))
     return cl;
 
+  /* compiled: go from one case to the next */
+  if (dg_compile_triggers && cl->branch)
+  {
+    for (c = cl->branch; c->next && c->op == DG_OP_CASE; c = c->branch)
+      if (case_matches(result, c->cmd + c->skip + 5, go, sc, trig))
+        return c;
+
+    return c;
+  }
+
   for (c = cl->next; c->next; c = c->next)
   {
     for (p = c->cmd; *p && isspace(*p); p++)
@@ -3092,17 +3704,8 @@ find_case(struct trig_data *trig, struct cmdlist_element *cl,
       c = find_done(c);
     else if (!strn_cmp("case ", p, 5))
     {
-      buf = (char *)malloc(MAX_STRING_LENGTH);
-      if (buf != NULL)
-      {
-        eval_op("==", result, p + 5, buf, go, sc, trig);
-        if (*buf && *buf != '0')
-        {
-          free(buf);
-          return c;
-        }
-        free(buf);
-      }
+      if (case_matches(result, p + 5, go, sc, trig))
+        return c;
     }
     else if (!strn_cmp("default", p, 7))
       return c;
@@ -3123,6 +3726,10 @@ static struct cmdlist_element *find_done(struct cmdlist_element *cl)
   if (!cl || !(cl->next))
     return cl;
 
+  /* compiled: only while, switch and break lines keep their done here */
+  if (dg_compile_triggers && cl->end)
+    return cl->end;
+
   for (c = cl->next; c && c->next; c = c->next)
   {
     for (p = c->cmd; *p && isspace(*p); p++)
@@ -3155,7 +3762,7 @@ void read_saved_vars(struct char_data *ch)
   /* Create the space for the script structure which holds the vars. We need to
    * do this first, because later calls to 'remote' will need. A script already
    * assigned. */
-  CREATE(SCRIPT(ch), struct script_data, 1);
+  SCRIPT(ch) = new_script(ch, MOB_TRIGGER);
 
   /* find the file that holds the saved variables and open it*/
   get_filename(fn, sizeof(fn), SCRIPT_VARS_FILE, GET_NAME(ch));
@@ -3248,7 +3855,7 @@ void read_saved_vars_ascii(FILE *file, struct char_data *ch, int count)
   /* Create the space for the script structure which holds the vars. We need to
    * do this first, because later calls to 'remote' will need. A script already
    * assigned. */
-  CREATE(SCRIPT(ch), struct script_data, 1);
+  SCRIPT(ch) = new_script(ch, MOB_TRIGGER);
 
   /* walk through each line in the file parsing variables */
   for (i = 0; i < count; i++)
@@ -3302,40 +3909,110 @@ void save_char_vars_ascii(FILE *file, struct char_data *ch)
 }
 
 /* find_char() helpers */
-/* Must be power of 2. */
-#define BUCKET_COUNT 64
-/* To recognize an empty bucket. */
-#define UID_OUT_OF_RANGE 1000000000
+
+/* Every character and object in the game by UID, in one open addressing
+ * table with linear probing.  Removing an entry shifts the ones after it
+ * back instead of leaving a tombstone, so a search always stops at the first
+ * empty slot.  The table doubles when it is 3/4 full and halves when it is
+ * less than 1/8 full, so adding an entry only allocates when it grows. */
+#define UID_TABLE_MIN 1024 /* Must be power of 2. */
 
 struct lookup_table_t
 {
   long uid;
-  void *c;
-  struct lookup_table_t *next;
+  void *c; /* NULL for an empty slot */
 };
-struct lookup_table_t lookup_table[BUCKET_COUNT];
+
+static struct lookup_table_t *lookup_table = NULL;
+static unsigned int lookup_size = 0;  /* slots, always a power of 2 */
+static unsigned int lookup_shift = 0; /* 32 - log2(lookup_size) */
+static unsigned int lookup_count = 0;
+
+/* for perfmon uids */
+static unsigned int lookup_peak = 0;
+static unsigned int lookup_grown = 0;
+static unsigned int lookup_shrunk = 0;
+static unsigned long lookup_finds = 0;
+static unsigned long lookup_misses = 0;
+static unsigned long lookup_probes = 0;
+static unsigned int lookup_max_probe = 0;
+
+/* Fibonacci hashing: UIDs are handed out in order, so the top bits of the
+ * product spread them where the low bits of the UID would not. */
+static unsigned int uid_slot(long uid)
+{
+  return ((unsigned int)uid * 2654435761U) >> lookup_shift;
+}
+
+static void resize_lookup_table(unsigned int size)
+{
+  struct lookup_table_t *old = lookup_table;
+  unsigned int old_size = lookup_size, i, j;
+
+  CREATE(lookup_table, struct lookup_table_t, size);
+  lookup_size = size;
+  for (lookup_shift = 32; size > 1; size >>= 1)
+    lookup_shift--;
+
+  for (i = 0; i < old_size; i++)
+  {
+    if (!old[i].c)
+      continue;
+
+    for (j = uid_slot(old[i].uid); lookup_table[j].c; j = (j + 1) & (lookup_size - 1))
+      ;
+    lookup_table[j] = old[i];
+  }
+
+  if (old)
+    free(old);
+}
 
 void init_lookup_table(void)
 {
-  int i;
-  for (i = 0; i < BUCKET_COUNT; i++)
+  if (lookup_table)
+    free(lookup_table);
+  lookup_table = NULL;
+  lookup_size = lookup_count = 0;
+
+  resize_lookup_table(UID_TABLE_MIN);
+}
+
+/* The slot holding uid, or -1. */
+static int find_uid_slot(long uid)
+{
+  unsigned int i, probes = 1;
+
+  lookup_finds++;
+  if (!lookup_count)
   {
-    lookup_table[i].uid = UID_OUT_OF_RANGE;
-    lookup_table[i].c = NULL;
-    lookup_table[i].next = NULL;
+    lookup_misses++;
+    return -1;
   }
+
+  for (i = uid_slot(uid); lookup_table[i].c; i = (i + 1) & (lookup_size - 1), probes++)
+    if (lookup_table[i].uid == uid)
+      break;
+
+  lookup_probes += probes;
+  if (probes > lookup_max_probe)
+    lookup_max_probe = probes;
+
+  if (!lookup_table[i].c)
+  {
+    lookup_misses++;
+    return -1;
+  }
+
+  return (int)i;
 }
 
 static struct char_data *find_char_by_uid_in_lookup_table(long uid)
 {
-  int bucket = (int)(uid & (BUCKET_COUNT - 1));
-  struct lookup_table_t *lt = &lookup_table[bucket];
-
-  for (; lt && lt->uid != uid; lt = lt->next)
-    ;
+  int i = find_uid_slot(uid);
 
-  if (lt)
-    return (struct char_data *)(lt->c);
+  if (i >= 0)
+    return (struct char_data *)(lookup_table[i].c);
 
   log("find_char_by_uid_in_lookup_table : No entity with number %ld in lookup table", uid);
   return NULL;
@@ -3343,14 +4020,10 @@ static struct char_data *find_char_by_uid_in_lookup_table(long uid)
 
 static struct obj_data *find_obj_by_uid_in_lookup_table(long uid)
 {
-  int bucket = (int)(uid & (BUCKET_COUNT - 1));
-  struct lookup_table_t *lt = &lookup_table[bucket];
-
-  for (; lt && lt->uid != uid; lt = lt->next)
-    ;
+  int i = find_uid_slot(uid);
 
-  if (lt)
-    return (struct obj_data *)(lt->c);
+  if (i >= 0)
+    return (struct obj_data *)(lookup_table[i].c);
 
   log("find_obj_by_uid_in_lookup_table : No entity with number %ld in lookup table", uid);
   return NULL;
@@ -3358,52 +4031,102 @@ static struct obj_data *find_obj_by_uid_in_lookup_table(long uid)
 
 void add_to_lookup_table(long uid, void *c)
 {
-  int bucket = (int)(uid & (BUCKET_COUNT - 1));
-  struct lookup_table_t *lt = &lookup_table[bucket];
+  unsigned int i;
 
-  if (lt && lt->uid == uid)
+  if (!c)
   {
-    log("add_to_lookup updating existing value for uid=%ld (%p -> %p)", uid, lt->c, c);
-    lt->c = c;
+    log("SYSERR: add_to_lookup_table called with no entity for uid=%ld", uid);
     return;
   }
 
-  for (; lt && lt->next; lt = lt->next)
-    if (lt->next->uid == uid)
+  if (!lookup_table)
+    init_lookup_table();
+
+  for (i = uid_slot(uid); lookup_table[i].c; i = (i + 1) & (lookup_size - 1))
+    if (lookup_table[i].uid == uid)
     {
-      log("add_to_lookup updating existing value for uid=%ld (%p -> %p)", uid, lt->next->c, c);
+      log("add_to_lookup updating existing value for uid=%ld (%p -> %p)", uid, lookup_table[i].c, c);
+      lookup_table[i].c = c;
       return;
     }
 
-  CREATE(lt->next, struct lookup_table_t, 1);
-  lt->next->uid = uid;
-  lt->next->c = c;
+  lookup_table[i].uid = uid;
+  lookup_table[i].c = c;
+  if (++lookup_count > lookup_peak)
+    lookup_peak = lookup_count;
+
+  if (lookup_count > lookup_size / 4 * 3)
+  {
+    resize_lookup_table(lookup_size * 2);
+    lookup_grown++;
+  }
 }
 
 void remove_from_lookup_table(long uid)
 {
-  int bucket = (int)(uid & (BUCKET_COUNT - 1));
-  struct lookup_table_t *lt = &lookup_table[bucket], *flt = NULL;
+  unsigned int i, j, home, mask = lookup_size - 1;
+  int slot;
 
   /* This is not supposed to happen. UID 0 is not used. However, while I'm
    * debugging the issue, let's just return right away. - Welcor */
   if (uid == 0)
     return;
 
-  for (; lt; lt = lt->next)
-    if (lt->uid == uid)
-      flt = lt;
-
-  if (flt)
+  if ((slot = find_uid_slot(uid)) < 0)
   {
-    for (lt = &lookup_table[bucket]; lt->next != flt; lt = lt->next)
-      ;
-    lt->next = flt->next;
-    free(flt);
+    log("remove_from_lookup. UID %ld not found.", uid);
     return;
   }
 
-  log("remove_from_lookup. UID %ld not found.", uid);
+  /* Pull back every later entry of the run that may sit in the hole: one
+   * whose home slot is not between the hole and where it is now. */
+  for (i = j = (unsigned int)slot;;)
+  {
+    j = (j + 1) & mask;
+    if (!lookup_table[j].c)
+      break;
+
+    home = uid_slot(lookup_table[j].uid);
+    if (((j - home) & mask) >= ((j - i) & mask))
+    {
+      lookup_table[i] = lookup_table[j];
+      i = j;
+    }
+  }
+
+  lookup_table[i].uid = 0;
+  lookup_table[i].c = NULL;
+  lookup_count--;
+
+  if (lookup_size > UID_TABLE_MIN && lookup_count < lookup_size / 8)
+  {
+    resize_lookup_table(lookup_size / 2);
+    lookup_shrunk++;
+  }
+}
+
+size_t lookup_table_repr(char *out_buf, size_t n)
+{
+  int len;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  len = snprintf(out_buf, n,
+                 "UID lookup table\r\n"
+                 "  Entries : %u in %u slots (%.1f%% full), peak %u\r\n"
+                 "  Resized : grown %u, shrunk %u times\r\n"
+                 "  Lookups : %lu, %lu missed, avg %.2f probes, max %u\r\n",
+                 lookup_count, lookup_size,
+                 (lookup_size ? lookup_count * 100.0 / lookup_size : 0.0), lookup_peak,
+                 lookup_grown, lookup_shrunk,
+                 lookup_finds, lookup_misses,
+                 (lookup_finds ? (double)lookup_probes / lookup_finds : 0.0), lookup_max_probe);
+
+  if (len < 0)
+    return 0;
+
+  return MIN(len, (int)n - 1);
 }
 
 bool check_flags_by_name_ar(int *array, int numflags, char *search, const char *namelist[])
@@ -130,12 +130,194 @@
 
 #define SCRIPT_ERROR_CODE -9999999 /* this shouldn't happen too often */
 
+/* What a line of a compiled trigger is, in the order script_driver() tests
+ * for them. */
+#define DG_OP_NONE 0 /* not compiled yet */
+#define DG_OP_COMMENT 1
+#define DG_OP_IF 2
+#define DG_OP_ELSEIF 3
+#define DG_OP_ELSE 4
+#define DG_OP_WHILE 5
+#define DG_OP_SWITCH 6
+#define DG_OP_END 7
+#define DG_OP_DONE 8
+#define DG_OP_BREAK 9
+#define DG_OP_CASE 10 /* "case <value>", what find_case() stops at */
+#define DG_OP_NOP 11  /* any other "case", does nothing */
+#define DG_OP_COMMAND 12
+
+/* a condition or eval expression split once, see compile_expr() */
+struct dg_expr;
+
 /* one line of the trigger */
 struct cmdlist_element
 {
         char *cmd; /* one line of a trigger */
         struct cmdlist_element *original;
         struct cmdlist_element *next;
+
+        /* filled in once by compile_trigger(), see dg_scripts.c */
+        ubyte op;                       /* DG_OP_*, 0 until compiled       */
+        ubyte cmd_op;                   /* DG_CMD_*, for DG_OP_COMMAND      */
+        int skip;                       /* leading spaces before the text   */
+        struct cmdlist_element *branch; /* next elseif/else/end, or case    */
+        struct cmdlist_element *end;    /* matching end, or done            */
+        struct dg_expr *expr;           /* condition, or expression of eval */
+};
+
+/* Fields of DG variables, as in %actor.name%: the index of each name in
+ * dg_fields[], which is sorted the same way.  Used by find_replacement()
+ * to test a field with one lookup instead of a string compare per field. */
+enum dg_field
+{
+        DG_FIELD_NONE = 0, /* not a known field */
+        DG_FIELD_AFFECT,
+        DG_FIELD_AFFECTS,
+        DG_FIELD_ALIAS,
+        DG_FIELD_ALIGN,
+        DG_FIELD_ARMOR,
+        DG_FIELD_BOUND,
+        DG_FIELD_CANBESEEN,
+        DG_FIELD_CAR,
+        DG_FIELD_CARRIED_BY,
+        DG_FIELD_CDR,
+        DG_FIELD_CHA,
+        DG_FIELD_CHAR,
+        DG_FIELD_CHARAT,
+        DG_FIELD_CLAN,
+        DG_FIELD_CLANRANK,
+        DG_FIELD_CLASS,
+        DG_FIELD_CON,
+        DG_FIELD_CONTAINS,
+        DG_FIELD_CONTENTS,
+        DG_FIELD_COST,
+        DG_FIELD_COST_PER_DAY,
+        DG_FIELD_COUNT,
+        DG_FIELD_DAMROLL,
+        DG_FIELD_DAY,
+        DG_FIELD_DEX,
+        DG_FIELD_DIR,
+        DG_FIELD_DOWN,
+        DG_FIELD_DRUNK,
+        DG_FIELD_EAST,
+        DG_FIELD_EQ,
+        DG_FIELD_EXP,
+        DG_FIELD_EXTRA,
+        DG_FIELD_FEAT,
+        DG_FIELD_FIGHTING,
+        DG_FIELD_FOLLOWER,
+        DG_FIELD_GLOBAL,
+        DG_FIELD_GOLD,
+        DG_FIELD_HAS_CLASS,
+        DG_FIELD_HAS_IN,
+        DG_FIELD_HAS_ITEM,
+        DG_FIELD_HASATTACHED,
+        DG_FIELD_HESHE,
+        DG_FIELD_HIMHER,
+        DG_FIELD_HISHER,
+        DG_FIELD_HITP,
+        DG_FIELD_HITROLL,
+        DG_FIELD_HOUR,
+        DG_FIELD_HUNGER,
+        DG_FIELD_ID,
+        DG_FIELD_INT,
+        DG_FIELD_INVENTORY,
+        DG_FIELD_IS_INROOM,
+        DG_FIELD_IS_KILLER,
+        DG_FIELD_IS_ON_QUEST,
+        DG_FIELD_IS_PC,
+        DG_FIELD_IS_THIEF,
+        DG_FIELD_LEVEL,
+        DG_FIELD_MASTER,
+        DG_FIELD_MAXHITP,
+        DG_FIELD_MAXMOVE,
+        DG_FIELD_MAXPSP,
+        DG_FIELD_MONTH,
+        DG_FIELD_MOVE,
+        DG_FIELD_MUDCOMMAND,
+        DG_FIELD_NAME,
+        DG_FIELD_NEXT_IN_LIST,
+        DG_FIELD_NEXT_IN_ROOM,
+        DG_FIELD_NORTH,
+        DG_FIELD_OSET,
+        DG_FIELD_PEOPLE,
+        DG_FIELD_POS,
+        DG_FIELD_PRAC,
+        DG_FIELD_PREF,
+        DG_FIELD_PSP,
+        DG_FIELD_QP,
+        DG_FIELD_QPNTS,
+        DG_FIELD_QUEST,
+        DG_FIELD_QUESTDONE,
+        DG_FIELD_QUESTPOINTS,
+        DG_FIELD_RACE,
+        DG_FIELD_RESIST_ACID,
+        DG_FIELD_RESIST_AIR,
+        DG_FIELD_RESIST_COLD,
+        DG_FIELD_RESIST_DISEASE,
+        DG_FIELD_RESIST_EARTH,
+        DG_FIELD_RESIST_ELECTRIC,
+        DG_FIELD_RESIST_ENERGY,
+        DG_FIELD_RESIST_FIRE,
+        DG_FIELD_RESIST_FORCE,
+        DG_FIELD_RESIST_HOLY,
+        DG_FIELD_RESIST_ILLUSION,
+        DG_FIELD_RESIST_LIGHT,
+        DG_FIELD_RESIST_MENTAL,
+        DG_FIELD_RESIST_NEGATIVE,
+        DG_FIELD_RESIST_POISON,
+        DG_FIELD_RESIST_PUNCTURE,
+        DG_FIELD_RESIST_SLICE,
+        DG_FIELD_RESIST_SOUND,
+        DG_FIELD_RESIST_UNHOLY,
+        DG_FIELD_RESIST_WATER,
+        DG_FIELD_ROOM,
+        DG_FIELD_ROOMFLAG,
+        DG_FIELD_SAVING_DEATH,
+        DG_FIELD_SAVING_FORT,
+        DG_FIELD_SAVING_POISON,
+        DG_FIELD_SAVING_REFL,
+        DG_FIELD_SAVING_WILL,
+        DG_FIELD_SECTOR,
+        DG_FIELD_SEX,
+        DG_FIELD_SHORTDESC,
+        DG_FIELD_SIZE,
+        DG_FIELD_SIZENUMBER,
+        DG_FIELD_SKILL,
+        DG_FIELD_SKILLROLL,
+        DG_FIELD_SKILLSET,
+        DG_FIELD_SOUTH,
+        DG_FIELD_STR,
+        DG_FIELD_STRADD,
+        DG_FIELD_STRLEN,
+        DG_FIELD_SUBRACE1,
+        DG_FIELD_SUBRACE2,
+        DG_FIELD_SUBRACE3,
+        DG_FIELD_THIRST,
+        DG_FIELD_TIMER,
+        DG_FIELD_TITLE,
+        DG_FIELD_TREASURE,
+        DG_FIELD_TRIM,
+        DG_FIELD_TYPE,
+        DG_FIELD_UP,
+        DG_FIELD_VAL0,
+        DG_FIELD_VAL1,
+        DG_FIELD_VAL2,
+        DG_FIELD_VAL3,
+        DG_FIELD_VAREXISTS,
+        DG_FIELD_VNUM,
+        DG_FIELD_WEARFLAG,
+        DG_FIELD_WEATHER,
+        DG_FIELD_WEIGHT,
+        DG_FIELD_WEST,
+        DG_FIELD_WIS,
+        DG_FIELD_WORN_BY,
+        DG_FIELD_XCOORD,
+        DG_FIELD_YCOORD,
+        DG_FIELD_YEAR,
+        DG_FIELD_ZONENAME,
+        DG_FIELD_ZONENUMBER,
+        NUM_DG_FIELDS
 };
 
 struct trig_var_data
@@ -169,6 +351,32 @@ struct trig_data
         struct trig_data *next_in_world; /**< next in the global trigger list */
 };
 
+/* Registries of scripts that carry a given kind of trigger, so the periodic
+ * checks do not have to sweep the whole world to find them. */
+#define SCRIPT_REG_RANDOM 0 /* MTRIG_RANDOM, OTRIG_RANDOM, WTRIG_RANDOM */
+#define SCRIPT_REG_TIME 1   /* MTRIG_TIME, OTRIG_TIME, WTRIG_TIME */
+#define NUM_SCRIPT_REGS 2
+
+/* Kinds of trigger that fire on what someone types, says or sees, each with
+ * its own argument index. */
+#define TRIG_ARG_COMMAND 0 /* MTRIG_COMMAND, OTRIG_COMMAND, WTRIG_COMMAND */
+#define TRIG_ARG_SPEECH 1  /* MTRIG_SPEECH, WTRIG_SPEECH */
+#define TRIG_ARG_ACT 2     /* MTRIG_ACT */
+#define NUM_TRIG_ARGS 3
+
+#define TRIG_ARG_BITS 256
+
+/* What the arguments of a script's command, speech and act triggers start
+ * with: a bit for the first letter of each command, and for a hash of the
+ * first word of each phrase.  A script without a bit the input sets cannot
+ * fire, so its triggers are not walked.  See index_trigger_args(). */
+struct trig_arg_index
+{
+        long generation; /* trig_arg_generation when it was built      */
+        ubyte always;    /* (1 << TRIG_ARG_*) that must always be walked */
+        ubyte keys[NUM_TRIG_ARGS][TRIG_ARG_BITS / 8];
+};
+
 /** a complete script (composed of several triggers) */
 struct script_data
 {
@@ -178,6 +386,14 @@ struct script_data
         ubyte purged;                      /**< script is set to be purged */
         long context;                      /**< current context for statics */
 
+        int attach_type;          /**< MOB_TRIGGER, OBJ_TRIGGER or WLD_TRIGGER */
+        void *attached;           /**< the mob or obj the script is on         */
+        room_vnum attached_room;  /**< the room, by vnum since world[] moves   */
+        ubyte registered;         /**< bitvector of registries it is in        */
+        struct script_data *reg_next[NUM_SCRIPT_REGS];
+        struct script_data *reg_prev[NUM_SCRIPT_REGS];
+        struct trig_arg_index arg_index;
+
         struct script_data *next; /**< used for purged_scripts    */
 };
 
@@ -208,6 +424,9 @@ typedef struct char_data char_data;
 char *one_phrase(char *arg, char *first_arg);
 int is_substring(char *sub, char *string);
 int word_check(char *str, char *wordlist);
+void index_trigger_args(struct script_data *sc);
+size_t trigger_scan_repr(char *out_buf, size_t n);
+extern long trig_arg_generation;
 
 void act_mtrigger(const char_data *ch, char *str,
                   char_data *actor, char_data *victim, obj_data *object, obj_data *target, char *arg);
@@ -311,6 +530,9 @@ int trig_is_attached(struct script_data *sc, int trig_num);
 /* To maintain strict-aliasing we'll have to do this trick with a union */
 /* Thanks to Chris Gilbert for reminding me that there are other options. */
 int script_driver(void *go_adress, trig_data *trig, int type, int mode);
+void compile_trigger(trig_data *trig);
+void free_compiled_line(struct cmdlist_element *cl);
+extern int dg_compile_triggers;
 trig_rnum real_trigger(trig_vnum vnum);
 void process_eval(void *go, struct script_data *sc, trig_data *trig,
                   int type, char *cmd);
@@ -319,6 +541,7 @@ void save_char_vars(struct char_data *ch);
 void init_lookup_table(void);
 void add_to_lookup_table(long uid, void *c);
 void remove_from_lookup_table(long uid);
+size_t lookup_table_repr(char *out_buf, size_t n);
 
 /* from dg_db_scripts.c */
 void parse_trigger(FILE *trig_f, int nr);
@@ -335,6 +558,8 @@ const char *skill_percent(struct char_data *ch, char *skill);
 int char_has_item(char *item, struct char_data *ch);
 void var_subst(void *go, struct script_data *sc, trig_data *trig,
                int type, char *line, char *buf);
+extern const char *dg_fields[];
+int find_dg_field(const char *field);
 int text_processed(char *field, char *subfield, struct trig_var_data *vd,
                    char *str, size_t slen);
 void find_replacement(void *go, struct script_data *sc, trig_data *trig,
@@ -347,6 +572,9 @@ int remove_var(struct trig_var_data **var_list, char *name);
 void free_trigger(trig_data *trig);
 void extract_trigger(struct trig_data *trig);
 void extract_script(void *thing, int type);
+struct script_data *new_script(void *thing, int type);
+void update_script_registries(struct script_data *sc);
+void walk_script_registry(int reg, void (*func)(void *thing, int type, struct script_data *sc));
 void extract_script_mem(struct script_memory *sc);
 void free_proto_script(void *thing, int type);
 void copy_proto_script(void *source, void *dest, int type);
@@ -107,6 +107,185 @@ int word_check(char *str, char *wordlist)
   return 0;
 }
 
+/* Argument indexes of command, speech and act triggers.  What someone
+ * types, says or sees sets the bits of its command or of each of its words
+ * once, and every script with a trigger of that kind is tested against them
+ * before its triggers are walked.  The index only ever lets through too
+ * much: the triggers themselves still decide, exactly as before. */
+
+/* Bumped when triggers are edited in place, so every index is rebuilt the
+ * next time it is used. */
+long trig_arg_generation = 1;
+
+/* The trigger type of each kind, for mobs, objects and rooms. */
+static const long trig_arg_types[NUM_TRIG_ARGS][WLD_TRIGGER + 1] = {
+    {MTRIG_COMMAND, OTRIG_COMMAND, WTRIG_COMMAND},
+    {MTRIG_SPEECH, 0, WTRIG_SPEECH},
+    {MTRIG_ACT, 0, 0}};
+
+static const char *trig_arg_names[NUM_TRIG_ARGS] = {"command", "speech", "act"};
+
+/* What finding the triggers to run costs, for perfmon. */
+static struct
+{
+  unsigned long searches; /* commands, speech or acts looked at */
+  unsigned long scripts;  /* scripts with a trigger of the kind */
+  unsigned long skipped;  /* of those, passed over by their index */
+  unsigned long checked;  /* triggers whose argument was tested */
+  unsigned long fired;
+  double usec; /* time spent, not counting the scripts run */
+} trig_scans[NUM_TRIG_ARGS];
+
+#define IS_WORD_CHAR(c) (!isspace(c) && !ispunct(c))
+
+static void set_word_key(ubyte *keys, const char *word, int len)
+{
+  unsigned int h = 0;
+  int i;
+
+  for (i = 0; i < len; i++)
+    h = h * 31 + LOWER(word[i]);
+
+  h &= TRIG_ARG_BITS - 1;
+  keys[h / 8] |= 1 << (h % 8);
+}
+
+static void set_command_key(ubyte *keys, const char *cmd)
+{
+  unsigned char c = LOWER(*cmd);
+
+  keys[c / 8] |= 1 << (c % 8);
+}
+
+/* The keys of every word of str, as is_substring() splits them. */
+static void text_keys(const char *str, ubyte *keys)
+{
+  const char *p;
+
+  memset(keys, 0, TRIG_ARG_BITS / 8);
+
+  while (str && *str)
+  {
+    for (p = str; *p && IS_WORD_CHAR(*p); p++)
+      ;
+    if (p > str)
+      set_word_key(keys, str, p - str);
+    str = *p ? p + 1 : p;
+  }
+}
+
+/* A phrase can only be found where its first word is. */
+static void index_phrase(struct trig_arg_index *idx, int kind, const char *phrase)
+{
+  const char *p;
+
+  for (p = phrase; *p && IS_WORD_CHAR(*p); p++)
+    ;
+
+  if (p == phrase)
+    SET_BIT(idx->always, 1 << kind);
+  else
+    set_word_key(idx->keys[kind], phrase, p - phrase);
+}
+
+void index_trigger_args(struct script_data *sc)
+{
+  struct trig_arg_index *idx = &sc->arg_index;
+  char words[MAX_INPUT_LENGTH], phrase[MAX_INPUT_LENGTH], *s, *arg;
+  trig_data *t;
+  long type;
+  int kind;
+
+  memset(idx, 0, sizeof(*idx));
+  idx->generation = trig_arg_generation;
+
+  for (t = TRIGGERS(sc); t; t = t->next)
+    for (kind = 0; kind < NUM_TRIG_ARGS; kind++)
+    {
+      if (t->attach_type < MOB_TRIGGER || t->attach_type > WLD_TRIGGER)
+        continue;
+      if (!(type = trig_arg_types[kind][(int)t->attach_type]) ||
+          !IS_SET(GET_TRIG_TYPE(t), type))
+        continue;
+
+      /* anything goes, or there is an error to log every time */
+      if (!(arg = GET_TRIG_ARG(t)) || !*arg || *arg == '*')
+        SET_BIT(idx->always, 1 << kind);
+      else if (kind == TRIG_ARG_COMMAND)
+        set_command_key(idx->keys[kind], arg);
+      else if (!GET_TRIG_NARG(t))
+        index_phrase(idx, kind, arg);
+      else
+      {
+        strlcpy(words, arg, sizeof(words));
+        for (s = one_phrase(words, phrase); *phrase; s = one_phrase(s, phrase))
+          index_phrase(idx, kind, phrase);
+      }
+    }
+}
+
+/* Could a trigger of kind in sc fire for the keys of the input? */
+static bool trig_args_match(struct script_data *sc, int kind, const ubyte *keys)
+{
+  struct trig_arg_index *idx = &sc->arg_index;
+  int i;
+
+  if (idx->generation != trig_arg_generation)
+    index_trigger_args(sc);
+
+  trig_scans[kind].scripts++;
+
+  if (IS_SET(idx->always, 1 << kind))
+    return TRUE;
+
+  for (i = 0; i < TRIG_ARG_BITS / 8; i++)
+    if (idx->keys[kind][i] & keys[i])
+      return TRUE;
+
+  trig_scans[kind].skipped++;
+  return FALSE;
+}
+
+static void trig_scan_add(int kind, struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  trig_scans[kind].usec += (now.tv_sec - start->tv_sec) * 1000000.0 +
+                           (now.tv_usec - start->tv_usec);
+}
+
+size_t trigger_scan_repr(char *out_buf, size_t n)
+{
+  size_t len = 0;
+  int kind, r;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  r = snprintf(out_buf, n,
+               "Command, speech and act triggers\r\n"
+               "  Kind      Searches   Scripts   Skipped  Triggers   Fired  us/search\r\n");
+  if (r < 0)
+    return 0;
+  len = MIN(r, (int)n - 1);
+
+  for (kind = 0; kind < NUM_TRIG_ARGS && len < n - 1; kind++)
+  {
+    r = snprintf(out_buf + len, n - len,
+                 "  %-8s %9lu %9lu %9lu %9lu %7lu %10.2f\r\n",
+                 trig_arg_names[kind], trig_scans[kind].searches,
+                 trig_scans[kind].scripts, trig_scans[kind].skipped,
+                 trig_scans[kind].checked, trig_scans[kind].fired,
+                 trig_scans[kind].searches ? trig_scans[kind].usec / trig_scans[kind].searches : 0.0);
+    if (r < 0)
+      break;
+    len += MIN(r, (int)(n - len) - 1);
+  }
+
+  return len;
+}
+
 /*Mob triggers. */
 void random_mtrigger(char_data *ch)
 {
@@ -332,6 +511,8 @@ int command_mtrigger(char_data *actor, char *cmd, char *argument)
   char_data *ch, *ch_next;
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
+  ubyte keys[TRIG_ARG_BITS / 8] = {0};
+  struct timeval start;
 
   /* prevent people we like from becoming trapped :P */
   if (!valid_dg_target(actor, 0))
@@ -343,18 +524,25 @@ int command_mtrigger(char_data *actor, char *cmd, char *argument)
     return 0;
   }
 
+  gettimeofday(&start, NULL);
+  trig_scans[TRIG_ARG_COMMAND].searches++;
+  set_command_key(keys, cmd);
+
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch_next)
   {
     ch_next = ch->next_in_room;
 
     if (SCRIPT_CHECK(ch, MTRIG_COMMAND) && !AFF_FLAGGED(ch, AFF_CHARM) &&
-        ((actor != ch) || CONFIG_SCRIPT_PLAYERS))
+        ((actor != ch) || CONFIG_SCRIPT_PLAYERS) &&
+        trig_args_match(SCRIPT(ch), TRIG_ARG_COMMAND, keys))
     {
       for (t = TRIGGERS(SCRIPT(ch)); t; t = t->next)
       {
         if (!TRIGGER_CHECK(t, MTRIG_COMMAND))
           continue;
 
+        trig_scans[TRIG_ARG_COMMAND].checked++;
+
         if (!GET_TRIG_ARG(t) || !*GET_TRIG_ARG(t))
         {
           mudlog(NRM, LVL_BUILDER, TRUE, "SYSERR: Command Trigger #%d has no text argument!",
@@ -371,13 +559,17 @@ int command_mtrigger(char_data *actor, char *cmd, char *argument)
           skip_spaces(&cmd);
           add_var(&GET_TRIG_VARS(t), "cmd", cmd, 0);
 
+          trig_scans[TRIG_ARG_COMMAND].fired++;
+          trig_scan_add(TRIG_ARG_COMMAND, &start);
           if (script_driver(&ch, t, MOB_TRIGGER, TRIG_NEW))
             return 1;
+          gettimeofday(&start, NULL);
         }
       }
     }
   }
 
+  trig_scan_add(TRIG_ARG_COMMAND, &start);
   return 0;
 }
 
@@ -386,18 +578,27 @@ void speech_mtrigger(char_data *actor, char *str)
   char_data *ch, *ch_next;
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
+  ubyte keys[TRIG_ARG_BITS / 8];
+  struct timeval start;
+
+  gettimeofday(&start, NULL);
+  trig_scans[TRIG_ARG_SPEECH].searches++;
+  text_keys(str, keys);
 
   for (ch = world[IN_ROOM(actor)].people; ch; ch = ch_next)
   {
     ch_next = ch->next_in_room;
 
     if (SCRIPT_CHECK(ch, MTRIG_SPEECH) && AWAKE(ch) &&
-        !AFF_FLAGGED(ch, AFF_CHARM) && ((actor != ch) || CONFIG_SCRIPT_PLAYERS))
+        !AFF_FLAGGED(ch, AFF_CHARM) && ((actor != ch) || CONFIG_SCRIPT_PLAYERS) &&
+        trig_args_match(SCRIPT(ch), TRIG_ARG_SPEECH, keys))
       for (t = TRIGGERS(SCRIPT(ch)); t; t = t->next)
       {
         if (!TRIGGER_CHECK(t, MTRIG_SPEECH))
           continue;
 
+        trig_scans[TRIG_ARG_SPEECH].checked++;
+
         if (!GET_TRIG_ARG(t) || !*GET_TRIG_ARG(t))
         {
           mudlog(NRM, LVL_BUILDER, TRUE, "SYSERR: Speech Trigger #%d has no text argument!",
@@ -410,11 +611,16 @@ void speech_mtrigger(char_data *actor, char *str)
         {
           ADD_UID_VAR(buf, t, actor, "actor", 0);
           add_var(&GET_TRIG_VARS(t), "speech", str, 0);
+          trig_scans[TRIG_ARG_SPEECH].fired++;
+          trig_scan_add(TRIG_ARG_SPEECH, &start);
           script_driver(&ch, t, MOB_TRIGGER, TRIG_NEW);
+          gettimeofday(&start, NULL);
           break;
         }
       }
   }
+
+  trig_scan_add(TRIG_ARG_SPEECH, &start);
 }
 
 void act_mtrigger(const char_data *ch, char *str, char_data *actor,
@@ -423,6 +629,8 @@ void act_mtrigger(const char_data *ch, char *str, char_data *actor,
 {
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
+  ubyte keys[TRIG_ARG_BITS / 8];
+  struct timeval start;
 
   /* Strip color codes. - Ornir */
   if (str)
@@ -434,13 +642,22 @@ void act_mtrigger(const char_data *ch, char *str, char_data *actor,
  *   send_to_char(actor, "arg : %s\r\n", arg);
  */
 
-  if (SCRIPT_CHECK(ch, MTRIG_ACT) && !AFF_FLAGGED(ch, AFF_CHARM) &&
-      (actor != ch))
+  if (!SCRIPT_CHECK(ch, MTRIG_ACT) || AFF_FLAGGED(ch, AFF_CHARM) ||
+      (actor == ch))
+    return;
+
+  gettimeofday(&start, NULL);
+  trig_scans[TRIG_ARG_ACT].searches++;
+  text_keys(str, keys);
+
+  if (trig_args_match(SCRIPT(ch), TRIG_ARG_ACT, keys))
     for (t = TRIGGERS(SCRIPT(ch)); t; t = t->next)
     {
       if (!TRIGGER_CHECK(t, MTRIG_ACT))
         continue;
 
+      trig_scans[TRIG_ARG_ACT].checked++;
+
       if (!GET_TRIG_ARG(t) || !*GET_TRIG_ARG(t))
       {
         mudlog(NRM, LVL_BUILDER, TRUE, "SYSERR: Act Trigger #%d has no text argument!",
@@ -468,10 +685,14 @@ void act_mtrigger(const char_data *ch, char *str, char_data *actor,
           add_var(&GET_TRIG_VARS(t), "arg", nstr, 0);
           free(fstr);
         }
+        trig_scans[TRIG_ARG_ACT].fired++;
+        trig_scan_add(TRIG_ARG_ACT, &start);
         script_driver(&ch, t, MOB_TRIGGER, TRIG_NEW);
-        break;
+        return;
       }
     }
+
+  trig_scan_add(TRIG_ARG_ACT, &start);
 }
 
 void fight_mtrigger(char_data *ch)
@@ -782,19 +1003,29 @@ int get_otrigger(obj_data *obj, char_data *actor)
   return 1;
 }
 
+/* When command_otrigger() started timing, for cmd_otrig() to leave out the
+ * scripts it runs. */
+static struct timeval otrig_start;
+
 /* checks for command trigger on specific object. assumes obj has cmd trig */
 int cmd_otrig(obj_data *obj, char_data *actor, char *cmd,
               char *argument, int type)
 {
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
+  ubyte keys[TRIG_ARG_BITS / 8] = {0};
+
+  set_command_key(keys, cmd);
 
-  if (obj && SCRIPT_CHECK(obj, OTRIG_COMMAND))
+  if (obj && SCRIPT_CHECK(obj, OTRIG_COMMAND) &&
+      trig_args_match(SCRIPT(obj), TRIG_ARG_COMMAND, keys))
     for (t = TRIGGERS(SCRIPT(obj)); t; t = t->next)
     {
       if (!TRIGGER_CHECK(t, OTRIG_COMMAND))
         continue;
 
+      trig_scans[TRIG_ARG_COMMAND].checked++;
+
       if (IS_SET(GET_TRIG_NARG(t), type) &&
           (!GET_TRIG_ARG(t) || !*GET_TRIG_ARG(t)))
       {
@@ -814,8 +1045,11 @@ int cmd_otrig(obj_data *obj, char_data *actor, char *cmd,
         skip_spaces(&cmd);
         add_var(&GET_TRIG_VARS(t), "cmd", cmd, 0);
 
+        trig_scans[TRIG_ARG_COMMAND].fired++;
+        trig_scan_add(TRIG_ARG_COMMAND, &otrig_start);
         if (script_driver(&obj, t, OBJ_TRIGGER, TRIG_NEW))
           return 1;
+        gettimeofday(&otrig_start, NULL);
       }
     }
 
@@ -835,6 +1069,9 @@ int command_otrigger(char_data *actor, char *cmd, char *argument)
   if (!valid_dg_target(actor, 0))
     return 0;
 
+  gettimeofday(&otrig_start, NULL);
+  trig_scans[TRIG_ARG_COMMAND].searches++;
+
   for (i = 0; i < NUM_WEARS; i++)
     if (actor && GET_EQ(actor, i))
       if (cmd_otrig(GET_EQ(actor, i), actor, cmd, argument, OCMD_EQUIP))
@@ -845,13 +1082,12 @@ int command_otrigger(char_data *actor, char *cmd, char *argument)
       return 1;
 
   /* dummy check */
-  if (IN_ROOM(actor) == NOWHERE)
-    return 0;
-
-  for (obj = world[IN_ROOM(actor)].contents; obj; obj = obj->next_content)
-    if (cmd_otrig(obj, actor, cmd, argument, OCMD_ROOM))
-      return 1;
+  if (IN_ROOM(actor) != NOWHERE)
+    for (obj = world[IN_ROOM(actor)].contents; obj; obj = obj->next_content)
+      if (cmd_otrig(obj, actor, cmd, argument, OCMD_ROOM))
+        return 1;
 
+  trig_scan_add(TRIG_ARG_COMMAND, &otrig_start);
   return 0;
 }
 
@@ -1181,6 +1417,8 @@ int command_wtrigger(char_data *actor, char *cmd, char *argument)
   struct room_data *room = NULL;
   trig_data *t = NULL;
   char buf[MAX_INPUT_LENGTH] = {'\0'};
+  ubyte keys[TRIG_ARG_BITS / 8] = {0};
+  struct timeval start;
 
   if (IN_ROOM(actor) == NOWHERE)
     return 0;
@@ -1193,11 +1431,24 @@ int command_wtrigger(char_data *actor, char *cmd, char *argument)
     return 0;
 
   room = &world[IN_ROOM(actor)];
+
+  gettimeofday(&start, NULL);
+  trig_scans[TRIG_ARG_COMMAND].searches++;
+  set_command_key(keys, cmd);
+
+  if (!trig_args_match(SCRIPT(room), TRIG_ARG_COMMAND, keys))
+  {
+    trig_scan_add(TRIG_ARG_COMMAND, &start);
+    return 0;
+  }
+
   for (t = TRIGGERS(SCRIPT(room)); t; t = t->next)
   {
     if (!TRIGGER_CHECK(t, WTRIG_COMMAND))
       continue;
 
+    trig_scans[TRIG_ARG_COMMAND].checked++;
+
     if (!GET_TRIG_ARG(t) || !*GET_TRIG_ARG(t))
     {
       mudlog(NRM, LVL_BUILDER, TRUE, "SYSERR: W-Command Trigger #%d has no text argument!",
@@ -1214,10 +1465,13 @@ int command_wtrigger(char_data *actor, char *cmd, char *argument)
       skip_spaces(&cmd);
       add_var(&GET_TRIG_VARS(t), "cmd", cmd, 0);
 
+      trig_scans[TRIG_ARG_COMMAND].fired++;
+      trig_scan_add(TRIG_ARG_COMMAND, &start);
       return script_driver(&room, t, WLD_TRIGGER, TRIG_NEW);
     }
   }
 
+  trig_scan_add(TRIG_ARG_COMMAND, &start);
   return 0;
 }
 
@@ -1226,16 +1480,31 @@ void speech_wtrigger(char_data *actor, char *str)
   struct room_data *room;
   trig_data *t;
   char buf[MAX_INPUT_LENGTH];
+  ubyte keys[TRIG_ARG_BITS / 8];
+  struct timeval start;
 
   if (!actor || !SCRIPT_CHECK(&world[IN_ROOM(actor)], WTRIG_SPEECH))
     return;
 
   room = &world[IN_ROOM(actor)];
+
+  gettimeofday(&start, NULL);
+  trig_scans[TRIG_ARG_SPEECH].searches++;
+  text_keys(str, keys);
+
+  if (!trig_args_match(SCRIPT(room), TRIG_ARG_SPEECH, keys))
+  {
+    trig_scan_add(TRIG_ARG_SPEECH, &start);
+    return;
+  }
+
   for (t = TRIGGERS(SCRIPT(room)); t; t = t->next)
   {
     if (!TRIGGER_CHECK(t, WTRIG_SPEECH))
       continue;
 
+    trig_scans[TRIG_ARG_SPEECH].checked++;
+
     if (!GET_TRIG_ARG(t) || !*GET_TRIG_ARG(t))
     {
       mudlog(NRM, LVL_BUILDER, TRUE, "SYSERR: W-Speech Trigger #%d has no text argument!",
@@ -1249,10 +1518,14 @@ void speech_wtrigger(char_data *actor, char *str)
     {
       ADD_UID_VAR(buf, t, actor, "actor", 0);
       add_var(&GET_TRIG_VARS(t), "speech", str, 0);
+      trig_scans[TRIG_ARG_SPEECH].fired++;
+      trig_scan_add(TRIG_ARG_SPEECH, &start);
       script_driver(&room, t, WLD_TRIGGER, TRIG_NEW);
-      break;
+      return;
     }
   }
+
+  trig_scan_add(TRIG_ARG_SPEECH, &start);
 }
 
 int drop_wtrigger(obj_data *obj, char_data *actor)
@@ -218,18 +218,91 @@ static int handle_oset(struct obj_data *obj, char *argument)
   return 1;
 }
 
+/* Field names, in the order of enum dg_field, see dg_scripts.h. */
+const char *dg_fields[] = {
+    "", /* DG_FIELD_NONE */
+    "affect", "affects", "alias", "align", "armor", "bound", "canbeseen",
+    "car", "carried_by", "cdr", "cha", "char", "charat", "clan", "clanrank",
+    "class", "con", "contains", "contents", "cost", "cost_per_day", "count",
+    "damroll", "day", "dex", "dir", "down", "drunk", "east", "eq", "exp",
+    "extra", "feat", "fighting", "follower", "global", "gold", "has_class",
+    "has_in", "has_item", "hasattached", "heshe", "himher", "hisher", "hitp",
+    "hitroll", "hour", "hunger", "id", "int", "inventory", "is_inroom",
+    "is_killer", "is_on_quest", "is_pc", "is_thief", "level", "master",
+    "maxhitp", "maxmove", "maxpsp", "month", "move", "mudcommand", "name",
+    "next_in_list", "next_in_room", "north", "oset", "people", "pos", "prac",
+    "pref", "psp", "qp", "qpnts", "quest", "questdone", "questpoints", "race",
+    "resist_acid", "resist_air", "resist_cold", "resist_disease",
+    "resist_earth", "resist_electric", "resist_energy", "resist_fire",
+    "resist_force", "resist_holy", "resist_illusion", "resist_light",
+    "resist_mental", "resist_negative", "resist_poison", "resist_puncture",
+    "resist_slice", "resist_sound", "resist_unholy", "resist_water", "room",
+    "roomflag", "saving_death", "saving_fort", "saving_poison", "saving_refl",
+    "saving_will", "sector", "sex", "shortdesc", "size", "sizenumber",
+    "skill", "skillroll", "skillset", "south", "str", "stradd", "strlen",
+    "subrace1", "subrace2", "subrace3", "thirst", "timer", "title",
+    "treasure", "trim", "type", "up", "val0", "val1", "val2", "val3",
+    "varexists", "vnum", "wearflag", "weather", "weight", "west", "wis",
+    "worn_by", "xcoord", "ycoord", "year", "zonename", "zonenumber",
+    "\n"};
+
+/* dg_fields[] hashed by name, built the first time it is used.  A slot holds
+ * the index of a field, 0 if it is empty. */
+#define DG_FIELD_HASH_SIZE 512
+static short dg_field_hash[DG_FIELD_HASH_SIZE];
+
+static unsigned int dg_field_bucket(const char *name)
+{
+  unsigned int h = 0;
+
+  for (; *name; name++)
+    h = h * 31 + LOWER(*name);
+
+  return h & (DG_FIELD_HASH_SIZE - 1);
+}
+
+/* Returns the DG_FIELD_* of a field name, or DG_FIELD_NONE if it is not one.
+ * Case does not matter, as with str_cmp(). */
+int find_dg_field(const char *field)
+{
+  static bool built = FALSE;
+  unsigned int h;
+  int i;
+
+  if (!built)
+  {
+    for (i = 1; *dg_fields[i] != '\n'; i++)
+    {
+      for (h = dg_field_bucket(dg_fields[i]); dg_field_hash[h]; h = (h + 1) & (DG_FIELD_HASH_SIZE - 1))
+        ;
+      dg_field_hash[h] = i;
+    }
+    built = TRUE;
+  }
+
+  if (!field)
+    return DG_FIELD_NONE;
+
+  for (h = dg_field_bucket(field); dg_field_hash[h]; h = (h + 1) & (DG_FIELD_HASH_SIZE - 1))
+    if (!str_cmp(dg_fields[dg_field_hash[h]], field))
+      return dg_field_hash[h];
+
+  return DG_FIELD_NONE;
+}
+
 int text_processed(char *field, char *subfield, struct trig_var_data *vd,
                    char *str, size_t slen)
 {
   char *p, *p2;
   char tmpvar[MAX_STRING_LENGTH];
+  int fid = find_dg_field(field);
 
-  if (!str_cmp(field, "strlen"))
+  if (fid == DG_FIELD_STRLEN)
   { /* strlen    */
     snprintf(str, slen, "%d", (int)strlen(vd->value));
     return TRUE;
   }
-  else if (!str_cmp(field, "trim"))
+  else if (fid == DG_FIELD_TRIM)
   { /* trim      */
     /* trim whitespace from ends */
     snprintf(tmpvar, sizeof(tmpvar) - 1, "%s", vd->value); /* -1 to use later*/
@@ -248,7 +321,7 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
     snprintf(str, slen, "%s", p);
     return TRUE;
   }
-  else if (!str_cmp(field, "contains"))
+  else if (fid == DG_FIELD_CONTAINS)
   { /* contains  */
     if (str_str(vd->value, subfield))
       strcpy(str, "1");
@@ -256,7 +329,7 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
       strcpy(str, "0");
     return TRUE;
   }
-  else if (!str_cmp(field, "car"))
+  else if (fid == DG_FIELD_CAR)
   { /* car       */
     char *car = vd->value;
     while (*car && !isspace(*car))
@@ -264,7 +337,7 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
     *str = '\0';
     return TRUE;
   }
-  else if (!str_cmp(field, "cdr"))
+  else if (fid == DG_FIELD_CDR)
   { /* cdr       */
     char *cdr = vd->value;
     while (*cdr && !isspace(*cdr))
@@ -275,7 +348,7 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
     snprintf(str, slen, "%s", cdr);
     return TRUE;
   }
-  else if (!str_cmp(field, "charat"))
+  else if (fid == DG_FIELD_CHARAT)
   { /* CharAt    */
     size_t len = strlen(vd->value), cindex = atoi(subfield);
     if (cindex > len || cindex < 1)
@@ -284,7 +357,7 @@ int text_processed(char *field, char *subfield, struct trig_var_data *vd,
       snprintf(str, slen, "%c", vd->value[cindex - 1]);
     return TRUE;
   }
-  else if (!str_cmp(field, "mudcommand"))
+  else if (fid == DG_FIELD_MUDCOMMAND)
   {
     /* find the mud command returned from this text */
     /* NOTE: you may need to replace "cmd_info" with "complete_cmd_info", */
@@ -315,7 +388,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
   obj_data *obj, *o = NULL;
   struct room_data *room, *r = NULL;
   char *name;
-  int num, count, i, j, doors;
+  int num, count, i, j, doors, fid;
 
   const char * const send_cmd[] = {"msend ", "osend ", "wsend "};
   const char * const echo_cmd[] = {"mecho ", "oecho ", "wecho "};
@@ -420,9 +493,11 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
 
     return;
   }
-  else if (vd && text_processed(field, subfield, vd, str, slen))
-    return;
 
+  fid = find_dg_field(field);
+
+  if (vd && text_processed(field, subfield, vd, str, slen))
+    return;
   else
   {
     if (vd)
@@ -525,13 +600,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       }
       else if (!str_cmp(var, "happyhour"))
       {
-        if (!str_cmp(field, "qp") && IS_HAPPYHOUR)
+        if (fid == DG_FIELD_QP && IS_HAPPYHOUR)
           snprintf(str, slen, "%d", HAPPY_QP);
-        else if (!str_cmp(field, "exp") && IS_HAPPYHOUR)
+        else if (fid == DG_FIELD_EXP && IS_HAPPYHOUR)
           snprintf(str, slen, "%d", HAPPY_EXP);
-        else if (!str_cmp(field, "gold") && IS_HAPPYHOUR)
+        else if (fid == DG_FIELD_GOLD && IS_HAPPYHOUR)
           snprintf(str, slen, "%d", HAPPY_GOLD);
-        else if (!str_cmp(field, "treasure") && IS_HAPPYHOUR)
+        else if (fid == DG_FIELD_TREASURE && IS_HAPPYHOUR)
           snprintf(str, slen, "%d", HAPPY_TREASURE);
         else
           snprintf(str, slen, "%d", HAPPY_TIME);
@@ -539,13 +614,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       }
       else if (!str_cmp(var, "time"))
       {
-        if (!str_cmp(field, "hour"))
+        if (fid == DG_FIELD_HOUR)
           snprintf(str, slen, "%d", time_info.hours);
-        else if (!str_cmp(field, "day"))
+        else if (fid == DG_FIELD_DAY)
           snprintf(str, slen, "%d", time_info.day + 1);
-        else if (!str_cmp(field, "month"))
+        else if (fid == DG_FIELD_MONTH)
           snprintf(str, slen, "%d", time_info.month + 1);
-        else if (!str_cmp(field, "year"))
+        else if (fid == DG_FIELD_YEAR)
           snprintf(str, slen, "%d", time_info.year);
         else
           *str = '\0';
@@ -612,7 +687,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       }
       else if (!str_cmp(var, "random"))
       {
-        if (!str_cmp(field, "char"))
+        if (fid == DG_FIELD_CHAR)
         {
           rndm = NULL;
           count = 0;
@@ -658,7 +733,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             *str = '\0';
         }
-        else if (!str_cmp(field, "dir"))
+        else if (fid == DG_FIELD_DIR)
         {
           room_rnum in_room = NOWHERE;
 
@@ -711,7 +786,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
 
     if (c)
     {
-      if (!str_cmp(field, "global"))
+      if (fid == DG_FIELD_GLOBAL)
       { /* get global of something else */
         if (IS_NPC(c) && c->script)
         {
@@ -725,7 +800,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       switch (LOWER(*field))
       {
       case 'a':
-        if (!str_cmp(field, "affect"))
+        if (fid == DG_FIELD_AFFECT)
         {
           if (subfield && *subfield)
           {
@@ -738,10 +813,10 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             strcpy(str, "0");
         }
-        else if (!str_cmp(field, "alias"))
+        else if (fid == DG_FIELD_ALIAS)
           snprintf(str, slen, "%s", GET_PC_NAME(c));
 
-        else if (!str_cmp(field, "align"))
+        else if (fid == DG_FIELD_ALIGN)
         {
           if (subfield && *subfield)
           {
@@ -750,18 +825,18 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_ALIGNMENT(c));
         }
-        else if (!str_cmp(field, "armor"))
+        else if (fid == DG_FIELD_ARMOR)
           snprintf(str, slen, "%d", compute_armor_class(NULL, c, FALSE, MODE_ARMOR_CLASS_NORMAL));
         break;
       case 'c':
-        if (!str_cmp(field, "canbeseen"))
+        if (fid == DG_FIELD_CANBESEEN)
         {
           if ((type == MOB_TRIGGER) && !CAN_SEE(((char_data *)go), c))
             strcpy(str, "0");
           else
             strcpy(str, "1");
         }
-        else if (!str_cmp(field, "cha"))
+        else if (fid == DG_FIELD_CHA)
         {
           if (subfield && *subfield)
           {
@@ -775,7 +850,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_CHA(c));
         }
-        else if (!str_cmp(field, "clan"))
+        else if (fid == DG_FIELD_CLAN)
         {
           if (!IS_NPC(c))
           {
@@ -791,7 +866,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", NO_CLAN); /* Mobs have no clan */
           }
         }
-        else if (!str_cmp(field, "clanrank"))
+        else if (fid == DG_FIELD_CLANRANK)
         {
           if (!IS_NPC(c))
           {
@@ -802,7 +877,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", NO_CLANRANK); /* Mobs have no clan */
           }
         }
-        else if (!str_cmp(field, "class"))
+        else if (fid == DG_FIELD_CLASS)
         {
           if (subfield && *subfield)
           {
@@ -823,7 +898,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%s", CLSLIST_NAME(GET_CLASS(c)));
           }
         }
-        else if (!str_cmp(field, "con"))
+        else if (fid == DG_FIELD_CON)
         {
           if (subfield && *subfield)
           {
@@ -839,7 +914,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'd':
-        if (!str_cmp(field, "damroll"))
+        if (fid == DG_FIELD_DAMROLL)
         {
           if (subfield && *subfield)
           {
@@ -848,7 +923,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_DAMROLL(c));
         }
-        else if (!str_cmp(field, "dex"))
+        else if (fid == DG_FIELD_DEX)
         {
           if (subfield && *subfield)
           {
@@ -862,7 +937,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_DEX(c));
         }
-        else if (!str_cmp(field, "drunk"))
+        else if (fid == DG_FIELD_DRUNK)
         {
           if (subfield && *subfield)
           {
@@ -873,7 +948,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'e':
-        if (!str_cmp(field, "eq"))
+        if (fid == DG_FIELD_EQ)
         {
           int pos;
           if (!subfield || !*subfield)
@@ -896,7 +971,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(GET_EQ(c, pos)));
         }
-        else if (!str_cmp(field, "exp"))
+        else if (fid == DG_FIELD_EXP)
         {
           if (subfield && *subfield)
           {
@@ -908,16 +983,16 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'f':
-        if (!str_cmp(field, "feat"))
+        if (fid == DG_FIELD_FEAT)
             snprintf(str, slen, "%d", dg_has_feat(c, subfield, 0));
-        else if (!str_cmp(field, "fighting"))
+        else if (fid == DG_FIELD_FIGHTING)
         {
           if (FIGHTING(c))
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(FIGHTING(c)));
           else
             *str = '\0';
         }
-        else if (!str_cmp(field, "follower"))
+        else if (fid == DG_FIELD_FOLLOWER)
         {
           if (!c->followers || !c->followers->follower)
             *str = '\0';
@@ -926,7 +1001,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'g':
-        if (!str_cmp(field, "gold"))
+        if (fid == DG_FIELD_GOLD)
         {
           if (subfield && *subfield)
           {
@@ -937,14 +1012,14 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'h':
-        if (!str_cmp(field, "has_item"))
+        if (fid == DG_FIELD_HAS_ITEM)
         {
           if (!(subfield && *subfield))
             *str = '\0';
           else
             snprintf(str, slen, "%d", char_has_item(subfield, c));
         }
-        else if (!str_cmp(field, "has_class"))
+        else if (fid == DG_FIELD_HAS_CLASS)
         {
           strcpy(str, "0");
           if (subfield && *subfield)
@@ -959,7 +1034,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             }
           }
         }
-        else if (!str_cmp(field, "hasattached"))
+        else if (fid == DG_FIELD_HASATTACHED)
         {
           if (!(subfield && *subfield) || !IS_NPC(c))
             *str = '\0';
@@ -969,13 +1044,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", trig_is_attached(SCRIPT(c), i));
           }
         }
-        else if (!str_cmp(field, "heshe"))
+        else if (fid == DG_FIELD_HESHE)
           snprintf(str, slen, "%s", HSSH(c));
-        else if (!str_cmp(field, "himher"))
+        else if (fid == DG_FIELD_HIMHER)
           snprintf(str, slen, "%s", HMHR(c));
-        else if (!str_cmp(field, "hisher"))
+        else if (fid == DG_FIELD_HISHER)
           snprintf(str, slen, "%s", HSHR(c));
-        else if (!str_cmp(field, "hitp"))
+        else if (fid == DG_FIELD_HITP)
         {
           if (subfield && *subfield)
           {
@@ -985,7 +1060,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_HIT(c));
         }
-        else if (!str_cmp(field, "hitroll"))
+        else if (fid == DG_FIELD_HITROLL)
         {
           if (subfield && *subfield)
           {
@@ -994,7 +1069,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_HITROLL(c));
         }
-        else if (!str_cmp(field, "hunger"))
+        else if (fid == DG_FIELD_HUNGER)
         {
           if (subfield && *subfield)
           {
@@ -1005,17 +1080,17 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'i':
-        if (!str_cmp(field, "id"))
+        if (fid == DG_FIELD_ID)
           snprintf(str, slen, "%ld", GET_ID(c));
         /* new check for pc/npc status */
-        else if (!str_cmp(field, "is_pc"))
+        else if (fid == DG_FIELD_IS_PC)
         {
           if (IS_NPC(c))
             strcpy(str, "0");
           else
             strcpy(str, "1");
         }
-        else if (!str_cmp(field, "int"))
+        else if (fid == DG_FIELD_INT)
         {
           if (subfield && *subfield)
           {
@@ -1029,7 +1104,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_INT(c));
         }
-        else if (!str_cmp(field, "inventory"))
+        else if (fid == DG_FIELD_INVENTORY)
         {
           if (subfield && *subfield)
           {
@@ -1056,7 +1131,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             }
           }
         }
-        else if (!str_cmp(field, "is_killer"))
+        else if (fid == DG_FIELD_IS_KILLER)
         {
           if (subfield && *subfield)
           {
@@ -1070,7 +1145,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             strcpy(str, "0");
         }
-        else if (!str_cmp(field, "is_on_quest"))
+        else if (fid == DG_FIELD_IS_ON_QUEST)
         {
           if (!IS_NPC(c) && subfield && *subfield)
           {
@@ -1083,7 +1158,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             strcpy(str, "0");
         }
-        else if (!str_cmp(field, "is_thief"))
+        else if (fid == DG_FIELD_IS_THIEF)
         {
           if (subfield && *subfield)
           {
@@ -1099,7 +1174,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'l':
-        if (!str_cmp(field, "level"))
+        if (fid == DG_FIELD_LEVEL)
         {
           if (subfield && *subfield)
           {
@@ -1111,7 +1186,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'm':
-        if (!str_cmp(field, "psp"))
+        if (fid == DG_FIELD_PSP)
         {
           if (subfield && *subfield)
           {
@@ -1120,14 +1195,14 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_PSP(c));
         }
-        else if (!str_cmp(field, "master"))
+        else if (fid == DG_FIELD_MASTER)
         {
           if (!c->master)
             *str = '\0';
           else
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(c->master));
         }
-        else if (!str_cmp(field, "maxhitp"))
+        else if (fid == DG_FIELD_MAXHITP)
         {
           if (subfield && *subfield)
           {
@@ -1136,7 +1211,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_MAX_HIT(c));
         }
-        else if (!str_cmp(field, "maxpsp"))
+        else if (fid == DG_FIELD_MAXPSP)
         {
           if (subfield && *subfield)
           {
@@ -1145,7 +1220,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_MAX_PSP(c));
         }
-        else if (!str_cmp(field, "maxmove"))
+        else if (fid == DG_FIELD_MAXMOVE)
         {
           if (subfield && *subfield)
           {
@@ -1154,7 +1229,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_MAX_MOVE(c));
         }
-        else if (!str_cmp(field, "move"))
+        else if (fid == DG_FIELD_MOVE)
         {
           if (subfield && *subfield)
           {
@@ -1165,10 +1240,10 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'n':
-        if (!str_cmp(field, "name"))
+        if (fid == DG_FIELD_NAME)
           snprintf(str, slen, "%s", GET_NAME(c));
 
-        else if (!str_cmp(field, "next_in_room"))
+        else if (fid == DG_FIELD_NEXT_IN_ROOM)
         {
           if (c->next_in_room)
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(c->next_in_room));
@@ -1179,7 +1254,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       case 'p':
         /* Thanks to Christian Ejlertsen for this idea
              And to Ken Ray for speeding the implementation up :)*/
-        if (!str_cmp(field, "pos"))
+        if (fid == DG_FIELD_POS)
         {
           if (subfield && *subfield)
           {
@@ -1195,7 +1270,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%s", position_types[GET_POS(c)]);
         }
-        else if (!str_cmp(field, "prac"))
+        else if (fid == DG_FIELD_PRAC)
         {
           if (subfield && *subfield)
           {
@@ -1204,7 +1279,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_PRACTICES(c));
         }
-        else if (!str_cmp(field, "pref"))
+        else if (fid == DG_FIELD_PREF)
         {
           if (subfield && *subfield)
           {
@@ -1219,8 +1294,8 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'q':
-        if (!IS_NPC(c) && (!str_cmp(field, "questpoints") ||
-                           !str_cmp(field, "qp") || !str_cmp(field, "qpnts")))
+        if (!IS_NPC(c) && (fid == DG_FIELD_QUESTPOINTS ||
+                           fid == DG_FIELD_QP || fid == DG_FIELD_QPNTS))
         {
           if (subfield && *subfield)
           {
@@ -1229,14 +1304,14 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_QUESTPOINTS(c));
         }
-        else if (!str_cmp(field, "quest"))
+        else if (fid == DG_FIELD_QUEST)
         {
           if (!IS_NPC(c) && (GET_QUEST(c) != NOTHING) && (real_quest(GET_QUEST(c)) != NOTHING))
             snprintf(str, slen, "%d", GET_QUEST(c));
           else
             strcpy(str, "0");
         }
-        else if (!str_cmp(field, "questdone"))
+        else if (fid == DG_FIELD_QUESTDONE)
         {
           if (!IS_NPC(c) && subfield && *subfield)
           {
@@ -1251,7 +1326,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'r':
-        if (!str_cmp(field, "race"))
+        if (fid == DG_FIELD_RACE)
         {
           if (subfield && *subfield)
           {
@@ -1272,7 +1347,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             //sprinttype(GET_RACE(c), pc_race_types, str, slen);
           }
         }
-        else if (!str_cmp(field, "resist_fire"))
+        else if (fid == DG_FIELD_RESIST_FIRE)
         {
           if (subfield && *subfield)
           {
@@ -1281,7 +1356,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_FIRE));
         }
-        else if (!str_cmp(field, "resist_cold"))
+        else if (fid == DG_FIELD_RESIST_COLD)
         {
           if (subfield && *subfield)
           {
@@ -1290,7 +1365,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_COLD));
         }
-        else if (!str_cmp(field, "resist_air"))
+        else if (fid == DG_FIELD_RESIST_AIR)
         {
           if (subfield && *subfield)
           {
@@ -1299,7 +1374,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_AIR));
         }
-        else if (!str_cmp(field, "resist_earth"))
+        else if (fid == DG_FIELD_RESIST_EARTH)
         {
           if (subfield && *subfield)
           {
@@ -1308,7 +1383,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_EARTH));
         }
-        else if (!str_cmp(field, "resist_acid"))
+        else if (fid == DG_FIELD_RESIST_ACID)
         {
           if (subfield && *subfield)
           {
@@ -1317,7 +1392,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_ACID));
         }
-        else if (!str_cmp(field, "resist_holy"))
+        else if (fid == DG_FIELD_RESIST_HOLY)
         {
           if (subfield && *subfield)
           {
@@ -1326,7 +1401,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_HOLY));
         }
-        else if (!str_cmp(field, "resist_electric"))
+        else if (fid == DG_FIELD_RESIST_ELECTRIC)
         {
           if (subfield && *subfield)
           {
@@ -1335,7 +1410,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_ELECTRIC));
         }
-        else if (!str_cmp(field, "resist_unholy"))
+        else if (fid == DG_FIELD_RESIST_UNHOLY)
         {
           if (subfield && *subfield)
           {
@@ -1344,7 +1419,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_UNHOLY));
         }
-        else if (!str_cmp(field, "resist_slice"))
+        else if (fid == DG_FIELD_RESIST_SLICE)
         {
           if (subfield && *subfield)
           {
@@ -1353,7 +1428,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_SLICE));
         }
-        else if (!str_cmp(field, "resist_puncture"))
+        else if (fid == DG_FIELD_RESIST_PUNCTURE)
         {
           if (subfield && *subfield)
           {
@@ -1362,7 +1437,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_PUNCTURE));
         }
-        else if (!str_cmp(field, "resist_force"))
+        else if (fid == DG_FIELD_RESIST_FORCE)
         {
           if (subfield && *subfield)
           {
@@ -1371,7 +1446,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_FORCE));
         }
-        else if (!str_cmp(field, "resist_sound"))
+        else if (fid == DG_FIELD_RESIST_SOUND)
         {
           if (subfield && *subfield)
           {
@@ -1380,7 +1455,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_SOUND));
         }
-        else if (!str_cmp(field, "resist_poison"))
+        else if (fid == DG_FIELD_RESIST_POISON)
         {
           if (subfield && *subfield)
           {
@@ -1390,7 +1465,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_POISON));
         }
-        else if (!str_cmp(field, "resist_disease"))
+        else if (fid == DG_FIELD_RESIST_DISEASE)
         {
           if (subfield && *subfield)
           {
@@ -1399,7 +1474,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_DISEASE));
         }
-        else if (!str_cmp(field, "resist_negative"))
+        else if (fid == DG_FIELD_RESIST_NEGATIVE)
         {
           if (subfield && *subfield)
           {
@@ -1408,7 +1483,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_NEGATIVE));
         }
-        else if (!str_cmp(field, "resist_illusion"))
+        else if (fid == DG_FIELD_RESIST_ILLUSION)
         {
           if (subfield && *subfield)
           {
@@ -1417,7 +1492,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_ILLUSION));
         }
-        else if (!str_cmp(field, "resist_mental"))
+        else if (fid == DG_FIELD_RESIST_MENTAL)
         {
           if (subfield && *subfield)
           {
@@ -1426,7 +1501,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_MENTAL));
         }
-        else if (!str_cmp(field, "resist_light"))
+        else if (fid == DG_FIELD_RESIST_LIGHT)
         {
           if (subfield && *subfield)
           {
@@ -1435,7 +1510,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_LIGHT));
         }
-        else if (!str_cmp(field, "resist_energy"))
+        else if (fid == DG_FIELD_RESIST_ENERGY)
         {
           if (subfield && *subfield)
           {
@@ -1444,7 +1519,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_ENERGY));
         }
-        else if (!str_cmp(field, "resist_water"))
+        else if (fid == DG_FIELD_RESIST_WATER)
         {
           if (subfield && *subfield)
           {
@@ -1453,7 +1528,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_RESISTANCES(c, DAM_WATER));
         }
-        else if (!str_cmp(field, "room"))
+        else if (fid == DG_FIELD_ROOM)
         { /* in NOWHERE, return the void */
           /* see note in dg_scripts.h */
 #ifdef ACTOR_ROOM_IS_UID
@@ -1465,7 +1540,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 's':
-        if (!str_cmp(field, "saving_death"))
+        if (fid == DG_FIELD_SAVING_DEATH)
         {
           if (subfield && *subfield)
           {
@@ -1474,7 +1549,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_SAVE(c, SAVING_DEATH));
         }
-        else if (!str_cmp(field, "saving_poison"))
+        else if (fid == DG_FIELD_SAVING_POISON)
         {
           if (subfield && *subfield)
           {
@@ -1483,7 +1558,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_SAVE(c, SAVING_POISON));
         }
-        else if (!str_cmp(field, "saving_fort"))
+        else if (fid == DG_FIELD_SAVING_FORT)
         {
           if (subfield && *subfield)
           {
@@ -1492,7 +1567,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_SAVE(c, SAVING_FORT));
         }
-        else if (!str_cmp(field, "saving_refl"))
+        else if (fid == DG_FIELD_SAVING_REFL)
         {
           if (subfield && *subfield)
           {
@@ -1501,7 +1576,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_SAVE(c, SAVING_REFL));
         }
-        else if (!str_cmp(field, "saving_will"))
+        else if (fid == DG_FIELD_SAVING_WILL)
         {
           if (subfield && *subfield)
           {
@@ -1510,17 +1585,17 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_SAVE(c, SAVING_WILL));
         }
-        else if (!str_cmp(field, "sex"))
+        else if (fid == DG_FIELD_SEX)
           snprintf(str, slen, "%s", genders[(int)GET_SEX(c)]);
-        else if (!str_cmp(field, "size"))
+        else if (fid == DG_FIELD_SIZE)
           snprintf(str, slen, "%s", size_names[(int)GET_SIZE(c)]);
-        else if (!str_cmp(field, "sizenumber"))
+        else if (fid == DG_FIELD_SIZENUMBER)
           snprintf(str, slen, "%d", (int)GET_SIZE(c));
-        else if (!str_cmp(field, "skill"))
+        else if (fid == DG_FIELD_SKILL)
           snprintf(str, slen, "%s", skill_percent(c, subfield));
-        else if (!str_cmp(field, "skillroll"))
+        else if (fid == DG_FIELD_SKILLROLL)
           snprintf(str, slen, "%s", skill_percent_plus_d20(c, subfield));
-        else if (!str_cmp(field, "skillset"))
+        else if (fid == DG_FIELD_SKILLSET)
         {
           if (!IS_NPC(c) && subfield && *subfield)
           {
@@ -1539,7 +1614,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           *str = '\0'; /* so the parser know we recognize 'skillset' as a field */
         }
-        else if (!str_cmp(field, "str"))
+        else if (fid == DG_FIELD_STR)
         {
           if (subfield && *subfield)
           {
@@ -1553,7 +1628,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_STR(c));
         }
-        else if (!str_cmp(field, "stradd"))
+        else if (fid == DG_FIELD_STRADD)
         {
           if (GET_STR(c) >= 18)
           {
@@ -1569,7 +1644,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "%d", GET_ADD(c));
           }
         }
-        else if (!str_cmp(field, "subrace1"))
+        else if (fid == DG_FIELD_SUBRACE1)
         {
           if (subfield && *subfield)
           {
@@ -1590,7 +1665,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             //sprinttype(GET_RACE(c), pc_race_types, str, slen);
           }
         }
-        else if (!str_cmp(field, "subrace2"))
+        else if (fid == DG_FIELD_SUBRACE2)
         {
           if (subfield && *subfield)
           {
@@ -1611,7 +1686,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             //sprinttype(GET_RACE(c), pc_race_types, str, slen);
           }
         }
-        else if (!str_cmp(field, "subrace3"))
+        else if (fid == DG_FIELD_SUBRACE3)
         {
           if (subfield && *subfield)
           {
@@ -1634,7 +1709,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 't':
-        if (!str_cmp(field, "thirst"))
+        if (fid == DG_FIELD_THIRST)
         {
           if (subfield && *subfield)
           {
@@ -1643,7 +1718,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_COND(c, THIRST));
         }
-        else if (!str_cmp(field, "title"))
+        else if (fid == DG_FIELD_TITLE)
         {
           if (!IS_NPC(c) && subfield && *subfield && valid_dg_target(c, DG_ALLOW_STAFFS))
           {
@@ -1655,7 +1730,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'v':
-        if (!str_cmp(field, "varexists"))
+        if (fid == DG_FIELD_VAREXISTS)
         {
           struct trig_var_data *remote_vd;
           strcpy(str, "0");
@@ -1670,7 +1745,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
               strcpy(str, "1");
           }
         }
-        else if (!str_cmp(field, "vnum"))
+        else if (fid == DG_FIELD_VNUM)
         {
           if (subfield && *subfield)
           {
@@ -1691,9 +1766,9 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'w':
-        if (!str_cmp(field, "weight"))
+        if (fid == DG_FIELD_WEIGHT)
           snprintf(str, slen, "%d", GET_WEIGHT(c));
-        else if (!str_cmp(field, "wis"))
+        else if (fid == DG_FIELD_WIS)
         {
           if (subfield && *subfield)
           {
@@ -1742,7 +1817,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
       switch (LOWER(*field))
       {
       case 'a':
-        if (!str_cmp(field, "affects"))
+        if (fid == DG_FIELD_AFFECTS)
         {
           if (subfield && *subfield)
           {
@@ -1755,7 +1830,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             snprintf(str, slen, "0");
         }
       case 'b':
-        if (!str_cmp(field, "bound"))
+        if (fid == DG_FIELD_BOUND)
         {
           if (GET_OBJ_BOUND_ID(o) != NOBODY)
           {
@@ -1768,7 +1843,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'c':
-        if (!str_cmp(field, "cost"))
+        if (fid == DG_FIELD_COST)
         {
           if (subfield && *subfield)
           {
@@ -1777,7 +1852,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_OBJ_COST(o));
         }
-        else if (!str_cmp(field, "cost_per_day"))
+        else if (fid == DG_FIELD_COST_PER_DAY)
         {
           if (subfield && *subfield)
           {
@@ -1786,21 +1861,21 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_OBJ_RENT(o));
         }
-        else if (!str_cmp(field, "carried_by"))
+        else if (fid == DG_FIELD_CARRIED_BY)
         {
           if (o->carried_by)
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(o->carried_by));
           else
             *str = '\0';
         }
-        else if (!str_cmp(field, "contents"))
+        else if (fid == DG_FIELD_CONTENTS)
         {
           if (o->contains)
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(o->contains));
           else
             *str = '\0';
         } /* thanks to Jamie Nelson (Mordecai of 4 Dimensions MUD) */
-        else if (!str_cmp(field, "count"))
+        else if (fid == DG_FIELD_COUNT)
         {
           if (GET_OBJ_TYPE(o) == ITEM_CONTAINER ||
               GET_OBJ_TYPE(o) == ITEM_AMMO_POUCH)
@@ -1810,7 +1885,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'e':
-        if (!str_cmp(field, "extra"))
+        if (fid == DG_FIELD_EXTRA)
         {
           if (subfield && *subfield)
           {
@@ -1827,7 +1902,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         break;
       case 'h':
         /* thanks to Jamie Nelson (Mordecai of 4 Dimensions MUD) */
-        if (!str_cmp(field, "has_in"))
+        if (fid == DG_FIELD_HAS_IN)
         {
           if (GET_OBJ_TYPE(o) == ITEM_CONTAINER ||
               GET_OBJ_TYPE(o) == ITEM_AMMO_POUCH)
@@ -1835,7 +1910,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             strcpy(str, "0");
         }
-        else if (!str_cmp(field, "hasattached"))
+        else if (fid == DG_FIELD_HASATTACHED)
         {
           if (!(subfield && *subfield))
             *str = '\0';
@@ -1847,26 +1922,26 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'i':
-        if (!str_cmp(field, "id"))
+        if (fid == DG_FIELD_ID)
           snprintf(str, slen, "%ld", GET_ID(o));
 
-        else if (!str_cmp(field, "is_inroom"))
+        else if (fid == DG_FIELD_IS_INROOM)
         {
           if (IN_ROOM(o) != NOWHERE)
             snprintf(str, slen, "%c%ld", UID_CHAR, (long)world[IN_ROOM(o)].number + ROOM_ID_BASE);
           else
             *str = '\0';
         }
-        else if (!str_cmp(field, "is_pc"))
+        else if (fid == DG_FIELD_IS_PC)
         {
           strcpy(str, "-1");
         }
         break;
       case 'n':
-        if (!str_cmp(field, "name"))
+        if (fid == DG_FIELD_NAME)
           snprintf(str, slen, "%s", o->name);
 
-        else if (!str_cmp(field, "next_in_list"))
+        else if (fid == DG_FIELD_NEXT_IN_LIST)
         {
           if (o->next_content)
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(o->next_content));
@@ -1875,7 +1950,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'o':
-        if (!str_cmp(field, "oset"))
+        if (fid == DG_FIELD_OSET)
         {
           if (subfield && *subfield)
           {
@@ -1887,7 +1962,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 'r':
-        if (!str_cmp(field, "room"))
+        if (fid == DG_FIELD_ROOM)
         {
           if (obj_room(o) != NOWHERE)
             snprintf(str, slen, "%c%ld", UID_CHAR, (long)world[obj_room(o)].number + ROOM_ID_BASE);
@@ -1896,18 +1971,18 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         }
         break;
       case 's':
-        if (!str_cmp(field, "shortdesc"))
+        if (fid == DG_FIELD_SHORTDESC)
           snprintf(str, slen, "%s", o->short_description);
         break;
       case 't':
-        if (!str_cmp(field, "type"))
+        if (fid == DG_FIELD_TYPE)
           sprinttype(GET_OBJ_TYPE(o), item_types, str, slen);
 
-        else if (!str_cmp(field, "timer"))
+        else if (fid == DG_FIELD_TIMER)
           snprintf(str, slen, "%d", GET_OBJ_TIMER(o));
         break;
       case 'v':
-        if (!str_cmp(field, "vnum"))
+        if (fid == DG_FIELD_VNUM)
           if (subfield && *subfield)
           {
             snprintf(str, slen, "%d", (int)(GET_OBJ_VNUM(o) == atoi(subfield)));
@@ -1916,20 +1991,20 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           {
             snprintf(str, slen, "%d", GET_OBJ_VNUM(o));
           }
-        else if (!str_cmp(field, "val0"))
+        else if (fid == DG_FIELD_VAL0)
           snprintf(str, slen, "%d", GET_OBJ_VAL(o, 0));
 
-        else if (!str_cmp(field, "val1"))
+        else if (fid == DG_FIELD_VAL1)
           snprintf(str, slen, "%d", GET_OBJ_VAL(o, 1));
 
-        else if (!str_cmp(field, "val2"))
+        else if (fid == DG_FIELD_VAL2)
           snprintf(str, slen, "%d", GET_OBJ_VAL(o, 2));
 
-        else if (!str_cmp(field, "val3"))
+        else if (fid == DG_FIELD_VAL3)
           snprintf(str, slen, "%d", GET_OBJ_VAL(o, 3));
         break;
       case 'w':
-        if (!str_cmp(field, "wearflag"))
+        if (fid == DG_FIELD_WEARFLAG)
         {
           if (subfield && *subfield)
           {
@@ -1941,7 +2016,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           else
             snprintf(str, slen, "0");
         }
-        else if (!str_cmp(field, "weight"))
+        else if (fid == DG_FIELD_WEIGHT)
         {
           if (subfield && *subfield)
           {
@@ -1950,7 +2025,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
           snprintf(str, slen, "%d", GET_OBJ_WEIGHT(o));
         }
-        else if (!str_cmp(field, "worn_by"))
+        else if (fid == DG_FIELD_WORN_BY)
         {
           if (o->worn_by)
             snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(o->worn_by));
@@ -2008,13 +2083,13 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
             *str = '\0';
         }
       }
-      else if (!str_cmp(field, "name"))
+      else if (fid == DG_FIELD_NAME)
         snprintf(str, slen, "%s", r->name);
 
-      else if (!str_cmp(field, "sector"))
+      else if (fid == DG_FIELD_SECTOR)
         sprinttype(r->sector_type, sector_types, str, slen);
 
-      else if (!str_cmp(field, "vnum"))
+      else if (fid == DG_FIELD_VNUM)
       {
         if (subfield && *subfield)
         {
@@ -2025,7 +2100,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           snprintf(str, slen, "%d", r->number);
         }
       }
-      else if (!str_cmp(field, "contents"))
+      else if (fid == DG_FIELD_CONTENTS)
       {
         if (subfield && *subfield)
         {
@@ -2053,14 +2128,14 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           }
         }
       }
-      else if (!str_cmp(field, "people"))
+      else if (fid == DG_FIELD_PEOPLE)
       {
         if (r->people)
           snprintf(str, slen, "%c%ld", UID_CHAR, GET_ID(r->people));
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "id"))
+      else if (fid == DG_FIELD_ID)
       {
         room_rnum rnum = real_room(r->number);
         if (rnum != NOWHERE)
@@ -2068,7 +2143,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "weather"))
+      else if (fid == DG_FIELD_WEATHER)
       {
         const char *sky_look[] = {
             "sunny",
@@ -2083,7 +2158,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "hasattached"))
+      else if (fid == DG_FIELD_HASATTACHED)
       {
         if (!(subfield && *subfield))
           *str = '\0';
@@ -2093,11 +2168,11 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
           snprintf(str, slen, "%d", trig_is_attached(SCRIPT(r), i));
         }
       }
-      else if (!str_cmp(field, "zonenumber"))
+      else if (fid == DG_FIELD_ZONENUMBER)
         snprintf(str, slen, "%d", zone_table[r->zone].number);
-      else if (!str_cmp(field, "zonename"))
+      else if (fid == DG_FIELD_ZONENAME)
         snprintf(str, slen, "%s", zone_table[r->zone].name);
-      else if (!str_cmp(field, "roomflag"))
+      else if (fid == DG_FIELD_ROOMFLAG)
       {
         if (subfield && *subfield)
         {
@@ -2110,7 +2185,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           snprintf(str, slen, "0");
       }
-      else if (!str_cmp(field, "north"))
+      else if (fid == DG_FIELD_NORTH)
       {
         if (R_EXIT(r, NORTH))
         {
@@ -2136,7 +2211,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "east"))
+      else if (fid == DG_FIELD_EAST)
       {
         if (R_EXIT(r, EAST))
         {
@@ -2162,7 +2237,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "south"))
+      else if (fid == DG_FIELD_SOUTH)
       {
         if (R_EXIT(r, SOUTH))
         {
@@ -2188,7 +2263,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "west"))
+      else if (fid == DG_FIELD_WEST)
       {
         if (R_EXIT(r, WEST))
         {
@@ -2214,7 +2289,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "up"))
+      else if (fid == DG_FIELD_UP)
       {
         if (R_EXIT(r, UP))
         {
@@ -2240,7 +2315,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "down"))
+      else if (fid == DG_FIELD_DOWN)
       {
         if (R_EXIT(r, DOWN))
         {
@@ -2266,7 +2341,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "xcoord"))
+      else if (fid == DG_FIELD_XCOORD)
       {
         room_rnum rnum = real_room(r->number);
         if (rnum != NOWHERE)
@@ -2274,7 +2349,7 @@ void find_replacement(void *go, struct script_data *sc, trig_data *trig,
         else
           *str = '\0';
       }
-      else if (!str_cmp(field, "ycoord"))
+      else if (fid == DG_FIELD_YCOORD)
       {
         room_rnum rnum = real_room(r->number);
         if (rnum != NOWHERE)
@@ -20,6 +20,7 @@
 #include "constants.h"
 #include "genzon.h" /* for zone_rnum real_zone_by_thing */
 #include "fight.h"  /* for die() */
+#include "graph.h"  /* for world_topology_changed() */
 
 /* Local functions, macros, defines and structs */
 
@@ -295,6 +296,8 @@ WCMD(do_wdoor)
       break;
     }
   }
+
+  world_topology_changed();
 }
 
 WCMD(do_wteleport)
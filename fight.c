@@ -1103,7 +1103,7 @@ bool set_fighting(struct char_data *ch, struct char_data *vict)
     FIRING(ch) = TRUE;
 
   /* start the combat loop, making sure we begin with phase "1" */
-  attach_mud_event(new_mud_event(eCOMBAT_ROUND, ch, strdup("1")), delay);
+  attach_mud_event(new_mud_event_var(eCOMBAT_ROUND, ch, 1), delay);
 
   return TRUE;
 }
@@ -4670,22 +4670,14 @@ int compute_hit_damage(struct char_data *ch, struct char_data *victim,
         struct mud_event_data *pMudEvent = NULL;
         struct affected_type af;
 
-        /* has event?  then we increment the events svariable */
+        /* has event?  then we increment the events counter */
         if ((pMudEvent = char_has_mud_event(victim, eCRIPPLING_CRITICAL)))
         {
-          int crippling_critical_var = 0;
-          char buf[10] = {'\0'};
-
-          crippling_critical_var = atoi((char *)pMudEvent->sVariables);
-          crippling_critical_var++;
-          snprintf(buf, sizeof(buf), "%d", crippling_critical_var);
-          if (pMudEvent->sVariables) /* need to free memory if we changing it */
-            free(pMudEvent->sVariables);
-          pMudEvent->sVariables = strdup(buf);
+          pMudEvent->iVars[0]++;
         }
         else
         { /* no event, so make one */
-          pMudEvent = new_mud_event(eCRIPPLING_CRITICAL, victim, strdup("1"));
+          pMudEvent = new_mud_event_var(eCRIPPLING_CRITICAL, victim, 1);
           /* create and attach new event, apply the first effect */
           attach_mud_event(pMudEvent, 60 * PASSES_PER_SEC);
         }
@@ -4698,7 +4690,7 @@ int compute_hit_damage(struct char_data *ch, struct char_data *victim,
           act("\tRYou strike $N with a crippling critical!\tn", FALSE, ch, NULL, victim, TO_CHAR);
           act("\tr$n strikes you with a crippling critical!\tn", FALSE, ch, NULL, victim, TO_VICT);
           act("\tr$n strikes $N with a crippling critical!\tn", FALSE, ch, NULL, victim, TO_NOTVICT);
-          switch (atoi((char *)pMudEvent->sVariables))
+          switch (pMudEvent->iVars[0])
           {
           case 1: /* 1d4 strength damage */
             new_affect(&af);
@@ -8287,11 +8279,10 @@ EVENTFUNC(event_combat_round)
   /* action queue system */
   execute_next_action(ch);
   /* execute phase */
-  perform_violence(ch, (pMudEvent->sVariables != NULL && is_number(pMudEvent->sVariables) ? atoi(pMudEvent->sVariables) : 0));
+  perform_violence(ch, pMudEvent->iVars[0]);
 
   /* set the next phase */
-  if (pMudEvent->sVariables != NULL)
-    sprintf(pMudEvent->sVariables, "%d", (atoi(pMudEvent->sVariables) < 3 ? atoi(pMudEvent->sVariables) + 1 : 1));
+  pMudEvent->iVars[0] = (pMudEvent->iVars[0] < 3 ? pMudEvent->iVars[0] + 1 : 1);
 
   return 2 RL_SEC; /* 6 second rounds, hack! */
 }
@@ -0,0 +1,442 @@
+/* *************************************************************************
+ *   File: file_worker.c                               Part of LuminariMUD *
+ *  Usage: Background writer for player files, written atomically.         *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "file_worker.h"
+
+#include <pthread.h>
+#include <signal.h>
+
+/*
+ * A job is the whole text of a file, built with stdio on a memory stream.
+ * The writer thread never touches game data: it only writes the text to
+ * <path>.tmp, syncs it and renames it over <path>.  Finished jobs go back on
+ * a done list, and file_worker_process() logs their errors and frees them
+ * on the game thread.
+ */
+
+struct file_job
+{
+  char *path;
+  FILE *fp; /* until the job is queued */
+  char *text;
+  size_t len;
+
+  const char *failed; /* the step that failed, NULL if it was written */
+  int error;
+
+  struct timeval started;
+  struct timeval queued;
+  struct timeval finished;
+  long run_usec;
+
+  struct file_job *next;
+};
+
+/* Everything up to "worker" is shared with the writer thread and only
+ * touched with the lock held. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;  /* jobs queued */
+static pthread_cond_t space_cond = PTHREAD_COND_INITIALIZER; /* queue not full */
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;  /* a job finished */
+
+static struct file_job *pending = NULL, *pending_tail = NULL;
+static int num_pending = 0;
+static struct file_job *running = NULL;
+static bool stopping = FALSE;
+static struct file_job *done = NULL, *done_tail = NULL;
+
+static pthread_t worker;
+static bool worker_running = FALSE;
+
+/* Game thread only. */
+static unsigned long builds = 0;
+static unsigned long jobs = 0;
+static unsigned long errors = 0;
+static unsigned long coalesced = 0;
+static unsigned long stalls = 0;
+static unsigned long waits = 0;
+static int max_pending = 0;
+static double total_kbytes = 0.0;
+static double build_msec = 0.0, max_build_msec = 0.0;
+static double run_msec = 0.0, max_run_msec = 0.0;
+static double total_msec = 0.0;
+
+static long usec_between(struct timeval *from, struct timeval *to)
+{
+  return (to->tv_sec - from->tv_sec) * 1000000L + (to->tv_usec - from->tv_usec);
+}
+
+struct file_job *file_job_new(const char *path)
+{
+  struct file_job *job;
+
+  CREATE(job, struct file_job, 1);
+
+  if (!(job->fp = open_memstream(&job->text, &job->len)))
+  {
+    log("SYSERR: Unable to build %s in memory: %s", path, strerror(errno));
+    free(job);
+    return (NULL);
+  }
+
+  job->path = strdup(path);
+  gettimeofday(&job->started, NULL);
+
+  return (job);
+}
+
+FILE *file_job_fp(struct file_job *job)
+{
+  return (job->fp);
+}
+
+static void free_job(struct file_job *job)
+{
+  if (job->fp)
+    fclose(job->fp);
+  if (job->text)
+    free(job->text);
+  free(job->path);
+  free(job);
+}
+
+void file_job_cancel(struct file_job *job)
+{
+  free_job(job);
+}
+
+/* Runs on whichever thread writes the file, so no logging here. */
+static void run_job(struct file_job *job)
+{
+  char tmp[PATH_MAX];
+  struct timeval start;
+  FILE *fl;
+
+  gettimeofday(&start, NULL);
+  snprintf(tmp, sizeof(tmp), "%s.tmp", job->path);
+
+  if (!(fl = fopen(tmp, "w")))
+  {
+    job->failed = "open";
+    job->error = errno;
+  }
+  else
+  {
+    if (fwrite(job->text, 1, job->len, fl) != job->len || fflush(fl))
+      job->failed = "write";
+    else if (fsync(fileno(fl)))
+      job->failed = "sync";
+    if (job->failed)
+      job->error = errno;
+
+    if (fclose(fl) && !job->failed)
+    {
+      job->failed = "close";
+      job->error = errno;
+    }
+
+    if (!job->failed && rename(tmp, job->path))
+    {
+      job->failed = "rename";
+      job->error = errno;
+    }
+
+    if (job->failed)
+      unlink(tmp);
+  }
+
+  gettimeofday(&job->finished, NULL);
+  job->run_usec = usec_between(&start, &job->finished);
+}
+
+static void finish_job(struct file_job *job)
+{
+  double msec;
+
+  jobs++;
+  total_kbytes += job->len / 1024.0;
+
+  msec = job->run_usec / 1000.0;
+  run_msec += msec;
+  if (msec > max_run_msec)
+    max_run_msec = msec;
+
+  total_msec += usec_between(&job->queued, &job->finished) / 1000.0;
+
+  if (job->failed)
+  {
+    errors++;
+    log("SYSERR: Couldn't write %s (%s): %s", job->path, job->failed, strerror(job->error));
+  }
+
+  free_job(job);
+}
+
+static void *worker_loop(void *arg)
+{
+  struct file_job *job;
+
+  pthread_mutex_lock(&lock);
+  for (;;)
+  {
+    while (!pending && !stopping)
+      pthread_cond_wait(&work_cond, &lock);
+
+    if (!pending)
+      break;
+
+    job = pending;
+    if (!(pending = job->next))
+      pending_tail = NULL;
+    job->next = NULL;
+    num_pending--;
+    running = job;
+    pthread_cond_signal(&space_cond);
+    pthread_mutex_unlock(&lock);
+
+    run_job(job);
+
+    pthread_mutex_lock(&lock);
+    if (done_tail)
+      done_tail->next = job;
+    else
+      done = job;
+    done_tail = job;
+    running = NULL;
+
+    pthread_cond_broadcast(&idle_cond);
+  }
+  pthread_mutex_unlock(&lock);
+
+  return (NULL);
+}
+
+void file_job_write(struct file_job *job)
+{
+  struct file_job *j, *prev = NULL, *dropped = NULL;
+  double msec;
+  int failed;
+
+  /* a file cut short by a failed fprintf must not replace the good one */
+  failed = ferror(job->fp);
+  if (fclose(job->fp))
+    failed = 1;
+  job->fp = NULL;
+
+  if (failed)
+  {
+    errors++;
+    log("SYSERR: Couldn't build %s in memory, keeping the old file.", job->path);
+    free_job(job);
+    return;
+  }
+
+  gettimeofday(&job->queued, NULL);
+  msec = usec_between(&job->started, &job->queued) / 1000.0;
+  builds++;
+  build_msec += msec;
+  if (msec > max_build_msec)
+    max_build_msec = msec;
+
+  if (!worker_running)
+  {
+    run_job(job);
+    finish_job(job);
+    return;
+  }
+
+  pthread_mutex_lock(&lock);
+
+  /* a newer write of the same file saves the same thing */
+  for (j = pending; j; j = (prev ? prev->next : pending))
+  {
+    if (strcmp(j->path, job->path))
+    {
+      prev = j;
+      continue;
+    }
+
+    if (prev)
+      prev->next = j->next;
+    else
+      pending = j->next;
+    if (pending_tail == j)
+      pending_tail = prev;
+    num_pending--;
+
+    j->next = dropped;
+    dropped = j;
+  }
+
+  while (num_pending >= FILE_QUEUE_MAX)
+  {
+    stalls++;
+    pthread_cond_wait(&space_cond, &lock);
+  }
+
+  if (pending_tail)
+    pending_tail->next = job;
+  else
+    pending = job;
+  pending_tail = job;
+  num_pending++;
+  max_pending = MAX(max_pending, num_pending);
+
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&lock);
+
+  for (; dropped; dropped = j)
+  {
+    j = dropped->next;
+    free_job(dropped);
+    coalesced++;
+  }
+}
+
+void file_worker_process(void)
+{
+  struct file_job *job, *next_job;
+
+  if (!worker_running && !done)
+    return;
+
+  pthread_mutex_lock(&lock);
+  job = done;
+  done = done_tail = NULL;
+  pthread_mutex_unlock(&lock);
+
+  for (; job; job = next_job)
+  {
+    next_job = job->next;
+    finish_job(job);
+  }
+}
+
+void file_worker_flush(void)
+{
+  if (worker_running)
+  {
+    pthread_mutex_lock(&lock);
+    while (pending || running)
+      pthread_cond_wait(&idle_cond, &lock);
+    pthread_mutex_unlock(&lock);
+  }
+
+  file_worker_process();
+}
+
+/* With the lock held. */
+static bool path_queued(const char *path)
+{
+  struct file_job *job;
+
+  if (running && !strcmp(running->path, path))
+    return (TRUE);
+
+  for (job = pending; job; job = job->next)
+    if (!strcmp(job->path, path))
+      return (TRUE);
+
+  return (FALSE);
+}
+
+void file_worker_wait(const char *path)
+{
+  if (!worker_running)
+    return;
+
+  pthread_mutex_lock(&lock);
+  if (path_queued(path))
+  {
+    waits++;
+    do
+      pthread_cond_wait(&idle_cond, &lock);
+    while (path_queued(path));
+  }
+  pthread_mutex_unlock(&lock);
+}
+
+int file_worker_init(void)
+{
+  sigset_t all, old;
+  int err;
+
+  if (worker_running)
+    return (0);
+
+  /* signals are for the game thread, the writer inherits this mask */
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  stopping = FALSE;
+  err = pthread_create(&worker, NULL, worker_loop, NULL);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  if (err)
+  {
+    log("SYSERR: Unable to start file writer: %s", strerror(err));
+    return (-1);
+  }
+
+  worker_running = TRUE;
+  log("File writer started.");
+
+  return (0);
+}
+
+void file_worker_shutdown(void)
+{
+  if (!worker_running)
+    return;
+
+  pthread_mutex_lock(&lock);
+  stopping = TRUE;
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&lock);
+
+  pthread_join(worker, NULL);
+  worker_running = FALSE;
+
+  file_worker_process();
+}
+
+size_t file_worker_repr(char *out_buf, size_t n)
+{
+  int len, depth;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  pthread_mutex_lock(&lock);
+  depth = num_pending + (running ? 1 : 0);
+  pthread_mutex_unlock(&lock);
+
+  len = snprintf(out_buf, n,
+                 "File writer\r\n"
+                 "  Running    : %s\r\n"
+                 "  Queue depth: %d now, %d max, %d limit, %lu full waits, %lu waits to read\r\n"
+                 "  Files      : %lu written, %lu failed, %lu replaced while queued, avg %.1fKB\r\n"
+                 "  Game thread: avg %.3fms, max %.3fms to build a file\r\n"
+                 "  Writer     : avg %.2fms, max %.2fms to write and sync, avg %.2fms queued to done\r\n",
+                 (worker_running ? "yes" : "no, files are written on the game thread"),
+                 depth, max_pending, FILE_QUEUE_MAX, stalls, waits,
+                 jobs, errors, coalesced, (jobs ? total_kbytes / jobs : 0.0),
+                 (builds ? build_msec / builds : 0.0), max_build_msec,
+                 (jobs ? run_msec / jobs : 0.0), max_run_msec,
+                 (jobs ? total_msec / jobs : 0.0));
+
+  if (len < 0)
+  {
+    out_buf[0] = '\0';
+    return 0;
+  }
+
+  return MIN(len, (int)n - 1);
+}
@@ -0,0 +1,51 @@
+/* *************************************************************************
+ *   File: file_worker.h                               Part of LuminariMUD *
+ *  Usage: Header file for the background player file writer.              *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FILE_WORKER_H
+#define FILE_WORKER_H
+
+/* Player, rent and index files are built in memory on the game thread and
+ * handed to a writer thread, which writes each one to a temporary file,
+ * syncs it and renames it over the old one.  A crash or a full disk leaves
+ * the last good file in place, never half of a new one.
+ *
+ *   if (!(job = file_job_new(filename)))
+ *     return;
+ *   fprintf(file_job_fp(job), "Name: %s\n", GET_NAME(ch));
+ *   file_job_write(job);
+ *
+ * file_job_cancel() drops a job instead, leaving the file as it was.  A
+ * write replaces any write to the same file that is still queued, since the
+ * newer one saves the same thing.  Before reading, renaming or removing a
+ * file that may have a write queued, call file_worker_wait() on it.
+ *
+ * If the writer is not running every file is written right away, in the
+ * same way, on the game thread. */
+
+/* Most files waiting for the writer before file_job_write() has to wait. */
+#define FILE_QUEUE_MAX 1024
+
+struct file_job;
+
+int file_worker_init(void);
+/* Writes everything still queued, then stops the writer. */
+void file_worker_shutdown(void);
+/* Log the failures of finished writes and count them, once a pulse. */
+void file_worker_process(void);
+/* Wait until everything queued so far is written. */
+void file_worker_flush(void);
+/* Wait until no write to path is queued or running. */
+void file_worker_wait(const char *path);
+
+struct file_job *file_job_new(const char *path);
+FILE *file_job_fp(struct file_job *job);
+void file_job_write(struct file_job *job);
+void file_job_cancel(struct file_job *job);
+
+size_t file_worker_repr(char *out_buf, size_t n);
+
+#endif /* FILE_WORKER_H */
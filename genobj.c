@@ -76,6 +76,8 @@ static int update_all_objects(struct obj_data *refobj)
     obj->next_content = swap.next_content;
     obj->next = swap.next;
     obj->sitting_here = swap.sitting_here;
+    /* the live script is registered for this object, oedit replaces it */
+    obj->script = swap.script;
   }
 
   return count;
@@ -19,6 +19,7 @@
 #include "dg_olc.h"
 #include "mud_event.h"
 #include "wilderness.h"
+#include "graph.h"
 
 /* This function will copy the strings so be sure you free your own copies of 
  * the description, title, and such. */
@@ -41,6 +42,7 @@ room_rnum add_room(struct room_data *room)
     copy_room(&world[i], room);
     world[i].people = tch;
     world[i].contents = tobj;
+    world_topology_changed();
     add_to_save_list(zone_table[room->zone].number, SL_WLD);
     log("GenOLC: add_room: Updated existing room #%d.", room->number);
     return i;
@@ -129,6 +131,8 @@ room_rnum add_room(struct room_data *room)
         W_EXIT(i, j)->to_room += (W_EXIT(i, j)->to_room >= found);
   } while (i > 0);
 
+  world_topology_changed();
+
   add_to_save_list(zone_table[room->zone].number, SL_WLD);
 
   /* Return what array entry we placed the new room in. */
@@ -294,6 +298,8 @@ int delete_room(room_rnum rnum)
   /* Rebuild the wilderness index. */
   initialize_wilderness_lists();
 
+  world_topology_changed();
+
   return TRUE;
 }
 
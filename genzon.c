@@ -227,6 +227,7 @@ zone_rnum create_new_zone(zone_vnum vzone_num, room_vnum bottom, room_vnum top,
   zone->min_level = -1;
   zone->max_level = -1;
   zone->show_weather = 1;
+  zone->occupants = 0;
 
   for (i = 0; i < ZN_ARRAY_MAX; i++)
     zone->zone_flags[i] = 0;
@@ -237,6 +238,9 @@ zone_rnum create_new_zone(zone_vnum vzone_num, room_vnum bottom, room_vnum top,
 
   top_of_zone_table++;
 
+  /* Zones above the new one moved up a slot, recount who is where. */
+  reset_zone_occupancy();
+
   add_to_save_list(zone->number, SL_ZON);
   return rznum;
 }
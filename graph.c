@@ -28,81 +28,292 @@
 
 /* local functions */
 static int VALID_EDGE(room_rnum x, int y);
-static void bfs_enqueue(room_rnum room, int dir);
-static void bfs_dequeue(void);
-static void bfs_clear_queue(void);
-struct bfs_queue_struct
-{
-  room_rnum room;
-  char dir;
-  struct bfs_queue_struct *next;
-};
-
-/* had to rename queue_head because it already exists in dg_event.h */
-static struct bfs_queue_struct *queue_head_2 = 0, *queue_tail = 0;
+static void bfs_setup(void);
+static void bfs_build_reverse(void);
+static unsigned int bfs_new_generation(void);
+static int bfs_forward(room_rnum src, room_rnum target);
+static int bfs_bidirectional(room_rnum src, room_rnum target);
+static int cached_first_step(room_rnum src, room_rnum target, bool bidir);
 
 /* Utility macros */
-#define MARK(room) (SET_BIT_AR(ROOM_FLAGS(room), ROOM_BFS_MARK))
-#define UNMARK(room) (REMOVE_BIT_AR(ROOM_FLAGS(room), ROOM_BFS_MARK))
-#define IS_MARKED(room) (ROOM_FLAGGED(room, ROOM_BFS_MARK))
 #define TOROOM(x, y) (world[(x)].dir_option[(y)]->to_room)
 #define IS_CLOSED(x, y) (EXIT_FLAGGED(world[(x)].dir_option[(y)], EX_CLOSED))
 
+/* The search engine keeps its state in arrays sized to the world, allocated
+ * once and reused.  Instead of setting and clearing ROOM_BFS_MARK on every
+ * room, a room has been visited in this search if its stamp equals the
+ * current generation.  Every room is queued at most once per search, so a
+ * queue the size of the world never overflows. */
+static room_rnum bfs_rooms = 0;       /* number of rooms the arrays are sized for */
+static unsigned int bfs_generation = 0;
+static unsigned int *bfs_fwd_stamp = NULL; /* visited from the source */
+static unsigned int *bfs_bwd_stamp = NULL; /* visited from the target */
+static int *bfs_fwd_dist = NULL;
+static int *bfs_bwd_dist = NULL;
+static sbyte *bfs_first_dir = NULL; /* first step from the source to reach the room */
+static room_rnum *bfs_fwd_queue = NULL;
+static room_rnum *bfs_bwd_queue = NULL;
+
+/* Exits into each room, for searching backwards from the target:
+ * rev_from[rev_start[r] .. rev_start[r + 1] - 1] lead into room r. */
+static int *bfs_rev_start = NULL;
+static room_rnum *bfs_rev_from = NULL;
+static sbyte *bfs_rev_dir = NULL;
+static unsigned long bfs_rev_version = 0;
+
+/* Bumped whenever exits are added, removed or lead somewhere else, and (along
+ * with the door version) whenever doors open or close. */
+static unsigned long world_topology_version = 1;
+static unsigned long world_door_version = 1;
+
+/* Recent answers, only trusted for the pulse they were found in. */
+#define BFS_CACHE_SIZE 512
+
+struct bfs_cache_entry
+{
+  room_rnum src;
+  room_rnum target;
+  int dir;
+  unsigned long pulse;
+  unsigned long version; /* world_door_version when found */
+  bool through_doors;    /* CONFIG_TRACK_T_DOORS when found */
+};
+
+static struct bfs_cache_entry bfs_cache[BFS_CACHE_SIZE];
+
+/* an exit the search may take, regardless of whether the room it leads to was
+ * already visited */
 static int VALID_EDGE(room_rnum x, int y)
 {
-  if (world[x].dir_option[y] == NULL || TOROOM(x, y) == NOWHERE)
+  if (world[x].dir_option[y] == NULL || TOROOM(x, y) == NOWHERE || TOROOM(x, y) > top_of_world)
     return 0;
   if (CONFIG_TRACK_T_DOORS == FALSE && IS_CLOSED(x, y))
     return 0;
-  if (ROOM_FLAGGED(TOROOM(x, y), ROOM_NOTRACK) || IS_MARKED(TOROOM(x, y)))
+  if (ROOM_FLAGGED(TOROOM(x, y), ROOM_NOTRACK))
     return 0;
 
   return 1;
 }
 
-static void bfs_enqueue(room_rnum room, int dir)
+/* exits were added, removed or pointed somewhere else, or rooms were added
+ * or deleted */
+void world_topology_changed(void)
+{
+  world_topology_version++;
+  world_door_version++;
+}
+
+/* a door opened or closed, or was locked or unlocked */
+void world_doors_changed(void)
+{
+  world_door_version++;
+}
+
+/* (re)size the search arrays if the world grew or shrank */
+static void bfs_setup(void)
 {
-  struct bfs_queue_struct *curr;
+  if (bfs_rooms == top_of_world + 1)
+    return;
+
+  bfs_rooms = top_of_world + 1;
 
-  CREATE(curr, struct bfs_queue_struct, 1);
-  curr->room = room;
-  curr->dir = dir;
-  curr->next = 0;
+  RECREATE(bfs_fwd_stamp, unsigned int, bfs_rooms);
+  RECREATE(bfs_bwd_stamp, unsigned int, bfs_rooms);
+  RECREATE(bfs_fwd_dist, int, bfs_rooms);
+  RECREATE(bfs_bwd_dist, int, bfs_rooms);
+  RECREATE(bfs_first_dir, sbyte, bfs_rooms);
+  RECREATE(bfs_fwd_queue, room_rnum, bfs_rooms);
+  RECREATE(bfs_bwd_queue, room_rnum, bfs_rooms);
+  RECREATE(bfs_rev_start, int, bfs_rooms + 1);
 
-  if (queue_tail)
+  memset(bfs_fwd_stamp, 0, sizeof(unsigned int) * bfs_rooms);
+  memset(bfs_bwd_stamp, 0, sizeof(unsigned int) * bfs_rooms);
+  bfs_generation = 0;
+
+  /* rnums have moved, the reverse index and cached answers are stale */
+  world_topology_changed();
+}
+
+/* start a new search, clearing the stamps when the generation wraps */
+static unsigned int bfs_new_generation(void)
+{
+  if (++bfs_generation == 0)
   {
-    queue_tail->next = curr;
-    queue_tail = curr;
+    memset(bfs_fwd_stamp, 0, sizeof(unsigned int) * bfs_rooms);
+    memset(bfs_bwd_stamp, 0, sizeof(unsigned int) * bfs_rooms);
+    bfs_generation = 1;
   }
-  else
-    queue_head_2 = queue_tail = curr;
+
+  return bfs_generation;
 }
 
-static void bfs_dequeue(void)
+/* index every exit by the room it leads into */
+static void bfs_build_reverse(void)
 {
-  struct bfs_queue_struct *curr;
+  room_rnum r, to;
+  int dir, total = 0;
+
+  if (bfs_rev_version == world_topology_version)
+    return;
+
+  memset(bfs_rev_start, 0, sizeof(int) * (bfs_rooms + 1));
+
+  /* count the exits into each room, then turn the counts into offsets */
+  for (r = 0; r < bfs_rooms; r++)
+    for (dir = 0; dir < DIR_COUNT; dir++)
+      if (world[r].dir_option[dir] && (to = TOROOM(r, dir)) != NOWHERE && to < bfs_rooms)
+      {
+        bfs_rev_start[to + 1]++;
+        total++;
+      }
 
-  curr = queue_head_2;
+  for (r = 0; r < bfs_rooms; r++)
+    bfs_rev_start[r + 1] += bfs_rev_start[r];
 
-  if (!(queue_head_2 = queue_head_2->next))
-    queue_tail = 0;
-  free(curr);
+  RECREATE(bfs_rev_from, room_rnum, MAX(total, 1));
+  RECREATE(bfs_rev_dir, sbyte, MAX(total, 1));
+
+  /* fill them in, using the forward distance array as a cursor per room */
+  for (r = 0; r < bfs_rooms; r++)
+    bfs_fwd_dist[r] = bfs_rev_start[r];
+
+  for (r = 0; r < bfs_rooms; r++)
+    for (dir = 0; dir < DIR_COUNT; dir++)
+      if (world[r].dir_option[dir] && (to = TOROOM(r, dir)) != NOWHERE && to < bfs_rooms)
+      {
+        bfs_rev_from[bfs_fwd_dist[to]] = r;
+        bfs_rev_dir[bfs_fwd_dist[to]] = dir;
+        bfs_fwd_dist[to]++;
+      }
+
+  bfs_rev_version = world_topology_version;
 }
 
-static void bfs_clear_queue(void)
+/* classic breadth first search outwards from src */
+static int bfs_forward(room_rnum src, room_rnum target)
 {
-  while (queue_head_2)
-    bfs_dequeue();
+  unsigned int gen = bfs_new_generation();
+  int head = 0, tail = 0, dir;
+  room_rnum r, to;
+
+  bfs_fwd_stamp[src] = gen;
+  bfs_fwd_queue[tail++] = src;
+
+  while (head < tail)
+  {
+    r = bfs_fwd_queue[head++];
+
+    for (dir = 0; dir < DIR_COUNT; dir++)
+    {
+      if (!VALID_EDGE(r, dir) || bfs_fwd_stamp[(to = TOROOM(r, dir))] == gen)
+        continue;
+
+      bfs_fwd_stamp[to] = gen;
+      bfs_first_dir[to] = (r == src) ? dir : bfs_first_dir[r];
+
+      if (to == target)
+        return (bfs_first_dir[to]);
+
+      bfs_fwd_queue[tail++] = to;
+    }
+  }
+
+  return (BFS_NO_PATH);
 }
 
-/* find_first_step: given a source room and a target room, find the first step
- * on the shortest path from the source to the target. Intended usage: in
- * mobile_activity, give a mob a dir to go if they're tracking another mob or a
- * PC.  Or, a 'track' skill for PCs. */
-int find_first_step(room_rnum src, room_rnum target)
+/* Search from both ends at once, a level at a time from whichever side has
+ * the smaller frontier.  The first level in which the two searches meet holds
+ * a shortest path, the best meeting in that level is the answer. */
+static int bfs_bidirectional(room_rnum src, room_rnum target)
+{
+  unsigned int gen;
+  int fhead = 0, ftail = 0, bhead = 0, btail = 0, level_end, best, best_dir, dir, i;
+  room_rnum r, to, from;
+
+  /* every exit into the target is refused, same as in bfs_forward() */
+  if (ROOM_FLAGGED(target, ROOM_NOTRACK))
+    return (BFS_NO_PATH);
+
+  bfs_build_reverse();
+  gen = bfs_new_generation();
+
+  bfs_fwd_stamp[src] = gen;
+  bfs_fwd_dist[src] = 0;
+  bfs_fwd_queue[ftail++] = src;
+
+  bfs_bwd_stamp[target] = gen;
+  bfs_bwd_dist[target] = 0;
+  bfs_bwd_queue[btail++] = target;
+
+  while (fhead < ftail && bhead < btail)
+  {
+    best = INT_MAX;
+    best_dir = BFS_NO_PATH;
+
+    if (ftail - fhead <= btail - bhead)
+    {
+      for (level_end = ftail; fhead < level_end;)
+      {
+        r = bfs_fwd_queue[fhead++];
+
+        for (dir = 0; dir < DIR_COUNT; dir++)
+        {
+          if (!VALID_EDGE(r, dir) || bfs_fwd_stamp[(to = TOROOM(r, dir))] == gen)
+            continue;
+
+          bfs_fwd_stamp[to] = gen;
+          bfs_fwd_dist[to] = bfs_fwd_dist[r] + 1;
+          bfs_first_dir[to] = (r == src) ? dir : bfs_first_dir[r];
+          bfs_fwd_queue[ftail++] = to;
+
+          if (bfs_bwd_stamp[to] == gen && bfs_fwd_dist[to] + bfs_bwd_dist[to] < best)
+          {
+            best = bfs_fwd_dist[to] + bfs_bwd_dist[to];
+            best_dir = bfs_first_dir[to];
+          }
+        }
+      }
+    }
+    else
+    {
+      for (level_end = btail; bhead < level_end;)
+      {
+        to = bfs_bwd_queue[bhead++];
+
+        for (i = bfs_rev_start[to]; i < bfs_rev_start[to + 1]; i++)
+        {
+          from = bfs_rev_from[i];
+          dir = bfs_rev_dir[i];
+
+          /* exits rewired without world_topology_changed() leave the
+           * reverse index stale, so check the edge still leads here */
+          if (bfs_bwd_stamp[from] == gen || !VALID_EDGE(from, dir) ||
+              TOROOM(from, dir) != to)
+            continue;
+
+          bfs_bwd_stamp[from] = gen;
+          bfs_bwd_dist[from] = bfs_bwd_dist[to] + 1;
+          bfs_bwd_queue[btail++] = from;
+
+          if (bfs_fwd_stamp[from] == gen && bfs_fwd_dist[from] + bfs_bwd_dist[from] < best)
+          {
+            best = bfs_fwd_dist[from] + bfs_bwd_dist[from];
+            best_dir = (from == src) ? dir : bfs_first_dir[from];
+          }
+        }
+      }
+    }
+
+    if (best_dir != BFS_NO_PATH)
+      return (best_dir);
+  }
+
+  return (BFS_NO_PATH);
+}
+
+static int cached_first_step(room_rnum src, room_rnum target, bool bidir)
 {
-  int curr_dir;
-  room_rnum curr_room;
+  struct bfs_cache_entry *entry;
 
   if (src == NOWHERE || target == NOWHERE || src > top_of_world || target > top_of_world)
   {
@@ -119,42 +330,41 @@ int find_first_step(room_rnum src, room_rnum target)
   if (src == target)
     return (BFS_ALREADY_THERE);
 
-  /* clear marks first, some OLC systems will save the mark. */
-  for (curr_room = 0; curr_room <= top_of_world; curr_room++)
-    UNMARK(curr_room);
+  bfs_setup();
 
-  MARK(src);
+  /* Mobs hunting the same victim ask the same question many times a pulse.
+   * Doors toggled outside the usual commands are not reported, so answers
+   * never outlive the pulse they were found in. */
+  entry = &bfs_cache[((unsigned long)src * 2654435761u + (unsigned long)target) % BFS_CACHE_SIZE];
 
-  /* first, enqueue the first steps, saving which direction we're going. */
-  for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++)
-    if (VALID_EDGE(src, curr_dir))
-    {
-      MARK(TOROOM(src, curr_dir));
-      bfs_enqueue(TOROOM(src, curr_dir), curr_dir);
-    }
+  if (entry->src == src && entry->target == target && entry->pulse == pulse &&
+      entry->version == world_door_version && entry->through_doors == CONFIG_TRACK_T_DOORS)
+    return (entry->dir);
 
-  /* now, do the classic BFS. */
-  while (queue_head_2)
-  {
-    if (queue_head_2->room == target)
-    {
-      curr_dir = queue_head_2->dir;
-      bfs_clear_queue();
-      return (curr_dir);
-    }
-    else
-    {
-      for (curr_dir = 0; curr_dir < DIR_COUNT; curr_dir++)
-        if (VALID_EDGE(queue_head_2->room, curr_dir))
-        {
-          MARK(TOROOM(queue_head_2->room, curr_dir));
-          bfs_enqueue(TOROOM(queue_head_2->room, curr_dir), queue_head_2->dir);
-        }
-      bfs_dequeue();
-    }
-  }
+  entry->src = src;
+  entry->target = target;
+  entry->pulse = pulse;
+  entry->version = world_door_version;
+  entry->through_doors = CONFIG_TRACK_T_DOORS;
+  entry->dir = bidir ? bfs_bidirectional(src, target) : bfs_forward(src, target);
 
-  return (BFS_NO_PATH);
+  return (entry->dir);
+}
+
+/* find_first_step: given a source room and a target room, find the first step
+ * on the shortest path from the source to the target. Intended usage: in
+ * mobile_activity, give a mob a dir to go if they're tracking another mob or a
+ * PC.  Or, a 'track' skill for PCs. */
+int find_first_step(room_rnum src, room_rnum target)
+{
+  return (cached_first_step(src, target, FALSE));
+}
+
+/* Same answer as find_first_step(), searching from both ends.  Visits far
+ * fewer rooms when the two are a long way apart in a big zone. */
+int find_first_step_bidir(room_rnum src, room_rnum target)
+{
+  return (cached_first_step(src, target, TRUE));
 }
 
 /* Functions and Commands which use the above functions. */
@@ -260,7 +470,7 @@ ACMD(do_track)
   /* handle inside of a zone (stock) */
   else if (!ch_in_wild && !vict_in_wild)
   {
-    dir = find_first_step(IN_ROOM(ch), IN_ROOM(vict));
+    dir = find_first_step_bidir(IN_ROOM(ch), IN_ROOM(vict));
     switch (dir)
     {
     case BFS_ERROR:
@@ -21,5 +21,8 @@
 void hunt_victim(struct char_data *ch);
 void hunt_loadroom(struct char_data *ch);
 int find_first_step(room_rnum src, room_rnum target);
+int find_first_step_bidir(room_rnum src, room_rnum target);
+void world_topology_changed(void);
+void world_doors_changed(void);
 
 #endif /* _GRAPH_H_*/
@@ -1209,6 +1209,7 @@ void char_from_room(struct char_data *ch)
   REMOVE_FROM_LIST(ch, world[IN_ROOM(ch)].people, next_in_room);
   IN_ROOM(ch) = NOWHERE;
   ch->next_in_room = NULL;
+  update_zone_occupancy(ch);
 }
 
 /* place a char at the specified coord location in the wilderness specified. */
@@ -1274,7 +1275,7 @@ void char_to_room(struct char_data *ch, room_rnum room)
       if (real_room(world[room].number) != NOWHERE && IS_DYNAMIC(room))
       {
         //log("Setting occupied bit to room: %d", room); /* spams syslogs */
-        SET_BIT_AR(ROOM_FLAGS(room), ROOM_OCCUPIED);
+        occupy_wilderness_room(room);
         /* Create the event to clear the flag, if it is not already set. */
         if (!room_has_mud_event(&world[room], eCHECK_OCCUPIED))
           NEW_EVENT(eCHECK_OCCUPIED, &world[room].number, NULL, 10 RL_SEC);
@@ -1287,6 +1288,7 @@ void char_to_room(struct char_data *ch, room_rnum room)
     ch->next_in_room = world[room].people;
     world[room].people = ch;
     IN_ROOM(ch) = room;
+    update_zone_occupancy(ch);
 
     autoquest_trigger_check(ch, 0, 0, AQ_ROOM_FIND);
     autoquest_trigger_check(ch, 0, 0, AQ_MOB_FIND);
@@ -1304,8 +1306,8 @@ void char_to_room(struct char_data *ch, room_rnum room)
     /* falling */
     if (char_should_fall(ch, FALSE) && !char_has_mud_event(ch, eFALLING))
     {
-      /* the svariable value of 20 is just a rough number for feet */
-      attach_mud_event(new_mud_event(eFALLING, ch, "20"), 5);
+      /* the event variable value of 20 is just a rough number for feet */
+      attach_mud_event(new_mud_event_var(eFALLING, ch, 20), 5);
       send_to_char(ch, "Suddenly your realize you are falling!\r\n");
       act("$n has just realized $e has no visible means of support!",
           FALSE, ch, 0, 0, TO_ROOM);
@@ -28,6 +28,8 @@ void space_to_minus(char *str)
     *str = '-';
 }
 
+static void get_help_entry_keywords(struct help_entry_list *entries);
+
 /* Name: search_help
  * Author: Ornir (Jamie McLaughlin)
  * 
@@ -43,24 +45,30 @@ struct help_entry_list *search_help(const char *argument, int level)
 
   struct help_entry_list *help_entries = NULL, *new_help_entry = NULL, *cur = NULL;
 
-  char buf[1024], escaped_arg[MAX_STRING_LENGTH];
+  char *buf = NULL, escaped_arg[MAX_STRING_LENGTH];
+  size_t size = 0;
 
   /*  Check the connection, reconnect if necessary. */
   mysql_ping(conn);
 
   mysql_real_escape_string(conn, escaped_arg, argument, strlen(argument));
 
-  snprintf(buf, sizeof(buf), "SELECT distinct he.tag, he.entry, he.min_level, he.last_updated, group_concat(distinct CONCAT(UCASE(LEFT(hk2.keyword, 1)), LCASE(SUBSTRING(hk2.keyword, 2))) separator ', ')"
+  /* the query text around the search term is well under 512 */
+  size = strlen(escaped_arg) + 512;
+  CREATE(buf, char, size);
+  snprintf(buf, size, "SELECT distinct he.tag, he.entry, he.min_level, he.last_updated, group_concat(distinct CONCAT(UCASE(LEFT(hk2.keyword, 1)), LCASE(SUBSTRING(hk2.keyword, 2))) separator ', ')"
                " FROM `help_entries` he, `help_keywords` hk, `help_keywords` hk2"
                " WHERE he.tag = hk.help_tag and hk.help_tag = hk2.help_tag and lower(hk.keyword) like '%s%%' and he.min_level <= %d"
                " group by hk.help_tag ORDER BY length(hk.keyword) asc",
-          argument, level);
+          escaped_arg, level);
 
   if (mysql_query(conn, buf))
   {
     log("SYSERR: Unable to SELECT from help_entries: %s", mysql_error(conn));
+    free(buf);
     return NULL;
   }
+  free(buf);
 
   if (!(result = mysql_store_result(conn)))
   {
@@ -79,8 +87,6 @@ struct help_entry_list *search_help(const char *argument, int level)
     new_help_entry->last_updated = strdup(row[3]);
     new_help_entry->keywords = strdup(row[4]);
 
-    new_help_entry->keyword_list = get_help_keywords(new_help_entry->tag);
-
     if (help_entries == NULL)
     {
       help_entries = new_help_entry;
@@ -96,9 +102,83 @@ struct help_entry_list *search_help(const char *argument, int level)
 
   mysql_free_result(result);
 
+  get_help_entry_keywords(help_entries);
+
   return help_entries;
 }
 
+/* Fills in the keyword_list of every entry with one query, rather than a
+ * get_help_keywords() round trip per entry. */
+static void get_help_entry_keywords(struct help_entry_list *entries)
+{
+  MYSQL_RES *result;
+  MYSQL_ROW row;
+
+  struct help_entry_list *entry = NULL;
+  struct help_keyword_list *new_keyword = NULL, *cur = NULL;
+
+  char *buf = NULL;
+  size_t len = 0, size = 0;
+
+  if (entries == NULL)
+    return;
+
+  for (entry = entries; entry; entry = entry->next)
+    size += strlen(entry->tag) * 2 + 4;
+  size += 256;
+  CREATE(buf, char, size);
+
+  len = snprintf(buf, size, "select help_tag, CONCAT(UCASE(LEFT(keyword, 1)), LCASE(SUBSTRING(keyword, 2))) from help_keywords where help_tag in (");
+  for (entry = entries; entry; entry = entry->next)
+  {
+    buf[len++] = '\'';
+    len += mysql_real_escape_string(conn, buf + len, entry->tag, strlen(entry->tag));
+    buf[len++] = '\'';
+    buf[len++] = entry->next ? ',' : ')';
+  }
+  buf[len] = '\0';
+
+  if (mysql_query(conn, buf))
+  {
+    log("SYSERR: Unable to SELECT from help_keywords: %s", mysql_error(conn));
+    free(buf);
+    return;
+  }
+  free(buf);
+
+  if (!(result = mysql_store_result(conn)))
+  {
+    log("SYSERR: Unable to SELECT from help_keywords: %s", mysql_error(conn));
+    return;
+  }
+
+  while ((row = mysql_fetch_row(result)))
+  {
+    for (entry = entries; entry; entry = entry->next)
+      if (!strcmp(entry->tag, row[0]))
+        break;
+    if (entry == NULL)
+      continue;
+
+    CREATE(new_keyword, struct help_keyword_list, 1);
+    new_keyword->tag = strdup(row[0]);
+    new_keyword->keyword = strdup(row[1]);
+    new_keyword->next = NULL;
+
+    /* keep each entry's keywords in the order they came */
+    if (entry->keyword_list == NULL)
+      entry->keyword_list = new_keyword;
+    else
+    {
+      for (cur = entry->keyword_list; cur->next; cur = cur->next)
+        ;
+      cur->next = new_keyword;
+    }
+  }
+
+  mysql_free_result(result);
+}
+
 struct help_keyword_list *get_help_keywords(const char *tag)
 {
   MYSQL_RES *result;
@@ -151,14 +231,18 @@ struct help_keyword_list *soundex_search_help_keywords(const char *argument, int
 
   struct help_keyword_list *keywords = NULL, *new_keyword = NULL, *cur = NULL;
 
-  char buf[1024], escaped_arg[MAX_STRING_LENGTH];
+  char *buf = NULL, escaped_arg[MAX_STRING_LENGTH];
+  size_t size = 0;
 
   /*   Check the connection, reconnect if necessary. */
   mysql_ping(conn);
 
   mysql_real_escape_string(conn, escaped_arg, argument, strlen(argument));
 
-  snprintf(buf, sizeof(buf), "SELECT hk.help_tag, "
+  /* the query text around the search term is well under 512 */
+  size = strlen(escaped_arg) + 512;
+  CREATE(buf, char, size);
+  snprintf(buf, size, "SELECT hk.help_tag, "
                "       hk.keyword "
                "FROM help_entries he, "
                "     help_keywords hk "
@@ -166,13 +250,15 @@ struct help_keyword_list *soundex_search_help_keywords(const char *argument, int
                "  and hk.keyword sounds like '%s' "
                "  and he.min_level <= %d "
                "ORDER BY length(hk.keyword) asc",
-          argument, level);
+          escaped_arg, level);
 
   if (mysql_query(conn, buf))
   {
     log("SYSERR: Unable to SELECT from help_keywords: %s", mysql_error(conn));
+    free(buf);
     return NULL;
   }
+  free(buf);
 
   if (!(result = mysql_store_result(conn)))
   {
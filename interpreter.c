@@ -66,12 +66,13 @@
 
 /* local (file scope) functions */
 static int perform_dupe_check(struct descriptor_data *d);
-static struct alias_data *find_alias(struct alias_data *alias_list, char *str);
+static struct alias_data *find_alias(struct char_data *ch, const char *str);
 static void perform_complex_alias(struct txt_q *input_q, char *orig, struct alias_data *a);
 static int _parse_name(char *arg, char *name);
 static bool perform_new_char_dupe_check(struct descriptor_data *d);
 /* sort_commands utility */
 static int sort_commands_helper(const void *a, const void *b);
+static void index_commands(void);
 
 // external functions
 void load_char_pets(struct char_data *ch);
@@ -826,6 +827,8 @@ void sort_commands(void)
     num_of_cmds++;
   num_of_cmds++; /* \n */
 
+  if (cmd_sort_info)
+    free(cmd_sort_info);
   CREATE(cmd_sort_info, int, num_of_cmds);
 
   for (a = 0; a < num_of_cmds; a++)
@@ -833,6 +836,98 @@ void sort_commands(void)
 
   /* Don't sort the RESERVED or \n entries. */
   qsort(cmd_sort_info + 1, num_of_cmds - 2, sizeof(int), sort_commands_helper);
+
+  index_commands();
+}
+
+/* complete_cmd_info[] numbers sorted by command name (and number, for the
+ * same name), so every command an abbreviation can stand for sits in one
+ * run that a binary search finds. */
+static int *cmd_by_name = NULL;
+static int num_cmd_by_name = 0;
+
+static int cmd_by_name_helper(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b, c;
+
+  if ((c = strcmp(complete_cmd_info[x].command, complete_cmd_info[y].command)))
+    return (c);
+
+  return (x - y);
+}
+
+static void index_commands(void)
+{
+  free_command_index();
+
+  while (complete_cmd_info[num_cmd_by_name].command[0] != '\n')
+    num_cmd_by_name++;
+
+  CREATE(cmd_by_name, int, MAX(num_cmd_by_name, 1));
+  for (num_cmd_by_name = 0; complete_cmd_info[num_cmd_by_name].command[0] != '\n'; num_cmd_by_name++)
+    cmd_by_name[num_cmd_by_name] = num_cmd_by_name;
+
+  qsort(cmd_by_name, num_cmd_by_name, sizeof(int), cmd_by_name_helper);
+}
+
+/* Has to go whenever complete_cmd_info[] does. */
+void free_command_index(void)
+{
+  if (cmd_by_name)
+    free(cmd_by_name);
+  cmd_by_name = NULL;
+  num_cmd_by_name = 0;
+}
+
+/* The first place in cmd_by_name whose command does not sort before the
+ * first len characters of txt. */
+static int cmd_lower_bound(const char *txt, size_t len)
+{
+  int lo = 0, hi = num_cmd_by_name, mid;
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2;
+    if (strncmp(complete_cmd_info[cmd_by_name[mid]].command, txt, len) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return (lo);
+}
+
+/* What arg stands for, for someone of the given level: of the commands it
+ * abbreviates, the one that comes first in complete_cmd_info[], and only if
+ * there is no such command the first social.  -1 if nothing matches. */
+int find_command_abbrev(const char *arg, int level)
+{
+  size_t len = strlen(arg);
+  int i, cmd, best = -1, best_social = -1;
+
+  if (!cmd_by_name)
+    index_commands();
+
+  for (i = cmd_lower_bound(arg, len); i < num_cmd_by_name; i++)
+  {
+    cmd = cmd_by_name[i];
+
+    if (strncmp(complete_cmd_info[cmd].command, arg, len))
+      break;
+
+    if (level < complete_cmd_info[cmd].minimum_level)
+      continue;
+
+    if (complete_cmd_info[cmd].command_pointer == do_action)
+    {
+      if (best_social < 0 || cmd < best_social)
+        best_social = cmd;
+    }
+    else if (best < 0 || cmd < best)
+      best = cmd;
+  }
+
+  return (best >= 0 ? best : best_social);
 }
 
 /* This is the actual command interpreter called from game_loop() in comm.c
@@ -840,7 +935,7 @@ void sort_commands(void)
  * then calls the appropriate function. */
 void command_interpreter(struct char_data *ch, char *argument)
 {
-  int cmd = 0, length = 0;
+  int cmd = 0;
   char *line = NULL;
   char arg[MAX_INPUT_LENGTH] = {'\0'};
 
@@ -911,22 +1006,8 @@ void command_interpreter(struct char_data *ch, char *argument)
       return;
   }
 
-  for (length = strlen(arg), cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
-    if (complete_cmd_info[cmd].command_pointer != do_action &&
-        !strncmp(complete_cmd_info[cmd].command, arg, length))
-      if (GET_LEVEL(ch) >= complete_cmd_info[cmd].minimum_level)
-        break;
-
-  /* it's not a 'real' command, so it's a social */
-
-  if (*complete_cmd_info[cmd].command == '\n')
-    for (length = strlen(arg), cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
-      if (complete_cmd_info[cmd].command_pointer == do_action &&
-          !strncmp(complete_cmd_info[cmd].command, arg, length))
-        if (GET_LEVEL(ch) >= complete_cmd_info[cmd].minimum_level)
-          break;
-
-  if (*complete_cmd_info[cmd].command == '\n')
+  /* a 'real' command if there is one, else a social */
+  if ((cmd = find_command_abbrev(arg, GET_LEVEL(ch))) < 0)
   {
     int found = 0;
     send_to_char(ch, "Huh!?!\r\n");
@@ -1102,16 +1183,56 @@ void command_interpreter(struct char_data *ch, char *argument)
 }
 
 /* Routines to handle aliasing. */
-static struct alias_data *find_alias(struct alias_data *alias_list, char *str)
+
+/* Aliases are also hashed by name, so looking one up for every line a
+ * player types does not walk the whole list.  The hash is built when it is
+ * first needed, and thrown away with free_alias_index() whenever the list
+ * changes. */
+static unsigned int alias_hash(const char *str)
 {
-  while (alias_list != NULL)
-  {
-    if (*str == *alias_list->alias) /* hey, every little bit counts :-) */
-      if (!strcmp(str, alias_list->alias))
-        return (alias_list);
+  unsigned int h = 0;
+
+  while (*str)
+    h = h * 31 + (unsigned char)*str++;
+
+  return (h % ALIAS_HASH_SIZE);
+}
+
+static void index_aliases(struct char_data *ch)
+{
+  struct alias_data *a;
+  unsigned int h;
+
+  CREATE(GET_ALIAS_INDEX(ch), struct alias_data *, ALIAS_HASH_SIZE);
 
-    alias_list = alias_list->next;
+  for (a = GET_ALIASES(ch); a; a = a->next)
+  {
+    h = alias_hash(a->alias);
+    a->next_hash = GET_ALIAS_INDEX(ch)[h];
+    GET_ALIAS_INDEX(ch)[h] = a;
   }
+}
+
+void free_alias_index(struct char_data *ch)
+{
+  if (GET_ALIAS_INDEX(ch))
+    free(GET_ALIAS_INDEX(ch));
+  GET_ALIAS_INDEX(ch) = NULL;
+}
+
+static struct alias_data *find_alias(struct char_data *ch, const char *str)
+{
+  struct alias_data *a;
+
+  if (!GET_ALIASES(ch))
+    return (NULL);
+
+  if (!GET_ALIAS_INDEX(ch))
+    index_aliases(ch);
+
+  for (a = GET_ALIAS_INDEX(ch)[alias_hash(str)]; a; a = a->next_hash)
+    if (!strcmp(str, a->alias))
+      return (a);
 
   return (NULL);
 }
@@ -1154,9 +1275,10 @@ ACMDU(do_alias)
   else
   { /* otherwise, add or remove aliases */
     /* is this an alias we've already defined? */
-    if ((a = find_alias(GET_ALIASES(ch), arg)) != NULL)
+    if ((a = find_alias(ch, arg)) != NULL)
     {
       REMOVE_FROM_LIST(a, GET_ALIASES(ch), next);
+      free_alias_index(ch);
       free_alias(a);
     }
     /* if no replacement string is specified, assume we want to delete */
@@ -1184,6 +1306,7 @@ ACMDU(do_alias)
         a->type = ALIAS_SIMPLE;
       a->next = GET_ALIASES(ch);
       GET_ALIASES(ch) = a;
+      free_alias_index(ch);
       save_char(ch, 0);
       send_to_char(ch, "Alias ready.\r\n");
     }
@@ -1268,14 +1391,14 @@ static void perform_complex_alias(struct txt_q *input_q, char *orig, struct alia
 int perform_alias(struct descriptor_data *d, char *orig, size_t maxlen)
 {
   char first_arg[MAX_INPUT_LENGTH], *ptr;
-  struct alias_data *a, *tmp;
+  struct alias_data *a;
 
   /* Mobs don't have alaises. */
   if (IS_NPC(d->character))
     return (0);
 
   /* bail out immediately if the guy doesn't have any aliases */
-  if ((tmp = GET_ALIASES(d->character)) == NULL)
+  if (GET_ALIASES(d->character) == NULL)
     return (0);
 
   /* find the alias we're supposed to match */
@@ -1286,7 +1409,7 @@ int perform_alias(struct descriptor_data *d, char *orig, size_t maxlen)
     return (0);
 
   /* if the first arg is not an alias, return without doing anything */
-  if ((a = find_alias(tmp, first_arg)) == NULL)
+  if ((a = find_alias(d->character, first_arg)) == NULL)
     return (0);
 
   if (a->type == ALIAS_SIMPLE)
@@ -1414,11 +1537,15 @@ int is_abbrev(const char *arg1, const char *arg2)
 /* Used in specprocs, mostly.  (Exactly) matches "command" to cmd number */
 int find_command(const char *command)
 {
-  int cmd;
+  int i;
+
+  if (!cmd_by_name)
+    index_commands();
 
-  for (cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
-    if (!strcmp(complete_cmd_info[cmd].command, command))
-      return (cmd);
+  /* the lowest number comes first among equal names */
+  i = cmd_lower_bound(command, strlen(command) + 1);
+  if (i < num_cmd_by_name && !strcmp(complete_cmd_info[cmd_by_name[i]].command, command))
+    return (cmd_by_name[i]);
 
   return (-1);
 }
@@ -1520,7 +1647,10 @@ static int perform_dupe_check(struct descriptor_data *d)
         mode = UNSWITCH;
       }
       if (k->character)
+      {
         k->character->desc = NULL;
+        update_zone_occupancy(k->character);
+      }
       k->character = NULL;
       k->original = NULL;
     }
@@ -1542,6 +1672,7 @@ static int perform_dupe_check(struct descriptor_data *d)
         mode = USURP;
       }
       k->character->desc = NULL;
+      update_zone_occupancy(k->character);
       k->character = NULL;
       k->original = NULL;
       write_to_output(k, "\r\nMultiple login detected -- disconnecting.\r\n");
@@ -1610,6 +1741,7 @@ static int perform_dupe_check(struct descriptor_data *d)
   d->character = target;
   d->character->desc = d;
   d->original = NULL;
+  update_zone_occupancy(d->character);
   d->character->char_specials.timer = 0;
   REMOVE_BIT_AR(PLR_FLAGS(d->character), PLR_MAILING);
   REMOVE_BIT_AR(PLR_FLAGS(d->character), PLR_WRITING);
@@ -20,6 +20,8 @@
 #define IS_MOVE(cmdnum) (complete_cmd_info[cmdnum].command_pointer == do_move)
 
 void sort_commands(void);
+void free_command_index(void);
+int find_command_abbrev(const char *arg, int level);
 void command_interpreter(struct char_data *ch, char *argument);
 char *one_argument_u(char *argument, char *first_arg);
 const char *one_argument(const char *argument, char *first_arg, size_t n);
@@ -46,6 +48,7 @@ void skip_spaces_c(const char **string);
 char *delete_doubledollar(char *string);
 int special(struct char_data *ch, int cmd, char *arg);
 void free_alias(struct alias_data *a);
+void free_alias_index(struct char_data *ch);
 int perform_alias(struct descriptor_data *d, char *orig, size_t maxlen);
 int enter_player_game(struct descriptor_data *d);
 
@@ -96,8 +99,12 @@ struct alias_data
   char *replacement;
   int type;
   struct alias_data *next;
+  struct alias_data *next_hash; /* next in its GET_ALIAS_INDEX() bucket */
 };
 
+/* Buckets in a player's alias hash */
+#define ALIAS_HASH_SIZE 32
+
 #define ALIAS_SIMPLE 0
 #define ALIAS_COMPLEX 1
 
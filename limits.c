@@ -260,8 +260,8 @@ void hazard_tick(struct char_data *ch)
   /* falling */
   if (char_should_fall(ch, TRUE) && !char_has_mud_event(ch, eFALLING))
   {
-    /* the svariable value of 20 is just a rough number for feet */
-    attach_mud_event(new_mud_event(eFALLING, ch, "20"), 5);
+    /* the event variable value of 20 is just a rough number for feet */
+    attach_mud_event(new_mud_event_var(eFALLING, ch, 20), 5);
     send_to_char(ch, "Suddenly your realize you are falling!\r\n");
     act("$n has just realized $e has no visible means of support!",
         FALSE, ch, 0, 0, TO_ROOM);
@@ -1064,6 +1064,7 @@ void check_idling(struct char_data *ch)
          */
         ch->desc->character = NULL;
         ch->desc = NULL;
+        update_zone_occupancy(ch);
       }
       save_char_pets(ch);
       if (CONFIG_FREE_RENT)
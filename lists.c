@@ -11,6 +11,7 @@
 #include "utils.h"
 #include "db.h"
 #include "dg_event.h"
+#include "mem_pool.h"
 
 //static struct iterator_data Iterator;
 //static bool loop = FALSE;
@@ -20,6 +21,9 @@
 struct list_data *global_lists = NULL;
 struct list_data *group_list = NULL;
 
+/* List nodes come and go with every event and follower, so they are pooled. */
+static struct mem_pool item_pool = MEM_POOL_INIT("list item", struct item_data, 1024);
+
 struct list_data *create_list(void)
 {
   struct list_data *pNewList = NULL;
@@ -45,7 +49,7 @@ struct item_data *create_item(void)
 {
   struct item_data *pNewItem = NULL;
 
-  CREATE(pNewItem, struct item_data, 1);
+  pNewItem = (struct item_data *)mem_pool_alloc(&item_pool);
 
   pNewItem->pNextItem = NULL;
   pNewItem->pPrevItem = NULL;
@@ -150,7 +154,7 @@ void remove_from_list(void *pContent, struct list_data *pList)
     pList->pLastItem = NULL;
   }
 
-  free(pRemovedItem);
+  mem_pool_free(&item_pool, pRemovedItem);
 }
 
 /** Merges an iterator with a list
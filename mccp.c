@@ -0,0 +1,332 @@
+/* *************************************************************************
+ *   File: mccp.c                                      Part of LuminariMUD *
+ *  Usage: MCCP (mud client compression) version 2 output streams.         *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#include "protocol.h"
+#include "mem_pool.h"
+#include "mccp.h"
+
+#include <arpa/telnet.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <zlib.h>
+
+/*
+ * A deflate stream holds about 256k of zlib state, so streams of closed
+ * connections are reset and kept for the next client rather than set up
+ * from scratch each time.
+ */
+
+struct mccp_stream
+{
+  z_stream z;
+
+  /* compressed bytes not written yet are out[out_pos] to out[out_len] */
+  unsigned char *out;
+  size_t out_pos;
+  size_t out_len;
+  size_t out_size;
+
+  bool finished; /* Z_FINISH was sent, only the tail is left to write */
+
+  unsigned long bytes_in;
+  unsigned long bytes_out;
+  long usec;
+
+  struct mccp_stream *next_idle;
+};
+
+static struct mem_pool mccp_pool = MEM_POOL_INIT("mccp stream", struct mccp_stream, 4);
+static struct mccp_stream *idle_streams = NULL;
+static int num_idle = 0;
+static int num_active = 0;
+
+/* Totals of streams that have been released. */
+static unsigned long total_in = 0;
+static unsigned long total_out = 0;
+static long total_usec = 0;
+static unsigned long total_streams = 0;
+
+static struct mccp_stream *get_stream(void)
+{
+  struct mccp_stream *st;
+
+  if ((st = idle_streams))
+  {
+    idle_streams = st->next_idle;
+    st->next_idle = NULL;
+    num_idle--;
+  }
+  else
+  {
+    st = (struct mccp_stream *)mem_pool_alloc(&mccp_pool);
+    if (deflateInit(&st->z, Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+      log("SYSERR: mccp: deflateInit failed: %s", st->z.msg ? st->z.msg : "unknown error");
+      mem_pool_free(&mccp_pool, st);
+      return (NULL);
+    }
+  }
+
+  st->out_pos = st->out_len = 0;
+  st->finished = FALSE;
+  st->bytes_in = st->bytes_out = 0;
+  st->usec = 0;
+  num_active++;
+  total_streams++;
+
+  return (st);
+}
+
+static void release_stream(struct descriptor_data *d)
+{
+  struct mccp_stream *st = d->mccp;
+
+  d->mccp = NULL;
+  num_active--;
+
+  total_in += st->bytes_in;
+  total_out += st->bytes_out;
+  total_usec += st->usec;
+
+  if (num_idle < MCCP_IDLE_MAX && deflateReset(&st->z) == Z_OK)
+  {
+    st->next_idle = idle_streams;
+    idle_streams = st;
+    num_idle++;
+    return;
+  }
+
+  deflateEnd(&st->z);
+  if (st->out)
+    free(st->out);
+  mem_pool_free(&mccp_pool, st);
+}
+
+/* make room for at least need more bytes at the end of out */
+static void out_reserve(struct mccp_stream *st, size_t need)
+{
+  if (st->out_pos > 0)
+  {
+    memmove(st->out, st->out + st->out_pos, st->out_len - st->out_pos);
+    st->out_len -= st->out_pos;
+    st->out_pos = 0;
+  }
+
+  if (st->out_size - st->out_len < need)
+  {
+    st->out_size = MAX(st->out_len + need, MAX(4096, st->out_size * 2));
+    RECREATE(st->out, unsigned char, st->out_size);
+  }
+}
+
+static void compress_bytes(struct mccp_stream *st, const char *txt, size_t len, int flush)
+{
+  struct timeval start, end;
+  size_t before = st->out_len - st->out_pos;
+
+  gettimeofday(&start, NULL);
+
+  st->z.next_in = (Bytef *)txt;
+  st->z.avail_in = len;
+
+  /* Run deflate until it stops filling up the space we give it. */
+  do
+  {
+    out_reserve(st, deflateBound(&st->z, st->z.avail_in) + 16);
+    st->z.next_out = st->out + st->out_len;
+    st->z.avail_out = st->out_size - st->out_len;
+
+    deflate(&st->z, flush);
+
+    st->out_len = st->out_size - st->z.avail_out;
+  } while (st->z.avail_out == 0);
+
+  gettimeofday(&end, NULL);
+
+  st->bytes_in += len;
+  st->bytes_out += (st->out_len - st->out_pos) - before;
+  st->usec += (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+}
+
+int mccp_flush(struct descriptor_data *d)
+{
+  struct mccp_stream *st = d->mccp;
+  int n;
+
+  if (!st || st->out_pos == st->out_len)
+    return (0);
+
+  if ((n = write_bytes_to_descriptor(d->descriptor, (char *)st->out + st->out_pos, st->out_len - st->out_pos)) < 0)
+    return (-1);
+
+  st->out_pos += n;
+  if (st->out_pos == st->out_len)
+    st->out_pos = st->out_len = 0;
+
+  return (0);
+}
+
+size_t mccp_pending(struct descriptor_data *d)
+{
+  return (d->mccp ? d->mccp->out_len - d->mccp->out_pos : 0);
+}
+
+int mccp_start(struct descriptor_data *d)
+{
+  const char start[] = {(char)IAC, (char)SB, TELOPT_MCCP, (char)IAC, (char)SE};
+  struct mccp_stream *st;
+
+  if (d->mccp)
+    return (0);
+
+  if (!(st = get_stream()))
+    return (-1);
+
+  d->mccp = st;
+
+  /* The start sequence itself goes out plain, everything after it is
+   * compressed, including output that was already queued. */
+  out_reserve(st, sizeof(start));
+  memcpy(st->out + st->out_len, start, sizeof(start));
+  st->out_len += sizeof(start);
+
+  return (mccp_flush(d));
+}
+
+void mccp_end(struct descriptor_data *d)
+{
+  struct mccp_stream *st = d->mccp;
+  struct pollfd pfd;
+  int waited = 0;
+
+  if (!st)
+    return;
+
+  if (!st->finished)
+  {
+    compress_bytes(st, "", 0, Z_FINISH);
+    st->finished = TRUE;
+  }
+
+  /* Anything we send after this is plain text, so the end of the stream has
+   * to be out first.  This only happens when the client turns MCCP off or on
+   * copyover, so it is fine to wait a little. */
+  while (mccp_flush(d) == 0 && mccp_pending(d) && waited < MCCP_END_WAIT_MS)
+  {
+    pfd.fd = d->descriptor;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    poll(&pfd, 1, 10);
+    waited += 10;
+  }
+
+  release_stream(d);
+}
+
+void mccp_free(struct descriptor_data *d)
+{
+  if (d->mccp)
+    release_stream(d);
+}
+
+int mccp_write(struct descriptor_data *d, const char *txt, size_t len)
+{
+  struct iovec iov;
+
+  iov.iov_base = (void *)txt;
+  iov.iov_len = len;
+
+  return (mccp_writev(d, &iov, 1));
+}
+
+int mccp_writev(struct descriptor_data *d, const struct iovec *iov, int cnt)
+{
+  struct mccp_stream *st = d->mccp;
+  size_t total = 0;
+  int i;
+
+  if (mccp_flush(d) < 0)
+    return (-1);
+
+  /* Still backed up: leave the text with the caller, like a full socket. */
+  if (mccp_pending(d))
+    return (0);
+
+  for (i = 0; i < cnt; i++)
+    total += iov[i].iov_len;
+
+  if (total == 0)
+    return (0);
+
+  /* Only the last piece needs a flush, the client gets it all at once. */
+  for (i = 0; i < cnt; i++)
+    compress_bytes(st, (const char *)iov[i].iov_base, iov[i].iov_len,
+                   i == cnt - 1 ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+
+  if (mccp_flush(d) < 0)
+    return (-1);
+
+  return (total);
+}
+
+static double ratio(unsigned long in, unsigned long out)
+{
+  return (in ? 100.0 * out / in : 0.0);
+}
+
+size_t mccp_repr(char *out_buf, size_t n)
+{
+  struct descriptor_data *d;
+  struct mccp_stream *st;
+  unsigned long all_in = total_in, all_out = total_out;
+  long all_usec = total_usec;
+  size_t written = 0;
+  int len;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  for (d = descriptor_list; d; d = d->next)
+    if ((st = d->mccp))
+    {
+      all_in += st->bytes_in;
+      all_out += st->bytes_out;
+      all_usec += st->usec;
+    }
+
+  len = snprintf(out_buf, n,
+                 "MCCP compression\r\n"
+                 "  Streams  : %d active, %d idle, %lu started\r\n"
+                 "  All time : %lu KB in, %lu KB out (%.1f%%), %.1f ms CPU\r\n"
+                 "  %-20s %10s %10s %7s %9s\r\n",
+                 num_active, num_idle, total_streams,
+                 all_in / 1024, all_out / 1024, ratio(all_in, all_out), all_usec / 1000.0,
+                 "Connection", "In (KB)", "Out (KB)", "Out/In", "CPU (ms)");
+
+  for (d = descriptor_list; len >= 0 && d; d = d->next)
+  {
+    if (!(st = d->mccp))
+      continue;
+
+    written += MIN(len, (int)(n - written) - 1);
+    len = snprintf(out_buf + written, n - written,
+                   "  %-20s %10lu %10lu %6.1f%% %9.1f\r\n",
+                   (d->character ? GET_NAME(d->character) : d->host),
+                   st->bytes_in / 1024, st->bytes_out / 1024,
+                   ratio(st->bytes_in, st->bytes_out), st->usec / 1000.0);
+  }
+
+  if (len < 0)
+    return written;
+
+  return written + MIN(len, (int)(n - written) - 1);
+}
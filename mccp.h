@@ -0,0 +1,44 @@
+/* *************************************************************************
+ *   File: mccp.h                                      Part of LuminariMUD *
+ *  Usage: Header file for MCCP (mud client compression) output streams.   *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MCCP_H
+#define MCCP_H
+
+/* Once a client has agreed to MCCP version 2, everything we send it goes
+ * through a zlib stream of its own.  Each write is flushed on a byte
+ * boundary, so the client can show the text (and the prompt that ends it)
+ * right away.  Compressed bytes the socket would not take yet are kept on
+ * the stream and go out before anything else. */
+
+/* Deflate streams kept ready for the next connection to ask for MCCP. */
+#define MCCP_IDLE_MAX 16
+/* How long ending a stream may wait for the socket to take the rest. */
+#define MCCP_END_WAIT_MS 250
+
+struct mccp_stream;
+struct iovec;
+
+/* Start compressing, after sending the client the start sequence. */
+int mccp_start(struct descriptor_data *d);
+/* Finish the stream so the client goes back to plain text. */
+void mccp_end(struct descriptor_data *d);
+/* Drop the stream of a descriptor that is being closed. */
+void mccp_free(struct descriptor_data *d);
+
+/* Compress and send len bytes.  Returns len, 0 if the socket is still
+ * backed up from last time, or -1 on a fatal error. */
+int mccp_write(struct descriptor_data *d, const char *txt, size_t len);
+/* Like mccp_write(), for text in several pieces.  Returns the total. */
+int mccp_writev(struct descriptor_data *d, const struct iovec *iov, int cnt);
+/* Send what the socket did not take last time, -1 on a fatal error. */
+int mccp_flush(struct descriptor_data *d);
+/* Compressed bytes still waiting for the socket. */
+size_t mccp_pending(struct descriptor_data *d);
+
+size_t mccp_repr(char *out_buf, size_t n);
+
+#endif /* MCCP_H */
@@ -0,0 +1,122 @@
+/* *************************************************************************
+ *   File: mem_pool.c                                  Part of LuminariMUD *
+ *  Usage: Fixed-size object pools for short lived, high churn objects.    *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "mem_pool.h"
+
+/*
+ * Every mud event allocates an event, a mud_event_data, a queue element and a
+ * list node, and frees them all again when it fires.  Rather than going back to
+ * malloc each time we keep the freed objects on a per-type free list.
+ */
+
+static struct mem_pool *mem_pools = NULL;
+
+/* Objects are padded so that the slab stays pointer aligned and a free object
+ * can hold the free list link. */
+static size_t pool_obj_size(struct mem_pool *pool)
+{
+  size_t size = pool->size;
+
+  if (size < sizeof(void *))
+    size = sizeof(void *);
+
+  return (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+static void pool_grow(struct mem_pool *pool)
+{
+  size_t size = pool_obj_size(pool);
+  char *slab = NULL;
+  int i;
+
+  if (pool->per_slab < 1)
+    pool->per_slab = 1;
+
+  CREATE(slab, char, size * pool->per_slab);
+
+  /* Thread the new objects onto the free list, first object first out. */
+  for (i = pool->per_slab - 1; i >= 0; i--)
+  {
+    *(void **)(slab + i * size) = pool->free_list;
+    pool->free_list = slab + i * size;
+  }
+
+  pool->capacity += pool->per_slab;
+  pool->slabs++;
+
+  if (!pool->registered)
+  {
+    pool->registered = TRUE;
+    pool->next = mem_pools;
+    mem_pools = pool;
+  }
+}
+
+void *mem_pool_alloc(struct mem_pool *pool)
+{
+  void *ptr = NULL;
+
+  if (!pool->free_list)
+    pool_grow(pool);
+
+  ptr = pool->free_list;
+  pool->free_list = *(void **)ptr;
+
+  memset(ptr, 0, pool_obj_size(pool));
+
+  pool->allocs++;
+  if (++pool->in_use > pool->high_water)
+    pool->high_water = pool->in_use;
+
+  return ptr;
+}
+
+void mem_pool_free(struct mem_pool *pool, void *ptr)
+{
+  if (!ptr)
+    return;
+
+  *(void **)ptr = pool->free_list;
+  pool->free_list = ptr;
+  pool->in_use--;
+}
+
+size_t mem_pool_repr(char *out_buf, size_t n)
+{
+  struct mem_pool *pool;
+  size_t written = 0;
+  int len;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  out_buf[0] = '\0';
+
+  len = snprintf(out_buf, n,
+                 "Object pools\r\n"
+                 "  %-16s %8s %8s %8s %8s %12s\r\n",
+                 "Pool", "In use", "Peak", "Capacity", "KB", "Allocations");
+
+  for (pool = mem_pools; len >= 0 && pool; pool = pool->next)
+  {
+    written += MIN(len, (int)(n - written) - 1);
+    len = snprintf(out_buf + written, n - written,
+                   "  %-16s %8ld %8ld %8ld %8lu %12lu\r\n",
+                   pool->name, pool->in_use, pool->high_water, pool->capacity,
+                   (unsigned long)(pool->capacity * pool_obj_size(pool)) / 1024,
+                   pool->allocs);
+  }
+
+  if (len < 0)
+    return written;
+
+  return written + MIN(len, (int)(n - written) - 1);
+}
@@ -0,0 +1,41 @@
+/* *************************************************************************
+ *   File: mem_pool.h                                  Part of LuminariMUD *
+ *  Usage: Header file for the fixed-size object pools.                    *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+/* A pool hands out objects of one size from slabs of per_slab objects, freed
+ * objects go on a free list and are handed out again.  Slabs are never given
+ * back, so a pool stays at its high-water mark.  Pools are declared static
+ * with MEM_POOL_INIT() and show up in "perfmon pools" once first used. */
+struct mem_pool
+{
+  const char *name;
+  size_t size;
+  int per_slab;
+
+  void *free_list;
+  struct mem_pool *next; /* All pools that have been used. */
+  bool registered;
+
+  long in_use;
+  long high_water;
+  long capacity;
+  unsigned long allocs;
+  unsigned long slabs;
+};
+
+#define MEM_POOL_INIT(name, type, per_slab) \
+  {(name), sizeof(type), (per_slab), NULL, NULL, FALSE, 0, 0, 0, 0, 0}
+
+/* Get a zeroed object from the pool, like CREATE(ptr, type, 1). */
+void *mem_pool_alloc(struct mem_pool *pool);
+/* Give an object back to the pool it came from.  NULL is ignored. */
+void mem_pool_free(struct mem_pool *pool, void *ptr);
+size_t mem_pool_repr(char *out_buf, size_t n);
+
+#endif /* MEM_POOL_H */
@@ -20,10 +20,126 @@
 #include "quest.h"
 #include "mysql.h"
 #include "act.h"
+#include "mem_pool.h"
 
 /* Global List */
 struct list_data *world_events = NULL;
 
+/* Event data, and the private vnum copy room and region events point at. */
+static struct mem_pool mud_event_pool = MEM_POOL_INIT("mud_event_data", struct mud_event_data, 512);
+static struct mem_pool event_vnum_pool = MEM_POOL_INIT("event vnum", room_vnum, 256);
+
+/* The *_has_mud_event() checks are made all the time, for every mob on every
+ * pulse, so rather than walking an entity's event list we keep a hash of
+ * (event list, event id) -> event.  The list pointer identifies the entity
+ * and moves with it when rooms are copied around by OLC.  Entries with the
+ * same key are kept oldest first, like the list they mirror.  The table
+ * doubles whenever it holds more entries than buckets. */
+#define EVENT_LOOKUP_MIN_SIZE 1024
+
+struct event_lookup
+{
+  struct list_data *pList;
+  event_id iId;
+  struct mud_event_data *pMudEvent;
+  struct event_lookup *pNext;
+};
+
+static struct event_lookup **event_lookup_hash = NULL;
+static unsigned int event_lookup_size = 0;
+static unsigned int event_lookup_count = 0;
+static struct mem_pool event_lookup_pool = MEM_POOL_INIT("event lookup", struct event_lookup, 512);
+
+static unsigned int event_lookup_key(struct list_data *pList, event_id iId)
+{
+  unsigned long h = (unsigned long)pList;
+
+  h = (h >> 4) * 2654435761u + (unsigned int)iId * 40503u;
+
+  return (unsigned int)(h ^ (h >> 15)) & (event_lookup_size - 1);
+}
+
+static void event_lookup_grow(void)
+{
+  struct event_lookup **old_hash = event_lookup_hash;
+  struct event_lookup *entry = NULL, *next = NULL, **pp = NULL;
+  unsigned int old_size = event_lookup_size, i;
+
+  event_lookup_size = old_size ? old_size * 2 : EVENT_LOOKUP_MIN_SIZE;
+  CREATE(event_lookup_hash, struct event_lookup *, event_lookup_size);
+
+  /* Move the old chains across in order so duplicates stay oldest first. */
+  for (i = 0; i < old_size; i++)
+  {
+    for (entry = old_hash[i]; entry; entry = next)
+    {
+      next = entry->pNext;
+      entry->pNext = NULL;
+
+      for (pp = &event_lookup_hash[event_lookup_key(entry->pList, entry->iId)]; *pp; pp = &(*pp)->pNext)
+        ;
+      *pp = entry;
+    }
+  }
+
+  if (old_hash)
+    free(old_hash);
+}
+
+static void event_lookup_add(struct list_data *pList, struct mud_event_data *pMudEvent)
+{
+  struct event_lookup **pp = NULL;
+  struct event_lookup *entry = (struct event_lookup *)mem_pool_alloc(&event_lookup_pool);
+
+  if (event_lookup_count >= event_lookup_size)
+    event_lookup_grow();
+
+  entry->pList = pList;
+  entry->iId = pMudEvent->iId;
+  entry->pMudEvent = pMudEvent;
+
+  for (pp = &event_lookup_hash[event_lookup_key(pList, entry->iId)]; *pp; pp = &(*pp)->pNext)
+    ;
+  *pp = entry;
+
+  event_lookup_count++;
+}
+
+static void event_lookup_remove(struct list_data *pList, struct mud_event_data *pMudEvent)
+{
+  struct event_lookup **pp = NULL;
+  struct event_lookup *entry = NULL;
+
+  if (!event_lookup_hash)
+    return;
+
+  for (pp = &event_lookup_hash[event_lookup_key(pList, pMudEvent->iId)]; *pp; pp = &(*pp)->pNext)
+  {
+    if ((*pp)->pMudEvent == pMudEvent)
+    {
+      entry = *pp;
+      *pp = entry->pNext;
+      mem_pool_free(&event_lookup_pool, entry);
+      event_lookup_count--;
+      return;
+    }
+  }
+}
+
+static struct mud_event_data *event_lookup_find(struct list_data *pList, event_id iId)
+{
+  struct event_lookup *entry = NULL;
+
+  if (!event_lookup_hash)
+    return NULL;
+
+  for (entry = event_lookup_hash[event_lookup_key(pList, iId)]; entry; entry = entry->pNext)
+    if (entry->pList == pList && entry->iId == iId)
+      return entry->pMudEvent;
+
+  return NULL;
+}
+
 /* The mud_event_index[] is merely a tool for organizing events, and giving
  * them a "const char *" name to help in potential debugging */
 struct mud_event_list mud_event_index[] = {
@@ -503,7 +619,6 @@ EVENTFUNC(event_daily_use_cooldown)
   int uses = 0;
   int nonfeat_daily_uses = 0;
   int featnum = 0;
-  char buf[128];
 
   pMudEvent = (struct mud_event_data *)event_obj;
 
@@ -525,20 +640,8 @@ EVENTFUNC(event_daily_use_cooldown)
     return 0;
   }
 
-  if (pMudEvent->sVariables == NULL)
-  {
-    /* This is odd - This field should always be populated for daily-use abilities,
-     * maybe some legacy code or bad id. */
-    log("SYSERR: sVariables field is NULL for daily-use-cooldown-event: %d", pMudEvent->iId);
-  }
-  else
-  {
-    if (sscanf(pMudEvent->sVariables, "uses:%d", &uses) != 1)
-    {
-      log("SYSERR: In event_daily_use_cooldown, bad sVariables for daily-use-cooldown-event: %d", pMudEvent->iId);
-      uses = 0;
-    }
-  }
+  /* The number of uses on cooldown. */
+  uses = pMudEvent->iVars[0];
 
   switch (pMudEvent->iId)
   {
@@ -764,11 +867,7 @@ EVENTFUNC(event_daily_use_cooldown)
   uses -= 1;
   if (uses > 0)
   {
-    if (pMudEvent->sVariables != NULL)
-      free(pMudEvent->sVariables);
-
-    snprintf(buf, sizeof(buf), "uses:%d", uses);
-    pMudEvent->sVariables = strdup(buf);
+    pMudEvent->iVars[0] = uses;
 
     if ((featnum == FEAT_UNDEFINED) && (nonfeat_daily_uses > 0))
     {
@@ -829,6 +928,7 @@ void attach_mud_event(struct mud_event_data *pMudEvent, long time)
       ch->events = create_list();
 
     add_to_list(pEvent, ch->events);
+    event_lookup_add(ch->events, pMudEvent);
     break;
   case EVENT_OBJECT:
     obj = (struct obj_data *)pMudEvent->pStruct;
@@ -837,10 +937,11 @@ void attach_mud_event(struct mud_event_data *pMudEvent, long time)
       obj->events = create_list();
 
     add_to_list(pEvent, obj->events);
+    event_lookup_add(obj->events, pMudEvent);
     break;
   case EVENT_ROOM:
 
-    CREATE(rvnum, room_vnum, 1);
+    rvnum = (room_vnum *)mem_pool_alloc(&event_vnum_pool);
     *rvnum = *((room_vnum *)pMudEvent->pStruct);
     pMudEvent->pStruct = rvnum;
     room = &world[real_room(*rvnum)];
@@ -851,9 +952,10 @@ void attach_mud_event(struct mud_event_data *pMudEvent, long time)
       room->events = create_list();
 
     add_to_list(pEvent, room->events);
+    event_lookup_add(room->events, pMudEvent);
     break;
   case EVENT_REGION:
-    CREATE(regvnum, region_vnum, 1);
+    regvnum = (region_vnum *)mem_pool_alloc(&event_vnum_pool);
     *regvnum = *((region_vnum *)pMudEvent->pStruct);
     pMudEvent->pStruct = regvnum;
 
@@ -862,7 +964,7 @@ void attach_mud_event(struct mud_event_data *pMudEvent, long time)
     if (real_region(*regvnum) == NOWHERE)
     {
       log("SYSERR: Attempt to add event to out-of-range region!");
-      free(regvnum);
+      mem_pool_free(&event_vnum_pool, regvnum);
       break;
     }
 
@@ -872,6 +974,7 @@ void attach_mud_event(struct mud_event_data *pMudEvent, long time)
       region->events = create_list();
 
     add_to_list(pEvent, region->events);
+    event_lookup_add(region->events, pMudEvent);
     break;
   }
 }
@@ -881,7 +984,7 @@ struct mud_event_data *new_mud_event(event_id iId, void *pStruct, const char *sV
   struct mud_event_data *pMudEvent = NULL;
   char *varString = NULL;
 
-  CREATE(pMudEvent, struct mud_event_data, 1);
+  pMudEvent = (struct mud_event_data *)mem_pool_alloc(&mud_event_pool);
   varString = (sVariables != NULL) ? strdup(sVariables) : NULL;
 
   pMudEvent->iId = iId;
@@ -892,6 +995,16 @@ struct mud_event_data *new_mud_event(event_id iId, void *pStruct, const char *sV
   return (pMudEvent);
 }
 
+/* Same as new_mud_event(), for events whose only variable is a number. */
+struct mud_event_data *new_mud_event_var(event_id iId, void *pStruct, int value)
+{
+  struct mud_event_data *pMudEvent = new_mud_event(iId, pStruct, NULL);
+
+  pMudEvent->iVars[0] = value;
+
+  return (pMudEvent);
+}
+
 void free_mud_event(struct mud_event_data *pMudEvent)
 {
   struct descriptor_data *d = NULL;
@@ -914,6 +1027,8 @@ void free_mud_event(struct mud_event_data *pMudEvent)
     break;
   case EVENT_CHAR:
     ch = (struct char_data *)pMudEvent->pStruct;
+    if (ch->events)
+      event_lookup_remove(ch->events, pMudEvent);
     remove_from_list(pMudEvent->pEvent, ch->events);
 
     if (ch->events && ch->events->iSize == 0)
@@ -924,6 +1039,8 @@ void free_mud_event(struct mud_event_data *pMudEvent)
     break;
   case EVENT_OBJECT:
     obj = (struct obj_data *)pMudEvent->pStruct;
+    if (obj->events)
+      event_lookup_remove(obj->events, pMudEvent);
     remove_from_list(pMudEvent->pEvent, obj->events);
 
     if (obj->events && obj->events->iSize == 0)
@@ -943,8 +1060,10 @@ void free_mud_event(struct mud_event_data *pMudEvent)
 
     //      log("[DEBUG] Removing Event %s from room %d, which has %d events.",mud_event_index[pMudEvent->iId].event_name, room->number, (room->events == NULL ? 0 : room->events->iSize));
 
-    free(pMudEvent->pStruct);
+    mem_pool_free(&event_vnum_pool, pMudEvent->pStruct);
 
+    if (room->events)
+      event_lookup_remove(room->events, pMudEvent);
     remove_from_list(pMudEvent->pEvent, room->events);
 
     if (room->events && room->events->iSize == 0)
@@ -958,8 +1077,10 @@ void free_mud_event(struct mud_event_data *pMudEvent)
 
     region = &region_table[real_region(*regvnum)];
 
-    free(pMudEvent->pStruct);
+    mem_pool_free(&event_vnum_pool, pMudEvent->pStruct);
 
+    if (region->events)
+      event_lookup_remove(region->events, pMudEvent);
     remove_from_list(pMudEvent->pEvent, region->events);
 
     if (region->events && region->events->iSize == 0)
@@ -974,151 +1095,39 @@ void free_mud_event(struct mud_event_data *pMudEvent)
     free(pMudEvent->sVariables);
 
   pMudEvent->pEvent->event_obj = NULL;
-  free(pMudEvent);
+  mem_pool_free(&mud_event_pool, pMudEvent);
 }
 
 struct mud_event_data *char_has_mud_event(struct char_data *ch, event_id iId)
 {
-  struct event *pEvent = NULL;
-  struct mud_event_data *pMudEvent = NULL;
-  bool found = FALSE;
-  struct iterator_data it;
-
   if (ch->events == NULL)
     return NULL;
 
-  if (ch->events->iSize == 0)
-    return NULL;
-
-  /*
-  simple_list(NULL);
-  while ((pEvent = (struct event *) simple_list(ch->events)) != NULL) {
-    if (!pEvent->isMudEvent)
-      continue;
-    pMudEvent = (struct mud_event_data *) pEvent->event_obj;
-    if (pMudEvent->iId == iId) {
-      found = TRUE;
-      break;
-    }
-  }
-  simple_list(NULL);
-   */
-
-  for (pEvent = (struct event *)merge_iterator(&it, ch->events);
-       pEvent != NULL;
-       pEvent = next_in_list(&it))
-  {
-    if (!pEvent->isMudEvent)
-      continue;
-    pMudEvent = (struct mud_event_data *)pEvent->event_obj;
-    if (pMudEvent->iId == iId)
-    {
-      found = TRUE;
-      break;
-    }
-  }
-  remove_iterator(&it);
-
-  if (found)
-    return (pMudEvent);
-
-  return NULL;
+  return event_lookup_find(ch->events, iId);
 }
 
 struct mud_event_data *room_has_mud_event(struct room_data *rm, event_id iId)
 {
-  struct event *pEvent = NULL;
-  struct mud_event_data *pMudEvent = NULL;
-  bool found = FALSE;
-
   if (rm->events == NULL)
     return NULL;
 
-  if (rm->events->iSize == 0)
-    return NULL;
-
-  simple_list(NULL);
-  while ((pEvent = (struct event *)simple_list(rm->events)) != NULL)
-  {
-    if (!pEvent->isMudEvent)
-      continue;
-    pMudEvent = (struct mud_event_data *)pEvent->event_obj;
-    if (pMudEvent->iId == iId)
-    {
-      found = TRUE;
-      break;
-    }
-  }
-  simple_list(NULL);
-
-  if (found)
-    return (pMudEvent);
-
-  return NULL;
+  return event_lookup_find(rm->events, iId);
 }
 
 struct mud_event_data *obj_has_mud_event(struct obj_data *obj, event_id iId)
 {
-  struct event *pEvent = NULL;
-  struct mud_event_data *pMudEvent = NULL;
-  bool found = FALSE;
-
   if (obj->events == NULL)
     return NULL;
 
-  if (obj->events->iSize == 0)
-    return NULL;
-
-  simple_list(NULL);
-  while ((pEvent = (struct event *)simple_list(obj->events)) != NULL)
-  {
-    if (!pEvent->isMudEvent)
-      continue;
-    pMudEvent = (struct mud_event_data *)pEvent->event_obj;
-    if (pMudEvent->iId == iId)
-    {
-      found = TRUE;
-      break;
-    }
-  }
-  simple_list(NULL);
-
-  if (found)
-    return (pMudEvent);
-
-  return NULL;
+  return event_lookup_find(obj->events, iId);
 }
 
 struct mud_event_data *region_has_mud_event(struct region_data *reg, event_id iId)
 {
-  struct event *pEvent = NULL;
-  struct mud_event_data *pMudEvent = NULL;
-  bool found = FALSE;
-
   if (reg->events == NULL)
     return NULL;
 
-  if (reg->events->iSize == 0)
-    return NULL;
-
-  simple_list(NULL);
-  while ((pEvent = (struct event *)simple_list(reg->events)) != NULL)
-  {
-    if (!pEvent->isMudEvent)
-      continue;
-    pMudEvent = (struct mud_event_data *)pEvent->event_obj;
-    if (pMudEvent->iId == iId)
-    {
-      found = TRUE;
-      break;
-    }
-  }
-  simple_list(NULL);
-
-  if (found)
-    return (pMudEvent);
-
-  return NULL;
+  return event_lookup_find(reg->events, iId);
 }
 
 /* remove world event */
@@ -1304,7 +1313,10 @@ void change_event_duration(struct char_data *ch, event_id iId, long time)
   if (found)
   {
     /* So we found the offending event, now build a new one, with the new time */
-    attach_mud_event(new_mud_event(iId, pMudEvent->pStruct, pMudEvent->sVariables), time);
+    struct mud_event_data *pNewEvent = new_mud_event(iId, pMudEvent->pStruct, pMudEvent->sVariables);
+
+    memcpy(pNewEvent->iVars, pMudEvent->iVars, sizeof(pNewEvent->iVars));
+    attach_mud_event(pNewEvent, time);
     if (event_is_queued(pEvent))
       event_cancel(pEvent);
   }
@@ -1342,7 +1354,10 @@ void change_event_svariables(struct char_data *ch, event_id iId, char *sVariable
   if (found)
   {
     /* So we found the offending event, now build a new one, with the new time */
-    attach_mud_event(new_mud_event(iId, pMudEvent->pStruct, sVariables), time);
+    struct mud_event_data *pNewEvent = new_mud_event(iId, pMudEvent->pStruct, sVariables);
+
+    memcpy(pNewEvent->iVars, pMudEvent->iVars, sizeof(pNewEvent->iVars));
+    attach_mud_event(pNewEvent, time);
     if (event_is_queued(pEvent))
       event_cancel(pEvent);
   }
@@ -25,6 +25,7 @@ struct region_data;
 #define EVENT_OBJECT 5
 
 #define NEW_EVENT(event_id, struct, var, time) (attach_mud_event(new_mud_event(event_id, struct, var), time))
+#define NEW_EVENT_VAR(event_id, struct, value, time) (attach_mud_event(new_mud_event_var(event_id, struct, value), time))
 
 typedef enum
 {
@@ -162,12 +163,20 @@ struct mud_event_list
   int iEvent_Type;
 };
 
+/* Number of integer payload slots carried by each event. */
+#define NUM_EVENT_VARS 4
+
+/* Most events only carry a number or two (uses spent, a spell circle, a
+ * performance, a countdown), which live in iVars so handlers read them
+ * directly instead of formatting and parsing sVariables on every tick.
+ * sVariables is left for the few events that need text. */
 struct mud_event_data
 {
-  struct event *pEvent; /***< Pointer reference to the event */
-  event_id iId;         /***< General ID reference */
-  void *pStruct;        /***< Pointer to NULL, Descriptor, Character .... */
-  char *sVariables;     /***< String variable */
+  struct event *pEvent;       /***< Pointer reference to the event */
+  event_id iId;               /***< General ID reference */
+  void *pStruct;              /***< Pointer to NULL, Descriptor, Character .... */
+  int iVars[NUM_EVENT_VARS];  /***< Integer variables, zero unless set */
+  char *sVariables;           /***< Optional string variable */
 };
 
 /* Externals */
@@ -177,6 +186,7 @@ extern struct mud_event_list mud_event_index[];
 /* Local Functions */
 void init_events(void);
 struct mud_event_data *new_mud_event(event_id iId, void *pStruct, const char *sVariables);
+struct mud_event_data *new_mud_event_var(event_id iId, void *pStruct, int value);
 void attach_mud_event(struct mud_event_data *pMudEvent, long time);
 void free_mud_event(struct mud_event_data *pMudEvent);
 struct mud_event_data *char_has_mud_event(struct char_data *ch, event_id iId);
@@ -14,8 +14,10 @@
 #include "comm.h"
 #include "modify.h"
 #include "mysql.h"
+#include "db_worker.h"
 
 #include "wilderness.h"
+#include "region_index.h"
 #include "mud_event.h"
 
 MYSQL *conn = NULL;
@@ -124,6 +126,9 @@ void connect_to_mysql()
     log("SYSERR: Unable to connect to MySQL3: %s", mysql_error(conn3));
     exit(1);
   }
+
+  /* Without the worker, queued queries just run on conn. */
+  db_worker_init(host, username, password, database);
 }
 
 void disconnect_from_mysql()
@@ -329,118 +334,8 @@ void load_regions()
   }
 
   mysql_free_result(result);
-}
-
-/* Move this out to another file... */
-bool is_point_within_region(region_vnum region, int x, int y)
-{
-  MYSQL_RES *result;
-  MYSQL_ROW row;
-  bool retval;
-
-  char buf[1024];
-
-  /* Need an ORDER BY here, since we can have multiple regions. */
-  snprintf(buf, sizeof(buf), "SELECT 1 "
-               "from region_index "
-               "where vnum = %d and "
-               "ST_Within(GeomFromText('POINT(%d %d)'), region_polygon)",
-          region,
-          x, y);
-
-  /* Check the connection, reconnect if necessary. */
-  mysql_ping(conn);
-
-  if (mysql_query(conn, buf))
-  {
-    log("SYSERR: Unable to SELECT from region_index: %s", mysql_error(conn));
-    exit(1);
-  }
-
-  if (!(result = mysql_store_result(conn)))
-  {
-    log("SYSERR: Unable to SELECT from region_index: %s", mysql_error(conn));
-    exit(1);
-  }
-
-  retval = false;
-  while ((row = mysql_fetch_row(result)))
-  {
-    retval = true;
-  }
-  mysql_free_result(result);
-
-  return retval;
-}
-
-struct region_list *get_enclosing_regions(zone_rnum zone, int x, int y)
-{
-  MYSQL_RES *result;
-  MYSQL_ROW row;
-
-  struct region_list *regions = NULL;
-  struct region_list *new_node = NULL;
-
-  char buf[1024];
-
-  /* Need an ORDER BY here, since we can have multiple regions. */
-  snprintf(buf, sizeof(buf), "SELECT vnum,  "
-               "case "
-               "  when ST_Within(geomfromtext('Point(%d %d)'), region_polygon) then "
-               "  case "
-               "    when (geomfromtext('Point(%d %d)') = Centroid(region_polygon)) then '1' "
-               "    when (ST_Distance(geomfromtext('Point(%d %d)'), exteriorring(region_polygon)) > "
-               "          ST_Distance(geomfromtext('Point(%d %d)'), Centroid(region_polygon))/2) then '2' "
-               "    else '3' "
-               "  end "
-               "  else NULL "
-               "end as loc "
-               "  from region_index "
-               "  where zone_vnum = %d "
-               "  and ST_Within(GeomFromText('POINT(%d %d)'), region_polygon)",
-          x, y,
-          x, y,
-          x, y,
-          x, y,
-          zone_table[zone].number,
-          x, y);
-
-  /* Check the connection, reconnect if necessary. */
-  mysql_ping(conn);
-
-  if (mysql_query(conn, buf))
-  {
-    log("SYSERR: Unable to SELECT from region_index: %s", mysql_error(conn));
-    exit(1);
-  }
-
-  if (!(result = mysql_store_result(conn)))
-  {
-    log("SYSERR: Unable to SELECT from region_index: %s", mysql_error(conn));
-    exit(1);
-  }
-
-  while ((row = mysql_fetch_row(result)))
-  {
-
-    /* Allocate memory for the region data. */
-    CREATE(new_node, struct region_list, 1);
-    new_node->rnum = real_region(atoi(row[0]));
-    if (atoi(row[1]) == 1)
-      new_node->pos = REGION_POS_CENTER;
-    else if (atoi(row[1]) == 2)
-      new_node->pos = REGION_POS_INSIDE;
-    else if (atoi(row[1]) == 3)
-      new_node->pos = REGION_POS_EDGE;
-    else
-      new_node->pos = REGION_POS_UNDEFINED;
-    new_node->next = regions;
-    regions = new_node;
-    new_node = NULL;
-  }
-  mysql_free_result(result);
 
-  return regions;
+  region_index_build_regions();
 }
 
 #define ROUND(num) (num < 0 ? num - 0.5 : num + 0.5)
@@ -674,6 +569,8 @@ void load_paths()
     i++;
   }
   mysql_free_result(result);
+
+  region_index_build_paths();
 }
 
 /* Insert a path into the database. */
@@ -744,64 +641,17 @@ bool delete_path(region_vnum vnum)
   }
 
   if (mysql_affected_rows(conn))
+  {
+    /* Drop it from the spatial index right away, load_paths() will rebuild
+     * the path half of the index from the new table. */
+    if (real_path(vnum) != NOWHERE)
+      region_index_remove_path(real_path(vnum));
     return true;
+  }
   else
     return false;
 }
 
-struct path_list *get_enclosing_paths(zone_rnum zone, int x, int y)
-{
-  MYSQL_RES *result;
-  MYSQL_ROW row;
-
-  struct path_list *paths = NULL;
-  struct path_list *new_node = NULL;
-
-  char buf[1024];
-
-  snprintf(buf, sizeof(buf), "SELECT vnum, "
-               "  CASE WHEN (ST_Within(GeomFromText('POINT(%d %d)'), path_linestring) AND "
-               "             ST_Within(GeomFromText('POINT(%d %d)'), path_linestring)) THEN %d"
-               "    WHEN (ST_Within(GeomFromText('POINT(%d %d)'), path_linestring) AND "
-               "               ST_Within(GeomFromText('POINT(%d %d)'), path_linestring)) THEN %d "
-               "    ELSE %d"
-               "  END AS glyph "
-               "  from path_index "
-               "  where zone_vnum = %d "
-               "  and ST_Within(GeomFromText('POINT(%d %d)'), path_linestring)",
-          x, y - 1, x, y + 1, GLYPH_TYPE_PATH_NS, x - 1, y, x + 1, y, GLYPH_TYPE_PATH_EW, GLYPH_TYPE_PATH_INT, zone_table[zone].number, x, y);
-
-  /* Check the connection, reconnect if necessary. */
-  mysql_ping(conn);
-
-  if (mysql_query(conn, buf))
-  {
-    log("SYSERR: Unable to SELECT from path_index: %s", mysql_error(conn));
-    exit(1);
-  }
-
-  if (!(result = mysql_store_result(conn)))
-  {
-    log("SYSERR: Unable to SELECT from path_index: %s", mysql_error(conn));
-    exit(1);
-  }
-
-  while ((row = mysql_fetch_row(result)))
-  {
-
-    /* Allocate memory for the region data. */
-    CREATE(new_node, struct path_list, 1);
-    new_node->rnum = real_path(atoi(row[0]));
-    new_node->glyph_type = atoi(row[1]);
-    new_node->next = paths;
-    paths = new_node;
-    new_node = NULL;
-  }
-  mysql_free_result(result);
-
-  return paths;
-}
-
 void save_paths()
 {
 }
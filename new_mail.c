@@ -26,6 +26,7 @@
 #include "clan.h"
 #include "mysql.h"
 #include "modify.h"
+#include "db_worker.h"
 
 void perform_mail_delete(struct char_data *ch, int mnum);
 void perform_mail_list(struct char_data *ch, int type);
@@ -43,6 +44,14 @@ ACMD(do_new_mail)
 
   skip_spaces_c(&argument);
 
+  /* reading or deleting mail changes the prompt's count, and a refresh
+   * already queued may have counted before the change */
+  if (!IS_NPC(ch))
+  {
+    ch->player_specials->new_mail_checked = 0;
+    ch->player_specials->new_mail_stamp++;
+  }
+
   if (!*argument)
   {
     send_to_char(ch, "Commands are:\r\n"
@@ -469,81 +478,126 @@ void perform_mail_delete(struct char_data *ch, int mnum)
   send_to_char(ch, "You have successfully deleted that mail.\r\n");
 }
 
-/* adjusted to return number of NEW mail and added 'silent' mode -zusuk */
-int new_mail_alert(struct char_data *ch, bool silent)
-{
-  MYSQL_RES *res = NULL;
-  MYSQL_ROW row = NULL;
-  MYSQL_RES *res2 = NULL;
-  MYSQL_ROW row2 = NULL;
-  extern MYSQL *conn2;
-  MYSQL_RES *res3 = NULL;
-  MYSQL_ROW row3 = NULL;
-  extern MYSQL *conn3;
-
-  /* Check the connection, reconnect if necessary. */
-  mysql_ping(conn);
-  mysql_ping(conn2);
-  mysql_ping(conn3);
+/* How long the (mail) flag in the prompt may lag behind, in seconds. */
+#define NEW_MAIL_REFRESH 30
 
-  int num_unread = 0, num_mails = 0, num_read = 0, num_deleted = 0;
-  ;
-
-  char days[200];
+/* One query counts the player's mail, and how much of it was read or
+ * deleted, instead of two more queries for every mail. */
+static void new_mail_query(struct char_data *ch, char *query, size_t size)
+{
   if (ch->player_specials->saved.mail_days <= 0)
   {
     ch->player_specials->saved.mail_days = 14;
   }
-  if (ch->player_specials->saved.mail_days > 0)
-  {
-    snprintf(days, sizeof(days), " AND date_sent >= DATE_SUB(NOW(), INTERVAL %d DAY) ", ch->player_specials->saved.mail_days);
-  }
-  else
+
+  snprintf(query, size, "SELECT COUNT(*),"
+                        " SUM(EXISTS(SELECT 1 FROM player_mail_deleted d WHERE d.player_name='%s' AND d.mail_id=m.mail_id)),"
+                        " SUM(EXISTS(SELECT 1 FROM player_mail_read r WHERE r.player_name='%s' AND r.mail_id=m.mail_id))"
+                        " FROM player_mail m WHERE (m.receiver='%s' OR m.receiver='All')"
+                        " AND m.date_sent >= DATE_SUB(NOW(), INTERVAL %d DAY)",
+           GET_NAME(ch), GET_NAME(ch), GET_NAME(ch), ch->player_specials->saved.mail_days);
+}
+
+/* mails - read - deleted, from the row new_mail_query() returns */
+static int new_mail_count(MYSQL_RES *result)
+{
+  MYSQL_ROW row = NULL;
+
+  if (!result || !(row = mysql_fetch_row(result)))
+    return 0;
+
+  return atoi(row[0]) - (row[1] ? atoi(row[1]) : 0) - (row[2] ? atoi(row[2]) : 0);
+}
+
+/* who a queued refresh is for, and their new_mail_stamp when it was queued */
+struct new_mail_refresh
+{
+  long idnum;
+  unsigned int stamp;
+};
+
+/* db worker callback for the prompt's refresh */
+static void new_mail_counted(MYSQL_RES *result, void *data)
+{
+  struct new_mail_refresh *refresh = (struct new_mail_refresh *)data;
+  struct descriptor_data *d = NULL;
+  struct player_special_data *ps = NULL;
+
+  for (d = descriptor_list; d; d = d->next)
   {
-    snprintf(days, sizeof(days), " ");
+    if (!d->character || IS_NPC(d->character) || GET_IDNUM(d->character) != refresh->idnum)
+      continue;
+
+    ps = d->character->player_specials;
+    ps->new_mail_pending = FALSE;
+
+    /* mail was read or deleted since, leave it to the next refresh */
+    if (ps->new_mail_stamp != refresh->stamp)
+      continue;
+
+    if (result)
+      ps->new_mail_count = new_mail_count(result);
+    ps->new_mail_checked = time(0);
   }
 
+  free(refresh);
+}
+
+/* adjusted to return number of NEW mail and added 'silent' mode -zusuk */
+/* Silent mode is for the prompt: it answers from the count cached on the
+ * player and has the db worker refresh it now and then, so the prompt never
+ * waits on MySQL.  Otherwise the mail is counted right now. */
+int new_mail_alert(struct char_data *ch, bool silent)
+{
+  MYSQL_RES *res = NULL;
+  struct db_job *job = NULL;
+  struct new_mail_refresh *refresh = NULL;
+  int num_unread = 0;
   char query[MAX_INPUT_LENGTH];
-  snprintf(query, sizeof(query), "SELECT mail_id,sender,receiver,subject FROM player_mail WHERE (receiver='%s' OR %s='All') %s ORDER BY mail_id DESC", GET_NAME(ch), "receiver", days);
-  mysql_query(conn, query);
-  res = mysql_use_result(conn);
-  if (res != NULL)
+
+  if (IS_NPC(ch))
+    return 0;
+
+  if (silent)
   {
-    while ((row = mysql_fetch_row(res)) != NULL)
+    if (!ch->player_specials->new_mail_pending &&
+        time(0) - ch->player_specials->new_mail_checked >= NEW_MAIL_REFRESH)
     {
+      new_mail_query(ch, query, sizeof(query));
+      job = db_job_new(NULL);
+      db_job_add(job, "%s", query);
+
+      CREATE(refresh, struct new_mail_refresh, 1);
+      refresh->idnum = GET_IDNUM(ch);
+      refresh->stamp = ch->player_specials->new_mail_stamp;
+      ch->player_specials->new_mail_pending = TRUE;
+      db_job_read(job, new_mail_counted, refresh);
+    }
 
-      num_mails++;
+    return ch->player_specials->new_mail_count;
+  }
 
-      snprintf(query, sizeof(query), "SELECT mail_id,player_name FROM player_mail_deleted WHERE player_name='%s' AND mail_id='%s'", GET_NAME(ch), row[0]);
-      mysql_query(conn2, query);
-      res2 = mysql_use_result(conn2);
-      if (res2 != NULL)
-      {
-        if ((row2 = mysql_fetch_row(res2)) != NULL)
-        {
-          num_deleted++;
-        }
-      }
-      mysql_free_result(res2);
+  /* Check the connection, reconnect if necessary. */
+  mysql_ping(conn);
 
-      snprintf(query, sizeof(query), "SELECT mail_id,player_name FROM player_mail_read WHERE player_name='%s' AND mail_id='%s'", GET_NAME(ch), row[0]);
-      mysql_query(conn3, query);
-      res3 = mysql_use_result(conn3);
-      if (res3 != NULL)
-      {
-        if ((row3 = mysql_fetch_row(res3)) != NULL)
-        {
-          num_read++;
-        }
-      }
-      mysql_free_result(res3);
-    }
+  new_mail_query(ch, query, sizeof(query));
+  if (mysql_query(conn, query))
+  {
+    log("SYSERR: Unable to count new mail for %s: %s", GET_NAME(ch), mysql_error(conn));
+    return 0;
   }
-  mysql_free_result(res);
 
-  num_unread = num_mails - num_read - num_deleted;
+  res = mysql_store_result(conn);
+  num_unread = new_mail_count(res);
+  if (res)
+    mysql_free_result(res);
+
+  /* newer than any refresh still queued */
+  ch->player_specials->new_mail_count = num_unread;
+  ch->player_specials->new_mail_checked = time(0);
+  ch->player_specials->new_mail_stamp++;
 
-  if (!silent && num_unread > 0)
+  if (num_unread > 0)
   {
     send_to_char(ch, "\r\nYou have %d NEW mail messages!\r\n\r\n", num_unread);
   }
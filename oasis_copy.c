@@ -25,6 +25,7 @@
 #include "dg_scripts.h"
 #include "wilderness.h"
 #include "quest.h"
+#include "graph.h"  /* for world_topology_changed() */
 
 /* Local, filescope function prototypes */
 /* Utility function for buildwalk */
@@ -325,6 +326,8 @@ ACMD(do_dig)
     W_EXIT(rrnum, rev_dir[dir])->to_room = IN_ROOM(ch);
     add_to_save_list(zone_table[world[rrnum].zone].number, SL_WLD);
   }
+
+  world_topology_changed();
 }
 
 /* BuildWalk - OasisOLC Extension by D. Tyler Barnes. */
@@ -479,6 +482,8 @@ int buildwalk(struct char_data *ch, int dir)
         send_to_char(ch, "%sRoom #%d created by BuildWalk.%s\r\n", yel, vnum, nrm);
       }
 
+      world_topology_changed();
+
       cleanup_olc(d, CLEANUP_STRUCTS);
 
       return (1);
@@ -24,6 +24,7 @@
 #include "genolc.h" /* for strip_cr and sprintascii */
 #include "craft.h"
 #include "spec_abilities.h"
+#include "file_worker.h"
 
 #define OBJSAVE_DB 1
 
@@ -602,6 +603,7 @@ int Crash_delete_file(char *name)
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return FALSE;
+  file_worker_wait(filename);
 
   if (!(fl = fopen(filename, "r")))
   {
@@ -630,6 +632,7 @@ int Crash_delete_crashfile(struct char_data *ch)
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, GET_NAME(ch)))
     return FALSE;
+  file_worker_wait(filename);
 
   if (!(fl = fopen(filename, "r")))
   {
@@ -660,6 +663,7 @@ int Crash_clean_file(char *name)
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return FALSE;
+  file_worker_wait(filename);
 
   /* Open so that permission problems will be flagged now, at boot time. */
   if (!(fl = fopen(filename, "r")))
@@ -733,6 +737,7 @@ void Crash_listrent(struct char_data *ch, char *name)
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, name))
     return;
+  file_worker_wait(filename);
 
   if (!(fl = fopen(filename, "r")))
   {
@@ -922,6 +927,7 @@ void Crash_crashsave(struct char_data *ch)
 {
   char buf[MAX_INPUT_LENGTH];
   int j;
+  struct file_job *job;
   FILE *fp;
 
   if (IS_NPC(ch))
@@ -930,8 +936,9 @@ void Crash_crashsave(struct char_data *ch)
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(job = file_job_new(buf)))
     return;
+  fp = file_job_fp(job);
 
 #ifdef OBJSAVE_DB
   char del_buf[2048];
@@ -939,6 +946,7 @@ void Crash_crashsave(struct char_data *ch)
   {
     log("SYSERR: Unable to start transaction for saving of player object data: %s",
         mysql_error(conn));
+    file_job_cancel(job);
     return;
   }
   /* Delete existing save data.  In the future may just flag these for deletion. */
@@ -948,13 +956,17 @@ void Crash_crashsave(struct char_data *ch)
   {
     log("SYSERR: Unable to delete player object save data: %s",
         mysql_error(conn));
+    file_job_cancel(job);
     return;
   }
 #endif
 
   /* write to file rentcode: rentcode, time, cost for renting, gold, bank-gold */
   if (!objsave_write_rentcode(fp, RENT_CRASH, 0, ch))
+  {
+    file_job_cancel(job);
     return;
+  }
 
   for (j = 0; j < NUM_WEARS; j++)
     if (GET_EQ(ch, j))
@@ -962,7 +974,7 @@ void Crash_crashsave(struct char_data *ch)
       /* recursive write-to-file function (like bags) */
       if (!Crash_save(GET_EQ(ch, j), ch, fp, j + 1))
       {
-        fclose(fp);
+        file_job_cancel(job);
         return;
       }
       /* makes sure containers have proper weight for carrying objects with weight value */
@@ -972,7 +984,7 @@ void Crash_crashsave(struct char_data *ch)
   /* inventory: recursive write-to-file function (like bags) */
   if (!Crash_save(ch->carrying, ch, fp, 0))
   {
-    fclose(fp);
+    file_job_cancel(job);
     return;
   }
 
@@ -980,7 +992,7 @@ void Crash_crashsave(struct char_data *ch)
   Crash_restore_weight(ch->carrying);
 
   fprintf(fp, "$~\n");
-  fclose(fp);
+  file_job_write(job);
 
 #ifdef OBJSAVE_DB
   if (mysql_query(conn, "commit;"))
@@ -998,6 +1010,7 @@ void Crash_idlesave(struct char_data *ch)
   char buf[MAX_INPUT_LENGTH];
   int j;
   int cost, cost_eq;
+  struct file_job *job;
   FILE *fp;
 
   if (IS_NPC(ch))
@@ -1006,8 +1019,9 @@ void Crash_idlesave(struct char_data *ch)
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(job = file_job_new(buf)))
     return;
+  fp = file_job_fp(job);
 
   Crash_extract_norent_eq(ch);
   Crash_extract_norents(ch->carrying);
@@ -1043,7 +1057,7 @@ void Crash_idlesave(struct char_data *ch)
       ;
     if (j == NUM_WEARS)
     { /* No equipment or inventory. */
-      fclose(fp);
+      file_job_cancel(job);
       Crash_delete_file(GET_NAME(ch));
       return;
     }
@@ -1051,7 +1065,10 @@ void Crash_idlesave(struct char_data *ch)
 
   /* write to file rentcode: rentcode, time, cost for renting, gold, bank-gold */
   if (!objsave_write_rentcode(fp, RENT_TIMEDOUT, cost, ch))
+  {
+    file_job_cancel(job);
     return;
+  }
 
   for (j = 0; j < NUM_WEARS; j++)
   {
@@ -1060,7 +1077,7 @@ void Crash_idlesave(struct char_data *ch)
       /* recursive write-to-file function (like bags) */
       if (!Crash_save(GET_EQ(ch, j), ch, fp, j + 1))
       {
-        fclose(fp);
+        file_job_cancel(job);
         return;
       }
       /* makes sure containers have proper weight for carrying objects with weight value */
@@ -1073,11 +1090,11 @@ void Crash_idlesave(struct char_data *ch)
   /* inventory: recursive write-to-file function (like bags) */
   if (!Crash_save(ch->carrying, ch, fp, 0))
   {
-    fclose(fp);
+    file_job_cancel(job);
     return;
   }
   fprintf(fp, "$~\n");
-  fclose(fp);
+  file_job_write(job);
 
   /* recursively remove objects and their contents */
   Crash_extract_objs(ch->carrying);
@@ -1089,6 +1106,7 @@ void Crash_rentsave(struct char_data *ch, int cost)
 {
   char buf[MAX_INPUT_LENGTH];
   int j;
+  struct file_job *job;
   FILE *fp;
 
   if (IS_NPC(ch))
@@ -1097,8 +1115,9 @@ void Crash_rentsave(struct char_data *ch, int cost)
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(job = file_job_new(buf)))
     return;
+  fp = file_job_fp(job);
 
 #ifdef OBJSAVE_DB
   char del_buf[2048];
@@ -1106,6 +1125,7 @@ void Crash_rentsave(struct char_data *ch, int cost)
   {
     log("SYSERR: Unable to start transaction for saving of player object data: %s",
         mysql_error(conn));
+    file_job_cancel(job);
     return;
   }
   /* Delete existing save data.  In the future may just flag these for deletion. */
@@ -1115,6 +1135,7 @@ void Crash_rentsave(struct char_data *ch, int cost)
   {
     log("SYSERR: Unable to delete player object save data: %s",
         mysql_error(conn));
+    file_job_cancel(job);
     return;
   }
 #endif
@@ -1125,7 +1146,10 @@ void Crash_rentsave(struct char_data *ch, int cost)
 
   /* write to file rentcode: rentcode, time, cost for renting, gold, bank-gold */
   if (!objsave_write_rentcode(fp, RENT_RENTED, cost, ch))
+  {
+    file_job_cancel(job);
     return;
+  }
 
   /* go through all equipment worn and save */
   for (j = 0; j < NUM_WEARS; j++)
@@ -1135,7 +1159,7 @@ void Crash_rentsave(struct char_data *ch, int cost)
       /* recursive save function (like bags) */
       if (!Crash_save(GET_EQ(ch, j), ch, fp, j + 1))
       {
-        fclose(fp);
+        file_job_cancel(job);
         return;
       }
       /* makes sure containers have proper weight for carrying objects with weight value */
@@ -1148,13 +1172,13 @@ void Crash_rentsave(struct char_data *ch, int cost)
   /* inventory: recursive save function (like bags) */
   if (!Crash_save(ch->carrying, ch, fp, 0))
   {
-    fclose(fp);
+    file_job_cancel(job);
     return;
   }
 
   /* file terminating char and close */
   fprintf(fp, "$~\n");
-  fclose(fp);
+  file_job_write(job);
 
 #ifdef OBJSAVE_DB
   if (mysql_query(conn, "commit;"))
@@ -1209,6 +1233,7 @@ static void Crash_cryosave(struct char_data *ch, int cost)
 {
   char buf[MAX_INPUT_LENGTH];
   int j;
+  struct file_job *job;
   FILE *fp;
 
   if (IS_NPC(ch))
@@ -1217,8 +1242,9 @@ static void Crash_cryosave(struct char_data *ch, int cost)
   if (!get_filename(buf, sizeof(buf), CRASH_FILE, GET_NAME(ch)))
     return;
 
-  if (!(fp = fopen(buf, "w")))
+  if (!(job = file_job_new(buf)))
     return;
+  fp = file_job_fp(job);
 
   Crash_extract_norent_eq(ch);
   Crash_extract_norents(ch->carrying);
@@ -1227,7 +1253,10 @@ static void Crash_cryosave(struct char_data *ch, int cost)
 
   /* write to file rentcode: rentcode, time, cost for renting, gold, bank-gold */
   if (!objsave_write_rentcode(fp, RENT_CRYO, 0, ch))
+  {
+    file_job_cancel(job);
     return;
+  }
 
   for (j = 0; j < NUM_WEARS; j++)
     if (GET_EQ(ch, j))
@@ -1235,7 +1264,7 @@ static void Crash_cryosave(struct char_data *ch, int cost)
       /* recursive save function (like bags) */
       if (!Crash_save(GET_EQ(ch, j), ch, fp, j + 1))
       {
-        fclose(fp);
+        file_job_cancel(job);
         return;
       }
       /* makes sure containers have proper weight for carrying objects with weight value */
@@ -1247,12 +1276,12 @@ static void Crash_cryosave(struct char_data *ch, int cost)
   /* inventory: recursive save function (like bags) */
   if (!Crash_save(ch->carrying, ch, fp, 0))
   {
-    fclose(fp);
+    file_job_cancel(job);
     return;
   }
 
   fprintf(fp, "$~\n");
-  fclose(fp);
+  file_job_write(job);
 
   /* recursively remove objects and their contents */
   Crash_extract_objs(ch->carrying);
@@ -1489,6 +1518,32 @@ void Crash_save_all(void)
   }
 }
 
+/* Autosave, called every pulse.  Each player is saved once every
+ * autosave_time minutes as with Crash_save_all(), but on a pulse picked by
+ * their id, so the saves are spread over the whole period instead of all
+ * landing on the same pulse. */
+void Crash_save_staggered(int pulse)
+{
+  struct descriptor_data *d;
+  long period = MAX(1, CONFIG_AUTOSAVE_TIME) * PULSE_AUTOSAVE;
+
+  for (d = descriptor_list; d; d = d->next)
+  {
+    if (STATE(d) != CON_PLAYING || IS_NPC(d->character))
+      continue;
+
+    if (GET_IDNUM(d->character) % period != pulse % period)
+      continue;
+
+    if (PLR_FLAGGED(d->character, PLR_CRASH))
+    {
+      Crash_crashsave(d->character);
+      save_char(d->character, 0);
+      REMOVE_BIT_AR(PLR_FLAGS(d->character), PLR_CRASH);
+    }
+  }
+}
+
 /* Parses the object records stored in fl, and returns the first object in a
  * linked list, which also handles location if worn. This list can then be
  * handled by house code, listrent code, autoeq code, etc. */
@@ -2193,6 +2248,7 @@ static int Crash_load_objs(struct char_data *ch)
 
   if (!get_filename(filename, sizeof(filename), CRASH_FILE, GET_NAME(ch)))
     return 1;
+  file_worker_wait(filename);
 
   for (i = 0; i < MAX_BAG_ROWS; i++)
     cont_row[i] = NULL;
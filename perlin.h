@@ -6,6 +6,8 @@
 
 #define MAX_GENERATED_NOISE 24
 
+#define PERLIN_GRID_BLOCK 64 /* Block edge used by PerlinNoise2DGrid() */
+
 #define B 0x100
 #define BM 0xff
 #define N 0x1000
@@ -33,6 +35,8 @@ void normalize2(double *);
 double PerlinNoise1D(int idx, double, double, double, int);
 double PerlinNoise2D(int idx, double, double, double, double, int);
 double PerlinNoise3D(int idx, double, double, double, double, double, int);
+void PerlinNoise2DGrid(int idx, double x0, double y0, double dx, double dy,
+                       int w, int h, double alpha, double beta, int n, double *out);
 double RidgedMultifractal2D(int idx, double x, double y, double H, double lacunarity,
                             double octaves, double offset, double gain);
 
@@ -32,6 +32,8 @@
 #include "templates.h"
 #include "premadebuilds.h"
 #include "missions.h"
+#include "db_worker.h"
+#include "file_worker.h"
 
 #define LOAD_HIT 0
 #define LOAD_PSP 1
@@ -59,6 +61,7 @@ long top_idnum = 0;
 /* local functions */
 static void load_dr(FILE *fl, struct char_data *ch);
 static void load_events(FILE *fl, struct char_data *ch);
+static void save_event(FILE *fl, struct mud_event_data *pMudEvent);
 static void load_affects(FILE *fl, struct char_data *ch);
 static void load_skills(FILE *fl, struct char_data *ch);
 static void load_feats(FILE *fl, struct char_data *ch);
@@ -87,6 +90,109 @@ void save_char_pets(struct char_data *ch);
 // external functions
 void autoroll_mob(struct char_data *mob, bool realmode, bool summoned);
 
+/* player_table[] is also hashed by name (ignoring case) and by id, so
+ * looking a player up does not compare every name in the game.  Buckets and
+ * chains hold positions in player_table[]: ptable_name_head[bucket] is the
+ * first entry in a bucket and ptable_name_next[pos] the one after pos, -1
+ * ending a chain.  The table itself is left alone for everything that walks
+ * it. */
+static int *ptable_name_head = NULL;
+static int *ptable_name_next = NULL;
+static int *ptable_id_head = NULL;
+static int *ptable_id_next = NULL;
+static int ptable_buckets = 0; /* a power of two, and also the room in the chains */
+
+static unsigned int ptable_name_hash(const char *name)
+{
+  unsigned int h = 0;
+
+  for (; *name; name++)
+    h = h * 31 + (unsigned char)LOWER(*name);
+
+  return (h & (ptable_buckets - 1));
+}
+
+static unsigned int ptable_id_hash(long id)
+{
+  return ((unsigned int)((unsigned long)id * 2654435761UL) & (ptable_buckets - 1));
+}
+
+static void ptable_hash_add(int pos)
+{
+  unsigned int h;
+
+  if (player_table[pos].name)
+  {
+    h = ptable_name_hash(player_table[pos].name);
+    ptable_name_next[pos] = ptable_name_head[h];
+    ptable_name_head[h] = pos;
+  }
+  else
+    ptable_name_next[pos] = -1;
+
+  h = ptable_id_hash(player_table[pos].id);
+  ptable_id_next[pos] = ptable_id_head[h];
+  ptable_id_head[h] = pos;
+}
+
+static void ptable_unlink(int *head, int *next, int pos)
+{
+  int *p;
+
+  for (p = head; *p >= 0; p = &next[*p])
+    if (*p == pos)
+    {
+      *p = next[pos];
+      return;
+    }
+}
+
+/* Take pos out of the hashes, while its name and id are still the ones it
+ * was hashed under. */
+static void ptable_hash_remove(int pos)
+{
+  if (player_table[pos].name)
+    ptable_unlink(&ptable_name_head[ptable_name_hash(player_table[pos].name)], ptable_name_next, pos);
+  ptable_unlink(&ptable_id_head[ptable_id_hash(player_table[pos].id)], ptable_id_next, pos);
+}
+
+static void free_ptable_hash(void)
+{
+  if (ptable_name_head)
+    free(ptable_name_head);
+  if (ptable_name_next)
+    free(ptable_name_next);
+  if (ptable_id_head)
+    free(ptable_id_head);
+  if (ptable_id_next)
+    free(ptable_id_next);
+  ptable_name_head = ptable_name_next = ptable_id_head = ptable_id_next = NULL;
+  ptable_buckets = 0;
+}
+
+/* (Re)build the hashes for everything in player_table[], with room for it to
+ * double before they have to be built again. */
+void index_player_table(void)
+{
+  int i, entries = top_of_p_table + 1;
+
+  free_ptable_hash();
+
+  for (ptable_buckets = 64; ptable_buckets < entries * 2; ptable_buckets <<= 1)
+    ;
+
+  CREATE(ptable_name_head, int, ptable_buckets);
+  CREATE(ptable_name_next, int, ptable_buckets);
+  CREATE(ptable_id_head, int, ptable_buckets);
+  CREATE(ptable_id_next, int, ptable_buckets);
+
+  for (i = 0; i < ptable_buckets; i++)
+    ptable_name_head[i] = ptable_id_head[i] = -1;
+
+  for (i = 0; i < entries; i++)
+    ptable_hash_add(i);
+}
+
 /* New version to build player index for ASCII Player Files. Generate index
  * table for the player file. */
 void build_player_index(void)
@@ -153,6 +259,8 @@ void build_player_index(void)
 
   fclose(plr_index);
   top_of_p_file = top_of_p_table = i - 1;
+
+  index_player_table();
 }
 
 /* Create a new entry in the in-memory index table for the player file. If the
@@ -173,13 +281,15 @@ int create_entry(char *name)
 
     RECREATE(player_table, struct player_index_element, i);
     pos = top_of_p_table;
+    memset(&player_table[pos], 0, sizeof(struct player_index_element));
   }
 
-  CREATE(player_table[pos].name, char, strlen(name) + 1);
+  /* outgrown the room in the hashes */
+  if (top_of_p_table >= ptable_buckets)
+    index_player_table();
 
   /* copy lowercase equivalent of name to table field */
-  for (i = 0; (player_table[pos].name[i] = LOWER(name[i])); i++)
-    /* Nothing */;
+  set_player_index_name(pos, name);
 
   /* clear the bitflag and clan in case we have garbage data */
   player_table[pos].flags = 0;
@@ -188,6 +298,36 @@ int create_entry(char *name)
   return (pos);
 }
 
+/* Give the entry at pos a new name or id.  Anything that changes either has
+ * to come through here, to keep the hashes right. */
+void set_player_index_name(int pos, const char *name)
+{
+  int i;
+
+  if (pos < 0 || pos > top_of_p_table)
+    return;
+
+  ptable_hash_remove(pos);
+
+  if (player_table[pos].name)
+    free(player_table[pos].name);
+  CREATE(player_table[pos].name, char, strlen(name) + 1);
+  for (i = 0; (player_table[pos].name[i] = LOWER(name[i])); i++)
+    /* Nothing */;
+
+  ptable_hash_add(pos);
+}
+
+void set_player_index_id(int pos, long id)
+{
+  if (pos < 0 || pos > top_of_p_table)
+    return;
+
+  ptable_hash_remove(pos);
+  player_table[pos].id = id;
+  ptable_hash_add(pos);
+}
+
 /* Remove an entry from the in-memory player index table.               *
  * Requires the 'pos' value returned by the get_ptable_by_name function */
 void remove_player_from_index(int pos)
@@ -223,6 +363,9 @@ void remove_player_from_index(int pos)
     free(player_table);
     player_table = NULL;
   }
+
+  /* everything after pos moved down one */
+  index_player_table();
 }
 
 /* This function necessary to save a separate ASCII player index */
@@ -230,14 +373,16 @@ void save_player_index(void)
 {
   int i = 0;
   char index_name[50] = {'\0'}, bits[64] = {'\0'};
+  struct file_job *job;
   FILE *index_file;
 
   snprintf(index_name, sizeof(index_name), "%s%s", LIB_PLRFILES, INDEX_FILE);
-  if (!(index_file = fopen(index_name, "w")))
+  if (!(job = file_job_new(index_name)))
   {
     log("SYSERR: Could not write player index file");
     return;
   }
+  index_file = file_job_fp(job);
 
   for (i = 0; i <= top_of_p_table; i++)
     if (*player_table[i].name)
@@ -258,7 +403,7 @@ void save_player_index(void)
     }
   fprintf(index_file, "~\n");
 
-  fclose(index_file);
+  file_job_write(job);
 }
 
 void free_player_index(void)
@@ -275,39 +420,58 @@ void free_player_index(void)
   free(player_table);
   player_table = NULL;
   top_of_p_table = 0;
+
+  free_ptable_hash();
 }
 
+/* A name can be in the table more than once, and the first one has always
+ * been the one that counts. */
 long get_ptable_by_name(const char *name)
 {
-  int i;
+  int i, found = -1;
 
-  for (i = 0; i <= top_of_p_table; i++)
-    if (!str_cmp(player_table[i].name, name))
-      return (i);
+  if (!ptable_buckets || !name)
+    return (-1);
+
+  for (i = ptable_name_head[ptable_name_hash(name)]; i >= 0; i = ptable_name_next[i])
+    if (!str_cmp(player_table[i].name, name) && (found < 0 || i < found))
+      found = i;
+
+  return (found);
+}
+
+long get_ptable_by_id(long id)
+{
+  int i, found = -1;
+
+  if (!ptable_buckets)
+    return (-1);
+
+  for (i = ptable_id_head[ptable_id_hash(id)]; i >= 0; i = ptable_id_next[i])
+    if (player_table[i].id == id && (found < 0 || i < found))
+      found = i;
 
-  return (-1);
+  return (found);
 }
 
 long get_id_by_name(const char *name)
 {
-  int i;
+  long i;
 
-  for (i = 0; i <= top_of_p_table; i++)
-    if (!str_cmp(player_table[i].name, name))
-      return (player_table[i].id);
+  if ((i = get_ptable_by_name(name)) < 0)
+    return (-1);
 
-  return (-1);
+  return (player_table[i].id);
 }
 
 char *get_name_by_id(long id)
 {
-  int i;
+  long i;
 
-  for (i = 0; i <= top_of_p_table; i++)
-    if (player_table[i].id == id)
-      return (player_table[i].name);
+  if ((i = get_ptable_by_id(id)) < 0)
+    return (NULL);
 
-  return (NULL);
+  return (player_table[i].name);
 }
 
 /* Stuff related to the save/load player system. */
@@ -330,6 +494,7 @@ int load_char(const char *name, struct char_data *ch)
   {
     if (!get_filename(filename, sizeof(filename), PLR_FILE, player_table[id].name))
       return (-1);
+    file_worker_wait(filename);
     if (!(fl = fopen(filename, "r")))
     {
       mudlog(NRM, LVL_STAFF, TRUE, "SYSERR: Couldn't open player file %s", filename);
@@ -1018,7 +1183,7 @@ int load_char(const char *name, struct char_data *ch)
           {
             t = read_trigger(t_rnum);
             if (!SCRIPT(ch))
-              CREATE(SCRIPT(ch), struct script_data, 1);
+              SCRIPT(ch) = new_script(ch, MOB_TRIGGER);
             add_trigger(SCRIPT(ch), t, -1);
           }
         }
@@ -1088,126 +1253,18 @@ int load_char(const char *name, struct char_data *ch)
   return (id);
 }
 
-/* Write the vital data of a player to the player file. */
-
-/* This is the ASCII Player Files save routine. */
-void save_char(struct char_data *ch, int mode)
+/* Writes the player file of ch, which has to hold the raw stats already:
+ * see save_char(). */
+static void write_char_file(FILE *fl, struct char_data *ch, int mode)
 {
-  FILE *fl;
-  char filename[40] = {'\0'}, buf[MAX_STRING_LENGTH] = {'\0'},
+  char buf[MAX_STRING_LENGTH] = {'\0'},
        bits[127] = {'\0'}, bits2[127] = {'\0'},
        bits3[127] = {'\0'}, bits4[127] = {'\0'};
-  int i = 0, j = 0, id = 0, save_index = FALSE;
+  int i = 0, j = 0;
   struct affected_type *aff = NULL;
-  struct affected_type tmp_aff[MAX_AFFECT] = {
-      {0}};
-  struct damage_reduction_type *tmp_dr = NULL, *cur_dr = NULL;
-  struct obj_data *char_eq[NUM_WEARS] = {NULL};
   trig_data *t = NULL;
   struct mud_event_data *pMudEvent = NULL;
 
-  if (IS_NPC(ch) || GET_PFILEPOS(ch) < 0)
-    return;
-
-  /* If ch->desc is not null, then update session data before saving. */
-  if (ch->desc)
-  {
-    if (ch->desc->host && *ch->desc->host)
-    {
-      if (!GET_HOST(ch))
-        GET_HOST(ch) = strdup(ch->desc->host);
-      else if (GET_HOST(ch) && strcmp(GET_HOST(ch), ch->desc->host))
-      {
-        free(GET_HOST(ch));
-        GET_HOST(ch) = strdup(ch->desc->host);
-      }
-    }
-
-    /* Only update the time.played and time.logon if the character is playing. */
-    if (STATE(ch->desc) == CON_PLAYING)
-    {
-      ch->player.time.played += time(0) - ch->player.time.logon;
-      ch->player.time.logon = time(0);
-    }
-  }
-
-  /* any problems with file handling? */
-  if (!get_filename(filename, sizeof(filename), PLR_FILE, GET_NAME(ch)))
-    return;
-  if (!(fl = fopen(filename, "w")))
-  {
-    mudlog(NRM, LVL_STAFF, TRUE, "SYSERR: Couldn't open player file %s for write", filename);
-    return;
-  }
-
-  /* Unaffect everything a character can be affected by. */
-  for (i = 0; i < NUM_WEARS; i++)
-  {
-    if (GET_EQ(ch, i))
-    {
-      char_eq[i] = unequip_char(ch, i);
-#ifndef NO_EXTRANEOUS_TRIGGERS
-      remove_otrigger(char_eq[i], ch);
-#endif
-    }
-    else
-      char_eq[i] = NULL;
-  }
-
-  for (aff = ch->affected, i = 0; i < MAX_AFFECT; i++)
-  {
-    if (aff)
-    {
-      tmp_aff[i] = *aff;
-      for (j = 0; j < AF_ARRAY_MAX; j++)
-        tmp_aff[i].bitvector[j] = aff->bitvector[j];
-      tmp_aff[i].next = 0;
-      aff = aff->next;
-    }
-    else
-    {
-      new_affect(&(tmp_aff[i]));
-      tmp_aff[i].next = 0;
-    }
-  }
-
-  /* Save off the dr since that is attached to affects (i.e. stoneskin will
-   * create a dr structure that is loosely coupled to the affect for the spell.
-   * If the spell affect is removed, however, the stoneskin dr is dropped.)
-   * This only counts for dr where spell is != 0. */
-  if (ch && GET_DR(ch) != NULL)
-  {
-    for (cur_dr = GET_DR(ch); cur_dr != NULL; cur_dr = cur_dr->next)
-    {
-      if (cur_dr->spell != 0)
-      {
-
-        struct damage_reduction_type *tmp;
-
-        CREATE(tmp, struct damage_reduction_type, 1);
-        *tmp = *cur_dr;
-        tmp->next = tmp_dr;
-        tmp_dr = tmp;
-      }
-    }
-  }
-
-  /* Remove the affections so that the raw values are stored; otherwise the
-   * effects are doubled when the char logs back in. */
-
-  while (ch->affected)
-    affect_remove(ch, ch->affected);
-
-  if ((i >= MAX_AFFECT) && aff && aff->next)
-    log("SYSERR: WARNING: OUT OF STORE ROOM FOR AFFECTED TYPES!!!");
-
-  ch->aff_abils = ch->real_abils;
-  reset_char_points(ch);
-
-  /* Make sure size doesn't go over/under caps */
-
-  /* end char_to_store code */
-
   if (GET_NAME(ch))
     fprintf(fl, "Name: %s\n", GET_NAME(ch));
   if (GET_PASSWD(ch))
@@ -1766,122 +1823,121 @@ void save_char(struct char_data *ch, int mode)
     /* Save events */
     /* Not going to save every event */
     fprintf(fl, "Evnt:\n");
-    /* Order:  Event-ID   Duration */
+    /* Order:  Event-ID   Duration   Variables */
     /* eSTRUGGLE - don't need to save this */
     if ((pMudEvent = char_has_mud_event(ch, eINVISIBLE_ROGUE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eVANISHED)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eVANISH)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eTAUNT)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eTAUNTED)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eINTIMIDATED)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eINTIMIDATE_COOLDOWN)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eRAGE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSACRED_FLAMES)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eINNER_FIRE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eMUTAGEN)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eCRIPPLING_CRITICAL)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eDEFENSIVE_STANCE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eCRYSTALFIST)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eCRYSTALBODY)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSLA_STRENGTH)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSLA_ENLARGE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSLA_INVIS)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSLA_LEVITATE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSLA_DARKNESS)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSLA_FAERIE_FIRE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eLAYONHANDS)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eEMPTYBODY)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eWHOLENESSOFBODY)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eRENEWEDDEFENSE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eRENEWEDVIGOR)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eTREATINJURY)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eMUMMYDUST)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eDRAGONKNIGHT)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eGREATERRUIN)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eHELLBALL)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eEPICMAGEARMOR)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eEPICWARDING)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eDEATHARROW)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eQUIVERINGPALM)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eANIMATEDEAD)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSTUNNINGFIST)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSUPRISE_ACCURACY)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eCOME_AND_GET_ME)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, ePOWERFUL_BLOW)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eD_ROLL)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eLAST_WORD)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, ePURIFY)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eC_ANIMAL)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eC_FAMILIAR)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eC_MOUNT)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eTURN_UNDEAD)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eSPELLBATTLE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eQUEST_COMPLETE)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eDRACBREATH)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eDRACCLAWS)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     if ((pMudEvent = char_has_mud_event(ch, eARCANEADEPT)))
-      fprintf(fl, "%d %ld\n", pMudEvent->iId, event_time(pMudEvent->pEvent));
+      save_event(fl, pMudEvent);
     fprintf(fl, "-1 -1\n");
   }
 
   /* Save affects */
-  if (tmp_aff[0].spell > 0)
+  if (ch->affected && ch->affected->spell > 0)
   {
     fprintf(fl, "Affs:\n");
-    for (i = 0; i < MAX_AFFECT; i++)
+    for (aff = ch->affected, i = 0; aff && i < MAX_AFFECT; aff = aff->next, i++)
     {
-      aff = &tmp_aff[i];
       if (aff->spell)
         fprintf(fl,
                 "%d %d %d %d %d %d %d %d %d %d\n",
@@ -1897,27 +1953,33 @@ void save_char(struct char_data *ch, int mode)
                 aff->specific);
     }
     fprintf(fl, "0 0 0 0 0 0 0 0 0 0\n");
+
+    if (aff)
+      log("SYSERR: WARNING: OUT OF STORE ROOM FOR AFFECTED TYPES!!!");
   }
 
   /* Save Damage Reduction */
-  if ((tmp_dr != NULL) || (GET_DR(ch) != NULL))
+  if (GET_DR(ch) != NULL)
   {
     struct damage_reduction_type *dr;
     int k = 0;
 
     fprintf(fl, "DmgR:\n");
-    /* DR from affects...*/
-    for (dr = tmp_dr; dr != NULL; dr = dr->next)
+    /* DR from affects (i.e. stoneskin) first, then permanent DR. */
+    for (dr = GET_DR(ch); dr != NULL; dr = dr->next)
     {
+      if (dr->spell == 0)
+        continue;
       fprintf(fl, "1 %d %d %d %d\n", dr->amount, dr->max_damage, dr->spell, dr->feat);
       for (k = 0; k < MAX_DR_BYPASS; k++)
       {
         fprintf(fl, "%d %d\n", dr->bypass_cat[k], dr->bypass_val[k]);
       }
     }
-    /* Permanent DR. */
     for (dr = GET_DR(ch); dr != NULL; dr = dr->next)
     {
+      if (dr->spell != 0)
+        continue;
       fprintf(fl, "1 %d %d %d %d\n", dr->amount, dr->max_damage, dr->spell, dr->feat);
       for (k = 0; k < MAX_DR_BYPASS; k++)
       {
@@ -1929,6 +1991,62 @@ void save_char(struct char_data *ch, int mode)
 
   write_aliases_ascii(fl, ch);
   save_char_vars_ascii(fl, ch);
+}
+
+/* Write the vital data of a player to the player file. */
+
+/* This is the ASCII Player Files save routine.  The file is built in memory
+ * and written by the file writer, see file_worker.h. */
+void save_char(struct char_data *ch, int mode)
+{
+  char filename[40] = {'\0'};
+  int i = 0, id = 0, save_index = FALSE;
+  struct char_data raw;
+  struct file_job *job = NULL;
+
+  if (IS_NPC(ch) || GET_PFILEPOS(ch) < 0)
+    return;
+
+  /* If ch->desc is not null, then update session data before saving. */
+  if (ch->desc)
+  {
+    if (ch->desc->host && *ch->desc->host)
+    {
+      if (!GET_HOST(ch))
+        GET_HOST(ch) = strdup(ch->desc->host);
+      else if (GET_HOST(ch) && strcmp(GET_HOST(ch), ch->desc->host))
+      {
+        free(GET_HOST(ch));
+        GET_HOST(ch) = strdup(ch->desc->host);
+      }
+    }
+
+    /* Only update the time.played and time.logon if the character is playing. */
+    if (STATE(ch->desc) == CON_PLAYING)
+    {
+      ch->player.time.played += time(0) - ch->player.time.logon;
+      ch->player.time.logon = time(0);
+    }
+  }
+
+  /* any problems with file handling? */
+  if (!get_filename(filename, sizeof(filename), PLR_FILE, GET_NAME(ch)))
+    return;
+  if (!(job = file_job_new(filename)))
+  {
+    mudlog(NRM, LVL_STAFF, TRUE, "SYSERR: Couldn't open player file %s for write", filename);
+    return;
+  }
+
+  /* The file keeps the raw stats, without what equipment and affects add,
+   * otherwise the effects are doubled when the char logs back in.  Work
+   * them out on a copy, so the character is never unequipped or stripped of
+   * its affects (and no wear or remove triggers fire) to be saved. */
+  raw = *ch;
+  affect_total_sub(&raw);
+
+  write_char_file(file_job_fp(job), &raw, mode);
+  file_job_write(job);
 
   /* Save account data
      Trying this before file gets closed, before use to be
@@ -1949,46 +2067,6 @@ void save_char(struct char_data *ch, int mode)
     save_account(ch->desc->account);
   }
 
-  /* FILE CLOSED!!! */
-  fclose(fl);
-
-  /* add affects, dr, etc back in */
-
-  /* More char_to_store code to add spell and eq affections back in. */
-  for (i = 0; i < MAX_AFFECT; i++)
-  {
-    if (tmp_aff[i].spell)
-      affect_to_char(ch, &tmp_aff[i]);
-  }
-
-  /* Reapply dr.*/
-  if (tmp_dr != NULL)
-  {
-    tmp_dr->next = GET_DR(ch);
-    GET_DR(ch) = tmp_dr;
-  }
-
-  // This will prevent things like item special abilities that send messages to the character
-  // when they equip it, since equipment is removed then re-equipped when saving character
-  ch->mute_equip_messages = TRUE;
-
-  for (i = 0; i < NUM_WEARS; i++)
-  {
-    if (char_eq[i])
-#ifndef NO_EXTRANEOUS_TRIGGERS
-      if (wear_otrigger(char_eq[i], ch, i))
-#endif
-        equip_char(ch, char_eq[i], i);
-#ifndef NO_EXTRANEOUS_TRIGGERS
-      else
-        obj_to_char(char_eq[i], ch);
-#endif
-  }
-
-  ch->mute_equip_messages = FALSE;
-
-  /* end char_to_store code */
-
   if ((id = get_ptable_by_name(GET_NAME(ch))) < 0)
     return;
 
@@ -2056,7 +2134,10 @@ void remove_player(int pfilepos)
   for (i = 0; i < MAX_FILES; i++)
   {
     if (get_filename(filename, sizeof(filename), i, player_table[pfilepos].name))
+    {
+      file_worker_wait(filename);
       unlink(filename);
+    }
   }
 
   log("PCLEAN: %s Lev: %d Last: %s",
@@ -2599,18 +2680,37 @@ void load_skill_focus(FILE *fl, struct char_data *ch)
   } while (skill != -1);
 }
 
+/* Events are saved as "id duration var0 var1 var2 var3".  Older files only
+ * have "id duration", in which case the variables are left at zero. */
+static void save_event(FILE *fl, struct mud_event_data *pMudEvent)
+{
+  fprintf(fl, "%d %ld %d %d %d %d\n", pMudEvent->iId, event_time(pMudEvent->pEvent),
+          pMudEvent->iVars[0], pMudEvent->iVars[1], pMudEvent->iVars[2], pMudEvent->iVars[3]);
+}
+
 static void load_events(FILE *fl, struct char_data *ch)
 {
-  int num = 0;
+  struct mud_event_data *pMudEvent = NULL;
+  int num = 0, fields = 0;
   long num2 = 0;
+  int vars[NUM_EVENT_VARS];
   char line[MAX_INPUT_LENGTH + 1];
 
   do
   {
     get_line(fl, line);
-    sscanf(line, "%d %ld", &num, &num2);
+    memset(vars, 0, sizeof(vars));
+    fields = sscanf(line, "%d %ld %d %d %d %d", &num, &num2, &vars[0], &vars[1], &vars[2], &vars[3]);
     if (num != -1)
-      attach_mud_event(new_mud_event(num, ch, NULL), num2);
+    {
+      /* Old files never saved daily-use counts, have one use come back. */
+      if (fields <= 2 && mud_event_index[num].func == event_daily_use_cooldown)
+        vars[0] = 1;
+
+      pMudEvent = new_mud_event(num, ch, NULL);
+      memcpy(pMudEvent->iVars, vars, sizeof(pMudEvent->iVars));
+      attach_mud_event(pMudEvent, num2);
+    }
   } while (num != -1);
 }
 
@@ -2685,6 +2785,8 @@ static void read_aliases_ascii(FILE *file, struct char_data *ch, int count)
 {
   int i;
 
+  free_alias_index(ch);
+
   if (count == 0)
   {
     GET_ALIASES(ch) = NULL;
@@ -2722,11 +2824,12 @@ static void read_aliases_ascii(FILE *file, struct char_data *ch, int count)
   }
 }
 
+/* One UPDATE for everyone online, run by the db worker.  If last minute's is
+ * somehow still queued it is replaced. */
 void update_player_last_on(void)
 {
-
   struct descriptor_data *d = NULL;
-  char buf[2048]; /* For MySQL insert. */
+  struct db_job *job = NULL;
 
   for (d = descriptor_list; d; d = d->next)
   {
@@ -2734,14 +2837,15 @@ void update_player_last_on(void)
     if (!d || !d->character)
       continue;
 
-    snprintf(buf, sizeof(buf), "UPDATE player_data SET last_online = NOW() "
-                               "WHERE name = '%s';",
-             GET_NAME(d->character));
-    if (mysql_query(conn, buf))
-    {
-      log("SYSERR: Unable to UPDATE last_online for %s on PLAYER_DATA: %s", GET_NAME(d->character), mysql_error(conn));
-    }
+    if (!job)
+      job = db_job_new("last_online");
+
+    db_job_add_row(job, "UPDATE player_data SET last_online = NOW() WHERE name IN (", ")",
+                   "'%s'", GET_NAME(d->character));
   }
+
+  if (job)
+    db_job_write(job);
 }
 
 void save_char_pets(struct char_data *ch)
@@ -2749,34 +2853,30 @@ void save_char_pets(struct char_data *ch)
 
   struct follow_type *f = NULL;
   struct char_data *tch = NULL;
-  char query[200];
-
-  mysql_ping(conn);
+  struct db_job *job = NULL;
+  char key[MAX_NAME_LENGTH + 10];
 
-  snprintf(query, sizeof(query), "DELETE FROM pet_data WHERE owner_name='%s'", GET_NAME(ch));
-  if (mysql_query(conn, query))
-  {
-    log("SYSERR: Unable to DELETE from pet_data: %s", mysql_error(conn));
-  }
+  /* Queued on the db worker, a newer save of the same pets replaces it. */
+  snprintf(key, sizeof(key), "pets:%s", GET_NAME(ch));
+  job = db_job_new(key);
 
-  if (!ch || !ch->desc || IS_NPC(ch))
-   return;
+  db_job_add(job, "DELETE FROM pet_data WHERE owner_name='%s'", GET_NAME(ch));
 
-  for (f = ch->followers; f; f = f->next)
+  if (ch->desc && !IS_NPC(ch))
   {
-    tch = f->follower;
-    if (!IS_NPC(tch)) continue;
-    if (!AFF_FLAGGED(tch, AFF_CHARM)) continue;
-    snprintf(query, sizeof(query), "INSERT INTO pet_data (pet_data_id, owner_name, vnum, level, hp, max_hp, str, con, dex, ac) VALUES(NULL,"
-                    "'%s','%d','%d','%d','%d','%d','%d','%d','%d')",
-                    GET_NAME(ch), GET_MOB_VNUM(tch), GET_LEVEL(tch), GET_HIT(tch), GET_REAL_MAX_HIT(tch),
-                    GET_REAL_STR(tch), GET_REAL_CON(tch), GET_REAL_DEX(tch), GET_REAL_AC(tch));
-    if (mysql_query(conn, query))
+    for (f = ch->followers; f; f = f->next)
     {
-      log("SYSERR: Unable to INSERT INTO pet_data: %s", mysql_error(conn));
-      return;
+      tch = f->follower;
+      if (!IS_NPC(tch)) continue;
+      if (!AFF_FLAGGED(tch, AFF_CHARM)) continue;
+      db_job_add_row(job, "INSERT INTO pet_data (pet_data_id, owner_name, vnum, level, hp, max_hp, str, con, dex, ac) VALUES ", "",
+                     "(NULL,'%s','%d','%d','%d','%d','%d','%d','%d','%d')",
+                     GET_NAME(ch), GET_MOB_VNUM(tch), GET_LEVEL(tch), GET_HIT(tch), GET_REAL_MAX_HIT(tch),
+                     GET_REAL_STR(tch), GET_REAL_CON(tch), GET_REAL_DEX(tch), GET_REAL_AC(tch));
     }
   }
+
+  db_job_write(job);
 }
 
 void load_char_pets(struct char_data *ch)
@@ -2790,6 +2890,9 @@ void load_char_pets(struct char_data *ch)
 
   if (IN_ROOM(ch) == NOWHERE) return;
 
+  /* a save of these pets may still be waiting on the db worker */
+  db_worker_flush();
+
   mysql_ping(conn);
 
   snprintf(query, sizeof(query), "SELECT vnum, level, hp, max_hp, str, con, dex, ac FROM pet_data WHERE owner_name='%s'", GET_NAME(ch));
@@ -0,0 +1,276 @@
+/* *************************************************************************
+ *   File: poller.c                                    Part of LuminariMUD *
+ *  Usage: Socket readiness poller, epoll with a poll() fallback.          *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "poller.h"
+
+#if defined(HAVE_SYS_EPOLL_H)
+#include <sys/epoll.h>
+#define POLLER_EPOLL
+#elif defined(HAVE_POLL_H)
+#include <poll.h>
+#define POLLER_POLL
+#else
+#error "poller.c needs epoll or poll()"
+#endif
+
+/*
+ * game_loop() used to put every descriptor in three fd_sets and select() on
+ * them each pulse, so an idle connection cost as much as a busy one and we
+ * could not go past FD_SETSIZE.  Here sockets are registered once and a wait
+ * only returns the ready ones.
+ *
+ * Nobody asks for writability: sockets are nearly always writable, so
+ * asking would wake us for every one of them.  Output is just written and a
+ * full send buffer shows up as EWOULDBLOCK, which process_output() handles.
+ */
+
+/* What each registered fd was registered with, indexed by fd. */
+static void **fd_data = NULL;
+static int fd_data_size = 0;
+static int registered = 0;
+
+/* Ready sockets from the last wait. */
+static struct poller_event *ready = NULL;
+static int ready_size = 0;
+static int num_ready = 0;
+static int ready_pos = 0;
+
+static unsigned long waits = 0;
+static unsigned long events_seen = 0;
+
+#if defined(POLLER_EPOLL)
+static int epoll_fd = -1;
+static struct epoll_event *epoll_events = NULL;
+#else
+/* poll() wants one array of every socket, pfd_index[fd] is fd's slot in it. */
+static struct pollfd *pfds = NULL;
+static int *pfd_index = NULL;
+static int pfds_size = 0;
+#endif
+
+static void grow_fd_tables(int fd)
+{
+  int old = fd_data_size, i;
+
+  if (fd < fd_data_size)
+    return;
+
+  fd_data_size = MAX(fd + 1, MAX(64, fd_data_size * 2));
+  RECREATE(fd_data, void *, fd_data_size);
+  for (i = old; i < fd_data_size; i++)
+    fd_data[i] = NULL;
+
+#if defined(POLLER_POLL)
+  RECREATE(pfd_index, int, fd_data_size);
+  for (i = old; i < fd_data_size; i++)
+    pfd_index[i] = -1;
+#endif
+}
+
+/* make sure the ready list can hold every registered socket */
+static void grow_ready(void)
+{
+  if (registered <= ready_size)
+    return;
+
+  ready_size = MAX(registered, MAX(64, ready_size * 2));
+  RECREATE(ready, struct poller_event, ready_size);
+#if defined(POLLER_EPOLL)
+  RECREATE(epoll_events, struct epoll_event, ready_size);
+#endif
+}
+
+int poller_init(void)
+{
+#if defined(POLLER_EPOLL)
+  /* close on exec, or copyover would leak it into the new process */
+  if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+  {
+    perror("SYSERR: epoll_create1");
+    return (-1);
+  }
+  log("Socket poller: epoll.");
+#else
+  log("Socket poller: poll().");
+#endif
+
+  return (0);
+}
+
+int poller_add(socket_t fd, void *data)
+{
+  if (fd < 0)
+    return (-1);
+
+  grow_fd_tables(fd);
+
+#if defined(POLLER_EPOLL)
+  {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLPRI;
+    ev.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+      perror("SYSERR: epoll_ctl(ADD)");
+      return (-1);
+    }
+  }
+#else
+  if (pfd_index[fd] >= 0)
+    return (-1);
+
+  if (registered >= pfds_size)
+  {
+    pfds_size = MAX(64, pfds_size * 2);
+    RECREATE(pfds, struct pollfd, pfds_size);
+  }
+
+  pfds[registered].fd = fd;
+  pfds[registered].events = POLLIN | POLLPRI;
+  pfds[registered].revents = 0;
+  pfd_index[fd] = registered;
+#endif
+
+  fd_data[fd] = data;
+  registered++;
+  grow_ready();
+
+  return (0);
+}
+
+void poller_remove(socket_t fd)
+{
+  int i;
+
+  if (fd < 0 || fd >= fd_data_size)
+    return;
+
+#if defined(POLLER_EPOLL)
+  /* closing the socket would drop it as well, unless it was dup()ed */
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL) < 0)
+    return;
+#else
+  if ((i = pfd_index[fd]) < 0)
+    return;
+
+  /* move the last one into the hole */
+  pfds[i] = pfds[registered - 1];
+  pfd_index[pfds[i].fd] = i;
+  pfd_index[fd] = -1;
+#endif
+
+  fd_data[fd] = NULL;
+  registered--;
+
+  /* it may still be waiting its turn in this pulse's ready list */
+  for (i = ready_pos; i < num_ready; i++)
+    if (ready[i].fd == fd)
+      ready[i].events = 0;
+}
+
+int poller_wait(int timeout_ms)
+{
+  int n, i, events;
+
+  num_ready = ready_pos = 0;
+  waits++;
+
+  if (registered == 0)
+    return (0);
+
+#if defined(POLLER_EPOLL)
+  if ((n = epoll_wait(epoll_fd, epoll_events, ready_size, timeout_ms)) < 0)
+    return (errno == EINTR ? 0 : -1);
+
+  for (i = 0; i < n; i++)
+  {
+    events = 0;
+    if (epoll_events[i].events & (EPOLLIN | EPOLLHUP))
+      events |= POLLER_READ;
+    if (epoll_events[i].events & (EPOLLPRI | EPOLLERR))
+      events |= POLLER_ERROR;
+
+    ready[num_ready].fd = epoll_events[i].data.fd;
+    ready[num_ready].data = fd_data[epoll_events[i].data.fd];
+    ready[num_ready].events = events;
+    num_ready++;
+  }
+#else
+  if ((n = poll(pfds, registered, timeout_ms)) < 0)
+    return (errno == EINTR ? 0 : -1);
+
+  for (i = 0; i < registered && num_ready < n; i++)
+  {
+    if (!pfds[i].revents)
+      continue;
+
+    events = 0;
+    if (pfds[i].revents & (POLLIN | POLLHUP))
+      events |= POLLER_READ;
+    if (pfds[i].revents & (POLLPRI | POLLERR | POLLNVAL))
+      events |= POLLER_ERROR;
+
+    ready[num_ready].fd = pfds[i].fd;
+    ready[num_ready].data = fd_data[pfds[i].fd];
+    ready[num_ready].events = events;
+    num_ready++;
+  }
+#endif
+
+  events_seen += num_ready;
+
+  return (num_ready);
+}
+
+struct poller_event *poller_next(void)
+{
+  while (ready_pos < num_ready)
+  {
+    if (ready[ready_pos].events)
+      return (&ready[ready_pos++]);
+    ready_pos++;
+  }
+
+  return (NULL);
+}
+
+size_t poller_repr(char *out_buf, size_t n)
+{
+  int len;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  len = snprintf(out_buf, n,
+                 "Socket poller\r\n"
+                 "  Backend    : %s\r\n"
+                 "  Registered : %d\r\n"
+                 "  Waits      : %lu\r\n"
+                 "  Ready/wait : %.2f\r\n",
+#if defined(POLLER_EPOLL)
+                 "epoll",
+#else
+                 "poll()",
+#endif
+                 registered, waits,
+                 (waits ? (double)events_seen / waits : 0.0));
+
+  if (len < 0)
+  {
+    out_buf[0] = '\0';
+    return 0;
+  }
+
+  return MIN(len, (int)n - 1);
+}
@@ -0,0 +1,37 @@
+/* *************************************************************************
+ *   File: poller.h                                    Part of LuminariMUD *
+ *  Usage: Header file for the socket readiness poller.                    *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef POLLER_H
+#define POLLER_H
+
+/* Sockets are registered once when they are opened and removed when they are
+ * closed.  Each poller_wait() then hands back only the sockets that have
+ * something to say, using epoll where we have it and poll() otherwise. */
+
+/* Ready events. */
+#define POLLER_READ (1 << 0)  /* data (or end of file) to read */
+#define POLLER_ERROR (1 << 1) /* error or out-of-band data, drop it */
+
+struct poller_event
+{
+  socket_t fd;
+  void *data;  /* what was passed to poller_add() */
+  int events;  /* POLLER_xxx, 0 once the socket was removed */
+};
+
+int poller_init(void);
+int poller_add(socket_t fd, void *data);
+void poller_remove(socket_t fd);
+/* Wait up to timeout_ms (-1 forever, 0 not at all) for ready sockets,
+ * returns how many or -1 on error. */
+int poller_wait(int timeout_ms);
+/* The next ready socket from the last poller_wait(), NULL when done.
+ * Sockets removed since the wait are skipped. */
+struct poller_event *poller_next(void);
+size_t poller_repr(char *out_buf, size_t n);
+
+#endif /* POLLER_H */
@@ -22,6 +22,7 @@
 #include "dg_scripts.h"
 #include "act.h"
 #include "modify.h"
+#include "mccp.h"
 
 /* Globals */
 const char *RGBone = "F022";
@@ -33,7 +34,7 @@ static void Write(descriptor_t *apDescriptor, const char *apData)
   if (apDescriptor != NULL && apDescriptor->has_prompt)
   {
     if (apDescriptor->pProtocol->WriteOOB > 0 ||
-        *(apDescriptor->output) == '\0')
+        apDescriptor->out_head == NULL)
     {
       apDescriptor->pProtocol->WriteOOB = 2;
     }
@@ -56,24 +57,13 @@ static void InfoMessage(descriptor_t *apDescriptor, const char *apData)
 
 static void CompressStart(descriptor_t *apDescriptor)
 {
-  /* If your mud uses MCCP (Mud Client Compression Protocol), you need to
-   * call whatever function normally starts compression from here - the
-   * ReportBug() call should then be deleted.
-   *
-   * Otherwise you can just ignore this function.
-   */
-  ReportBug("CompressStart() in protocol.c is being called, but it doesn't do anything!\n");
+  if (mccp_start(apDescriptor) < 0)
+    ReportBug("CompressStart() in protocol.c was unable to start compression.\n");
 }
 
 static void CompressEnd(descriptor_t *apDescriptor)
 {
-  /* If your mud uses MCCP (Mud Client Compression Protocol), you need to
-   * call whatever function normally starts compression from here - the
-   * ReportBug() call should then be deleted.
-   *
-   * Otherwise you can just ignore this function.
-   */
-  ReportBug("CompressEnd() in protocol.c is being called, but it doesn't do anything!\n");
+  mccp_end(apDescriptor);
 }
 
 /******************************************************************************
@@ -1055,6 +1045,38 @@ const char *ProtocolOutput(descriptor_t *apDescriptor, const char *apData, int *
   return Result;
 }
 
+int ProtocolOutputClass(descriptor_t *apDescriptor, const char *apData)
+{
+  protocol_t *pProtocol = apDescriptor ? apDescriptor->pProtocol : NULL;
+  struct char_data *ch = apDescriptor ? apDescriptor->character : NULL;
+  int Colour = 0;
+  const char *p;
+
+  if (pProtocol == NULL)
+    return -1;
+
+  /* These tags read and change bBlockMXP, so MXP users get their own. */
+  if (pProtocol->pVariables[eMSDP_MXP]->ValueInt)
+    for (p = strchr(apData, '\t'); p != NULL; p = strchr(p + 1, '\t'))
+      if (p[1] == '<' || p[1] == '(' || p[1] == ')' || p[1] == '[')
+        return -1;
+
+  /* The same tests as ColourRGB() */
+  if (ch && !IS_NPC(ch) && !IS_SET_AR(PRF_FLAGS(ch), PRF_COLOR_1) &&
+      !IS_SET_AR(PRF_FLAGS(ch), PRF_COLOR_2))
+    Colour = 0;
+  else if (!pProtocol->pVariables[eMSDP_ANSI_COLORS]->ValueInt)
+    Colour = 0;
+  else if (pProtocol->pVariables[eMSDP_XTERM_256_COLORS]->ValueInt)
+    Colour = 2;
+  else
+    Colour = 1;
+
+  return Colour +
+         (pProtocol->pVariables[eMSDP_UTF_8]->ValueInt ? 3 : 0) +
+         (pProtocol->bMSP || pProtocol->pVariables[eMSDP_SOUND]->ValueInt ? 6 : 0);
+}
+
 /* Some clients (such as GMud) don't properly handle negotiation, and simply
  * display every printable character to the screen.  However TTYPE isn't a
  * printable character, so we negotiate for it first, and only negotiate for
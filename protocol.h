@@ -44,9 +44,7 @@ typedef struct descriptor_data descriptor_t;
  If your mud supports MCCP (compression), uncomment the next line.
  ******************************************************************************/
 
-/*
 #define USING_MCCP
-*/
 
 /******************************************************************************
  If your offer a Mudlet GUI for autoinstallation, put the path/filename here.
@@ -62,7 +60,7 @@ typedef struct descriptor_data descriptor_t;
 
 #define MAX_PROTOCOL_BUFFER MAX_RAW_INPUT_LENGTH
 #define MAX_VARIABLE_LENGTH 4096
-#define MAX_OUTPUT_BUFFER LARGE_BUFSIZE
+#define MAX_OUTPUT_BUFFER (MAX_STRING_LENGTH * 2)
 #define MAX_MSSP_BUFFER 4096
 
 #define SEND 1
@@ -402,6 +400,17 @@ ssize_t ProtocolInput(descriptor_t *apDescriptor, char *apData, int aSize, char
  */
 const char *ProtocolOutput(descriptor_t *apDescriptor, const char *apData, int *apLength);
 
+/* Function: ProtocolOutputClass
+ *
+ * Descriptors with the same class get the same result from ProtocolOutput()
+ * for apData, so a message for many descriptors only has to go through it
+ * once per class.  Returns a number below PROTOCOL_OUTPUT_CLASSES, or -1 if
+ * the result for this descriptor can't be shared (no protocol data, or MXP
+ * tags in apData for a client using MXP, as those change its state).
+ */
+#define PROTOCOL_OUTPUT_CLASSES 12
+int ProtocolOutputClass(descriptor_t *apDescriptor, const char *apData);
+
 /******************************************************************************
  Copyover save/load functions.
  ******************************************************************************/
@@ -485,13 +485,12 @@ void generic_complete_quest(struct char_data *ch)
   else if (GET_QUEST(ch) != NOTHING)
   {
     struct mud_event_data *pMudEvent = NULL;
-    char buf[128] = {'\0'};
     qst_vnum event_quest_num = NOTHING;
 
     if ((pMudEvent = char_has_mud_event(ch, eQUEST_COMPLETE)))
     {
       /* grab vnum of quest that is in event */
-      event_quest_num = atoi((char *)pMudEvent->sVariables);
+      event_quest_num = pMudEvent->iVars[0];
 
       /* make sure we do not already have an event for this quest! */
       if (event_quest_num == GET_QUEST(ch))
@@ -502,9 +501,9 @@ void generic_complete_quest(struct char_data *ch)
       }
     }
 
-    /* we should be in the clear to tag this player with a completed quest */
-    snprintf(buf, sizeof(buf), "%d", GET_QUEST(ch)); /* sending vnum to event of quest */
-    attach_mud_event(new_mud_event(eQUEST_COMPLETE, ch, buf), 1);
+    /* we should be in the clear to tag this player with a completed quest,
+       sending vnum to event of quest */
+    attach_mud_event(new_mud_event_var(eQUEST_COMPLETE, ch, GET_QUEST(ch)), 1);
   }
 }
 
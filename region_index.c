@@ -0,0 +1,496 @@
+/* *************************************************************************
+ *   File: region_index.c                              Part of LuminariMUD *
+ *  Usage: In-memory spatial index for wilderness regions and paths.       *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include <math.h>
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "db.h"
+#include "wilderness.h"
+#include "region_index.h"
+
+/*
+ * Region and path geometry used to live only in MySQL, and every tile of a
+ * wilderness map asked the database which polygons and linestrings contained
+ * it.  The geometry is small and changes rarely, so we keep it in a grid of
+ * buckets instead and do the ST_Within() math ourselves.
+ *
+ * Semantics follow the old queries:
+ *  - A point is within a region if it lies strictly inside the exterior ring,
+ *    points on the ring itself are not within.
+ *  - A point is within a path if it lies on one of its segments, excluding the
+ *    two end points of an open linestring (those are its boundary).
+ */
+
+struct index_bounds
+{
+  int min_x, min_y;
+  int max_x, max_y;
+  double centroid_x, centroid_y;
+};
+
+struct index_cell
+{
+  region_rnum *regions;
+  int num_regions;
+  int max_regions;
+
+  path_rnum *paths;
+  int num_paths;
+  int max_paths;
+};
+
+static struct index_cell index_grid[REGION_INDEX_GRID_SIZE][REGION_INDEX_GRID_SIZE];
+
+static struct index_bounds *region_bounds = NULL;
+static int num_region_bounds = 0;
+
+/* Grid helpers */
+
+static int coord_to_cell(int coord)
+{
+  if (coord < REGION_INDEX_MIN_COORD)
+    coord = REGION_INDEX_MIN_COORD;
+  if (coord > REGION_INDEX_MAX_COORD)
+    coord = REGION_INDEX_MAX_COORD;
+
+  return (coord - REGION_INDEX_MIN_COORD) / REGION_INDEX_CELL_SIZE;
+}
+
+static void cell_add(IDXTYPE **list, int *num, int *max, IDXTYPE rnum)
+{
+  int i;
+
+  /* Entries are added one polygon at a time, so a duplicate can only be
+   * sitting at the tail. */
+  if (*num > 0 && (*list)[*num - 1] == rnum)
+    return;
+
+  if (*num >= *max)
+  {
+    *max = (*max ? *max * 2 : 4);
+    RECREATE(*list, IDXTYPE, *max);
+  }
+
+  /* Keep the bucket sorted so results come out in table order. */
+  for (i = *num; i > 0 && (*list)[i - 1] > rnum; i--)
+    (*list)[i] = (*list)[i - 1];
+
+  (*list)[i] = rnum;
+  (*num)++;
+}
+
+static void cell_remove(IDXTYPE *list, int *num, IDXTYPE rnum)
+{
+  int i, j;
+
+  for (i = 0; i < *num; i++)
+  {
+    if (list[i] == rnum)
+    {
+      for (j = i + 1; j < *num; j++)
+        list[j - 1] = list[j];
+      (*num)--;
+      return;
+    }
+  }
+}
+
+static struct index_cell *cell_at(int x, int y)
+{
+  return &index_grid[coord_to_cell(x)][coord_to_cell(y)];
+}
+
+/* Geometry helpers, all exact integer math where it matters. */
+
+static bool point_on_segment(int px, int py, const struct vertex *a, const struct vertex *b)
+{
+  long long cross;
+
+  if (px < MIN(a->x, b->x) || px > MAX(a->x, b->x) ||
+      py < MIN(a->y, b->y) || py > MAX(a->y, b->y))
+    return FALSE;
+
+  cross = (long long)(b->x - a->x) * (py - a->y) - (long long)(b->y - a->y) * (px - a->x);
+
+  return (cross == 0);
+}
+
+static double point_segment_distance(double px, double py, const struct vertex *a, const struct vertex *b)
+{
+  double dx = b->x - a->x;
+  double dy = b->y - a->y;
+  double len2 = dx * dx + dy * dy;
+  double t = 0;
+
+  if (len2 > 0)
+  {
+    t = ((px - a->x) * dx + (py - a->y) * dy) / len2;
+    t = (t < 0 ? 0 : (t > 1 ? 1 : t));
+  }
+
+  dx = a->x + t * dx - px;
+  dy = a->y + t * dy - py;
+
+  return sqrt(dx * dx + dy * dy);
+}
+
+static void compute_bounds(const struct vertex *vertices, int num_vertices, struct index_bounds *bounds)
+{
+  int i;
+  double area = 0, cx = 0, cy = 0, cross;
+
+  bounds->min_x = bounds->max_x = vertices[0].x;
+  bounds->min_y = bounds->max_y = vertices[0].y;
+
+  for (i = 0; i < num_vertices; i++)
+  {
+    const struct vertex *a = &vertices[i];
+    const struct vertex *b = &vertices[(i + 1) % num_vertices];
+
+    bounds->min_x = MIN(bounds->min_x, a->x);
+    bounds->min_y = MIN(bounds->min_y, a->y);
+    bounds->max_x = MAX(bounds->max_x, a->x);
+    bounds->max_y = MAX(bounds->max_y, a->y);
+
+    cross = (double)a->x * b->y - (double)b->x * a->y;
+    area += cross;
+    cx += (a->x + b->x) * cross;
+    cy += (a->y + b->y) * cross;
+  }
+
+  if (area != 0)
+  {
+    bounds->centroid_x = cx / (3.0 * area);
+    bounds->centroid_y = cy / (3.0 * area);
+  }
+  else
+  {
+    bounds->centroid_x = (bounds->min_x + bounds->max_x) / 2.0;
+    bounds->centroid_y = (bounds->min_y + bounds->max_y) / 2.0;
+  }
+}
+
+/* Regions */
+
+static struct region_data *valid_region(region_rnum rnum)
+{
+  if (region_table == NULL || rnum > top_of_region_table)
+    return NULL;
+  if (region_table[rnum].vertices == NULL || region_table[rnum].num_vertices < 1)
+    return NULL;
+  return &region_table[rnum];
+}
+
+void region_index_add_region(region_rnum rnum)
+{
+  struct region_data *region;
+  struct index_bounds *bounds;
+  int cx, cy;
+
+  if (!(region = valid_region(rnum)))
+    return;
+
+  if ((int)rnum >= num_region_bounds)
+  {
+    RECREATE(region_bounds, struct index_bounds, rnum + 1);
+    num_region_bounds = rnum + 1;
+  }
+
+  bounds = &region_bounds[rnum];
+  compute_bounds(region->vertices, region->num_vertices, bounds);
+
+  for (cx = coord_to_cell(bounds->min_x); cx <= coord_to_cell(bounds->max_x); cx++)
+    for (cy = coord_to_cell(bounds->min_y); cy <= coord_to_cell(bounds->max_y); cy++)
+      cell_add(&index_grid[cx][cy].regions, &index_grid[cx][cy].num_regions,
+               &index_grid[cx][cy].max_regions, rnum);
+}
+
+void region_index_remove_region(region_rnum rnum)
+{
+  struct index_bounds *bounds;
+  int cx, cy;
+
+  if ((int)rnum >= num_region_bounds)
+    return;
+
+  bounds = &region_bounds[rnum];
+
+  for (cx = coord_to_cell(bounds->min_x); cx <= coord_to_cell(bounds->max_x); cx++)
+    for (cy = coord_to_cell(bounds->min_y); cy <= coord_to_cell(bounds->max_y); cy++)
+      cell_remove(index_grid[cx][cy].regions, &index_grid[cx][cy].num_regions, rnum);
+}
+
+void region_index_build_regions(void)
+{
+  region_rnum i;
+  int cx, cy;
+
+  for (cx = 0; cx < REGION_INDEX_GRID_SIZE; cx++)
+    for (cy = 0; cy < REGION_INDEX_GRID_SIZE; cy++)
+      index_grid[cx][cy].num_regions = 0;
+
+  if (region_table == NULL)
+    return;
+
+  for (i = 0; i <= top_of_region_table; i++)
+    region_index_add_region(i);
+}
+
+bool region_contains_point(region_rnum rnum, int x, int y)
+{
+  struct region_data *region;
+  bool inside = FALSE;
+  int i;
+
+  if (!(region = valid_region(rnum)))
+    return FALSE;
+
+  if ((int)rnum < num_region_bounds &&
+      (x < region_bounds[rnum].min_x || x > region_bounds[rnum].max_x ||
+       y < region_bounds[rnum].min_y || y > region_bounds[rnum].max_y))
+    return FALSE;
+
+  for (i = 0; i < region->num_vertices; i++)
+  {
+    const struct vertex *a = &region->vertices[i];
+    const struct vertex *b = &region->vertices[(i + 1) % region->num_vertices];
+
+    /* On the ring is not within. */
+    if (point_on_segment(x, y, a, b))
+      return FALSE;
+
+    if ((a->y > y) != (b->y > y))
+    {
+      long long lhs = (long long)(x - a->x) * (b->y - a->y);
+      long long rhs = (long long)(b->x - a->x) * (y - a->y);
+
+      if ((b->y > a->y) ? (lhs < rhs) : (lhs > rhs))
+        inside = !inside;
+    }
+  }
+
+  return inside;
+}
+
+/* Classify where (x, y) sits within a region it is known to be inside of,
+ * the same way the old query compared distances to the ring and centroid. */
+static int region_position(region_rnum rnum, int x, int y)
+{
+  struct region_data *region = &region_table[rnum];
+  struct index_bounds *bounds = &region_bounds[rnum];
+  double ring_dist = -1, d, centroid_dist;
+  int i;
+
+  if (x == bounds->centroid_x && y == bounds->centroid_y)
+    return REGION_POS_CENTER;
+
+  for (i = 0; i < region->num_vertices; i++)
+  {
+    d = point_segment_distance(x, y, &region->vertices[i],
+                               &region->vertices[(i + 1) % region->num_vertices]);
+    if (ring_dist < 0 || d < ring_dist)
+      ring_dist = d;
+  }
+
+  centroid_dist = sqrt((x - bounds->centroid_x) * (x - bounds->centroid_x) +
+                       (y - bounds->centroid_y) * (y - bounds->centroid_y));
+
+  if (ring_dist > centroid_dist / 2)
+    return REGION_POS_INSIDE;
+
+  return REGION_POS_EDGE;
+}
+
+struct region_list *get_enclosing_regions(zone_rnum zone, int x, int y)
+{
+  struct region_list *regions = NULL;
+  struct region_list *new_node = NULL;
+  struct index_cell *cell = cell_at(x, y);
+  int i;
+
+  for (i = 0; i < cell->num_regions; i++)
+  {
+    region_rnum rnum = cell->regions[i];
+
+    if (region_table[rnum].zone != zone)
+      continue;
+    if (!region_contains_point(rnum, x, y))
+      continue;
+
+    CREATE(new_node, struct region_list, 1);
+    new_node->rnum = rnum;
+    new_node->pos = region_position(rnum, x, y);
+    new_node->next = regions;
+    regions = new_node;
+    new_node = NULL;
+  }
+
+  return regions;
+}
+
+bool is_point_within_region(region_vnum region, int x, int y)
+{
+  region_rnum rnum = real_region(region);
+
+  if (rnum == NOWHERE)
+    return FALSE;
+
+  return region_contains_point(rnum, x, y);
+}
+
+void free_region_list(struct region_list *regions)
+{
+  struct region_list *next;
+
+  for (; regions; regions = next)
+  {
+    next = regions->next;
+    free(regions);
+  }
+}
+
+/* Paths */
+
+static struct path_data *valid_path(path_rnum rnum)
+{
+  if (path_table == NULL || rnum > top_of_path_table)
+    return NULL;
+  if (path_table[rnum].vertices == NULL || path_table[rnum].num_vertices < 1)
+    return NULL;
+  return &path_table[rnum];
+}
+
+void region_index_add_path(path_rnum rnum)
+{
+  struct path_data *path;
+  int i, cx, cy;
+
+  if (!(path = valid_path(rnum)))
+    return;
+
+  /* Bucket each segment separately, long winding rivers would otherwise
+   * land in every cell of their bounding box. */
+  for (i = 0; i < path->num_vertices; i++)
+  {
+    const struct vertex *a = &path->vertices[i];
+    const struct vertex *b = &path->vertices[(i + 1 < path->num_vertices) ? i + 1 : i];
+
+    for (cx = coord_to_cell(MIN(a->x, b->x)); cx <= coord_to_cell(MAX(a->x, b->x)); cx++)
+      for (cy = coord_to_cell(MIN(a->y, b->y)); cy <= coord_to_cell(MAX(a->y, b->y)); cy++)
+        cell_add(&index_grid[cx][cy].paths, &index_grid[cx][cy].num_paths,
+                 &index_grid[cx][cy].max_paths, rnum);
+  }
+}
+
+void region_index_remove_path(path_rnum rnum)
+{
+  struct path_data *path;
+  int i, cx, cy;
+
+  if (!(path = valid_path(rnum)))
+    return;
+
+  for (i = 0; i < path->num_vertices; i++)
+  {
+    const struct vertex *a = &path->vertices[i];
+    const struct vertex *b = &path->vertices[(i + 1 < path->num_vertices) ? i + 1 : i];
+
+    for (cx = coord_to_cell(MIN(a->x, b->x)); cx <= coord_to_cell(MAX(a->x, b->x)); cx++)
+      for (cy = coord_to_cell(MIN(a->y, b->y)); cy <= coord_to_cell(MAX(a->y, b->y)); cy++)
+        cell_remove(index_grid[cx][cy].paths, &index_grid[cx][cy].num_paths, rnum);
+  }
+}
+
+void region_index_build_paths(void)
+{
+  path_rnum i;
+  int cx, cy;
+
+  for (cx = 0; cx < REGION_INDEX_GRID_SIZE; cx++)
+    for (cy = 0; cy < REGION_INDEX_GRID_SIZE; cy++)
+      index_grid[cx][cy].num_paths = 0;
+
+  if (path_table == NULL)
+    return;
+
+  for (i = 0; i <= top_of_path_table; i++)
+    region_index_add_path(i);
+}
+
+bool path_contains_point(path_rnum rnum, int x, int y)
+{
+  struct path_data *path;
+  const struct vertex *first, *last;
+  int i;
+
+  if (!(path = valid_path(rnum)))
+    return FALSE;
+
+  first = &path->vertices[0];
+  last = &path->vertices[path->num_vertices - 1];
+
+  /* The end points of an open linestring are its boundary, not its interior. */
+  if (first->x != last->x || first->y != last->y)
+  {
+    if ((x == first->x && y == first->y) || (x == last->x && y == last->y))
+      return FALSE;
+  }
+
+  for (i = 0; i + 1 < path->num_vertices; i++)
+    if (point_on_segment(x, y, &path->vertices[i], &path->vertices[i + 1]))
+      return TRUE;
+
+  return FALSE;
+}
+
+struct path_list *get_enclosing_paths(zone_rnum zone, int x, int y)
+{
+  struct path_list *paths = NULL;
+  struct path_list *new_node = NULL;
+  struct index_cell *cell = cell_at(x, y);
+  int i;
+
+  for (i = 0; i < cell->num_paths; i++)
+  {
+    path_rnum rnum = cell->paths[i];
+
+    if (path_table[rnum].zone != zone)
+      continue;
+    if (!path_contains_point(rnum, x, y))
+      continue;
+
+    CREATE(new_node, struct path_list, 1);
+    new_node->rnum = rnum;
+
+    if (path_contains_point(rnum, x, y - 1) && path_contains_point(rnum, x, y + 1))
+      new_node->glyph_type = GLYPH_TYPE_PATH_NS;
+    else if (path_contains_point(rnum, x - 1, y) && path_contains_point(rnum, x + 1, y))
+      new_node->glyph_type = GLYPH_TYPE_PATH_EW;
+    else
+      new_node->glyph_type = GLYPH_TYPE_PATH_INT;
+
+    new_node->next = paths;
+    paths = new_node;
+    new_node = NULL;
+  }
+
+  return paths;
+}
+
+void free_path_list(struct path_list *paths)
+{
+  struct path_list *next;
+
+  for (; paths; paths = next)
+  {
+    next = paths->next;
+    free(paths);
+  }
+}
@@ -0,0 +1,45 @@
+/* *************************************************************************
+ *   File: region_index.h                              Part of LuminariMUD *
+ *  Usage: Header file for the in-memory wilderness region/path index.     *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef REGION_INDEX_H
+#define REGION_INDEX_H
+
+/* The index is a uniform grid laid over the wilderness.  Each cell holds the
+ * regions and paths whose bounding boxes touch it, so a point query only has
+ * to run exact geometry tests against a handful of candidates.  Coordinates
+ * outside the grid are clamped to the border cells. */
+#define REGION_INDEX_MIN_COORD (-WILD_X_SIZE)
+#define REGION_INDEX_MAX_COORD (WILD_X_SIZE - 1)
+#define REGION_INDEX_CELL_SIZE 32
+#define REGION_INDEX_GRID_SIZE ((REGION_INDEX_MAX_COORD - REGION_INDEX_MIN_COORD + 1) / REGION_INDEX_CELL_SIZE)
+
+/* (Re)build the region or path half of the index from region_table or
+ * path_table.  Called by load_regions() and load_paths(). */
+void region_index_build_regions(void);
+void region_index_build_paths(void);
+
+/* Add or drop a single region/path.  Used by the builders above and whenever
+ * a single entry in the tables changes. */
+void region_index_add_region(region_rnum rnum);
+void region_index_remove_region(region_rnum rnum);
+void region_index_add_path(path_rnum rnum);
+void region_index_remove_path(path_rnum rnum);
+
+/* Geometry tests, answered without touching the database. */
+bool region_contains_point(region_rnum rnum, int x, int y);
+bool path_contains_point(path_rnum rnum, int x, int y);
+
+/* Same results as the old ST_Within queries against region_index and
+ * path_index.  Lists are allocated and must be freed by the caller. */
+struct region_list *get_enclosing_regions(zone_rnum zone, int x, int y);
+struct path_list *get_enclosing_paths(zone_rnum zone, int x, int y);
+bool is_point_within_region(region_vnum region, int x, int y);
+
+void free_region_list(struct region_list *regions);
+void free_path_list(struct path_list *paths);
+
+#endif /* REGION_INDEX_H */
@@ -0,0 +1,468 @@
+/* *************************************************************************
+ *   File: resolver.c                                  Part of LuminariMUD *
+ *  Usage: Reverse DNS lookups of new connections, on resolver threads.    *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "comm.h"
+#include "ban.h"
+#include "resolver.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/*
+ * The resolver threads only ever see jobs: an address in, a name out.  The
+ * cache and the descriptors belong to the game thread, which picks up
+ * finished jobs in resolver_process().  Descriptors waiting on a lookup are
+ * found by their numeric host, so a connection that closes in the meantime
+ * needs no cleanup here.
+ */
+
+#define RESOLVER_BUCKETS 256
+
+struct resolver_entry
+{
+  struct in_addr addr;
+  char host[HOST_LENGTH + 1]; /* empty if the lookup failed */
+  time_t expires;
+  bool pending; /* a lookup for it is queued or running */
+
+  struct resolver_entry *next;
+};
+
+struct resolver_job
+{
+  struct in_addr addr;
+  char numeric[HOST_LENGTH + 1];
+  char host[HOST_LENGTH + 1];
+  int result;
+
+  struct timeval queued;
+  struct timeval finished;
+
+  struct resolver_job *next;
+};
+
+/* Shared with the resolver threads, only touched with the lock held. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER; /* jobs queued */
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER; /* queue drained */
+
+static struct resolver_job *pending = NULL, *pending_tail = NULL;
+static struct resolver_job *done = NULL, *done_tail = NULL;
+static int num_pending = 0;
+static int num_busy = 0;
+static bool stopping = FALSE;
+static resolver_func lookup_func = NULL;
+
+static pthread_t *threads = NULL;
+static int num_threads = 0;
+
+/* Game thread only. */
+static struct resolver_entry *cache[RESOLVER_BUCKETS];
+static int cache_count = 0;
+
+static unsigned long lookups = 0;
+static unsigned long answered = 0;
+static unsigned long failures = 0;
+static unsigned long cache_hits = 0;
+static unsigned long coalesced = 0;
+static double total_msec = 0.0;
+static double max_msec = 0.0;
+
+static int default_lookup(const struct in_addr *addr, char *host, size_t n)
+{
+  struct sockaddr_in sa;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr = *addr;
+
+  if (getnameinfo((struct sockaddr *)&sa, sizeof(sa), host, n, NULL, 0, NI_NAMEREQD))
+    return (-1);
+
+  return (0);
+}
+
+static void run_job(resolver_func func, struct resolver_job *job)
+{
+  job->result = (func ? func : default_lookup)(&job->addr, job->host, sizeof(job->host));
+  if (job->result < 0)
+    *job->host = '\0';
+
+  gettimeofday(&job->finished, NULL);
+}
+
+static void *resolver_loop(void *arg)
+{
+  struct resolver_job *job;
+  resolver_func func;
+
+  pthread_mutex_lock(&lock);
+  for (;;)
+  {
+    while (!pending && !stopping)
+      pthread_cond_wait(&work_cond, &lock);
+
+    if (stopping)
+      break;
+
+    job = pending;
+    if (!(pending = job->next))
+      pending_tail = NULL;
+    job->next = NULL;
+    num_pending--;
+    num_busy++;
+    func = lookup_func;
+    pthread_mutex_unlock(&lock);
+
+    run_job(func, job);
+
+    pthread_mutex_lock(&lock);
+    if (done_tail)
+      done_tail->next = job;
+    else
+      done = job;
+    done_tail = job;
+    num_busy--;
+
+    if (!pending && !num_busy)
+      pthread_cond_broadcast(&idle_cond);
+  }
+  pthread_mutex_unlock(&lock);
+
+  return (NULL);
+}
+
+static struct resolver_entry **bucket_of(const struct in_addr *addr)
+{
+  return (&cache[ntohl(addr->s_addr) % RESOLVER_BUCKETS]);
+}
+
+static struct resolver_entry *find_entry(const struct in_addr *addr)
+{
+  struct resolver_entry *e;
+
+  for (e = *bucket_of(addr); e; e = e->next)
+    if (e->addr.s_addr == addr->s_addr)
+      return (e);
+
+  return (NULL);
+}
+
+/* drop everything that has expired and is not being looked up again */
+static void prune_cache(time_t now)
+{
+  struct resolver_entry **pe, *e;
+  int i;
+
+  for (i = 0; i < RESOLVER_BUCKETS; i++)
+    for (pe = &cache[i]; (e = *pe);)
+    {
+      if (e->pending || e->expires > now)
+      {
+        pe = &e->next;
+        continue;
+      }
+
+      *pe = e->next;
+      free(e);
+      cache_count--;
+    }
+}
+
+static struct resolver_entry *new_entry(const struct in_addr *addr, time_t now)
+{
+  struct resolver_entry *e, **bucket = bucket_of(addr);
+
+  if (cache_count >= RESOLVER_CACHE_MAX)
+    prune_cache(now);
+
+  /* still full of fresh names: look it up without caching it */
+  if (cache_count >= RESOLVER_CACHE_MAX)
+    return (NULL);
+
+  CREATE(e, struct resolver_entry, 1);
+  e->addr = *addr;
+  e->next = *bucket;
+  *bucket = e;
+  cache_count++;
+
+  return (e);
+}
+
+/* Put the answer in the cache and count it. */
+static void store_job(struct resolver_job *job)
+{
+  struct resolver_entry *e;
+  double msec;
+
+  msec = (job->finished.tv_sec - job->queued.tv_sec) * 1000.0 +
+         (job->finished.tv_usec - job->queued.tv_usec) / 1000.0;
+  answered++;
+  total_msec += msec;
+  if (msec > max_msec)
+    max_msec = msec;
+  if (job->result < 0)
+    failures++;
+
+  if ((e = find_entry(&job->addr)))
+  {
+    strlcpy(e->host, job->host, sizeof(e->host));
+    e->expires = time(0) + (job->result < 0 ? RESOLVER_FAIL_TTL : RESOLVER_TTL);
+    e->pending = FALSE;
+  }
+}
+
+/* Give the name to every descriptor still waiting for it. */
+static void finish_job(struct resolver_job *job)
+{
+  struct descriptor_data *d, *next_d;
+
+  store_job(job);
+
+  for (d = descriptor_list; d; d = next_d)
+  {
+    next_d = d->next;
+
+    if (!d->host_pending || strcmp(d->host, job->numeric))
+      continue;
+
+    d->host_pending = FALSE;
+    if (job->result < 0)
+      continue;
+
+    strlcpy(d->host, job->host, sizeof(d->host));
+
+    /* the site may only be banned by name */
+    if (isbanned(d->host) == BAN_ALL)
+    {
+      mudlog(CMP, LVL_STAFF, TRUE, "Connection attempt denied from [%s]", d->host);
+      close_socket(d);
+    }
+  }
+
+  free(job);
+}
+
+void resolver_lookup(struct descriptor_data *d, const struct in_addr *addr)
+{
+  struct resolver_entry *e;
+  struct resolver_job *job;
+  time_t now = time(0);
+
+  strlcpy(d->host, inet_ntoa(*addr), sizeof(d->host));
+  d->host_pending = FALSE;
+
+  if ((e = find_entry(addr)))
+  {
+    if (e->pending)
+    {
+      coalesced++;
+      d->host_pending = TRUE;
+      return;
+    }
+
+    if (e->expires > now)
+    {
+      cache_hits++;
+      if (*e->host)
+        strlcpy(d->host, e->host, sizeof(d->host));
+      return;
+    }
+  }
+  else
+    e = new_entry(addr, now);
+
+  CREATE(job, struct resolver_job, 1);
+  job->addr = *addr;
+  strlcpy(job->numeric, d->host, sizeof(job->numeric));
+  gettimeofday(&job->queued, NULL);
+  lookups++;
+
+  /* no threads: this is the old blocking lookup */
+  if (!num_threads)
+  {
+    run_job(lookup_func, job);
+    store_job(job);
+    if (job->result == 0)
+      strlcpy(d->host, job->host, sizeof(d->host));
+    free(job);
+    return;
+  }
+
+  if (e)
+    e->pending = TRUE;
+  d->host_pending = TRUE;
+
+  pthread_mutex_lock(&lock);
+  if (pending_tail)
+    pending_tail->next = job;
+  else
+    pending = job;
+  pending_tail = job;
+  num_pending++;
+  pthread_cond_signal(&work_cond);
+  pthread_mutex_unlock(&lock);
+}
+
+void resolver_process(void)
+{
+  struct resolver_job *job, *next_job;
+
+  if (!num_threads)
+    return;
+
+  pthread_mutex_lock(&lock);
+  job = done;
+  done = done_tail = NULL;
+  pthread_mutex_unlock(&lock);
+
+  for (; job; job = next_job)
+  {
+    next_job = job->next;
+    finish_job(job);
+  }
+}
+
+void resolver_flush(void)
+{
+  if (num_threads)
+  {
+    pthread_mutex_lock(&lock);
+    while (pending || num_busy)
+      pthread_cond_wait(&idle_cond, &lock);
+    pthread_mutex_unlock(&lock);
+  }
+
+  resolver_process();
+}
+
+void resolver_set_func(resolver_func func)
+{
+  pthread_mutex_lock(&lock);
+  lookup_func = func;
+  pthread_mutex_unlock(&lock);
+}
+
+int resolver_init(int count)
+{
+  sigset_t all, old;
+  int err = 0;
+
+  if (num_threads)
+    return (0);
+
+  CREATE(threads, pthread_t, count);
+
+  /* signals are for the game thread, the resolvers inherit this mask */
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  stopping = FALSE;
+  for (num_threads = 0; num_threads < count; num_threads++)
+    if ((err = pthread_create(&threads[num_threads], NULL, resolver_loop, NULL)))
+      break;
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  if (err)
+    log("SYSERR: Unable to start resolver thread: %s", strerror(err));
+
+  if (!num_threads)
+  {
+    free(threads);
+    threads = NULL;
+    return (-1);
+  }
+
+  log("Started %d resolver thread%s.", num_threads, num_threads == 1 ? "" : "s");
+
+  return (0);
+}
+
+/* Stops the threads.  Lookups that are not done yet are dropped, their
+ * descriptors keep the numeric address. */
+void resolver_shutdown(void)
+{
+  struct resolver_job *job, *next_job;
+  struct resolver_entry *e;
+  struct descriptor_data *d;
+  int i;
+
+  if (!num_threads)
+    return;
+
+  pthread_mutex_lock(&lock);
+  stopping = TRUE;
+  pthread_cond_broadcast(&work_cond);
+  pthread_mutex_unlock(&lock);
+
+  for (i = 0; i < num_threads; i++)
+    pthread_join(threads[i], NULL);
+  free(threads);
+  threads = NULL;
+  num_threads = 0;
+
+  for (job = pending; job; job = next_job)
+  {
+    next_job = job->next;
+    free(job);
+  }
+  pending = pending_tail = NULL;
+  num_pending = 0;
+
+  for (job = done; job; job = next_job)
+  {
+    next_job = job->next;
+    free(job);
+  }
+  done = done_tail = NULL;
+
+  for (d = descriptor_list; d; d = d->next)
+    d->host_pending = FALSE;
+
+  for (i = 0; i < RESOLVER_BUCKETS; i++)
+    while ((e = cache[i]))
+    {
+      cache[i] = e->next;
+      free(e);
+    }
+  cache_count = 0;
+}
+
+size_t resolver_repr(char *out_buf, size_t n)
+{
+  int queued, busy;
+  int len;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  pthread_mutex_lock(&lock);
+  queued = num_pending;
+  busy = num_busy;
+  pthread_mutex_unlock(&lock);
+
+  len = snprintf(out_buf, n,
+                 "Reverse DNS resolver\r\n"
+                 "  Threads : %d, %d lookups queued, %d running\r\n"
+                 "  Lookups : %lu, %lu failed, avg %.1fms, max %.1fms\r\n"
+                 "  Cache   : %d of %d addresses, %lu hits, %lu waited on a running lookup\r\n",
+                 num_threads, queued, busy,
+                 lookups, failures,
+                 (answered ? total_msec / answered : 0.0), max_msec,
+                 cache_count, RESOLVER_CACHE_MAX, cache_hits, coalesced);
+
+  if (len < 0)
+    return 0;
+
+  return MIN(len, (int)n - 1);
+}
@@ -0,0 +1,48 @@
+/* *************************************************************************
+ *   File: resolver.h                                  Part of LuminariMUD *
+ *  Usage: Header file for reverse DNS lookups of new connections.         *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+/* Host names of new connections are looked up by a few resolver threads, so
+ * a slow name server never holds up the game loop.  A new descriptor starts
+ * out with its numeric address as host and has host_pending set; once the
+ * name is known resolver_process() puts it in d->host and checks the bans
+ * again.  Names (and failed lookups) are cached for a while, so players who
+ * reconnect get their name right away and a burst of connections from one
+ * address is only looked up once. */
+
+/* Threads doing lookups. */
+#define RESOLVER_THREADS 2
+/* Most addresses kept in the cache. */
+#define RESOLVER_CACHE_MAX 1024
+/* Seconds a name is cached, and a failed lookup. */
+#define RESOLVER_TTL (60 * 60)
+#define RESOLVER_FAIL_TTL (5 * 60)
+
+struct in_addr;
+
+/* Does the actual lookup, on a resolver thread: puts the name of addr in
+ * host and returns 0, or returns -1 if it has none. */
+typedef int (*resolver_func)(const struct in_addr *addr, char *host, size_t n);
+
+int resolver_init(int threads);
+void resolver_shutdown(void);
+/* Use func for lookups instead of getnameinfo(), NULL to go back. */
+void resolver_set_func(resolver_func func);
+
+/* Set d->host for a connection from addr: the name if it is cached, else
+ * the numeric address while the name is looked up. */
+void resolver_lookup(struct descriptor_data *d, const struct in_addr *addr);
+/* Hand finished lookups to their descriptors, once a pulse. */
+void resolver_process(void);
+/* Wait until every lookup queued so far is done, then process them. */
+void resolver_flush(void);
+
+size_t resolver_repr(char *out_buf, size_t n);
+
+#endif /* RESOLVER_H */
@@ -2159,6 +2159,7 @@ SPECIAL(kt_twister)
 
       world[real_room(132901)].dir_option[3]->to_room;
   world[real_room(32901)].dir_option[3]->to_room = temp;
+  world_topology_changed();
 
   send_to_room(real_room(132901), "\tCThe world seems to turn.\tn\r\n");
 
@@ -1170,8 +1170,6 @@ bool is_preparing(struct char_data *ch)
 /* we check the queue for top spell for first timer */
 void start_prep_event(struct char_data *ch, int class)
 {
-  char buf[50] = {'\0'};
-
   switch (class)
   {
   case CLASS_SORCERER:
@@ -1195,8 +1193,8 @@ void start_prep_event(struct char_data *ch, int class)
   set_preparing_state(ch, class, TRUE);
   if (!char_has_mud_event(ch, ePREPARATION))
   {
-    snprintf(buf, sizeof(buf), "%d", class); /* carry our class as the svar */
-    NEW_EVENT(ePREPARATION, ch, strdup(buf), (1 * PASSES_PER_SEC));
+    /* carry our class as the event variable */
+    NEW_EVENT_VAR(ePREPARATION, ch, class, (1 * PASSES_PER_SEC));
   }
 }
 
@@ -2017,8 +2015,8 @@ EVENTFUNC(event_preparation)
   ch = (struct char_data *)prepare_event->pStruct;
   if (!ch)
     return 0;
-  /* grab the svariable for class */
-  class = atoi((char *)prepare_event->sVariables);
+  /* grab the event variable for class */
+  class = prepare_event->iVars[0];
 
   /* this is definitely a dummy check */
   switch (class)
@@ -2004,6 +2004,8 @@ ASPELL(spell_wizard_eye)
   ch->desc->original = ch;
   eye->desc = ch->desc;
   ch->desc = NULL;
+  update_zone_occupancy(eye);
+  update_zone_occupancy(ch);
 }
 
 ASPELL(psionic_concussive_onslaught)
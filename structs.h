@@ -2824,10 +2824,10 @@
 /* Variables for the output buffering system */
 #define MAX_SOCK_BUF (24 * 1024) /**< Size of kernel's sock buf   */
 #define MAX_PROMPT_LENGTH 400    /**< Max length of prompt        */
-#define GARBAGE_SPACE 32         /**< Space for **OVERFLOW** etc  */
-#define SMALL_BUFSIZE 1024       /**< Static output buffer size   */
-/** Max amount of output that can be buffered */
-#define LARGE_BUFSIZE (MAX_SOCK_BUF - GARBAGE_SPACE - MAX_PROMPT_LENGTH)
+#define OUTPUT_SEGMENT_SIZE 4096 /**< Text in one output segment  */
+#define MAX_OUTPUT_IOV 32        /**< Segments sent in one write  */
+/** Max amount of output that can be queued for one descriptor */
+#define MAX_OUTPUT_QUEUE (512 * 1024)
 
 /* an arbitrary cap, medium/small in size for text */
 #define SMALL_STRING 128
@@ -3575,6 +3575,7 @@ struct player_special_data
     char *poofin;               /**< Description displayed to room on arrival of a god. */
     char *poofout;              /**< Description displayed to room at a god's exit. */
     struct alias_data *aliases; /**< Command aliases			*/
+    struct alias_data **alias_index; /**< aliases hashed by name, or NULL */
     long last_tell;             /**< idnum of PC who last told this PC, used to reply */
     void *last_olc_targ;        /**< ? Currently Unused ? */
     int last_olc_mode;          /**< ? Currently Unused ? */
@@ -3599,6 +3600,10 @@ struct player_special_data
     char *new_mail_receiver;
     char *new_mail_subject;
     char *new_mail_content;
+    int new_mail_count;         // unread mail for the prompt, see new_mail_alert()
+    time_t new_mail_checked;    // when new_mail_count was last refreshed
+    bool new_mail_pending;      // a refresh of new_mail_count is queued
+    unsigned int new_mail_stamp; // bumped when mail is read or deleted
     byte has_eldritch_knight_spell_critical;
     int destination;            // used for carriage and airship systems
     int travel_timer;           // used for carriage and airship systems
@@ -3821,6 +3826,9 @@ struct char_data
 
     struct list_data *events;
 
+    bool occupying;           /**< Counted in occupied_zone's occupants */
+    zone_rnum occupied_zone;  /**< Zone this char is counted in, if occupying */
+
     struct char_data *last_attacker; // mainly to prevent type_suffering from awarding exp
 
     int sticky_bomb[3];
@@ -3847,6 +3855,17 @@ struct txt_q
     struct txt_block *tail; /**< ? */
 };
 
+/** A piece of a descriptor's output queue.  Text is added at the end of the
+ * last segment and sent from the start of the first one, so queued output
+ * is never moved around. */
+struct out_segment
+{
+    struct out_segment *next;       /**< next segment in the queue */
+    int start;                      /**< first byte not sent yet */
+    int len;                        /**< bytes from start not sent yet */
+    char text[OUTPUT_SEGMENT_SIZE]; /**< the text itself, not terminated */
+};
+
 /** Master structure players. Holds the real players connection to the mud.
  * An analogy is the char_data is the body of the character, the descriptor_data
  * is the soul. */
@@ -3854,6 +3873,7 @@ struct descriptor_data
 {
     socket_t descriptor;               /**< file descriptor for socket */
     char host[HOST_LENGTH + 1];        /**< hostname */
+    bool host_pending;                 /**< host is numeric until looked up */
     byte bad_pws;                      /**< number of bad pw attemps this login */
     byte idle_tics;                    /**< tics idle at password prompt		*/
     int connected;                     /**< mode of 'connectedness'		*/
@@ -3870,13 +3890,12 @@ struct descriptor_data
     int has_prompt;                    /**< is the user at a prompt?             */
     char inbuf[MAX_RAW_INPUT_LENGTH];  /**< buffer for raw input		*/
     char last_input[MAX_INPUT_LENGTH]; /**< the last input			*/
-    char small_outbuf[SMALL_BUFSIZE];  /**< standard output buffer		*/
-    char *output;                      /**< ptr to the current output buffer	*/
+    struct out_segment *out_head;      /**< output waiting to be sent		*/
+    struct out_segment *out_tail;      /**< last segment, new output goes here	*/
+    size_t out_queued;                 /**< bytes waiting in the output queue	*/
+    bool out_overflow;                 /**< output dropped until queue empties	*/
     char **history;                    /**< History of commands, for ! mostly.	*/
     int history_pos;                   /**< Circular array position.		*/
-    int bufptr;                        /**< ptr to end of current output		*/
-    int bufspace;                      /**< space left in the output buffer	*/
-    struct txt_block *large_outbuf;    /**< ptr to large buffer, if we need it */
     struct txt_q input;                /**< q of unprocessed input		*/
     struct char_data *character;       /**< linked to char			*/
     struct char_data *original;        /**< original char if switched		*/
@@ -3886,6 +3905,7 @@ struct descriptor_data
     struct oasis_olc_data *olc;        /**< OLC info */
 
     protocol_t *pProtocol;    /**< Kavir plugin */
+    struct mccp_stream *mccp; /**< MCCP compression, if the client wants it */
     struct list_data *events; // event system
 
     struct account_data *account; /**< Account system */
@@ -0,0 +1,287 @@
+/* *************************************************************************
+ *   File: terrain_cache.c                             Part of LuminariMUD *
+ *  Usage: Cache for the Perlin derived wilderness terrain values.         *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#include "conf.h"
+#include "sysdep.h"
+#include "structs.h"
+#include "utils.h"
+#include "terrain_cache.h"
+
+/*
+ * Elevation and moisture only depend on (map, x, y) and the noise seeds set at
+ * boot, but they cost 8-32 octaves of noise each time.  The wilderness map asks
+ * for the same tiles over and over as players walk around, so we remember them.
+ *
+ * Chunks are filled in lazily one tile at a time, an unfilled tile holds
+ * TERRAIN_UNSET.  Values that do not fit in a short are never cached.
+ */
+
+#define TERRAIN_UNSET SHRT_MIN
+
+struct terrain_chunk
+{
+  int kind;
+  int map;
+  int cx, cy;
+
+  short values[TERRAIN_CHUNK_SIZE * TERRAIN_CHUNK_SIZE];
+
+  struct terrain_chunk *hnext; /* Hash chain. */
+  struct terrain_chunk *prev;  /* LRU list, most recently used first. */
+  struct terrain_chunk *next;
+};
+
+static struct terrain_chunk *chunk_hash[TERRAIN_CACHE_HASH_SIZE];
+static struct terrain_chunk *lru_head = NULL;
+static struct terrain_chunk *lru_tail = NULL;
+static int num_chunks = 0;
+
+static unsigned long cache_hits = 0;
+static unsigned long cache_misses = 0;
+static unsigned long cache_evictions = 0;
+
+/* Floor division, so that negative coordinates land in the right chunk. */
+static int chunk_coord(int coord)
+{
+  if (coord >= 0)
+    return coord / TERRAIN_CHUNK_SIZE;
+  return -((-coord - 1) / TERRAIN_CHUNK_SIZE) - 1;
+}
+
+static unsigned int chunk_hash_key(int kind, int map, int cx, int cy)
+{
+  unsigned int h = (unsigned int)kind;
+
+  h = h * 31 + (unsigned int)map;
+  h = h * 2654435761u + (unsigned int)cx;
+  h = h * 2654435761u + (unsigned int)cy;
+
+  return (h ^ (h >> 16)) % TERRAIN_CACHE_HASH_SIZE;
+}
+
+static void lru_unlink(struct terrain_chunk *chunk)
+{
+  if (chunk->prev)
+    chunk->prev->next = chunk->next;
+  else
+    lru_head = chunk->next;
+
+  if (chunk->next)
+    chunk->next->prev = chunk->prev;
+  else
+    lru_tail = chunk->prev;
+
+  chunk->prev = chunk->next = NULL;
+}
+
+static void lru_push_front(struct terrain_chunk *chunk)
+{
+  chunk->prev = NULL;
+  chunk->next = lru_head;
+
+  if (lru_head)
+    lru_head->prev = chunk;
+  else
+    lru_tail = chunk;
+
+  lru_head = chunk;
+}
+
+static void hash_unlink(struct terrain_chunk *chunk)
+{
+  struct terrain_chunk **pp;
+
+  pp = &chunk_hash[chunk_hash_key(chunk->kind, chunk->map, chunk->cx, chunk->cy)];
+
+  for (; *pp; pp = &(*pp)->hnext)
+  {
+    if (*pp == chunk)
+    {
+      *pp = chunk->hnext;
+      return;
+    }
+  }
+}
+
+static struct terrain_chunk *get_chunk(int kind, int map, int cx, int cy)
+{
+  unsigned int key = chunk_hash_key(kind, map, cx, cy);
+  struct terrain_chunk *chunk;
+  int i;
+
+  for (chunk = chunk_hash[key]; chunk; chunk = chunk->hnext)
+  {
+    if (chunk->kind == kind && chunk->map == map && chunk->cx == cx && chunk->cy == cy)
+    {
+      if (chunk != lru_head)
+      {
+        lru_unlink(chunk);
+        lru_push_front(chunk);
+      }
+      return chunk;
+    }
+  }
+
+  /* Not there - reuse the least recently used chunk if we are at the cap. */
+  if (num_chunks >= TERRAIN_CACHE_MAX_CHUNKS && lru_tail)
+  {
+    chunk = lru_tail;
+    lru_unlink(chunk);
+    hash_unlink(chunk);
+    cache_evictions++;
+  }
+  else
+  {
+    CREATE(chunk, struct terrain_chunk, 1);
+    num_chunks++;
+  }
+
+  chunk->kind = kind;
+  chunk->map = map;
+  chunk->cx = cx;
+  chunk->cy = cy;
+
+  for (i = 0; i < TERRAIN_CHUNK_SIZE * TERRAIN_CHUNK_SIZE; i++)
+    chunk->values[i] = TERRAIN_UNSET;
+
+  chunk->hnext = chunk_hash[key];
+  chunk_hash[key] = chunk;
+  lru_push_front(chunk);
+
+  return chunk;
+}
+
+/* Get a terrain value for (x, y), calling gen() to compute it on a miss. */
+int terrain_cache_get(int kind, int map, int x, int y, terrain_gen_func gen)
+{
+  struct terrain_chunk *chunk;
+  int cx = chunk_coord(x);
+  int cy = chunk_coord(y);
+  int idx, value;
+
+  chunk = get_chunk(kind, map, cx, cy);
+  idx = (y - cy * TERRAIN_CHUNK_SIZE) * TERRAIN_CHUNK_SIZE + (x - cx * TERRAIN_CHUNK_SIZE);
+
+  if (chunk->values[idx] != TERRAIN_UNSET)
+  {
+    cache_hits++;
+    return chunk->values[idx];
+  }
+
+  cache_misses++;
+  value = gen(map, x, y);
+
+  if (value > TERRAIN_UNSET && value <= SHRT_MAX)
+    chunk->values[idx] = (short)value;
+
+  return value;
+}
+
+/* Get the terrain values for the w x h rectangle at (x0, y0) into out, row
+ * major.  Each chunk the rectangle overlaps that is missing any tile gets its
+ * part of the rectangle generated in one gen() call. */
+void terrain_cache_get_rect(int kind, int map, int x0, int y0, int w, int h, int *out, terrain_grid_func gen)
+{
+  static int buf[TERRAIN_CHUNK_SIZE * TERRAIN_CHUNK_SIZE];
+  struct terrain_chunk *chunk;
+  int cx, cy, x, y, sx0, sx1, sy0, sy1, sw, missing, idx, value;
+
+  if (w < 1 || h < 1)
+    return;
+
+  for (cy = chunk_coord(y0); cy <= chunk_coord(y0 + h - 1); cy++)
+  {
+    sy0 = MAX(y0, cy * TERRAIN_CHUNK_SIZE);
+    sy1 = MIN(y0 + h - 1, cy * TERRAIN_CHUNK_SIZE + TERRAIN_CHUNK_SIZE - 1);
+
+    for (cx = chunk_coord(x0); cx <= chunk_coord(x0 + w - 1); cx++)
+    {
+      sx0 = MAX(x0, cx * TERRAIN_CHUNK_SIZE);
+      sx1 = MIN(x0 + w - 1, cx * TERRAIN_CHUNK_SIZE + TERRAIN_CHUNK_SIZE - 1);
+      sw = sx1 - sx0 + 1;
+
+      chunk = get_chunk(kind, map, cx, cy);
+
+      missing = 0;
+      for (y = sy0; y <= sy1; y++)
+        for (x = sx0; x <= sx1; x++)
+          if (chunk->values[(y - cy * TERRAIN_CHUNK_SIZE) * TERRAIN_CHUNK_SIZE + (x - cx * TERRAIN_CHUNK_SIZE)] == TERRAIN_UNSET)
+            missing++;
+
+      if (missing)
+        gen(map, sx0, sy0, sw, sy1 - sy0 + 1, buf);
+
+      cache_misses += missing;
+      cache_hits += sw * (sy1 - sy0 + 1) - missing;
+
+      for (y = sy0; y <= sy1; y++)
+      {
+        for (x = sx0; x <= sx1; x++)
+        {
+          idx = (y - cy * TERRAIN_CHUNK_SIZE) * TERRAIN_CHUNK_SIZE + (x - cx * TERRAIN_CHUNK_SIZE);
+
+          if (missing)
+          {
+            value = buf[(y - sy0) * sw + (x - sx0)];
+            if (value > TERRAIN_UNSET && value <= SHRT_MAX)
+              chunk->values[idx] = (short)value;
+          }
+          else
+            value = chunk->values[idx];
+
+          out[(y - y0) * w + (x - x0)] = value;
+        }
+      }
+    }
+  }
+}
+
+/* Drop everything, needed if the noise generators are ever re-seeded. */
+void terrain_cache_flush(void)
+{
+  struct terrain_chunk *chunk, *next;
+
+  for (chunk = lru_head; chunk; chunk = next)
+  {
+    next = chunk->next;
+    free(chunk);
+  }
+
+  memset(chunk_hash, 0, sizeof(chunk_hash));
+  lru_head = lru_tail = NULL;
+  num_chunks = 0;
+}
+
+size_t terrain_cache_repr(char *out_buf, size_t n)
+{
+  unsigned long total = cache_hits + cache_misses;
+  int len;
+
+  if (!out_buf || n < 1)
+    return 0;
+
+  len = snprintf(out_buf, n,
+                 "Terrain cache\r\n"
+                 "  Chunks   : %d / %d (%dx%d tiles, %lu KB)\r\n"
+                 "  Hits     : %lu\r\n"
+                 "  Misses   : %lu\r\n"
+                 "  Hit rate : %.2f%%\r\n"
+                 "  Evicted  : %lu\r\n",
+                 num_chunks, TERRAIN_CACHE_MAX_CHUNKS, TERRAIN_CHUNK_SIZE, TERRAIN_CHUNK_SIZE,
+                 (unsigned long)(num_chunks * sizeof(struct terrain_chunk)) / 1024,
+                 cache_hits, cache_misses,
+                 (total ? 100.0 * cache_hits / total : 0.0),
+                 cache_evictions);
+
+  if (len < 0)
+  {
+    out_buf[0] = '\0';
+    return 0;
+  }
+
+  return MIN(len, (int)n - 1);
+}
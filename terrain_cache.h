@@ -0,0 +1,32 @@
+/* *************************************************************************
+ *   File: terrain_cache.h                             Part of LuminariMUD *
+ *  Usage: Header file for the wilderness terrain value cache.             *
+ ***************************************************************************
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TERRAIN_CACHE_H
+#define TERRAIN_CACHE_H
+
+/* Terrain values are cached in square chunks of tiles, chunks are kept in a
+ * hash and evicted least-recently-used first once the cap is reached. */
+#define TERRAIN_CHUNK_SIZE 64
+#define TERRAIN_CACHE_MAX_CHUNKS 512 /* 512 chunks of 64x64 tiles is about 4MB */
+#define TERRAIN_CACHE_HASH_SIZE 1024
+
+/* Value kinds that can be cached. */
+#define TERRAIN_ELEVATION 0
+#define TERRAIN_MOISTURE 1
+#define NUM_TERRAIN_VALUES 2
+
+/* Generators used to fill in missing values, one tile or a w x h rectangle
+ * (row major, out[r * w + c] is the value at (x0 + c, y0 + r)). */
+typedef int (*terrain_gen_func)(int map, int x, int y);
+typedef void (*terrain_grid_func)(int map, int x0, int y0, int w, int h, int *out);
+
+int terrain_cache_get(int kind, int map, int x, int y, terrain_gen_func gen);
+void terrain_cache_get_rect(int kind, int map, int x0, int y0, int w, int h, int *out, terrain_grid_func gen);
+void terrain_cache_flush(void);
+size_t terrain_cache_repr(char *out_buf, size_t n);
+
+#endif /* TERRAIN_CACHE_H */
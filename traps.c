@@ -43,18 +43,13 @@
  event to the victim*/
 void set_off_trap(struct char_data *ch, struct obj_data *trap)
 {
-  char buf[128];
-
   if (IS_NPC(ch) && !IS_PET(ch))
     return;
 
   send_to_char(ch, "Ooops, you must have triggered something.\r\n");
 
-  /* Build the effect string */
-  snprintf(buf, sizeof(buf), "%d", GET_OBJ_VAL(trap, 2));
-
-  /* Add the event to the character.*/
-  NEW_EVENT(eTRAPTRIGGERED, ch, strdup(buf), 1);
+  /* Add the event to the character, carrying the trap effect.*/
+  NEW_EVENT_VAR(eTRAPTRIGGERED, ch, GET_OBJ_VAL(trap, 2), 1);
 }
 
 /* checks the 5th value (4) to see if its set (which indicates detection) */
@@ -252,16 +247,7 @@ EVENTFUNC(event_trap_triggered)
     break;
   }
 
-  if (pMudEvent->sVariables == NULL)
-  {
-    /* This is odd - This field should always be populated for traps. */
-    log("SYSERR: sVariables field is NULL for event_trap_triggered: %d", pMudEvent->iId);
-    return 0;
-  }
-  else
-  {
-    effect = atoi(pMudEvent->sVariables);
-  }
+  effect = pMudEvent->iVars[0];
 
   switch (pMudEvent->iId)
   {
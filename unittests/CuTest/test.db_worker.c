@@ -0,0 +1,98 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../mysql.h"
+#include "../../db_worker.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Runs against a scratch database on a local MySQL/MariaDB server:
+ *
+ *   LUMINARI_TEST_MYSQL="host user password database" bin/cutest
+ *
+ * The table db_worker_test is created and dropped there.  Without the
+ * variable the test is skipped. */
+
+#define TEST_KEYS 10
+#define TEST_SAVES 100
+#define TEST_ROWS 5000
+
+static long read_value = -1;
+static int reads_done = 0;
+
+static void read_first_value(MYSQL_RES *result, void *data)
+{
+    MYSQL_ROW row;
+
+    reads_done++;
+    read_value = -1;
+    if (result && (row = mysql_fetch_row(result)) && row[0])
+        read_value = atol(row[0]);
+}
+
+static long read_now(const char *query)
+{
+    struct db_job *job = db_job_new(NULL);
+
+    db_job_add(job, "%s", query);
+    db_job_read(job, read_first_value, NULL);
+    db_worker_flush();
+
+    return read_value;
+}
+
+void Test_db_worker_mysql(CuTest *tc)
+{
+    char host[128], user[128], password[128], database[128];
+    const char *cfg = getenv("LUMINARI_TEST_MYSQL");
+    struct db_job *job;
+    char key[32];
+    int i;
+
+    if (!cfg || sscanf(cfg, "%127s %127s %127s %127s", host, user, password, database) != 4)
+        return;
+
+    CuAssertIntEquals(tc, 0, mysql_library_init(0, NULL, NULL));
+    CuAssertIntEquals(tc, 0, db_worker_init(host, user, password, database));
+
+    job = db_job_new(NULL);
+    db_job_add(job, "DROP TABLE IF EXISTS db_worker_test");
+    db_job_add(job, "CREATE TABLE db_worker_test (id INT NOT NULL, val INT NOT NULL)");
+    db_job_write(job);
+
+    /* Saves of the same key replace each other while queued, whatever is
+     * left has to end up with the last one. */
+    for (i = 0; i < TEST_SAVES; i++)
+    {
+        snprintf(key, sizeof(key), "test:%d", i % TEST_KEYS);
+        job = db_job_new(key);
+        db_job_add(job, "DELETE FROM db_worker_test WHERE id = %d", i % TEST_KEYS);
+        db_job_add_row(job, "INSERT INTO db_worker_test (id, val) VALUES ", "", "(%d, %d)", i % TEST_KEYS, i);
+        db_job_write(job);
+    }
+
+    /* Enough rows that they take more than one statement. */
+    job = db_job_new(NULL);
+    for (i = 0; i < TEST_ROWS; i++)
+        db_job_add_row(job, "INSERT INTO db_worker_test (id, val) VALUES ", "", "(%d, %d)", 1000 + i, i);
+    db_job_write(job);
+
+    CuAssertIntEquals(tc, TEST_KEYS + TEST_ROWS, read_now("SELECT COUNT(*) FROM db_worker_test"));
+    CuAssertIntEquals(tc, TEST_SAVES - TEST_KEYS + 3, read_now("SELECT val FROM db_worker_test WHERE id = 3"));
+    CuAssertIntEquals(tc, TEST_ROWS - 1, read_now("SELECT MAX(val) FROM db_worker_test WHERE id >= 1000"));
+
+    /* A failed read still gets its callback, with no result. */
+    i = reads_done;
+    CuAssertIntEquals(tc, -1, read_now("SELECT no_such_column FROM db_worker_test"));
+    CuAssertIntEquals(tc, i + 1, reads_done);
+
+    job = db_job_new(NULL);
+    db_job_add(job, "DROP TABLE db_worker_test");
+    db_job_write(job);
+
+    db_worker_shutdown();
+}
@@ -0,0 +1,125 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../comm.h"
+#include "../../dg_event.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_EVENTS 2000000
+
+/* Pull everything due up to and including pulse 'when' off the queue, checking
+ * that keys come out in order and none of them early. */
+static int drain_to(CuTest *tc, struct dg_queue *q, long when)
+{
+    long last = 0, key;
+    int n = 0;
+
+    pulse = when;
+
+    while ((key = queue_key(q)) <= (long)pulse)
+    {
+        CuAssertTrue(tc, key >= last);
+        last = key;
+        queue_head(q);
+        n++;
+    }
+
+    return n;
+}
+
+void Test_dg_queue_order(CuTest *tc)
+{
+    static struct q_element *elems[1000];
+    static long keys[1000];
+    struct dg_queue *q;
+    int i, n = 0, cancelled = 0;
+
+    pulse = 5;
+    q = queue_init();
+
+    /* Spread keys across every level of the wheel, including the far future. */
+    for (i = 0; i < 1000; i++)
+    {
+        keys[i] = pulse + 1 + ((long)i * i * 7919) % 20000000;
+        elems[i] = queue_enq(q, NULL, keys[i]);
+    }
+
+    /* Nothing is due yet. */
+    CuAssertTrue(tc, queue_key(q) == LONG_MAX);
+    CuAssertPtrEquals(tc, NULL, queue_head(q));
+
+    /* Cancel every third element. */
+    for (i = 0; i < 1000; i += 3)
+    {
+        queue_deq(q, elems[i]);
+        elems[i] = NULL;
+        cancelled++;
+    }
+    CuAssertIntEquals(tc, 1000 - cancelled, (int)q->count);
+
+    /* Keys stay put while queued, whatever level they sit on. */
+    for (i = 0; i < 1000; i++)
+        if (elems[i])
+            CuAssertTrue(tc, queue_elmt_key(elems[i]) == keys[i]);
+
+    /* Walk forward in uneven steps, the way a lagging heartbeat would. */
+    n += drain_to(tc, q, 6);
+    n += drain_to(tc, q, 300);
+    n += drain_to(tc, q, 70000);
+    n += drain_to(tc, q, 70001);
+    n += drain_to(tc, q, 20000010);
+
+    CuAssertIntEquals(tc, 1000 - cancelled, n);
+    CuAssertIntEquals(tc, 0, (int)q->count);
+
+    queue_free(q);
+}
+
+/* Not a correctness test, times enqueue/cancel churn of the kind affects and
+ * mud events cause. */
+void Test_dg_queue_benchmark(CuTest *tc)
+{
+    static struct q_element *elems[BENCH_EVENTS];
+    struct dg_queue *q;
+    clock_t start;
+    double enq_secs, deq_secs, run_secs;
+    int i, fired = 0;
+
+    pulse = 1;
+    q = queue_init();
+
+    start = clock();
+    for (i = 0; i < BENCH_EVENTS; i++)
+        elems[i] = queue_enq(q, NULL, pulse + 1 + (i * 37) % 6000);
+    enq_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (i = 0; i < BENCH_EVENTS; i += 2)
+        queue_deq(q, elems[i]);
+    deq_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    while (q->count > 0)
+    {
+        pulse++;
+        while (queue_key(q) <= (long)pulse)
+        {
+            queue_head(q);
+            fired++;
+        }
+    }
+    run_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (getenv("LUMINARI_BENCHMARK"))
+        printf("dg_queue: %d enqueued in %.3fs, %d cancelled in %.3fs, %d fired in %.3fs\n",
+               BENCH_EVENTS, enq_secs, BENCH_EVENTS / 2, deq_secs, fired, run_secs);
+
+    CuAssertIntEquals(tc, BENCH_EVENTS / 2, fired);
+
+    queue_free(q);
+}
@@ -0,0 +1,354 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../db.h"
+#include "../../handler.h"
+#include "../../dg_scripts.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_RUNS 20000
+
+/* Busy triggers that only script: no waits, no commands for the room, so
+ * they can run without a world.  Each returns what it worked out. */
+static const struct
+{
+    const char *name;
+    const char *script;
+    int result;
+} busy_triggers[] = {
+    {"elseif chain",
+     "* pick a branch far down the chain\n"
+     "set n 9\n"
+     "set r 0\n"
+     "if %n% == 1\n"
+     "  set r 1\n"
+     "elseif %n% == 2\n"
+     "  set r 2\n"
+     "elseif %n% == 3\n"
+     "  set r 3\n"
+     "elseif %n% == 4\n"
+     "  if %r% == 0\n"
+     "    set r 4\n"
+     "  end\n"
+     "elseif %n% == 5\n"
+     "  set r 5\n"
+     "elseif %n% == 6\n"
+     "  set r 6\n"
+     "elseif %n% == 7\n"
+     "  set r 7\n"
+     "elseif %n% == 8\n"
+     "  set r 8\n"
+     "elseif %n% == 9\n"
+     "  if %r% == 0\n"
+     "    set r 90\n"
+     "  end\n"
+     "else\n"
+     "  set r -1\n"
+     "end\n"
+     "return %r%",
+     90},
+    {"switch in a loop",
+     "set i 0\n"
+     "set sum 0\n"
+     "while %i% < 20\n"
+     "  eval i %i% + 1\n"
+     "  switch %i%\n"
+     "    case 1\n"
+     "    case 2\n"
+     "      eval sum %sum% + 1\n"
+     "      break\n"
+     "    case 3\n"
+     "      eval sum %sum% + 10\n"
+     "      break\n"
+     "    case 5\n"
+     "      eval sum %sum% + 100\n"
+     "  done\n"
+     "done\n"
+     "return %sum%",
+     112},
+    {"command from a variable",
+     "set verb eval\n"
+     "set total 0\n"
+     "set j 0\n"
+     "while %j% < 25\n"
+     "  %verb% j %j% + 1\n"
+     "  if %j% > 20\n"
+     "    eval total %total% + 3\n"
+     "  elseif %j% > 10\n"
+     "    eval total %total% + 2\n"
+     "  else\n"
+     "    eval total %total% + 1\n"
+     "  end\n"
+     "done\n"
+     "return %total%",
+     45},
+    {"values with ops in them",
+     "set a -5\n"
+     "set b x+y\n"
+     "set n 7\n"
+     "set r 0\n"
+     "eval c %a% - 2\n"
+     "eval d %b%\n"
+     "eval e (%n% + 3) * 2\n"
+     "eval f %e% / %n%\n"
+     "if %d% == 0 && %f% == 2\n"
+     "  eval r %c% * 1000 + %e% * 10 + %f%\n"
+     "end\n"
+     "return %r%",
+     -3202},
+    {NULL, NULL, 0}};
+
+static struct cmdlist_element *make_cmdlist(const char *script)
+{
+    struct cmdlist_element *head = NULL, **tail = &head;
+    char *s = strdup(script), *line;
+
+    for (line = strtok(s, "\n\r"); line; line = strtok(NULL, "\n\r"))
+    {
+        CREATE(*tail, struct cmdlist_element, 1);
+        (*tail)->cmd = strdup(line);
+        tail = &(*tail)->next;
+    }
+
+    free(s);
+    return head;
+}
+
+static void free_cmdlist(struct cmdlist_element *cl)
+{
+    struct cmdlist_element *next;
+
+    for (; cl; cl = next)
+    {
+        next = cl->next;
+        free_compiled_line(cl);
+        free(cl->cmd);
+        free(cl);
+    }
+}
+
+static double run_trigger(CuTest *tc, struct room_data *room, trig_data *trig,
+                          int compiled, int expect)
+{
+    clock_t start;
+    int i;
+
+    dg_compile_triggers = compiled;
+
+    start = clock();
+    for (i = 0; i < BENCH_RUNS; i++)
+        CuAssertIntEquals(tc, expect, script_driver(&room, trig, WLD_TRIGGER, TRIG_NEW));
+
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Compiles every trigger of a .trg file and counts the blocks that were
+ * left to the text scans. */
+static void compile_trigger_file(CuTest *tc, const char *path)
+{
+    struct index_data **saved_index = trig_index;
+    int saved_top = top_of_trigt;
+    struct cmdlist_element *cl;
+    char line[MAX_INPUT_LENGTH];
+    int count = 0, lines = 0, blocks = 0, scanned = 0, i;
+    clock_t start;
+    FILE *fl;
+
+    if (!(fl = fopen(path, "r")))
+    {
+        printf("dg scripts: cannot open %s\n", path);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fl))
+        if (*line == '#')
+            count++;
+    rewind(fl);
+
+    CREATE(trig_index, struct index_data *, count + 1);
+    top_of_trigt = 0;
+
+    dg_compile_triggers = 0;
+    while (fgets(line, sizeof(line), fl) && *line != '$')
+        if (*line == '#')
+            parse_trigger(fl, atoi(line + 1));
+    fclose(fl);
+
+    start = clock();
+    for (i = 0; i < top_of_trigt; i++)
+        compile_trigger(trig_index[i]->proto);
+
+    for (i = 0; i < top_of_trigt; i++)
+        for (cl = trig_index[i]->proto->cmdlist; cl; cl = cl->next)
+        {
+            CuAssertTrue(tc, cl->op != DG_OP_NONE);
+            lines++;
+            if (cl->op == DG_OP_IF || cl->op == DG_OP_SWITCH)
+            {
+                blocks++;
+                scanned += !cl->branch;
+            }
+        }
+
+    printf("dg scripts: %s: %d triggers, %d lines compiled in %.3fs, %d of %d blocks left to the scans\n",
+           path, top_of_trigt, lines, (double)(clock() - start) / CLOCKS_PER_SEC,
+           scanned, blocks);
+
+    for (i = 0; i < top_of_trigt; i++)
+    {
+        free_cmdlist(trig_index[i]->proto->cmdlist);
+        trig_index[i]->proto->cmdlist = NULL;
+        free_trigger(trig_index[i]->proto);
+        free(trig_index[i]);
+    }
+    free(trig_index);
+
+    trig_index = saved_index;
+    top_of_trigt = saved_top;
+}
+
+void Test_dg_script_benchmark(CuTest *tc)
+{
+    int saved_compile = dg_compile_triggers;
+    struct room_data room_data, *room = &room_data;
+    struct script_data *sc;
+    trig_data *trig;
+    double text_secs, compiled_secs;
+    const char *path;
+    int i;
+
+    memset(&room_data, 0, sizeof(room_data));
+    CREATE(sc, struct script_data, 1);
+    SCRIPT(room) = sc;
+
+    for (i = 0; busy_triggers[i].name; i++)
+    {
+        CREATE(trig, trig_data, 1);
+        trig->attach_type = WLD_TRIGGER;
+        trig->cmdlist = make_cmdlist(busy_triggers[i].script);
+
+        /* The same answer whichever way the trigger runs. */
+        text_secs = run_trigger(tc, room, trig, 0, busy_triggers[i].result);
+        compiled_secs = run_trigger(tc, room, trig, 1, busy_triggers[i].result);
+        CuAssertTrue(tc, trig->cmdlist->op != DG_OP_NONE);
+
+        if (getenv("LUMINARI_BENCHMARK"))
+            printf("dg scripts: %-24s %d runs, %.2fus from text, %.2fus compiled\n",
+                   busy_triggers[i].name, BENCH_RUNS,
+                   text_secs * 1000000.0 / BENCH_RUNS,
+                   compiled_secs * 1000000.0 / BENCH_RUNS);
+
+        free_cmdlist(trig->cmdlist);
+        free(trig);
+    }
+
+    free(sc);
+
+    /* Point this at a .trg file to check a whole zone compiles. */
+    if ((path = getenv("LUMINARI_TRIGGER_FILE")))
+        compile_trigger_file(tc, path);
+
+    dg_compile_triggers = saved_compile;
+}
+
+#define UID_OBJECTS 500000
+#define UID_SWAPS 200000
+
+static struct obj_data *obj_by_uid(long uid)
+{
+    char name[MAX_INPUT_LENGTH];
+
+    snprintf(name, sizeof(name), "%c%ld", UID_CHAR, uid);
+    return get_obj(name);
+}
+
+/* Stands in for a character: the table only keeps the pointer. */
+static char fake_chars[UID_SWAPS];
+
+void Test_uid_lookup_table(CuTest *tc)
+{
+    struct obj_data *saved_list = object_list, **objs, *obj;
+    long *uids, uid, tmp;
+    double create_secs, find_secs, extract_secs;
+    clock_t start;
+    char buf[MAX_STRING_LENGTH];
+    int i, j;
+
+    object_list = NULL;
+    init_lookup_table();
+    CREATE(objs, struct obj_data *, UID_OBJECTS);
+    CREATE(uids, long, UID_OBJECTS);
+
+    start = clock();
+    for (i = 0; i < UID_OBJECTS; i++)
+        objs[i] = create_obj();
+    create_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (i = 0; i < UID_OBJECTS; i++)
+        CuAssertPtrEquals(tc, objs[i], obj_by_uid(GET_ID(objs[i])));
+    find_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    /* Objects are extracted newest first, the head of object_list. */
+    start = clock();
+    for (i = UID_OBJECTS - 1; i >= UID_OBJECTS / 2; i--)
+    {
+        uids[i] = GET_ID(objs[i]);
+        extract_obj(objs[i]);
+    }
+    for (i = 0; i < UID_OBJECTS / 2; i++)
+        CuAssertPtrEquals(tc, objs[i], obj_by_uid(GET_ID(objs[i])));
+    CuAssertPtrEquals(tc, NULL, obj_by_uid(uids[UID_OBJECTS - 1]));
+
+    while ((obj = object_list))
+        extract_obj(obj);
+    extract_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    CuAssertPtrEquals(tc, NULL, obj_by_uid(uids[UID_OBJECTS / 2]));
+
+    if (getenv("LUMINARI_BENCHMARK"))
+    {
+        lookup_table_repr(buf, sizeof(buf));
+        printf("uid table: %d objects created in %.3fs, found in %.3fus each, extracted in %.3fs\n%s",
+               UID_OBJECTS, create_secs, find_secs * 1000000.0 / UID_OBJECTS, extract_secs, buf);
+    }
+
+    /* Removing in any order leaves the rest to be found. */
+    for (i = 0; i < UID_SWAPS; i++)
+    {
+        uids[i] = i + 1;
+        add_to_lookup_table(uids[i], &fake_chars[i]);
+    }
+    for (i = UID_SWAPS - 1; i > 0; i--)
+    {
+        j = (int)(((unsigned long)i * 2654435761UL) % (i + 1));
+        tmp = uids[i];
+        uids[i] = uids[j];
+        uids[j] = tmp;
+    }
+    for (i = 0; i < UID_SWAPS; i++)
+    {
+        remove_from_lookup_table(uids[i]);
+        if (i % 1000 == 0)
+            for (j = i + 1; j < UID_SWAPS; j += 97)
+            {
+                uid = uids[j];
+                CuAssertPtrEquals(tc, &fake_chars[uid - 1], (char *)find_char(uid));
+            }
+    }
+
+    /* A UID added again takes the new pointer. */
+    add_to_lookup_table(7, &fake_chars[1]);
+    add_to_lookup_table(7, &fake_chars[2]);
+    CuAssertPtrEquals(tc, &fake_chars[2], (char *)find_char(7));
+    remove_from_lookup_table(7);
+
+    free(objs);
+    free(uids);
+    object_list = saved_list;
+    init_lookup_table();
+}
@@ -0,0 +1,95 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../dg_scripts.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_LOOKUPS 1000000
+
+/* How find_replacement() used to tell fields apart: a str_cmp() against
+ * each name in turn. */
+static int linear_dg_field(const char *field)
+{
+    int i;
+
+    for (i = 1; *dg_fields[i] != '\n'; i++)
+        if (!str_cmp(dg_fields[i], field))
+            return i;
+
+    return DG_FIELD_NONE;
+}
+
+static void check_field(CuTest *tc, const char *field)
+{
+    CuAssertIntEquals(tc, linear_dg_field(field), find_dg_field(field));
+}
+
+void Test_dg_field_lookup(CuTest *tc)
+{
+    char buf[MAX_INPUT_LENGTH];
+    double linear_secs, hashed_secs;
+    clock_t start;
+    long hits = 0;
+    int i, j, n;
+
+    /* One name per field, sorted, and a few the code tests by name. */
+    for (n = 1; *dg_fields[n] != '\n'; n++)
+        if (n > 1)
+            CuAssertTrue(tc, str_cmp(dg_fields[n - 1], dg_fields[n]) < 0);
+    CuAssertIntEquals(tc, NUM_DG_FIELDS, n);
+    CuAssertStrEquals(tc, "affect", dg_fields[DG_FIELD_AFFECT]);
+    CuAssertStrEquals(tc, "name", dg_fields[DG_FIELD_NAME]);
+    CuAssertStrEquals(tc, "zonenumber", dg_fields[DG_FIELD_ZONENUMBER]);
+
+    /* Every field, in any case, and everything that is almost a field. */
+    for (i = 1; i < n; i++)
+    {
+        CuAssertIntEquals(tc, i, find_dg_field(dg_fields[i]));
+
+        strlcpy(buf, dg_fields[i], sizeof(buf));
+        for (j = 0; buf[j]; j++)
+            buf[j] = UPPER(buf[j]);
+        CuAssertIntEquals(tc, i, find_dg_field(buf));
+        buf[0] = LOWER(buf[0]);
+        check_field(tc, buf);
+
+        strlcpy(buf, dg_fields[i], sizeof(buf));
+        for (j = strlen(buf); j >= 0; j--)
+        {
+            buf[j] = '\0';
+            check_field(tc, buf);
+        }
+
+        snprintf(buf, sizeof(buf), "%sx", dg_fields[i]);
+        check_field(tc, buf);
+        snprintf(buf, sizeof(buf), "x%s", dg_fields[i]);
+        check_field(tc, buf);
+        snprintf(buf, sizeof(buf), "%s ", dg_fields[i]);
+        check_field(tc, buf);
+    }
+
+    check_field(tc, "");
+    check_field(tc, "nosuchfield");
+    check_field(tc, "mudcommands");
+    CuAssertIntEquals(tc, DG_FIELD_NONE, find_dg_field(NULL));
+
+    start = clock();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+        hits += linear_dg_field(dg_fields[1 + i % (n - 1)]) != DG_FIELD_NONE;
+    linear_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+        hits += find_dg_field(dg_fields[1 + i % (n - 1)]) != DG_FIELD_NONE;
+    hashed_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (getenv("LUMINARI_BENCHMARK"))
+        printf("dg fields: %d names, %.3fus by str_cmp, %.3fus hashed (%ld found)\n",
+               n - 1, linear_secs * 1000000.0 / BENCH_LOOKUPS,
+               hashed_secs * 1000000.0 / BENCH_LOOKUPS, hits);
+}
@@ -0,0 +1,115 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../file_worker.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_FILES 10
+#define TEST_SAVES 200
+#define TEST_LINES 1000 /* about the size of a player file */
+
+static void file_path(char *buf, size_t n, const char *dir, int file)
+{
+    snprintf(buf, n, "%s/player%d", dir, file);
+}
+
+static void write_save(const char *dir, int save)
+{
+    char path[PATH_MAX];
+    struct file_job *job;
+    int i;
+
+    file_path(path, sizeof(path), dir, save % TEST_FILES);
+    job = file_job_new(path);
+    fprintf(file_job_fp(job), "Save %d\n", save);
+    for (i = 0; i < TEST_LINES; i++)
+        fprintf(file_job_fp(job), "Line %d of save %d\n", i, save);
+    file_job_write(job);
+}
+
+/* The save a file holds, -1 if it is missing or cut short. */
+static int read_save(const char *dir, int file)
+{
+    char path[PATH_MAX], line[128];
+    int save = -1, lines = 0;
+    FILE *fl;
+
+    file_path(path, sizeof(path), dir, file);
+    if (!(fl = fopen(path, "r")))
+        return -1;
+
+    if (fscanf(fl, "Save %d\n", &save) != 1)
+        save = -1;
+    while (fgets(line, sizeof(line), fl))
+        lines++;
+    fclose(fl);
+
+    return lines == TEST_LINES ? save : -1;
+}
+
+static double saves_msec(const char *dir, int first)
+{
+    struct timeval start, end;
+    int i;
+
+    gettimeofday(&start, NULL);
+    for (i = first; i < first + TEST_SAVES; i++)
+        write_save(dir, i);
+    gettimeofday(&end, NULL);
+
+    return ((end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_usec - start.tv_usec) / 1000.0) / TEST_SAVES;
+}
+
+void Test_file_worker(CuTest *tc)
+{
+    char dir[] = "/tmp/file_worker_XXXXXX", path[PATH_MAX];
+    struct file_job *job;
+    double inline_msec, queued_msec;
+    int i;
+
+    CuAssertPtrNotNull(tc, mkdtemp(dir));
+
+    /* Without the writer running, the file is there right away. */
+    write_save(dir, 0);
+    CuAssertIntEquals(tc, 0, read_save(dir, 0));
+    snprintf(path, sizeof(path), "%s/player0.tmp", dir);
+    CuAssertTrue(tc, access(path, F_OK) < 0);
+
+    /* A cancelled save leaves the file as it was. */
+    file_path(path, sizeof(path), dir, 0);
+    job = file_job_new(path);
+    fprintf(file_job_fp(job), "Save 99\n");
+    file_job_cancel(job);
+    CuAssertIntEquals(tc, 0, read_save(dir, 0));
+
+    inline_msec = saves_msec(dir, 0);
+
+    CuAssertIntEquals(tc, 0, file_worker_init());
+    queued_msec = saves_msec(dir, TEST_SAVES);
+
+    /* Whatever was replaced in the queue, each file ends up with its last
+     * save, and never half of one. */
+    file_worker_wait(path);
+    CuAssertIntEquals(tc, 2 * TEST_SAVES - TEST_FILES, read_save(dir, 0));
+    file_worker_flush();
+    for (i = 0; i < TEST_FILES; i++)
+        CuAssertIntEquals(tc, 2 * TEST_SAVES - TEST_FILES + i, read_save(dir, i));
+
+    if (getenv("LUMINARI_BENCHMARK"))
+        printf("file worker: %d saves of %d lines, %.3fms each on the game thread written there, %.3fms queued\n",
+               TEST_SAVES, TEST_LINES, inline_msec, queued_msec);
+
+    file_worker_shutdown();
+
+    for (i = 0; i < TEST_FILES; i++)
+    {
+        file_path(path, sizeof(path), dir, i);
+        unlink(path);
+    }
+    rmdir(dir);
+}
@@ -5,9 +5,13 @@
 #include "../../utils.h"
 #include "../../structs.h"
 #include "../../interpreter.h"
+#include "../../db.h"
+#include "../../act.h"
 
 #include <stdio.h>
 #include <stddef.h>
+#include <ctype.h>
+#include <time.h>
 
 
 void Test_three_arguments_u(CuTest *tc)
@@ -52,4 +56,146 @@ void Test_three_arguments(CuTest *tc)
         CuAssertStrEquals(tc, exp_outp2, outp2);
         CuAssertStrEquals(tc, exp_outp3, outp3);
     }
-}
\ No newline at end of file
+}
+/* The way command_interpreter() used to find a command: the first real
+ * command in complete_cmd_info[] that arg abbreviates, else the first
+ * social. */
+static int linear_command_abbrev(const char *arg, int level)
+{
+    size_t length = strlen(arg);
+    int cmd;
+
+    for (cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
+        if (complete_cmd_info[cmd].command_pointer != do_action &&
+            !strncmp(complete_cmd_info[cmd].command, arg, length) &&
+            level >= complete_cmd_info[cmd].minimum_level)
+            return cmd;
+
+    for (cmd = 0; *complete_cmd_info[cmd].command != '\n'; cmd++)
+        if (complete_cmd_info[cmd].command_pointer == do_action &&
+            !strncmp(complete_cmd_info[cmd].command, arg, length) &&
+            level >= complete_cmd_info[cmd].minimum_level)
+            return cmd;
+
+    return -1;
+}
+
+/* What gets typed when nobody has given us a log to replay. */
+static const char *sample_session[] = {
+    "l", "look", "n", "s", "e", "w", "u", "d", "k", "kill", "get", "drop",
+    "i", "inv", "eq", "sc", "score", "'", "say", "gos", "tell", "reply",
+    "who", "where", "cast", "c", "rest", "sleep", "wake", "stand", "open",
+    "close", "unlock", "wear", "wield", "rem", "sm", "smile", "nod", "sal",
+    "grin", "bow", "flee", "bash", "kick", "cons", "buy", "sell", "list",
+    "value", "prep", "mem", "affects", "aff", "help", "save", "quit",
+    "xyzzy", "nosuchcommand", NULL};
+
+#define COMMAND_LOG_MAX 100000
+#define COMMAND_REPLAYS 200
+
+void Test_command_lookup(CuTest *tc)
+{
+    static char nod[] = "nod", salute[] = "salute", sal[] = "sal",
+                smile[] = "smile", sm[] = "sm", smirk[] = "smirk";
+    static struct social_messg socials[] = {
+        {0, nod, nod},
+        {0, salute, sal},
+        {0, smile, sm},
+        {0, smirk, smirk, 0, 0, 0, LVL_IMMORT}};
+    static const int levels[] = {1, LVL_IMMORT, LVL_IMPL};
+    struct social_messg *saved_socials = soc_mess_list;
+    int saved_top = top_of_socialt;
+    char **lines = NULL, buf[MAX_INPUT_LENGTH], arg[MAX_INPUT_LENGTH], *p;
+    const char *log_name = getenv("LUMINARI_COMMAND_LOG"), *source = "sample session";
+    int i, j, l, num_lines = 0, linear_hits = 0, indexed_hits = 0;
+    double linear_secs, indexed_secs;
+    clock_t start;
+    FILE *fl;
+
+    soc_mess_list = socials;
+    top_of_socialt = sizeof(socials) / sizeof(socials[0]) - 1;
+    create_command_list();
+    sort_commands();
+
+    /* Every prefix of every command means the same thing it always did. */
+    for (i = 0; *complete_cmd_info[i].command != '\n'; i++)
+        for (j = 1; complete_cmd_info[i].command[j - 1]; j++)
+        {
+            strlcpy(buf, complete_cmd_info[i].command, MIN(j + 1, (int)sizeof(buf)));
+            for (l = 0; l < (int)(sizeof(levels) / sizeof(levels[0])); l++)
+                CuAssertIntEquals_Msg(tc, buf, linear_command_abbrev(buf, levels[l]),
+                                      find_command_abbrev(buf, levels[l]));
+        }
+
+    /* Real commands beat socials, and socials are level gated too. */
+    CuAssertStrEquals(tc, "sacrifice", complete_cmd_info[find_command_abbrev("sa", 1)].command);
+    CuAssertStrEquals(tc, "salute", complete_cmd_info[find_command_abbrev("sal", 1)].command);
+    CuAssertIntEquals(tc, -1, find_command_abbrev("smir", 1));
+    CuAssertStrEquals(tc, "smirk", complete_cmd_info[find_command_abbrev("smir", LVL_IMMORT)].command);
+    CuAssertIntEquals(tc, -1, find_command_abbrev("nosuchcommand", LVL_IMPL));
+    CuAssertIntEquals(tc, find_command_abbrev("look", 1), find_command("look"));
+    CuAssertIntEquals(tc, -1, find_command("loo"));
+
+    /* Replay a log of typed commands, one per line, through both. */
+    if (log_name && (fl = fopen(log_name, "r")))
+    {
+        source = log_name;
+        CREATE(lines, char *, COMMAND_LOG_MAX);
+        while (num_lines < COMMAND_LOG_MAX && fgets(buf, sizeof(buf), fl))
+        {
+            p = buf;
+            skip_spaces(&p);
+            if (!*p)
+                continue;
+            if (isalpha(*p))
+                any_one_arg(p, arg);
+            else
+            {
+                arg[0] = *p;
+                arg[1] = '\0';
+            }
+            lines[num_lines++] = strdup(arg);
+        }
+        fclose(fl);
+    }
+    else
+    {
+        for (num_lines = 0; sample_session[num_lines]; num_lines++)
+            ;
+        CREATE(lines, char *, num_lines);
+        for (i = 0; i < num_lines; i++)
+            lines[i] = strdup(sample_session[i]);
+    }
+
+    start = clock();
+    for (j = 0; j < COMMAND_REPLAYS; j++)
+        for (i = 0; i < num_lines; i++)
+            linear_hits += linear_command_abbrev(lines[i], 1) >= 0;
+    linear_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (j = 0; j < COMMAND_REPLAYS; j++)
+        for (i = 0; i < num_lines; i++)
+            indexed_hits += find_command_abbrev(lines[i], 1) >= 0;
+    indexed_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    CuAssertIntEquals(tc, linear_hits, indexed_hits);
+
+    if (getenv("LUMINARI_BENCHMARK"))
+        printf("command lookup: %d commands x %d from %s, linear %.3fs, indexed %.3fs\n",
+               num_lines, COMMAND_REPLAYS, source,
+               linear_secs, indexed_secs);
+
+    for (i = 0; i < num_lines; i++)
+        free(lines[i]);
+    free(lines);
+
+    free_command_list();
+    soc_mess_list = saved_socials;
+    top_of_socialt = saved_top;
+    if (saved_socials)
+    {
+        create_command_list();
+        sort_commands();
+    }
+}
@@ -0,0 +1,114 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../lists.h"
+#include "../../dg_event.h"
+#include "../../mud_event.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_MOBS 5000
+#define BENCH_ROUNDS 200
+
+/* Countdown events that are attached to every mob. */
+static const event_id bench_events[] = {
+    eTAUNT, eTAUNTED, eMUMMYDUST, eDRAGONKNIGHT, eGREATERRUIN, eHELLBALL, eEPICMAGEARMOR, eEPICWARDING};
+#define NUM_BENCH_EVENTS (int)(sizeof(bench_events) / sizeof(bench_events[0]))
+
+/* The way char_has_mud_event() used to find an event. */
+static struct mud_event_data *walk_events(struct char_data *ch, event_id iId)
+{
+    struct iterator_data it;
+    struct event *pEvent;
+    struct mud_event_data *pMudEvent, *found = NULL;
+
+    if (ch->events == NULL)
+        return NULL;
+
+    for (pEvent = (struct event *)merge_iterator(&it, ch->events); pEvent; pEvent = next_in_list(&it))
+    {
+        pMudEvent = (struct mud_event_data *)pEvent->event_obj;
+        if (pMudEvent->iId == iId)
+        {
+            found = pMudEvent;
+            break;
+        }
+    }
+    remove_iterator(&it);
+
+    return found;
+}
+
+void Test_char_has_mud_event_benchmark(CuTest *tc)
+{
+    static bool queue_ready = FALSE;
+    struct char_data *mobs;
+    struct mud_event_data *pMudEvent;
+    clock_t start;
+    double walk_secs, lookup_secs;
+    int i, j, r, hits = 0;
+
+    if (!queue_ready)
+    {
+        if (global_lists == NULL)
+            global_lists = create_list();
+        event_init();
+        queue_ready = TRUE;
+    }
+
+    CREATE(mobs, struct char_data, BENCH_MOBS);
+
+    for (i = 0; i < BENCH_MOBS; i++)
+        for (j = 0; j < NUM_BENCH_EVENTS; j++)
+            attach_mud_event(new_mud_event(bench_events[j], &mobs[i], NULL), 1000 + j);
+
+    /* Lookups agree with the list, for present and absent events. */
+    for (i = 0; i < BENCH_MOBS; i++)
+    {
+        CuAssertPtrEquals(tc, NULL, char_has_mud_event(&mobs[i], eSTUNNED));
+        for (j = 0; j < NUM_BENCH_EVENTS; j++)
+        {
+            pMudEvent = char_has_mud_event(&mobs[i], bench_events[j]);
+            CuAssertPtrNotNull(tc, pMudEvent);
+            CuAssertPtrEquals(tc, walk_events(&mobs[i], bench_events[j]), pMudEvent);
+            CuAssertPtrEquals(tc, &mobs[i], pMudEvent->pStruct);
+        }
+    }
+
+    /* What mobile_activity() does: is this mob stunned?  Plus a hit on the
+     * last event in each list. */
+    start = clock();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+        for (i = 0; i < BENCH_MOBS; i++)
+            hits += (walk_events(&mobs[i], eSTUNNED) != NULL) + (walk_events(&mobs[i], eEPICWARDING) != NULL);
+    walk_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (r = 0; r < BENCH_ROUNDS; r++)
+        for (i = 0; i < BENCH_MOBS; i++)
+            hits += (char_has_mud_event(&mobs[i], eSTUNNED) != NULL) + (char_has_mud_event(&mobs[i], eEPICWARDING) != NULL);
+    lookup_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (getenv("LUMINARI_BENCHMARK"))
+        printf("char_has_mud_event: %d mobs x %d events, %d lookups: list walk %.3fs, index %.3fs\n",
+               BENCH_MOBS, NUM_BENCH_EVENTS, 2 * BENCH_ROUNDS * BENCH_MOBS, walk_secs, lookup_secs);
+
+    CuAssertIntEquals(tc, 2 * BENCH_ROUNDS * BENCH_MOBS, hits);
+
+    /* Cancelling drops the events from the index as well. */
+    for (i = 0; i < BENCH_MOBS; i++)
+    {
+        for (j = 0; j < NUM_BENCH_EVENTS; j++)
+        {
+            event_cancel(char_has_mud_event(&mobs[i], bench_events[j])->pEvent);
+            CuAssertPtrEquals(tc, NULL, char_has_mud_event(&mobs[i], bench_events[j]));
+        }
+        CuAssertPtrEquals(tc, NULL, mobs[i].events);
+    }
+
+    free(mobs);
+}
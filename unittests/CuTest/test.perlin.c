@@ -0,0 +1,46 @@
+#include "CuTest.h"
+
+#include "../../perlin.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#define GRID_TOLERANCE 1e-12
+
+static void check_grid(CuTest *tc, int idx, double x0, double y0, double dx, double dy,
+                       int w, int h, double alpha, double beta, int n)
+{
+    static double out[130 * 70];
+    int r, c;
+
+    PerlinNoise2DGrid(idx, x0, y0, dx, dy, w, h, alpha, beta, n, out);
+
+    for (r = 0; r < h; r++)
+    {
+        for (c = 0; c < w; c++)
+        {
+            double exp = PerlinNoise2D(idx, x0 + c * dx, y0 + r * dy, alpha, beta, n);
+
+            CuAssertDblEquals(tc, exp, out[r * w + c], GRID_TOLERANCE);
+        }
+    }
+}
+
+void Test_PerlinNoise2DGrid(CuTest *tc)
+{
+    init_perlin(0, 822344);
+    init_perlin(1, 834);
+
+    // Single point
+    check_grid(tc, 0, 0.25, -0.5, 1.0, 1.0, 1, 1, 2.0, 2.0, 16);
+
+    // Wilderness elevation and moisture scales, negative coordinates
+    check_grid(tc, 0, -20 / 1024.0, -20 / 1024.0, 1 / 1024.0, 1 / 1024.0, 41, 41, 2.0, 2.0, 16);
+    check_grid(tc, 1, 700 / 256.0, -900 / 256.0, 1 / 256.0, 1 / 256.0, 41, 41, 1.5, 2.0, 8);
+
+    // Spans several blocks in both directions, odd sizes
+    check_grid(tc, 1, -3.3, 1.7, 0.013, 0.029, 130, 70, 2.0, 2.0, 12);
+
+    // Single row, as used by the map exporters
+    check_grid(tc, 0, -1.0, 0.5, 1 / 512.0, 0.0, 130, 1, 2.0, 2.0, 16);
+}
@@ -0,0 +1,127 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../db.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_PLAYERS 200000
+#define BENCH_LINEAR_LOOKUPS 1000
+#define BENCH_HASHED_LOOKUPS 1000000
+
+/* How player_table used to be searched. */
+static long linear_ptable_by_name(const char *name)
+{
+    int i;
+
+    for (i = 0; i <= top_of_p_table; i++)
+        if (!str_cmp(player_table[i].name, name))
+            return i;
+
+    return -1;
+}
+
+static long linear_ptable_by_id(long id)
+{
+    int i;
+
+    for (i = 0; i <= top_of_p_table; i++)
+        if (player_table[i].id == id)
+            return i;
+
+    return -1;
+}
+
+static void bench_name(char *buf, size_t n, int i)
+{
+    snprintf(buf, n, "Player%c%d", 'a' + i % 26, i);
+}
+
+void Test_player_index(CuTest *tc)
+{
+    struct player_index_element *saved_table = player_table;
+    int saved_top = top_of_p_table;
+    char name[MAX_NAME_LENGTH + 16];
+    double build_secs, linear_secs, hashed_secs;
+    clock_t start;
+    long hits = 0;
+    int i;
+
+    player_table = NULL;
+    top_of_p_table = -1;
+
+    start = clock();
+    for (i = 0; i < BENCH_PLAYERS; i++)
+    {
+        bench_name(name, sizeof(name), i);
+        CuAssertIntEquals(tc, i, create_entry(name));
+        set_player_index_id(i, 1000 + i);
+    }
+    build_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    /* Names are found whatever their case, ids by number. */
+    CuAssertIntEquals(tc, 12345, get_ptable_by_name("PLAYERV12345"));
+    CuAssertIntEquals(tc, 1000 + 12345, get_id_by_name("playerv12345"));
+    CuAssertStrEquals(tc, "playerv12345", get_name_by_id(1000 + 12345));
+    CuAssertIntEquals(tc, -1, get_ptable_by_name("Nobody"));
+    CuAssertPtrEquals(tc, NULL, get_name_by_id(999));
+
+    /* The same name again reuses its entry. */
+    strlcpy(name, "PLAYERH7", sizeof(name));
+    CuAssertIntEquals(tc, 7, create_entry(name));
+    CuAssertIntEquals(tc, BENCH_PLAYERS - 1, top_of_p_table);
+
+    /* Renames and new ids move the entry in the hashes. */
+    set_player_index_name(42, "Renamed");
+    CuAssertIntEquals(tc, 42, get_ptable_by_name("renamed"));
+    CuAssertIntEquals(tc, -1, get_ptable_by_name("Playerq42"));
+    set_player_index_id(42, 5);
+    CuAssertStrEquals(tc, "renamed", get_name_by_id(5));
+    CuAssertPtrEquals(tc, NULL, get_name_by_id(1042));
+
+    /* Removing an entry moves everything after it down one. */
+    remove_player_from_index(10);
+    CuAssertIntEquals(tc, BENCH_PLAYERS - 2, top_of_p_table);
+    CuAssertIntEquals(tc, -1, get_ptable_by_name("Playerk10"));
+    CuAssertIntEquals(tc, 10, get_ptable_by_name("Playerl11"));
+    CuAssertIntEquals(tc, 41, get_ptable_by_id(5));
+
+    for (i = 0; i < BENCH_LINEAR_LOOKUPS; i++)
+    {
+        bench_name(name, sizeof(name), (int)((long)i * 7919 % BENCH_PLAYERS));
+        CuAssertIntEquals(tc, linear_ptable_by_name(name), get_ptable_by_name(name));
+        CuAssertIntEquals(tc, linear_ptable_by_id(1000 + i * 7), get_ptable_by_id(1000 + i * 7));
+    }
+
+    start = clock();
+    for (i = 0; i < BENCH_LINEAR_LOOKUPS; i++)
+    {
+        bench_name(name, sizeof(name), (int)((long)i * 7919 % BENCH_PLAYERS));
+        hits += linear_ptable_by_name(name) >= 0;
+    }
+    linear_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (i = 0; i < BENCH_HASHED_LOOKUPS; i++)
+    {
+        bench_name(name, sizeof(name), (int)((long)i * 7919 % BENCH_PLAYERS));
+        hits += get_ptable_by_name(name) >= 0;
+    }
+    hashed_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (getenv("LUMINARI_BENCHMARK"))
+        printf("player index: %d entries built in %.3fs, by name %.2fus linear, %.3fus hashed (%ld found)\n",
+               BENCH_PLAYERS, build_secs,
+               linear_secs * 1000000.0 / BENCH_LINEAR_LOOKUPS,
+               hashed_secs * 1000000.0 / BENCH_HASHED_LOOKUPS, hits);
+
+    free_player_index();
+    player_table = saved_table;
+    top_of_p_table = saved_top;
+    if (player_table)
+        index_player_table();
+}
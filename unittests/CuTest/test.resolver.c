@@ -0,0 +1,101 @@
+#include "CuTest.h"
+
+#include "../../conf.h"
+#include "../../sysdep.h"
+#include "../../structs.h"
+#include "../../utils.h"
+#include "../../comm.h"
+#include "../../resolver.h"
+
+#include <arpa/inet.h>
+
+/* Stands in for the name server, like a hosts file: addresses not in it
+ * have no name. */
+static const char *fake_hosts[][2] = {
+    {"10.0.0.1", "one.example.org"},
+    {"10.0.0.2", "two.example.org"},
+    {NULL, NULL}};
+
+static int fake_calls = 0;
+
+static int fake_lookup(const struct in_addr *addr, char *host, size_t n)
+{
+    struct in_addr a;
+    int i;
+
+    __sync_fetch_and_add(&fake_calls, 1);
+
+    for (i = 0; fake_hosts[i][0]; i++)
+        if (inet_aton(fake_hosts[i][0], &a) && a.s_addr == addr->s_addr)
+        {
+            strlcpy(host, fake_hosts[i][1], n);
+            return 0;
+        }
+
+    return -1;
+}
+
+static void connect_from(struct descriptor_data *d, const char *ip)
+{
+    struct in_addr a;
+
+    inet_aton(ip, &a);
+    resolver_lookup(d, &a);
+}
+
+void Test_resolver_cache(CuTest *tc)
+{
+    struct descriptor_data *saved_list = descriptor_list;
+    struct descriptor_data a, b, c, d, e;
+
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    memset(&c, 0, sizeof(c));
+    memset(&d, 0, sizeof(d));
+    memset(&e, 0, sizeof(e));
+
+    resolver_set_func(fake_lookup);
+    CuAssertIntEquals(tc, 0, resolver_init(2));
+
+    a.next = &b;
+    b.next = &c;
+    descriptor_list = &a;
+
+    /* Everyone starts out numeric, and two connections from the same
+     * address share one lookup. */
+    connect_from(&a, "10.0.0.1");
+    connect_from(&b, "10.0.0.1");
+    connect_from(&c, "10.0.0.3");
+    CuAssertStrEquals(tc, "10.0.0.1", a.host);
+    CuAssertStrEquals(tc, "10.0.0.1", b.host);
+    CuAssertTrue(tc, a.host_pending && b.host_pending && c.host_pending);
+
+    resolver_flush();
+    CuAssertIntEquals(tc, 2, fake_calls);
+    CuAssertStrEquals(tc, "one.example.org", a.host);
+    CuAssertStrEquals(tc, "one.example.org", b.host);
+    CuAssertStrEquals(tc, "10.0.0.3", c.host);
+    CuAssertTrue(tc, !a.host_pending && !b.host_pending && !c.host_pending);
+
+    /* Names and failures are cached. */
+    connect_from(&d, "10.0.0.1");
+    CuAssertStrEquals(tc, "one.example.org", d.host);
+    CuAssertTrue(tc, !d.host_pending);
+    connect_from(&d, "10.0.0.3");
+    CuAssertStrEquals(tc, "10.0.0.3", d.host);
+    CuAssertIntEquals(tc, 2, fake_calls);
+
+    /* A connection that is gone by the time the name comes back. */
+    connect_from(&e, "10.0.0.2");
+    CuAssertTrue(tc, e.host_pending);
+    resolver_flush();
+    CuAssertStrEquals(tc, "10.0.0.2", e.host);
+    CuAssertIntEquals(tc, 3, fake_calls);
+
+    connect_from(&e, "10.0.0.2");
+    CuAssertStrEquals(tc, "two.example.org", e.host);
+
+    descriptor_list = saved_list;
+    resolver_shutdown();
+    resolver_set_func(NULL);
+}
@@ -0,0 +1,134 @@
+/* ************************************************************************
+*  file: connload.c                                   Part of LuminariMUD *
+*  Usage: Open a pile of idle connections to a running MUD, to check that *
+*         the per-pulse cost of idle descriptors stays flat.              *
+*         connload <port> <connections> [seconds] [host]                  *
+************************************************************************* */
+
+#include "conf.h"
+#include "sysdep.h"
+
+#include <poll.h>
+
+/*
+ * Every connection sits at the login prompt and never types anything, it only
+ * reads whatever the MUD sends so the MUD's output never backs up.  While it
+ * runs, watch "perfmon summ" and "perfmon poller" in the game: the pulse usage
+ * should stay where it was with only a handful of players on.
+ *
+ * The MUD will not take more than CONFIG_MAX_PLAYING connections, and both
+ * ends need a file descriptor limit (ulimit -n) above the connection count.
+ */
+
+static int open_connection(struct sockaddr_in *sa)
+{
+  int s, flags;
+
+  if ((s = socket(PF_INET, SOCK_STREAM, 0)) < 0)
+  {
+    perror("socket");
+    return (-1);
+  }
+
+  if (connect(s, (struct sockaddr *)sa, sizeof(*sa)) < 0)
+  {
+    perror("connect");
+    close(s);
+    return (-1);
+  }
+
+  flags = fcntl(s, F_GETFL, 0);
+  fcntl(s, F_SETFL, flags | O_NONBLOCK);
+
+  return (s);
+}
+
+int main(int argc, char **argv)
+{
+  struct sockaddr_in sa;
+  struct pollfd *pfds;
+  char buf[4096];
+  int port, wanted, seconds = 60, open_now = 0, dropped = 0, i, n;
+  long bytes = 0;
+  time_t end;
+
+  if (argc < 3)
+  {
+    fprintf(stderr, "Usage: %s <port> <connections> [seconds] [host]\n", argv[0]);
+    exit(1);
+  }
+
+  port = atoi(argv[1]);
+  wanted = atoi(argv[2]);
+  if (argc > 3)
+    seconds = atoi(argv[3]);
+
+  if (port < 1 || wanted < 1 || seconds < 1)
+  {
+    fprintf(stderr, "Port, connections and seconds must all be positive.\n");
+    exit(1);
+  }
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = inet_addr(argc > 4 ? argv[4] : "127.0.0.1");
+
+  if ((pfds = calloc(wanted, sizeof(struct pollfd))) == NULL)
+  {
+    perror("calloc");
+    exit(1);
+  }
+
+  for (i = 0; i < wanted; i++)
+  {
+    if ((pfds[open_now].fd = open_connection(&sa)) < 0)
+      break;
+    pfds[open_now].events = POLLIN;
+    open_now++;
+
+    if (open_now % 500 == 0)
+      printf("%d connections open.\n", open_now);
+  }
+
+  printf("%d of %d connections open, holding them for %d seconds.\n", open_now, wanted, seconds);
+
+  end = time(0) + seconds;
+  while (time(0) < end && open_now - dropped > 0)
+  {
+    if (poll(pfds, open_now, 1000) < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      perror("poll");
+      break;
+    }
+
+    for (i = 0; i < open_now; i++)
+    {
+      if (pfds[i].fd < 0 || !pfds[i].revents)
+        continue;
+
+      while ((n = read(pfds[i].fd, buf, sizeof(buf))) > 0)
+        bytes += n;
+
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+      {
+        /* the MUD hung up on us, probably the idle password timeout */
+        close(pfds[i].fd);
+        pfds[i].fd = -1;
+        dropped++;
+      }
+    }
+  }
+
+  printf("Done: %d connections held, %d closed by the MUD, %ld bytes read.\n",
+         open_now - dropped, dropped, bytes);
+
+  for (i = 0; i < open_now; i++)
+    if (pfds[i].fd >= 0)
+      close(pfds[i].fd);
+
+  free(pfds);
+  return (0);
+}
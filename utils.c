@@ -3628,14 +3628,13 @@ int get_daily_uses(struct char_data *ch, int featnum) {
 }
 
 /* Function to create an event, based on the mud_event passed in, that will either:
- * 1.) Create a new event with the proper sVariables
- * 2.) Update an existing event with a new sVariable value
+ * 1.) Create a new event with one use on cooldown
+ * 2.) Update an existing event with a new number of uses
  *
  * Returns the current number of uses on cooldown. */
 int start_daily_use_cooldown(struct char_data *ch, int featnum) {
   struct mud_event_data * pMudEvent = NULL;
   int uses = 0, daily_uses = 0;
-  char buf[128];
   event_id iId = 0;
 
   /* Transform the feat number to the event id for that ability. */
@@ -3652,30 +3651,15 @@ int start_daily_use_cooldown(struct char_data *ch, int featnum) {
 
   if ((pMudEvent = char_has_mud_event(ch, iId))) {
     /* Player is on cooldown for this ability - just update the event. */
-    /* The number of uses is stored in the pMudEvent->sVariables field. */
-    if (pMudEvent->sVariables == NULL) {
-      /* This is odd - This field should always be populated for daily-use abilities,
-       * maybe some legacy code or bad id. */
-      log("SYSERR: sVariables field is NULL for daily-use-cooldown-event: %d", iId);
-    } else {
-
-      if (sscanf(pMudEvent->sVariables, "uses:%d", &uses) != 1) {
-        log("SYSERR: In start_daily_use_cooldown, bad sVariables for daily-use-cooldown-event: %d", iId);
-        uses = 0;
-      }
-      free(pMudEvent->sVariables);
-    }
-    uses++;
+    /* The number of uses is stored in pMudEvent->iVars[0]. */
+    uses = ++pMudEvent->iVars[0];
 
     if (uses > daily_uses)
       log("SYSERR: Daily uses exceeed maximum for %s, feat %s", GET_NAME(ch), feat_list[featnum].name);
-
-    snprintf(buf, sizeof(buf), "uses:%d", uses);
-    pMudEvent->sVariables = strdup(buf);
   } else {
     /* No event - so attach one. */
     uses = 1;
-    attach_mud_event(new_mud_event(iId, ch, "uses:1"), (SECS_PER_MUD_DAY / daily_uses) RL_SEC);
+    attach_mud_event(new_mud_event_var(iId, ch, 1), (SECS_PER_MUD_DAY / daily_uses) RL_SEC);
   }
 
   return uses;
@@ -3692,18 +3676,8 @@ int daily_uses_remaining(struct char_data *ch, int featnum) {
   if ((iId = feat_list[featnum].event) == eNULL)
     return -1;
 
-  if ((pMudEvent = char_has_mud_event(ch, iId))) {
-    if (pMudEvent->sVariables == NULL) {
-      /* This is odd - This field should always be populated for daily-use abilities,
-       * maybe some legacy code or bad id. */
-      log("SYSERR: sVariables field is NULL for daily-use-cooldown-event: %d", iId);
-    } else {
-      if (sscanf(pMudEvent->sVariables, "uses:%d", &uses) != 1) {
-        log("SYSERR: In daily_uses_remaining, bad sVariables for daily-use-cooldown-event: %d", iId);
-        uses = 0;
-      }
-    }
-  }
+  if ((pMudEvent = char_has_mud_event(ch, iId)))
+    uses = pMudEvent->iVars[0];
 
   uses_per_day = get_daily_uses(ch, featnum);
 
@@ -3711,14 +3685,13 @@ int daily_uses_remaining(struct char_data *ch, int featnum) {
 }
 
 /* Function to create an event, based on the mud_event passed in, that will either:
- * 1.) Create a new event with the proper sVariables
- * 2.) Update an existing event with a new sVariable value
+ * 1.) Create a new event with one use on cooldown
+ * 2.) Update an existing event with a new number of uses
  *
  * Returns the current number of uses on cooldown. */
 int start_item_specab_daily_use_cooldown(struct obj_data *obj, int specab) {
   struct mud_event_data * pMudEvent = NULL;
   int uses = 0, daily_uses = 0;
-  char buf[128];
   event_id iId = 0;
 
   /* Transform the feat number to the event id for that ability. */
@@ -3735,30 +3708,15 @@ int start_item_specab_daily_use_cooldown(struct obj_data *obj, int specab) {
 
   if ((pMudEvent = obj_has_mud_event(obj, iId))) {
     /* Player is on cooldown for this ability - just update the event. */
-    /* The number of uses is stored in the pMudEvent->sVariables field. */
-    if (pMudEvent->sVariables == NULL) {
-      /* This is odd - This field should always be populated for daily-use abilities,
-       * maybe some legacy code or bad id. */
-      log("SYSERR: sVariables field is NULL for daily-use-cooldown-event: %d", iId);
-    } else {
-
-      if (sscanf(pMudEvent->sVariables, "uses:%d", &uses) != 1) {
-        log("SYSERR: In start_daily_use_cooldown, bad sVariables for daily-use-cooldown-event: %d", iId);
-        uses = 0;
-      }
-      free(pMudEvent->sVariables);
-    }
-    uses++;
+    /* The number of uses is stored in pMudEvent->iVars[0]. */
+    uses = ++pMudEvent->iVars[0];
 
     if (uses > daily_uses)
       log("SYSERR: Daily uses exceeed maximum for %s, specab %s", obj->name, special_ability_info[specab].name);
-
-    snprintf(buf, sizeof(buf), "uses:%d", uses);
-    pMudEvent->sVariables = strdup(buf);
   } else {
     /* No event - so attach one. */
     uses = 1;
-    attach_mud_event(new_mud_event(iId, obj, "uses:1"), (SECS_PER_MUD_DAY / daily_uses) RL_SEC);
+    attach_mud_event(new_mud_event_var(iId, obj, 1), (SECS_PER_MUD_DAY / daily_uses) RL_SEC);
   }
 
   return uses;
@@ -3775,18 +3733,8 @@ int daily_item_specab_uses_remaining(struct obj_data *obj, int specab) {
   if ((iId = special_ability_info[specab].event) == eNULL)
     return -1;
 
-  if ((pMudEvent = obj_has_mud_event(obj, iId))) {
-    if (pMudEvent->sVariables == NULL) {
-      /* This is odd - This field should always be populated for daily-use abilities,
-       * maybe some legacy code or bad id. */
-      log("SYSERR: sVariables field is NULL for daily-use-cooldown-event: %d", iId);
-    } else {
-      if (sscanf(pMudEvent->sVariables, "uses:%d", &uses) != 1) {
-        log("SYSERR: In daily_uses_remaining, bad sVariables for daily-use-cooldown-event: %d", iId);
-        uses = 0;
-      }
-    }
-  }
+  if ((pMudEvent = obj_has_mud_event(obj, iId)))
+    uses = pMudEvent->iVars[0];
 
   uses_per_day = special_ability_info[specab].daily_uses;
 
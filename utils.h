@@ -1064,6 +1064,7 @@ void char_from_furniture(struct char_data *ch);
 
 /** Retrieve command aliases for ch. */
 #define GET_ALIASES(ch) CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->aliases))
+#define GET_ALIAS_INDEX(ch) CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->alias_index))
 
 /** Who ch last spoke to with the 'tell' command. */
 #define GET_LAST_TELL(ch) CHECK_PLAYER_SPECIAL((ch), ((ch)->player_specials->last_tell))
@@ -15,14 +15,187 @@
 #include "constants.h"
 #include "mud_event.h"
 #include "wilderness.h"
-#include "kdtree.h"
 
 #include "mysql.h"
+#include "region_index.h"
+#include "terrain_cache.h"
 #include "desc_engine.h"
 
 void insert_path(struct path_data *path);
 
-struct kdtree *kd_wilderness_rooms = NULL;
+/* Wilderness rooms by coordinates.  Both indexes are open addressing hashes
+ * with linear probing, keyed by (x, y):
+ *
+ * - static_rooms holds the rooms built in the wilderness zone, and is sized
+ *   to fit them when initialize_wilderness_lists() builds it.
+ * - dynamic_rooms holds the rooms of the dynamic pool that are in use.  The
+ *   free ones wait on a stack, so moving around the wilderness never scans
+ *   the pool.
+ *
+ * Everything holds rnums, so initialize_wilderness_lists() rebuilds it all
+ * whenever world[] is renumbered. */
+#define WILD_DYNAMIC_ROOMS (WILD_DYNAMIC_ROOM_VNUM_END - WILD_DYNAMIC_ROOM_VNUM_START + 1)
+#define WILD_COORD_HASH_SIZE 16384 /* a power of two, well over twice the pool */
+
+struct wild_coord_slot
+{
+  int x, y;
+  room_rnum room; /* NOWHERE if the slot is empty */
+};
+
+struct wild_coord_index
+{
+  struct wild_coord_slot *slots;
+  unsigned int size; /* a power of two, or 0 before it is built */
+};
+
+static struct wild_coord_slot dynamic_slots[WILD_COORD_HASH_SIZE];
+static struct wild_coord_index dynamic_rooms = {dynamic_slots, WILD_COORD_HASH_SIZE};
+static struct wild_coord_index static_rooms = {NULL, 0};
+
+static room_rnum wild_free[WILD_DYNAMIC_ROOMS];
+static int wild_free_top = 0;
+static bool wild_on_free[WILD_DYNAMIC_ROOMS]; /* by vnum - WILD_DYNAMIC_ROOM_VNUM_START */
+static bool wild_indexed = FALSE;
+
+static void index_dynamic_rooms(void);
+
+static unsigned int wild_coord_hash(const struct wild_coord_index *idx, int x, int y)
+{
+  return (((unsigned int)x * 73856093U) ^ ((unsigned int)y * 19349663U)) & (idx->size - 1);
+}
+
+/* Where (x, y) is, or the empty slot it would go in. */
+static unsigned int wild_coord_slot(const struct wild_coord_index *idx, int x, int y)
+{
+  unsigned int i = wild_coord_hash(idx, x, y);
+
+  while (idx->slots[i].room != NOWHERE &&
+         (idx->slots[i].x != x || idx->slots[i].y != y))
+    i = (i + 1) & (idx->size - 1);
+
+  return i;
+}
+
+static room_rnum wild_coord_get(const struct wild_coord_index *idx, int x, int y)
+{
+  if (!idx->size)
+    return NOWHERE;
+
+  return idx->slots[wild_coord_slot(idx, x, y)].room;
+}
+
+static void wild_coord_set(struct wild_coord_index *idx, int x, int y, room_rnum room)
+{
+  unsigned int i = wild_coord_slot(idx, x, y);
+
+  idx->slots[i].x = x;
+  idx->slots[i].y = y;
+  idx->slots[i].room = room;
+}
+
+/* Forget (x, y) if it is room's, moving later entries of the probe run
+ * back so no tombstones are needed. */
+static void wild_coord_clear(struct wild_coord_index *idx, int x, int y, room_rnum room)
+{
+  unsigned int i = wild_coord_slot(idx, x, y), j, k;
+
+  if (idx->slots[i].room != room)
+    return;
+
+  for (j = i;;)
+  {
+    j = (j + 1) & (idx->size - 1);
+    if (idx->slots[j].room == NOWHERE)
+      break;
+
+    /* entries whose home is cyclically in (i, j] stay put */
+    k = wild_coord_hash(idx, idx->slots[j].x, idx->slots[j].y);
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+      continue;
+
+    idx->slots[i] = idx->slots[j];
+    i = j;
+  }
+
+  idx->slots[i].room = NOWHERE;
+}
+
+/* The dynamic room index, built if it has not been yet. */
+static struct wild_coord_index *dynamic_index(void)
+{
+  if (!wild_indexed)
+    index_dynamic_rooms();
+
+  return &dynamic_rooms;
+}
+
+static void wild_free_push(room_rnum room)
+{
+  int n = world[room].number - WILD_DYNAMIC_ROOM_VNUM_START;
+
+  if (wild_on_free[n])
+    return;
+
+  wild_on_free[n] = TRUE;
+  wild_free[wild_free_top++] = room;
+}
+
+static void index_dynamic_rooms(void)
+{
+  room_rnum room;
+  int i;
+
+  wild_indexed = TRUE;
+
+  for (i = 0; i < WILD_COORD_HASH_SIZE; i++)
+    dynamic_rooms.slots[i].room = NOWHERE;
+  memset(wild_on_free, 0, sizeof(wild_on_free));
+  wild_free_top = 0;
+
+  /* backwards, so the lowest vnums are handed out first, as they always were */
+  for (i = WILD_DYNAMIC_ROOM_VNUM_END; i >= WILD_DYNAMIC_ROOM_VNUM_START; i--)
+  {
+    if ((room = real_room(i)) == NOWHERE)
+      continue;
+
+    if (ROOM_FLAGGED(room, ROOM_OCCUPIED))
+      wild_coord_set(&dynamic_rooms, world[room].coords[X_COORD], world[room].coords[Y_COORD], room);
+    else
+      wild_free_push(room);
+  }
+}
+
+static void index_static_rooms(void)
+{
+  room_rnum room;
+  unsigned int i;
+  int vnum, count = 0;
+
+  /* The +1 is so that the 'magic' room is not included in the index. */
+  for (vnum = WILD_ROOM_VNUM_START + 1; vnum < WILD_DYNAMIC_ROOM_VNUM_START; vnum++)
+    if (real_room(vnum) != NOWHERE)
+      count++;
+
+  if (static_rooms.slots)
+    free(static_rooms.slots);
+
+  for (static_rooms.size = 64; static_rooms.size < (unsigned int)count * 2; static_rooms.size <<= 1)
+    ;
+  CREATE(static_rooms.slots, struct wild_coord_slot, static_rooms.size);
+  for (i = 0; i < static_rooms.size; i++)
+    static_rooms.slots[i].room = NOWHERE;
+
+  for (vnum = WILD_ROOM_VNUM_START + 1; vnum < WILD_DYNAMIC_ROOM_VNUM_START; vnum++)
+  {
+    if ((room = real_room(vnum)) == NOWHERE)
+      continue;
+
+    /* two rooms at one spot: the lower vnum wins */
+    if (wild_coord_get(&static_rooms, world[room].coords[X_COORD], world[room].coords[Y_COORD]) == NOWHERE)
+      wild_coord_set(&static_rooms, world[room].coords[X_COORD], world[room].coords[Y_COORD], room);
+  }
+}
 
 int wild_waterline = 128;
 
@@ -74,35 +247,14 @@ struct wild_map_info_type wild_map_info[] = {
     {-1, "", {NULL}}, /* RESERVED, NUM_ROOM_SECTORS */
 };
 
-/* Initialize the kd-tree that indexes the static rooms of the wilderness.
+/* Build the coordinate indexes of the wilderness rooms.
  * This procedure can be used to do whatever initialization is needed,
  * but be aware that it is run whenever a room is added or deleted from
  * the wilderness zone. */
 void initialize_wilderness_lists()
 {
-  int i;
-  double loc[2];
-  room_vnum *rm;
-
-  if (kd_wilderness_rooms != NULL)
-    kd_free(kd_wilderness_rooms);
-
-  kd_wilderness_rooms = kd_create(2);
-
-  /* The +1 for the initializer is so that the 'magic' room is not
-   * included in the index. */
-  for (i = WILD_ROOM_VNUM_START + 1; i < WILD_DYNAMIC_ROOM_VNUM_START; i++)
-  {
-    if (real_room(i) != NOWHERE)
-    {
-      CREATE(rm, room_rnum, 1);
-      *rm = real_room(i);
-      loc[0] = world[real_room(i)].coords[0];
-      loc[1] = world[real_room(i)].coords[1];
-
-      kd_insert(kd_wilderness_rooms, loc, rm);
-    }
-  }
+  index_static_rooms();
+  index_dynamic_rooms();
 }
 
 /* Get the value of the radial/box gradient at the specified (x,y) coordinate. */
@@ -169,18 +321,9 @@ double get_radial_gradient(int x, int y)
   return 0;
 }
 
-int get_elevation(int map, int x, int y)
+/* Turn the raw elevation and distortion noise at (x, y) into an elevation. */
+static int shape_elevation(int x, int y, double result, double dist)
 {
-  double trans_x;
-  double trans_y;
-  double result;
-  double dist;
-
-  trans_x = x / (double)(WILD_X_SIZE / 2.0);
-  trans_y = y / (double)(WILD_Y_SIZE / 2.0);
-
-  result = PerlinNoise2D(map, trans_x, trans_y, 2.0, 2.0, 16);
-
   /* Compress the data a little, makes better mountains. */
   result = (result > .8 ? .8 : result);
   result = (result < -.8 ? -.8 : result);
@@ -195,19 +338,63 @@ int get_elevation(int map, int x, int y)
   result *= result;
   result *= result;
 
+  /* Take a weighted average, normalize over [0..1] */
+  result = ((result + dist) + 1) / 3.0;
+
+  /* Apply the radial gradient. */
+  result *= get_radial_gradient(x, y);
+
+  return 255 * result;
+}
+
+/* Compute the elevation at (x, y), use get_elevation() to go through the cache. */
+static int gen_elevation(int map, int x, int y)
+{
+  double trans_x;
+  double trans_y;
+  double result;
+  double dist;
+
+  trans_x = x / (double)(WILD_X_SIZE / 2.0);
+  trans_y = y / (double)(WILD_Y_SIZE / 2.0);
+
+  result = PerlinNoise2D(map, trans_x, trans_y, 2.0, 2.0, 16);
+
   trans_x = x / (double)(WILD_X_SIZE / 8.0);
   trans_y = y / (double)(WILD_Y_SIZE / 8.0);
 
   /* get the distortion */
   dist = PerlinNoise2D(NOISE_MATERIAL_PLANE_ELEV_DIST, trans_x, trans_y, 1.5, 2.0, 16);
 
-  /* Take a weighted average, normalize over [0..1] */
-  result = ((result + dist) + 1) / 3.0;
+  return shape_elevation(x, y, result, dist);
+}
 
-  /* Apply the radial gradient. */
-  result *= get_radial_gradient(x, y);
+/* Same as gen_elevation(), for the w x h rectangle at (x0, y0), row major. */
+static void gen_elevation_grid(int map, int x0, int y0, int w, int h, int *out)
+{
+  double *noise, *dist;
+  int i;
 
-  return 255 * result;
+  CREATE(noise, double, w * h);
+  CREATE(dist, double, w * h);
+
+  PerlinNoise2DGrid(map, x0 / (double)(WILD_X_SIZE / 2.0), y0 / (double)(WILD_Y_SIZE / 2.0),
+                    1 / (double)(WILD_X_SIZE / 2.0), 1 / (double)(WILD_Y_SIZE / 2.0),
+                    w, h, 2.0, 2.0, 16, noise);
+  PerlinNoise2DGrid(NOISE_MATERIAL_PLANE_ELEV_DIST, x0 / (double)(WILD_X_SIZE / 8.0), y0 / (double)(WILD_Y_SIZE / 8.0),
+                    1 / (double)(WILD_X_SIZE / 8.0), 1 / (double)(WILD_Y_SIZE / 8.0),
+                    w, h, 1.5, 2.0, 16, dist);
+
+  for (i = 0; i < w * h; i++)
+    out[i] = shape_elevation(x0 + i % w, y0 + i / w, noise[i], dist[i]);
+
+  free(noise);
+  free(dist);
+}
+
+int get_elevation(int map, int x, int y)
+{
+  return terrain_cache_get(TERRAIN_ELEVATION, map, x, y, gen_elevation);
 }
 
 int get_weather(int x, int y)
@@ -233,7 +420,8 @@ int get_weather(int x, int y)
   return 255 * result;
 }
 
-int get_moisture(int map, int x, int y)
+/* Compute the moisture at (x, y), use get_moisture() to go through the cache. */
+static int gen_moisture(int map, int x, int y)
 {
   double trans_x;
   double trans_y;
@@ -250,11 +438,32 @@ int get_moisture(int map, int x, int y)
   return 255 * result;
 }
 
-int get_temperature(int map, int x, int y)
+/* Same as gen_moisture(), for the w x h rectangle at (x0, y0), row major. */
+static void gen_moisture_grid(int map, int x0, int y0, int w, int h, int *out)
+{
+  double *noise;
+  int i;
+
+  CREATE(noise, double, w * h);
+
+  PerlinNoise2DGrid(map, x0 / (double)(WILD_X_SIZE / 8.0), y0 / (double)(WILD_Y_SIZE / 8.0),
+                    1 / (double)(WILD_X_SIZE / 8.0), 1 / (double)(WILD_Y_SIZE / 8.0),
+                    w, h, 1.5, 2.0, 8, noise);
+
+  for (i = 0; i < w * h; i++)
+    out[i] = 255 * ((noise[i] + 1) / 2.0);
+
+  free(noise);
+}
+
+int get_moisture(int map, int x, int y)
 {
-  /* This is a gradient in the y direction, modified
-   * by terrain height. */
+  return terrain_cache_get(TERRAIN_MOISTURE, map, x, y, gen_moisture);
+}
 
+/* Temperature is a gradient in the y direction, modified by terrain height. */
+static int temperature_from_elevation(int y, int elevation)
+{
   int max_temp = 35;
   int min_temp = -30;
   int dist = 0;
@@ -270,11 +479,16 @@ int get_temperature(int map, int x, int y)
   pct = (double)(dist / (double)(WILD_Y_SIZE - equator));
 
   /* Return the temp. */
-  temp = (max_temp - (max_temp - min_temp) * pct) - (MAX(1.5 * get_elevation(map, x, y) - WATERLINE, 0)) / 10;
+  temp = (max_temp - (max_temp - min_temp) * pct) - (MAX(1.5 * elevation - WATERLINE, 0)) / 10;
 
   return temp;
 }
 
+int get_temperature(int map, int x, int y)
+{
+  return temperature_from_elevation(y, get_elevation(map, x, y));
+}
+
 /* 
  * Generate a height map centered on center_x and center_y. 
  */
@@ -286,22 +500,31 @@ void get_map(int xsize, int ysize, int center_x, int center_y, struct wild_map_t
   int trans_x, trans_y;
 
   /* Below is for looking up static rooms. */
-  room_rnum *room;
-  double loc[2], pos[2];
-  void *set;
+  room_rnum room;
+
+  /* Terrain for the whole map, fetched as one rectangle. */
+  int *elevation, *moisture;
 
   x_offset = (center_x - ((xsize - 1) / 2));
   y_offset = (center_y - ((ysize - 1) / 2));
 
+  CREATE(elevation, int, xsize * ysize);
+  CREATE(moisture, int, xsize * ysize);
+
+  terrain_cache_get_rect(TERRAIN_ELEVATION, NOISE_MATERIAL_PLANE_ELEV, x_offset, y_offset,
+                         xsize, ysize, elevation, gen_elevation_grid);
+  terrain_cache_get_rect(TERRAIN_MOISTURE, NOISE_MATERIAL_PLANE_MOISTURE, x_offset, y_offset,
+                         xsize, ysize, moisture, gen_moisture_grid);
+
   /* map MUST be big enough! */
   for (y = 0; y < ysize; y++)
   {
     for (x = 0; x < xsize; x++)
     {
       map[x][y].vis = 0;
-      map[x][y].sector_type = get_sector_type(get_elevation(NOISE_MATERIAL_PLANE_ELEV, x + x_offset, y + y_offset),
-                                              get_temperature(NOISE_MATERIAL_PLANE_ELEV, x + x_offset, y + y_offset),
-                                              get_moisture(NOISE_MATERIAL_PLANE_MOISTURE, x + x_offset, y + y_offset));
+      map[x][y].sector_type = get_sector_type(elevation[y * xsize + x],
+                                              temperature_from_elevation(y + y_offset, elevation[y * xsize + x]),
+                                              moisture[y * xsize + x]);
       map[x][y].glyph = NULL;
       map[x][y].num_regions = 0;
       map[x][y].weather = get_weather(x + x_offset, y + y_offset);
@@ -362,6 +585,8 @@ void get_map(int xsize, int ysize, int center_x, int center_y, struct wild_map_t
           break;
         }
       }
+      free_region_list(regions);
+      free_path_list(paths);
 
       /* Check if the sector type has variant glyphs */
       if (wild_map_info[map[x][y].sector_type].variant_disp[0])
@@ -378,30 +603,19 @@ void get_map(int xsize, int ysize, int center_x, int center_y, struct wild_map_t
     }
   }
 
-  /* use the kd_wilderness_rooms kd-tree index to look up the nearby rooms */
-  loc[0] = center_x;
-  loc[1] = center_y;
-  set = kd_nearest_range(kd_wilderness_rooms, loc, ((xsize - 1) / 2) + 1);
-
-  while (!kd_res_end(set))
-  {
-    room = (room_rnum *)kd_res_item(set, pos);
-
-    /* Sanity check. */
-    trans_x = MAX(0, MIN((int)pos[0] - x_offset, xsize));
-    trans_y = MAX(0, MIN((int)pos[1] - y_offset, ysize));
+  free(elevation);
+  free(moisture);
 
-    if ((trans_x < xsize) && (trans_y < ysize))
+  /* static rooms override the generated terrain, one probe per tile */
+  for (trans_y = 0; trans_y < ysize; trans_y++)
+    for (trans_x = 0; trans_x < xsize; trans_x++)
     {
-      // log ("Altering room (%f, %f) based on kd-tree index!\r\n", pos[0], pos[1]);
-      map[trans_x][trans_y].sector_type = world[*room].sector_type;
+      if ((room = find_static_room_by_coordinates(trans_x + x_offset, trans_y + y_offset)) == NOWHERE)
+        continue;
+
+      map[trans_x][trans_y].sector_type = world[room].sector_type;
       map[trans_x][trans_y].glyph = NULL;
     }
-    /* go to the next entry */
-    kd_res_next(set);
-  }
-
-  kd_res_free(set);
 }
 
 /* Get the sector type based on the three variables -
@@ -539,26 +753,14 @@ int get_modified_sector_type(zone_rnum zone, int x, int y)
       }
     }
   }
+  free_region_list(regions);
+  free_path_list(paths);
   return sector_type;
 }
 
 room_rnum find_static_room_by_coordinates(int x, int y)
 {
-  double loc[2], pos[2];
-  void *set;
-  room_rnum *room;
-
-  /* use the kd_wilderness_rooms kd-tree index to look up the room at (x, y) */
-  loc[0] = (double)x;
-  loc[1] = (double)y;
-
-  set = kd_nearest_range(kd_wilderness_rooms, loc, 0.5);
-  while (!kd_res_end(set))
-  {
-    room = (room_rnum *)kd_res_item(set, pos);
-    return *room;
-  }
-  return NOWHERE;
+  return wild_coord_get(&static_rooms, x, y);
 }
 
 /* Function to retreive a room based on coordinates.  The coordinates are
@@ -566,8 +768,6 @@ room_rnum find_static_room_by_coordinates(int x, int y)
  * vector and a pointer to struct room_data (the actual room!). */
 room_rnum find_room_by_coordinates(int x, int y)
 {
-
-  int i = 0;
   room_rnum room = NOWHERE;
 
   if ((room = find_static_room_by_coordinates(x, y)) != NOWHERE)
@@ -575,16 +775,15 @@ room_rnum find_room_by_coordinates(int x, int y)
     return room;
   }
   /* Check the dynamic rooms. */
-  for (i = WILD_DYNAMIC_ROOM_VNUM_START; (i <= WILD_DYNAMIC_ROOM_VNUM_END) && (real_room(i) != NOWHERE); i++)
+  room = wild_coord_get(dynamic_index(), x, y);
+  if (room != NOWHERE && ROOM_FLAGGED(room, ROOM_OCCUPIED) &&
+      (world[room].coords[X_COORD] == x) &&
+      (world[room].coords[Y_COORD] == y))
   {
-    if ((ROOM_FLAGGED(real_room(i), ROOM_OCCUPIED)) &&
-        (world[real_room(i)].coords[X_COORD] == x) &&
-        (world[real_room(i)].coords[Y_COORD] == y))
-    {
-      /* Match */
-      return real_room(i);
-    }
+    /* Match */
+    return room;
   }
+  room = NOWHERE;
 
   /* No rooms currently allocated for (x,y), so allocate one. */
   //  if((room = find_available_wilderness_room()) == NOWHERE)
@@ -595,26 +794,51 @@ room_rnum find_room_by_coordinates(int x, int y)
   return room;
 }
 
+/* The room on top of the free stack stays there until someone actually
+ * moves in, so asking twice without using it gives the same room. */
 room_rnum find_available_wilderness_room()
 {
-  int i = 0;
+  room_rnum room;
 
-  for (i = WILD_DYNAMIC_ROOM_VNUM_START; i <= WILD_DYNAMIC_ROOM_VNUM_END; i++)
+  dynamic_index();
+
+  while (wild_free_top > 0)
   {
-    /* Skip gaps. */
-    if (real_room(i) == NOWHERE)
-      continue;
+    room = wild_free[wild_free_top - 1];
 
-    if (!ROOM_FLAGGED(real_room(i), ROOM_OCCUPIED))
+    if (!ROOM_FLAGGED(room, ROOM_OCCUPIED))
     {
       /* Here is our room. */
-      return real_room(i);
+      return room;
     }
+
+    /* Taken since it was freed. */
+    wild_on_free[world[room].number - WILD_DYNAMIC_ROOM_VNUM_START] = FALSE;
+    wild_free_top--;
   }
   /* If we get here, there is a problem. */
   return NOWHERE;
 }
 
+/* Mark a dynamic room as in use at its coordinates. */
+void occupy_wilderness_room(room_rnum room)
+{
+  SET_BIT_AR(ROOM_FLAGS(room), ROOM_OCCUPIED);
+  wild_coord_set(dynamic_index(), world[room].coords[X_COORD], world[room].coords[Y_COORD], room);
+}
+
+/* Give a dynamic room back to the pool. */
+void release_wilderness_room(room_rnum room)
+{
+  REMOVE_BIT_AR(ROOM_FLAGS(room), ROOM_OCCUPIED);
+
+  if (!IS_DYNAMIC(room))
+    return;
+
+  wild_coord_clear(dynamic_index(), world[room].coords[X_COORD], world[room].coords[Y_COORD], room);
+  wild_free_push(room);
+}
+
 void assign_wilderness_room(room_rnum room, int x, int y)
 {
 
@@ -637,6 +861,11 @@ void assign_wilderness_room(room_rnum room, int x, int y)
   }
 
   /* Here we will set the coordinates, build the descriptions, set the exits, sector type, etc. */
+  if (IS_DYNAMIC(room))
+  {
+    wild_coord_clear(dynamic_index(), world[room].coords[0], world[room].coords[1], room);
+    wild_coord_set(dynamic_index(), x, y, room);
+  }
   world[room].coords[0] = x;
   world[room].coords[1] = y;
 
@@ -697,6 +926,8 @@ void assign_wilderness_room(room_rnum room, int x, int y)
       }
     }
   }
+  free_region_list(regions);
+  free_path_list(paths);
 
   /* Generate the description, now that everything else is set up. */
   world[room].description = wilderness_desc;
@@ -1030,7 +1261,7 @@ EVENTFUNC(event_check_occupied)
       (room->events && room->events->iSize == 1))
   {
 
-    REMOVE_BIT_AR(ROOM_FLAGS(rnum), ROOM_OCCUPIED);
+    release_wilderness_room(rnum);
     return 0; /* No need to continue checking! */
   }
   else
@@ -1087,9 +1318,9 @@ void save_map_to_file(const char *fn, int xsize, int ysize)
   int i, x, y;
   int color_by_sector[NUM_ROOM_SECTORS];
   int sector_type;
-  room_rnum *room;
-  double loc[2], pos[2];
-  void *set;
+  room_rnum room;
+  int *elevation, *moisture;
+  int row_start = -xsize / 2, row_len = xsize / 2 - (-xsize / 2);
 
   im = gdImageCreate(xsize, ysize); //create an image
 
@@ -1137,16 +1368,24 @@ void save_map_to_file(const char *fn, int xsize, int ysize)
     gray[i] = gdImageColorAllocate(im, i, i, i);
   }
 
+  /* The export covers far more tiles than the terrain cache holds, so each
+   * row is generated directly instead of going through it. */
+  CREATE(elevation, int, MAX(row_len, 1));
+  CREATE(moisture, int, MAX(row_len, 1));
+
   for (y = (-ysize / 2); y < ysize / 2; y++)
   {
+    gen_elevation_grid(NOISE_MATERIAL_PLANE_ELEV, row_start, -y, row_len, 1, elevation);
+    gen_moisture_grid(NOISE_MATERIAL_PLANE_MOISTURE, row_start, -y, row_len, 1, moisture);
+
     for (x = (-xsize / 2); x < xsize / 2; x++)
     {
       /* We need to check for prebuilt rooms at these coordinates, as well
        * as regions that might change the sector type.  */
       /* Start with the default - The value returned for the generated wilderness. */
-      sector_type = get_sector_type(get_elevation(NOISE_MATERIAL_PLANE_ELEV, x, -y),
-                                    get_temperature(NOISE_MATERIAL_PLANE_ELEV, x, -y),
-                                    get_moisture(NOISE_MATERIAL_PLANE_MOISTURE, x, -y));
+      sector_type = get_sector_type(elevation[x - row_start],
+                                    temperature_from_elevation(-y, elevation[x - row_start]),
+                                    moisture[x - row_start]);
 
       /* Map should reflect changes from regions */
       struct region_list *regions = NULL;
@@ -1194,31 +1433,24 @@ void save_map_to_file(const char *fn, int xsize, int ysize)
           break;
         }
       }
+      free_region_list(regions);
+      free_path_list(paths);
 
-      /* use the kd_wilderness_rooms kd-tree index to look up the nearby rooms */
-      loc[0] = x;
-      loc[1] = -y;
-      set = kd_nearest_range(kd_wilderness_rooms, loc, 1); /* size is 1, we check each coord. */
-
-      while (!kd_res_end(set))
-      {
-        room = (room_rnum *)kd_res_item(set, pos);
-        sector_type = world[*room].sector_type;
-
-        /* go to the next entry */
-        kd_res_next(set);
-      }
-
-      kd_res_free(set);
+      /* a static room at this spot overrides the terrain */
+      if ((room = find_static_room_by_coordinates(x, -y)) != NOWHERE)
+        sector_type = world[room].sector_type;
 
       /* Use greytones for impassable mountains. */
       if (sector_type == SECT_HIGH_MOUNTAIN)
-        gdImageSetPixel(im, x + xsize / 2, ysize / 2 + y, gray[get_elevation(NOISE_MATERIAL_PLANE_ELEV, x, -y)]);
+        gdImageSetPixel(im, x + xsize / 2, ysize / 2 + y, gray[elevation[x - row_start]]);
       else
         gdImageSetPixel(im, x + xsize / 2, ysize / 2 + y, color_by_sector[sector_type]);
     }
   }
 
+  free(elevation);
+  free(moisture);
+
   out = fopen(fn, "wb");
   gdImagePng(im, out);
   fclose(out);
@@ -1234,7 +1466,8 @@ void save_noise_to_file(int idx, const char *fn, int xsize, int ysize, int zoom)
   int i, x, y;
   double pixel;
   //  double dist;
-  double trans_x, trans_y;
+  double trans_y;
+  double *row;
 
   //  int canvas_x = (zoom == 0 ? xsize : xsize/(2*zoom));
   //  int canvas_y = (zoom == 0 ? ysize : ysize/(2*zoom));
@@ -1251,15 +1484,19 @@ void save_noise_to_file(int idx, const char *fn, int xsize, int ysize, int zoom)
     gray[i] = gdImageColorAllocate(im, i, i, i);
   }
 
+  CREATE(row, double, canvas_y + 1);
+
   for (y = 0; y <= canvas_x; y++)
   {
-    for (x = 0; x <= canvas_y; x++)
-    {
+    trans_y = y / (double)((ysize / 4.0) * (zoom == 0 ? 1 : 0.5 * zoom));
 
-      trans_x = x / (double)((xsize / 4.0) * (zoom == 0 ? 1 : 0.5 * zoom));
-      trans_y = y / (double)((ysize / 4.0) * (zoom == 0 ? 1 : 0.5 * zoom));
+    /* One noise call for the whole row. */
+    PerlinNoise2DGrid(idx, 0, trans_y, 1 / (double)((xsize / 4.0) * (zoom == 0 ? 1 : 0.5 * zoom)), 0,
+                      canvas_y + 1, 1, 2.0, 2.0, 16, row);
 
-      pixel = PerlinNoise2D(idx, trans_x, trans_y, 2.0, 2.0, 16);
+    for (x = 0; x <= canvas_y; x++)
+    {
+      pixel = row[x];
 
       pixel = (pixel + 1) / 2.0;
       //      pixel =1.0 -  (pixel < 0 ? -pixel : pixel);
@@ -1275,6 +1512,8 @@ void save_noise_to_file(int idx, const char *fn, int xsize, int ysize, int zoom)
     }
   }
 
+  free(row);
+
   out = fopen(fn, "wb");
   gdImagePng(im, out);
   fclose(out);
@@ -1289,9 +1528,7 @@ void generate_river(struct char_data *ch, int dir, region_vnum vnum, const char
   struct vertex vertices[1024];
   int num_vertices = 0;
   int sector_type;
-  room_rnum *room;
-  double loc[2], pos[2];
-  void *set;
+  room_rnum room;
   int move_dir = -1;
   int new_move_dir = -1;
 
@@ -1459,21 +1696,12 @@ void generate_river(struct char_data *ch, int dir, region_vnum vnum, const char
         break;
       }
     }
+    free_region_list(regions);
+    free_path_list(paths);
 
-    /* use the kd_wilderness_rooms kd-tree index to look up the nearby rooms */
-    loc[0] = x;
-    loc[1] = -y;
-    set = kd_nearest_range(kd_wilderness_rooms, loc, 1); /* size is 1, we check each coord. */
-
-    while (!kd_res_end(set))
-    {
-      room = (room_rnum *)kd_res_item(set, pos);
-      sector_type = world[*room].sector_type;
-
-      /* go to the next entry */
-      kd_res_next(set);
-    }
-    kd_res_free(set);
+    /* a static room at this spot overrides the terrain */
+    if ((room = find_static_room_by_coordinates(x, -y)) != NOWHERE)
+      sector_type = world[room].sector_type;
   }
 
   /* Create the structure for the path */
@@ -92,8 +92,6 @@
 #define WILD_MAP_SHAPE_CIRCLE 1
 #define WILD_MAP_SHAPE_RECT 2
 
-extern struct kdtree *kd_wilderness_rooms;
-
 struct wild_map_info_type
 {
   int sector_type;
@@ -212,6 +210,8 @@ room_rnum find_available_wilderness_room();       /* Get the next empty room in
 room_rnum find_room_by_coordinates(int x, int y); /* Get the room at coordinates (x,y) */
 room_rnum find_static_room_by_coordinates(int x, int y);
 void assign_wilderness_room(room_rnum room, int x, int y); /* Assign the room to the provided coordinates, adjusting descriptions, etc. */
+void occupy_wilderness_room(room_rnum room);  /* Flag a dynamic room as in use at its coordinates. */
+void release_wilderness_room(room_rnum room); /* Return a dynamic room to the pool. */
 
 /* Regions */
 /*
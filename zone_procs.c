@@ -3256,6 +3256,7 @@ void open_exit(struct slider_row row)
   REMOVE_BIT(EXITN(row.room, row.door)->exit_info, EX_LOCKED);
   //REMOVE_BIT(EXITN(row.room, row.door)->exit_info, EX_HIDDEN3);
   SET_BIT(EXITN(row.room, row.door)->exit_info, EX_PICKPROOF);
+  world_doors_changed();
 }
 
 void close_exit(struct slider_row row)
@@ -3264,6 +3265,7 @@ void close_exit(struct slider_row row)
   SET_BIT(EXITN(row.room, row.door)->exit_info, EX_LOCKED);
   //SET_BIT(EXITN(row.room, row.door)->exit_info, EX_HIDDEN3);
   SET_BIT(EXITN(row.room, row.door)->exit_info, EX_PICKPROOF);
+  world_doors_changed();
 }
 
 static void send_to_cube(const char *echo)